@@ -0,0 +1,48 @@
+#include "arena.hpp"
+
+#include <cstdlib>
+#include <new>
+
+Arena::Arena(size_t chunkSize) {
+  this->chunks = NULL;
+  this->next = NULL;
+  this->limit = NULL;
+  this->chunkSize = chunkSize;
+  this->used = 0;
+}
+
+Arena::~Arena() {
+  release();
+}
+
+// Starts a new chunk when the current one is full. Requests larger
+// than the chunk size get a chunk of their own.
+void *Arena::allocateSlow(size_t size) {
+  size_t header = (sizeof(Chunk) + alignment - 1) & ~(alignment - 1);
+  size_t capacity = size > chunkSize ? size : chunkSize;
+  Chunk *chunk = (Chunk *) malloc(header + capacity);
+  if (!chunk)
+    throw std::bad_alloc();
+  chunk->next = chunks;
+  chunk->size = capacity;
+  chunks = chunk;
+  char *memory = (char *) chunk + header;
+  // An oversized chunk is used up at once; keep bump allocating
+  // from the current chunk
+  if (size > chunkSize)
+    return memory;
+  next = memory + size;
+  limit = memory + capacity;
+  return memory;
+}
+
+void Arena::release() {
+  while (chunks) {
+    Chunk *chunk = chunks;
+    chunks = chunk->next;
+    free(chunk);
+  }
+  next = NULL;
+  limit = NULL;
+  used = 0;
+}
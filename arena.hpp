@@ -0,0 +1,113 @@
+#ifndef __ARENA_HPP
+#define __ARENA_HPP
+
+#include <cstddef>
+#include <cstring>
+
+// Defines a bump allocator. Memory is handed out from large
+// chunks by moving a pointer, and is only ever given back all at
+// once, when the arena is released or destroyed. The AST of a
+// compilation lives in one arena: nodes never own other memory,
+// so no destructors have to run and the whole tree is freed by
+// freeing the chunks.
+class Arena {
+private:
+  struct Chunk {
+    Chunk *next;
+    size_t size;
+  };
+
+  Chunk *chunks;
+  char *next;
+  char *limit;
+  size_t chunkSize;
+  size_t used;
+
+  void *allocateSlow(size_t size);
+
+  Arena(const Arena &);
+  Arena &operator=(const Arena &);
+
+public:
+  Arena(size_t chunkSize = 256 * 1024);
+  ~Arena();
+
+  // Returns size bytes aligned for a pointer, which is as much as
+  // nodes, lists and names need, so that nodes take no padding
+  void *allocate(size_t size) {
+    size = (size + alignment - 1) & ~(alignment - 1);
+    used += size;
+    if ((size_t) (limit - next) >= size) {
+      void *memory = next;
+      next += size;
+      return memory;
+    }
+    return allocateSlow(size);
+  }
+
+  // Frees everything allocated from the arena
+  void release();
+
+  // Returns the number of bytes handed out since the arena was
+  // created or last released
+  size_t bytesUsed() const { return used; }
+
+  static const size_t alignment = alignof(void *);
+};
+
+// Defines a list of child nodes. Lists are contiguous arrays in
+// the arena of their tree that grow by doubling; the old array is left in
+// the arena, which frees it along with the rest of the tree.
+// Lists are built by appending, in the parser, and are read
+// through iterators, which are plain pointers. Lists built by
+// right-recursive rules come out backwards and are reversed.
+template <typename T>
+class NodeList {
+private:
+  Arena *arena;
+  T *items;
+  unsigned int count;
+  unsigned int capacity;
+
+public:
+  typedef T *iterator;
+  typedef const T *const_iterator;
+
+  NodeList(Arena &arena) : arena(&arena), items(NULL), count(0), capacity(0) {}
+
+  void push_back(const T &item) {
+    if (count == capacity) {
+      unsigned int grown = capacity ? capacity * 2 : 4;
+      T *larger = (T *) arena->allocate(grown * sizeof(T));
+      if (count)
+        memcpy(larger, items, count * sizeof(T));
+      items = larger;
+      capacity = grown;
+    }
+    items[count++] = item;
+  }
+
+  iterator begin() { return items; }
+  iterator end() { return items + count; }
+  const_iterator begin() const { return items; }
+  const_iterator end() const { return items + count; }
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  T &operator[](size_t index) { return items[index]; }
+  T &front() { return items[0]; }
+  T &back() { return items[count - 1]; }
+
+  void reverse() {
+    for (unsigned int i = 0, j = count; i + 1 < j; i++, j--) {
+      T item = items[i];
+      items[i] = items[j - 1];
+      items[j - 1] = item;
+    }
+  }
+
+  static void *operator new(size_t size, Arena &arena) { return arena.allocate(size); }
+  static void operator delete(void *, Arena &) {}
+  static void operator delete(void *) {}
+};
+
+#endif
@@ -0,0 +1,1332 @@
+#ifndef __AST_HPP
+#define __AST_HPP
+
+#include <iostream>
+#include <vector>
+#include <stack>
+#include <string>
+#include <sstream>
+
+#include "arena.hpp"
+#include "stats.hpp"
+#include "symbols.hpp"
+
+// Enumaration of all base types in the language. bt_error is the poison
+//   type given to expressions whose type could not be determined
+typedef enum {bt_integer, bt_boolean, bt_none, bt_object, bt_error} BaseType;
+
+// Types are numbered by small ids, which are what nodes and the symbol
+//   table store. A base type other than object is its own id, and the
+//   type of the objects of a class is numbered after them by the symbol
+//   of the class name, so the symbol interner of a compilation is also
+//   its table of types and ids are taken apart without a lookup
+typedef unsigned int TypeId;
+const TypeId firstObjectType = bt_error + 1;
+
+inline TypeId typeId(BaseType baseType, Symbol className = noSymbol) {
+  return baseType == bt_object ? firstObjectType + className : baseType;
+}
+
+inline BaseType baseTypeOf(TypeId type) {
+  return type < firstObjectType ? (BaseType) type : bt_object;
+}
+
+// Returns the class of an object type, or noSymbol for other types
+inline Symbol classNameOf(TypeId type) {
+  return type < firstObjectType ? noSymbol : type - firstObjectType;
+}
+
+// Forward declarations of AST Node classes
+class ProgramNode;
+class ClassNode;
+class MethodNode;
+class MethodBodyNode;
+class ParameterNode;
+class DeclarationNode;
+class ReturnStatementNode;
+class AssignmentNode;
+class CallNode;
+class IfElseNode;
+class WhileNode;
+class RepeatNode;
+class PrintNode;
+class PlusNode;
+class MinusNode;
+class TimesNode;
+class DivideNode;
+class LessNode;
+class LessEqualNode;
+class EqualNode;
+class AndNode;
+class OrNode;
+class NotNode;
+class NegationNode;
+class MethodCallNode;
+class MemberAccessNode;
+class VariableNode;
+class IntegerLiteralNode;
+class BooleanLiteralNode;
+class NewNode;
+class IntegerTypeNode;
+class BooleanTypeNode;
+class ObjectTypeNode;
+class NoneNode;
+
+
+class StatementNode;
+
+class ExpressionNode;
+
+class TypeNode;
+
+class IdentifierNode;
+class IntegerNode;
+
+// Enumeration of the kinds of AST nodes. Every node stores its kind, so that
+//   statically dispatched visitors can switch on it, and the kinds number
+//   the nodes counted in --stats
+typedef enum : unsigned char {
+  nk_Program,
+  nk_Class,
+  nk_Method,
+  nk_MethodBody,
+  nk_Parameter,
+  nk_Declaration,
+  nk_ReturnStatement,
+  nk_Assignment,
+  nk_Call,
+  nk_IfElse,
+  nk_While,
+  nk_Repeat,
+  nk_Print,
+  nk_Plus,
+  nk_Minus,
+  nk_Times,
+  nk_Divide,
+  nk_Less,
+  nk_LessEqual,
+  nk_Equal,
+  nk_And,
+  nk_Or,
+  nk_Not,
+  nk_Negation,
+  nk_MethodCall,
+  nk_MemberAccess,
+  nk_Variable,
+  nk_IntegerLiteral,
+  nk_BooleanLiteral,
+  nk_New,
+  nk_IntegerType,
+  nk_BooleanType,
+  nk_ObjectType,
+  nk_None,
+  nk_Identifier,
+  nk_Integer
+} NodeKind;
+#define AST_NODE_KINDS 36
+static_assert(AST_NODE_KINDS <= STATS_NODE_KINDS, "too many kinds of nodes to count");
+extern const char* const astNodeNames[AST_NODE_KINDS];
+
+// Check order of inclusion
+#ifdef YYSTYPE_IS_TRIVIAL
+#error Make sure to include this file BEFORE parser.hpp
+#endif
+
+// Define YYSTYPE (type of all $$, $N variables) as a union
+//   of all necessary pointers (including lists). This will
+//   be used in %type specifiers and in lexer.
+typedef union {
+  ProgramNode* program_ptr;
+  NodeList<ClassNode*>* class_list_ptr;
+  ClassNode* class_ptr;
+  IdentifierNode* identifier_ptr;
+  NodeList<DeclarationNode*>* declaration_list_ptr;
+  NodeList<MethodNode*>* method_list_ptr;
+  MethodNode* method_ptr;
+  NodeList<ParameterNode*>* parameter_list_ptr;
+  TypeNode* type_ptr;
+  MethodBodyNode* methodbody_ptr;
+  NodeList<StatementNode*>* statement_list_ptr;
+  ReturnStatementNode* returnstatement_ptr;
+  ParameterNode* parameter_ptr;
+  DeclarationNode* declaration_ptr;
+  NodeList<IdentifierNode*>* identifier_list_ptr;
+  ExpressionNode* expression_ptr;
+  AssignmentNode* assignment_ptr;
+  CallNode* call_ptr;
+  MethodCallNode* methodcall_ptr;
+  IfElseNode* ifelse_ptr;
+  WhileNode* while_ptr;
+  RepeatNode* repeat_ptr;
+  PrintNode* print_ptr;
+  PlusNode* plus_ptr;
+  MinusNode* minus_ptr;
+  TimesNode* times_ptr;
+  DivideNode* divide_ptr;
+  LessNode* less_ptr;
+  LessEqualNode* lessequal_ptr;
+  EqualNode* equal_ptr;
+  AndNode* and_ptr;
+  OrNode* or_ptr;
+  NotNode* not_ptr;
+  NegationNode* negation_ptr;
+  NodeList<ExpressionNode*>* expression_list_ptr;
+  MemberAccessNode* memberaccess_ptr;
+  VariableNode* variable_ptr;
+  IntegerLiteralNode* integerliteral_ptr;
+  IntegerNode* integer_ptr;
+  BooleanLiteralNode* booleanliteral_ptr;
+  NewNode* new_ptr;
+  IntegerTypeNode* integertype_ptr;
+  BooleanTypeNode* booleantype_ptr;
+  ObjectTypeNode* objecttype_ptr;
+  NoneNode* none_ptr;
+  StatementNode* statement_ptr;
+  char* base_char_ptr;
+  int base_int;
+} astnode_union;
+#define YYSTYPE astnode_union
+
+// Define abstract base class for all Visitors
+class Visitor {
+public:
+  // Declare all virtual visitor functions (all must be implemented in visitors)
+  virtual void visitProgramNode(ProgramNode* node) = 0;
+  virtual void visitClassNode(ClassNode* node) = 0;
+  virtual void visitMethodNode(MethodNode* node) = 0;
+  virtual void visitMethodBodyNode(MethodBodyNode* node) = 0;
+  virtual void visitParameterNode(ParameterNode* node) = 0;
+  virtual void visitDeclarationNode(DeclarationNode* node) = 0;
+  virtual void visitReturnStatementNode(ReturnStatementNode* node) = 0;
+  virtual void visitAssignmentNode(AssignmentNode* node) = 0;
+  virtual void visitCallNode(CallNode* node) = 0;
+  virtual void visitIfElseNode(IfElseNode* node) = 0;
+  virtual void visitWhileNode(WhileNode* node) = 0;
+  virtual void visitRepeatNode(RepeatNode* node) = 0;
+  virtual void visitPrintNode(PrintNode* node) = 0;
+  virtual void visitPlusNode(PlusNode* node) = 0;
+  virtual void visitMinusNode(MinusNode* node) = 0;
+  virtual void visitTimesNode(TimesNode* node) = 0;
+  virtual void visitDivideNode(DivideNode* node) = 0;
+  virtual void visitLessNode(LessNode* node) = 0;
+  virtual void visitLessEqualNode(LessEqualNode* node) = 0;
+  virtual void visitEqualNode(EqualNode* node) = 0;
+  virtual void visitAndNode(AndNode* node) = 0;
+  virtual void visitOrNode(OrNode* node) = 0;
+  virtual void visitNotNode(NotNode* node) = 0;
+  virtual void visitNegationNode(NegationNode* node) = 0;
+  virtual void visitMethodCallNode(MethodCallNode* node) = 0;
+  virtual void visitMemberAccessNode(MemberAccessNode* node) = 0;
+  virtual void visitVariableNode(VariableNode* node) = 0;
+  virtual void visitIntegerLiteralNode(IntegerLiteralNode* node) = 0;
+  virtual void visitBooleanLiteralNode(BooleanLiteralNode* node) = 0;
+  virtual void visitNewNode(NewNode* node) = 0;
+  virtual void visitIntegerTypeNode(IntegerTypeNode* node) = 0;
+  virtual void visitBooleanTypeNode(BooleanTypeNode* node) = 0;
+  virtual void visitObjectTypeNode(ObjectTypeNode* node) = 0;
+  virtual void visitNoneNode(NoneNode* node) = 0;
+  virtual void visitIdentifierNode(IdentifierNode* node) = 0;
+  virtual void visitIntegerNode(IntegerNode* node) = 0;
+};
+
+// Define abstract base class for all AST Nodes
+//   (this also serves to define the visitable objects)
+class ASTNode {
+public:
+  // All AST nodes have a member which stores their type id, which gives
+  //   their basetype (int, bool, none, object) and, if the base type is
+  //   object, the class name (as an interned symbol)
+  TypeId typeId;
+  // All AST nodes store their kind, which is set by the constructor
+  //   of each concrete node class. The kind is a byte, so that it fits
+  //   beside the type id and a node with no children takes 16 bytes
+  NodeKind kind;
+
+  ASTNode() : typeId(bt_none) {}
+
+  BaseType basetype() const { return baseTypeOf(typeId); }
+  Symbol objectClassName() const { return classNameOf(typeId); }
+
+  // All AST nodes are allocated from the arena of their compilation,
+  //   with new (arena) Node(...), and are freed with it all at once,
+  //   so deleting a single node does nothing. Each kind of node
+  //   allocates itself the same way and counts itself for --stats,
+  //   and declares the matching deletes beside its new
+  static void* operator new(size_t size, Arena& arena) { return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+
+  // All AST nodes provide visit children and accept methods
+  virtual void visit_children(Visitor* v) = 0;
+  virtual void accept(Visitor* v) = 0;
+};
+
+// Define all abstract AST node classes
+class StatementNode : public ASTNode {};
+class ExpressionNode : public ASTNode {};
+class TypeNode : public ASTNode {};
+
+// Define leaf AST nodes for ids and ints (also used for bools)
+// Identifiers have a member symbol, which is the interned name
+class IdentifierNode : public ASTNode {
+public:
+  Symbol symbol;
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Identifier); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v) { /* No Children */ }
+  virtual void accept(Visitor* v) { v->visitIdentifierNode(this); }
+  IdentifierNode(Symbol symbol) { this->kind = nk_Identifier; this->symbol = symbol; }
+
+};
+
+// Integers have a member value, which is a C int
+class IntegerNode : public ASTNode {
+public:
+  int value;
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Integer); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+
+  virtual void visit_children(Visitor* v) {/* No Children */ }
+  virtual void accept(Visitor* v) { v->visitIntegerNode(this); }
+
+  IntegerNode(int value) { this->kind = nk_Integer; this->value = value; }
+};
+
+// Define all other AST nodes
+
+// AST Node for Program
+class ProgramNode : public ASTNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Program); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitProgramNode(this); }
+
+  NodeList<ClassNode*>* class_list;
+
+  ProgramNode(NodeList<ClassNode*>* class_list);
+};
+
+// AST Node for Class
+class ClassNode : public ASTNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Class); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitClassNode(this); }
+
+  IdentifierNode* identifier_1;
+  IdentifierNode* identifier_2;
+  NodeList<DeclarationNode*>* declaration_list;
+  NodeList<MethodNode*>* method_list;
+
+  ClassNode(IdentifierNode* identifier_1, IdentifierNode* identifier_2, NodeList<DeclarationNode*>* declaration_list, NodeList<MethodNode*>* method_list);
+};
+
+// AST Node for Method
+class MethodNode : public ASTNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Method); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitMethodNode(this); }
+
+  IdentifierNode* identifier;
+  NodeList<ParameterNode*>* parameter_list;
+  TypeNode* type;
+  MethodBodyNode* methodbody;
+
+  MethodNode(IdentifierNode* identifier, NodeList<ParameterNode*>* parameter_list, TypeNode* type, MethodBodyNode* methodbody);
+};
+
+// AST Node for MethodBody
+class MethodBodyNode : public ASTNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_MethodBody); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitMethodBodyNode(this); }
+
+  NodeList<DeclarationNode*>* declaration_list;
+  NodeList<StatementNode*>* statement_list;
+  ReturnStatementNode* returnstatement;
+
+  MethodBodyNode(NodeList<DeclarationNode*>* declaration_list, NodeList<StatementNode*>* statement_list, ReturnStatementNode* returnstatement);
+};
+
+// AST Node for Parameter
+class ParameterNode : public ASTNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Parameter); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitParameterNode(this); }
+
+  TypeNode* type;
+  IdentifierNode* identifier;
+
+  ParameterNode(TypeNode* type, IdentifierNode* identifier);
+};
+
+// AST Node for Declaration
+class DeclarationNode : public ASTNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Declaration); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitDeclarationNode(this); }
+
+  TypeNode* type;
+  NodeList<IdentifierNode*>* identifier_list;
+
+  DeclarationNode(TypeNode* type, NodeList<IdentifierNode*>* identifier_list);
+};
+
+// AST Node for ReturnStatement
+class ReturnStatementNode : public ASTNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_ReturnStatement); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitReturnStatementNode(this); }
+
+  ExpressionNode* expression;
+
+  ReturnStatementNode(ExpressionNode* expression);
+};
+
+// AST Node for Assignment
+class AssignmentNode : public StatementNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Assignment); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitAssignmentNode(this); }
+
+  IdentifierNode* identifier_1;
+  IdentifierNode* identifier_2;
+  ExpressionNode* expression;
+
+  AssignmentNode(IdentifierNode* identifier_1, IdentifierNode* identifier_2, ExpressionNode* expression);
+};
+
+// AST Node for Call
+class CallNode : public StatementNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Call); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitCallNode(this); }
+
+  MethodCallNode* methodcall;
+
+  CallNode(MethodCallNode* methodcall);
+};
+
+// AST Node for IfElse
+class IfElseNode : public StatementNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_IfElse); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitIfElseNode(this); }
+
+  ExpressionNode* expression;
+  NodeList<StatementNode*>* statement_list_1;
+  NodeList<StatementNode*>* statement_list_2;
+
+  IfElseNode(ExpressionNode* expression, NodeList<StatementNode*>* statement_list_1, NodeList<StatementNode*>* statement_list_2);
+};
+
+// AST Node for While
+class WhileNode : public StatementNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_While); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitWhileNode(this); }
+
+  ExpressionNode* expression;
+  NodeList<StatementNode*>* statement_list;
+
+  WhileNode(ExpressionNode* expression, NodeList<StatementNode*>* statement_list);
+};
+
+// AST Node for Repeat
+class RepeatNode : public StatementNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Repeat); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitRepeatNode(this); }
+
+  NodeList<StatementNode*>* statement_list;
+  ExpressionNode* expression;
+
+  RepeatNode(NodeList<StatementNode*>* statement_list, ExpressionNode* expression);
+};
+
+// AST Node for Print
+class PrintNode : public StatementNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Print); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitPrintNode(this); }
+
+  ExpressionNode* expression;
+
+  PrintNode(ExpressionNode* expression);
+};
+
+// AST Node for Plus
+class PlusNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Plus); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitPlusNode(this); }
+
+  ExpressionNode* expression_1;
+  ExpressionNode* expression_2;
+
+  PlusNode(ExpressionNode* expression_1, ExpressionNode* expression_2);
+};
+
+// AST Node for Minus
+class MinusNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Minus); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitMinusNode(this); }
+
+  ExpressionNode* expression_1;
+  ExpressionNode* expression_2;
+
+  MinusNode(ExpressionNode* expression_1, ExpressionNode* expression_2);
+};
+
+// AST Node for Times
+class TimesNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Times); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitTimesNode(this); }
+
+  ExpressionNode* expression_1;
+  ExpressionNode* expression_2;
+
+  TimesNode(ExpressionNode* expression_1, ExpressionNode* expression_2);
+};
+
+// AST Node for Divide
+class DivideNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Divide); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitDivideNode(this); }
+
+  ExpressionNode* expression_1;
+  ExpressionNode* expression_2;
+
+  DivideNode(ExpressionNode* expression_1, ExpressionNode* expression_2);
+};
+
+// AST Node for Less
+class LessNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Less); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitLessNode(this); }
+
+  ExpressionNode* expression_1;
+  ExpressionNode* expression_2;
+
+  LessNode(ExpressionNode* expression_1, ExpressionNode* expression_2);
+};
+
+// AST Node for LessEqual
+class LessEqualNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_LessEqual); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitLessEqualNode(this); }
+
+  ExpressionNode* expression_1;
+  ExpressionNode* expression_2;
+
+  LessEqualNode(ExpressionNode* expression_1, ExpressionNode* expression_2);
+};
+
+// AST Node for Equal
+class EqualNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Equal); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitEqualNode(this); }
+
+  ExpressionNode* expression_1;
+  ExpressionNode* expression_2;
+
+  EqualNode(ExpressionNode* expression_1, ExpressionNode* expression_2);
+};
+
+// AST Node for And
+class AndNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_And); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitAndNode(this); }
+
+  ExpressionNode* expression_1;
+  ExpressionNode* expression_2;
+
+  AndNode(ExpressionNode* expression_1, ExpressionNode* expression_2);
+};
+
+// AST Node for Or
+class OrNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Or); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitOrNode(this); }
+
+  ExpressionNode* expression_1;
+  ExpressionNode* expression_2;
+
+  OrNode(ExpressionNode* expression_1, ExpressionNode* expression_2);
+};
+
+// AST Node for Not
+class NotNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Not); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitNotNode(this); }
+
+  ExpressionNode* expression;
+
+  NotNode(ExpressionNode* expression);
+};
+
+// AST Node for Negation
+class NegationNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Negation); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitNegationNode(this); }
+
+  ExpressionNode* expression;
+
+  NegationNode(ExpressionNode* expression);
+};
+
+// AST Node for MethodCall
+class MethodCallNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_MethodCall); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitMethodCallNode(this); }
+
+  IdentifierNode* identifier_1;
+  IdentifierNode* identifier_2;
+  NodeList<ExpressionNode*>* expression_list;
+
+  MethodCallNode(IdentifierNode* identifier_1, IdentifierNode* identifier_2, NodeList<ExpressionNode*>* expression_list);
+};
+
+// AST Node for MemberAccess
+class MemberAccessNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_MemberAccess); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitMemberAccessNode(this); }
+
+  IdentifierNode* identifier_1;
+  IdentifierNode* identifier_2;
+
+  MemberAccessNode(IdentifierNode* identifier_1, IdentifierNode* identifier_2);
+};
+
+// AST Node for Variable
+class VariableNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Variable); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitVariableNode(this); }
+
+  IdentifierNode* identifier;
+
+  VariableNode(IdentifierNode* identifier);
+};
+
+// AST Node for IntegerLiteral
+class IntegerLiteralNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_IntegerLiteral); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitIntegerLiteralNode(this); }
+
+  IntegerNode* integer;
+
+  IntegerLiteralNode(IntegerNode* integer);
+};
+
+// AST Node for BooleanLiteral
+class BooleanLiteralNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_BooleanLiteral); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitBooleanLiteralNode(this); }
+
+  IntegerNode* integer;
+
+  BooleanLiteralNode(IntegerNode* integer);
+};
+
+// AST Node for New
+class NewNode : public ExpressionNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_New); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitNewNode(this); }
+
+  IdentifierNode* identifier;
+  NodeList<ExpressionNode*>* expression_list;
+
+  NewNode(IdentifierNode* identifier, NodeList<ExpressionNode*>* expression_list);
+};
+
+// AST Node for IntegerType
+class IntegerTypeNode : public TypeNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_IntegerType); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitIntegerTypeNode(this); }
+
+  IntegerTypeNode() { this->kind = nk_IntegerType; }
+};
+
+// AST Node for BooleanType
+class BooleanTypeNode : public TypeNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_BooleanType); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitBooleanTypeNode(this); }
+
+  BooleanTypeNode() { this->kind = nk_BooleanType; }
+};
+
+// AST Node for ObjectType
+class ObjectTypeNode : public TypeNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_ObjectType); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitObjectTypeNode(this); }
+
+  IdentifierNode* identifier;
+
+  ObjectTypeNode(IdentifierNode* identifier);
+};
+
+// AST Node for None
+class NoneNode : public TypeNode {
+public:
+  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_None); return arena.allocate(size); }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+  virtual void visit_children(Visitor* v);
+  virtual void accept(Visitor* v) { v->visitNoneNode(this); }
+
+  NoneNode() { this->kind = nk_None; }
+};
+
+// Define the base class of statically dispatched visitors. A pass
+//   derives from StaticVisitor<Pass> and defines the visitXNode
+//   functions of the kinds of nodes it handles, without virtual. The
+//   kind of a node picks its handler in a switch, and children whose
+//   kind is known from the definition of their parent are handed to
+//   their handler directly, so a traversal makes no indirect calls
+//   and the compiler can inline the handlers. The handlers a pass does
+//   not define visit the children, and are empty for leaves
+template <typename Pass>
+class StaticVisitor {
+public:
+  // Visit a node of any kind
+  void visit(ASTNode* node);
+
+  // Visit the children of a node, in the same order as visit_children
+  void visitChildren(ProgramNode* node);
+  void visitChildren(ClassNode* node);
+  void visitChildren(MethodNode* node);
+  void visitChildren(MethodBodyNode* node);
+  void visitChildren(ParameterNode* node);
+  void visitChildren(DeclarationNode* node);
+  void visitChildren(ReturnStatementNode* node);
+  void visitChildren(AssignmentNode* node);
+  void visitChildren(CallNode* node);
+  void visitChildren(IfElseNode* node);
+  void visitChildren(WhileNode* node);
+  void visitChildren(RepeatNode* node);
+  void visitChildren(PrintNode* node);
+  void visitChildren(PlusNode* node);
+  void visitChildren(MinusNode* node);
+  void visitChildren(TimesNode* node);
+  void visitChildren(DivideNode* node);
+  void visitChildren(LessNode* node);
+  void visitChildren(LessEqualNode* node);
+  void visitChildren(EqualNode* node);
+  void visitChildren(AndNode* node);
+  void visitChildren(OrNode* node);
+  void visitChildren(NotNode* node);
+  void visitChildren(NegationNode* node);
+  void visitChildren(MethodCallNode* node);
+  void visitChildren(MemberAccessNode* node);
+  void visitChildren(VariableNode* node);
+  void visitChildren(IntegerLiteralNode* node);
+  void visitChildren(BooleanLiteralNode* node);
+  void visitChildren(NewNode* node);
+  void visitChildren(IntegerTypeNode* node);
+  void visitChildren(BooleanTypeNode* node);
+  void visitChildren(ObjectTypeNode* node);
+  void visitChildren(NoneNode* node);
+  void visitChildren(IdentifierNode* node) {}
+  void visitChildren(IntegerNode* node) {}
+
+  // Default handlers, hidden by those the pass defines
+  void visitProgramNode(ProgramNode* node) { visitChildren(node); }
+  void visitClassNode(ClassNode* node) { visitChildren(node); }
+  void visitMethodNode(MethodNode* node) { visitChildren(node); }
+  void visitMethodBodyNode(MethodBodyNode* node) { visitChildren(node); }
+  void visitParameterNode(ParameterNode* node) { visitChildren(node); }
+  void visitDeclarationNode(DeclarationNode* node) { visitChildren(node); }
+  void visitReturnStatementNode(ReturnStatementNode* node) { visitChildren(node); }
+  void visitAssignmentNode(AssignmentNode* node) { visitChildren(node); }
+  void visitCallNode(CallNode* node) { visitChildren(node); }
+  void visitIfElseNode(IfElseNode* node) { visitChildren(node); }
+  void visitWhileNode(WhileNode* node) { visitChildren(node); }
+  void visitRepeatNode(RepeatNode* node) { visitChildren(node); }
+  void visitPrintNode(PrintNode* node) { visitChildren(node); }
+  void visitPlusNode(PlusNode* node) { visitChildren(node); }
+  void visitMinusNode(MinusNode* node) { visitChildren(node); }
+  void visitTimesNode(TimesNode* node) { visitChildren(node); }
+  void visitDivideNode(DivideNode* node) { visitChildren(node); }
+  void visitLessNode(LessNode* node) { visitChildren(node); }
+  void visitLessEqualNode(LessEqualNode* node) { visitChildren(node); }
+  void visitEqualNode(EqualNode* node) { visitChildren(node); }
+  void visitAndNode(AndNode* node) { visitChildren(node); }
+  void visitOrNode(OrNode* node) { visitChildren(node); }
+  void visitNotNode(NotNode* node) { visitChildren(node); }
+  void visitNegationNode(NegationNode* node) { visitChildren(node); }
+  void visitMethodCallNode(MethodCallNode* node) { visitChildren(node); }
+  void visitMemberAccessNode(MemberAccessNode* node) { visitChildren(node); }
+  void visitVariableNode(VariableNode* node) { visitChildren(node); }
+  void visitIntegerLiteralNode(IntegerLiteralNode* node) { visitChildren(node); }
+  void visitBooleanLiteralNode(BooleanLiteralNode* node) { visitChildren(node); }
+  void visitNewNode(NewNode* node) { visitChildren(node); }
+  void visitIntegerTypeNode(IntegerTypeNode* node) { visitChildren(node); }
+  void visitBooleanTypeNode(BooleanTypeNode* node) { visitChildren(node); }
+  void visitObjectTypeNode(ObjectTypeNode* node) { visitChildren(node); }
+  void visitNoneNode(NoneNode* node) { visitChildren(node); }
+  void visitIdentifierNode(IdentifierNode* node) {}
+  void visitIntegerNode(IntegerNode* node) {}
+
+private:
+  Pass* pass() { return static_cast<Pass*>(this); }
+};
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visit(ASTNode* node) {
+  switch (node->kind) {
+  case nk_Program:
+    pass()->visitProgramNode(static_cast<ProgramNode*>(node));
+    break;
+  case nk_Class:
+    pass()->visitClassNode(static_cast<ClassNode*>(node));
+    break;
+  case nk_Method:
+    pass()->visitMethodNode(static_cast<MethodNode*>(node));
+    break;
+  case nk_MethodBody:
+    pass()->visitMethodBodyNode(static_cast<MethodBodyNode*>(node));
+    break;
+  case nk_Parameter:
+    pass()->visitParameterNode(static_cast<ParameterNode*>(node));
+    break;
+  case nk_Declaration:
+    pass()->visitDeclarationNode(static_cast<DeclarationNode*>(node));
+    break;
+  case nk_ReturnStatement:
+    pass()->visitReturnStatementNode(static_cast<ReturnStatementNode*>(node));
+    break;
+  case nk_Assignment:
+    pass()->visitAssignmentNode(static_cast<AssignmentNode*>(node));
+    break;
+  case nk_Call:
+    pass()->visitCallNode(static_cast<CallNode*>(node));
+    break;
+  case nk_IfElse:
+    pass()->visitIfElseNode(static_cast<IfElseNode*>(node));
+    break;
+  case nk_While:
+    pass()->visitWhileNode(static_cast<WhileNode*>(node));
+    break;
+  case nk_Repeat:
+    pass()->visitRepeatNode(static_cast<RepeatNode*>(node));
+    break;
+  case nk_Print:
+    pass()->visitPrintNode(static_cast<PrintNode*>(node));
+    break;
+  case nk_Plus:
+    pass()->visitPlusNode(static_cast<PlusNode*>(node));
+    break;
+  case nk_Minus:
+    pass()->visitMinusNode(static_cast<MinusNode*>(node));
+    break;
+  case nk_Times:
+    pass()->visitTimesNode(static_cast<TimesNode*>(node));
+    break;
+  case nk_Divide:
+    pass()->visitDivideNode(static_cast<DivideNode*>(node));
+    break;
+  case nk_Less:
+    pass()->visitLessNode(static_cast<LessNode*>(node));
+    break;
+  case nk_LessEqual:
+    pass()->visitLessEqualNode(static_cast<LessEqualNode*>(node));
+    break;
+  case nk_Equal:
+    pass()->visitEqualNode(static_cast<EqualNode*>(node));
+    break;
+  case nk_And:
+    pass()->visitAndNode(static_cast<AndNode*>(node));
+    break;
+  case nk_Or:
+    pass()->visitOrNode(static_cast<OrNode*>(node));
+    break;
+  case nk_Not:
+    pass()->visitNotNode(static_cast<NotNode*>(node));
+    break;
+  case nk_Negation:
+    pass()->visitNegationNode(static_cast<NegationNode*>(node));
+    break;
+  case nk_MethodCall:
+    pass()->visitMethodCallNode(static_cast<MethodCallNode*>(node));
+    break;
+  case nk_MemberAccess:
+    pass()->visitMemberAccessNode(static_cast<MemberAccessNode*>(node));
+    break;
+  case nk_Variable:
+    pass()->visitVariableNode(static_cast<VariableNode*>(node));
+    break;
+  case nk_IntegerLiteral:
+    pass()->visitIntegerLiteralNode(static_cast<IntegerLiteralNode*>(node));
+    break;
+  case nk_BooleanLiteral:
+    pass()->visitBooleanLiteralNode(static_cast<BooleanLiteralNode*>(node));
+    break;
+  case nk_New:
+    pass()->visitNewNode(static_cast<NewNode*>(node));
+    break;
+  case nk_IntegerType:
+    pass()->visitIntegerTypeNode(static_cast<IntegerTypeNode*>(node));
+    break;
+  case nk_BooleanType:
+    pass()->visitBooleanTypeNode(static_cast<BooleanTypeNode*>(node));
+    break;
+  case nk_ObjectType:
+    pass()->visitObjectTypeNode(static_cast<ObjectTypeNode*>(node));
+    break;
+  case nk_None:
+    pass()->visitNoneNode(static_cast<NoneNode*>(node));
+    break;
+  case nk_Identifier:
+    pass()->visitIdentifierNode(static_cast<IdentifierNode*>(node));
+    break;
+  case nk_Integer:
+    pass()->visitIntegerNode(static_cast<IntegerNode*>(node));
+    break;
+  }
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(ProgramNode* node) {
+  if (node->class_list) {
+    for(NodeList<ClassNode*>::iterator iter = node->class_list->begin();
+        iter != node->class_list->end(); iter++) {
+      pass()->visitClassNode(*iter);
+    }
+  }
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(ClassNode* node) {
+  pass()->visitIdentifierNode(node->identifier_1);
+  if (node->identifier_2) {
+    pass()->visitIdentifierNode(node->identifier_2);
+  }
+  if (node->declaration_list) {
+    for(NodeList<DeclarationNode*>::iterator iter = node->declaration_list->begin();
+        iter != node->declaration_list->end(); iter++) {
+      pass()->visitDeclarationNode(*iter);
+    }
+  }
+  if (node->method_list) {
+    for(NodeList<MethodNode*>::iterator iter = node->method_list->begin();
+        iter != node->method_list->end(); iter++) {
+      pass()->visitMethodNode(*iter);
+    }
+  }
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(MethodNode* node) {
+  pass()->visitIdentifierNode(node->identifier);
+  if (node->parameter_list) {
+    for(NodeList<ParameterNode*>::iterator iter = node->parameter_list->begin();
+        iter != node->parameter_list->end(); iter++) {
+      pass()->visitParameterNode(*iter);
+    }
+  }
+  visit(node->type);
+  pass()->visitMethodBodyNode(node->methodbody);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(MethodBodyNode* node) {
+  if (node->declaration_list) {
+    for(NodeList<DeclarationNode*>::iterator iter = node->declaration_list->begin();
+        iter != node->declaration_list->end(); iter++) {
+      pass()->visitDeclarationNode(*iter);
+    }
+  }
+  if (node->statement_list) {
+    for(NodeList<StatementNode*>::iterator iter = node->statement_list->begin();
+        iter != node->statement_list->end(); iter++) {
+      visit(*iter);
+    }
+  }
+  if (node->returnstatement) {
+    pass()->visitReturnStatementNode(node->returnstatement);
+  }
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(ParameterNode* node) {
+  visit(node->type);
+  pass()->visitIdentifierNode(node->identifier);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(DeclarationNode* node) {
+  visit(node->type);
+  if (node->identifier_list) {
+    for(NodeList<IdentifierNode*>::iterator iter = node->identifier_list->begin();
+        iter != node->identifier_list->end(); iter++) {
+      pass()->visitIdentifierNode(*iter);
+    }
+  }
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(ReturnStatementNode* node) {
+  visit(node->expression);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(AssignmentNode* node) {
+  pass()->visitIdentifierNode(node->identifier_1);
+  if (node->identifier_2) {
+    pass()->visitIdentifierNode(node->identifier_2);
+  }
+  visit(node->expression);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(CallNode* node) {
+  pass()->visitMethodCallNode(node->methodcall);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(IfElseNode* node) {
+  visit(node->expression);
+  if (node->statement_list_1) {
+    for(NodeList<StatementNode*>::iterator iter = node->statement_list_1->begin();
+        iter != node->statement_list_1->end(); iter++) {
+      visit(*iter);
+    }
+  }
+  if (node->statement_list_2) {
+    for(NodeList<StatementNode*>::iterator iter = node->statement_list_2->begin();
+        iter != node->statement_list_2->end(); iter++) {
+      visit(*iter);
+    }
+  }
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(WhileNode* node) {
+  visit(node->expression);
+  if (node->statement_list) {
+    for(NodeList<StatementNode*>::iterator iter = node->statement_list->begin();
+        iter != node->statement_list->end(); iter++) {
+      visit(*iter);
+    }
+  }
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(RepeatNode* node) {
+  if (node->statement_list) {
+    for(NodeList<StatementNode*>::iterator iter = node->statement_list->begin();
+        iter != node->statement_list->end(); iter++) {
+      visit(*iter);
+    }
+  }
+  visit(node->expression);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(PrintNode* node) {
+  visit(node->expression);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(PlusNode* node) {
+  visit(node->expression_1);
+  visit(node->expression_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(MinusNode* node) {
+  visit(node->expression_1);
+  visit(node->expression_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(TimesNode* node) {
+  visit(node->expression_1);
+  visit(node->expression_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(DivideNode* node) {
+  visit(node->expression_1);
+  visit(node->expression_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(LessNode* node) {
+  visit(node->expression_1);
+  visit(node->expression_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(LessEqualNode* node) {
+  visit(node->expression_1);
+  visit(node->expression_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(EqualNode* node) {
+  visit(node->expression_1);
+  visit(node->expression_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(AndNode* node) {
+  visit(node->expression_1);
+  visit(node->expression_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(OrNode* node) {
+  visit(node->expression_1);
+  visit(node->expression_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(NotNode* node) {
+  visit(node->expression);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(NegationNode* node) {
+  visit(node->expression);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(MethodCallNode* node) {
+  pass()->visitIdentifierNode(node->identifier_1);
+  if (node->identifier_2) {
+    pass()->visitIdentifierNode(node->identifier_2);
+  }
+  if (node->expression_list) {
+    for(NodeList<ExpressionNode*>::iterator iter = node->expression_list->begin();
+        iter != node->expression_list->end(); iter++) {
+      visit(*iter);
+    }
+  }
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(MemberAccessNode* node) {
+  pass()->visitIdentifierNode(node->identifier_1);
+  pass()->visitIdentifierNode(node->identifier_2);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(VariableNode* node) {
+  pass()->visitIdentifierNode(node->identifier);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(IntegerLiteralNode* node) {
+  pass()->visitIntegerNode(node->integer);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(BooleanLiteralNode* node) {
+  pass()->visitIntegerNode(node->integer);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(NewNode* node) {
+  pass()->visitIdentifierNode(node->identifier);
+  if (node->expression_list) {
+    for(NodeList<ExpressionNode*>::iterator iter = node->expression_list->begin();
+        iter != node->expression_list->end(); iter++) {
+      visit(*iter);
+    }
+  }
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(IntegerTypeNode* node) {
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(BooleanTypeNode* node) {
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(ObjectTypeNode* node) {
+  pass()->visitIdentifierNode(node->identifier);
+}
+
+template <typename Pass>
+inline void StaticVisitor<Pass>::visitChildren(NoneNode* node) {
+}
+
+// Define the provided Print visitor, which will print the AST,
+//   this is an example of a concrete visitor which visit the tree
+class Print : public Visitor {
+private:
+  std::vector<std::string>* elements;
+  std::stack<std::vector<std::string>*> stack;
+  unsigned int indent;
+  const SymbolInterner* symbols;
+
+  void pushLevel(std::string, bool);
+  void addElement(std::string);
+  void popLevel(bool, bool);
+
+public:
+  // Identifiers are printed by name, looked up in the interner
+  //   of the compilation the tree belongs to
+  Print(const SymbolInterner& symbols) : elements(NULL), indent(0), symbols(&symbols) {}
+
+  virtual void visitProgramNode(ProgramNode* node);
+  virtual void visitClassNode(ClassNode* node);
+  virtual void visitMethodNode(MethodNode* node);
+  virtual void visitMethodBodyNode(MethodBodyNode* node);
+  virtual void visitParameterNode(ParameterNode* node);
+  virtual void visitDeclarationNode(DeclarationNode* node);
+  virtual void visitReturnStatementNode(ReturnStatementNode* node);
+  virtual void visitAssignmentNode(AssignmentNode* node);
+  virtual void visitCallNode(CallNode* node);
+  virtual void visitIfElseNode(IfElseNode* node);
+  virtual void visitWhileNode(WhileNode* node);
+  virtual void visitRepeatNode(RepeatNode* node);
+  virtual void visitPrintNode(PrintNode* node);
+  virtual void visitPlusNode(PlusNode* node);
+  virtual void visitMinusNode(MinusNode* node);
+  virtual void visitTimesNode(TimesNode* node);
+  virtual void visitDivideNode(DivideNode* node);
+  virtual void visitLessNode(LessNode* node);
+  virtual void visitLessEqualNode(LessEqualNode* node);
+  virtual void visitEqualNode(EqualNode* node);
+  virtual void visitAndNode(AndNode* node);
+  virtual void visitOrNode(OrNode* node);
+  virtual void visitNotNode(NotNode* node);
+  virtual void visitNegationNode(NegationNode* node);
+  virtual void visitMethodCallNode(MethodCallNode* node);
+  virtual void visitMemberAccessNode(MemberAccessNode* node);
+  virtual void visitVariableNode(VariableNode* node);
+  virtual void visitIntegerLiteralNode(IntegerLiteralNode* node);
+  virtual void visitBooleanLiteralNode(BooleanLiteralNode* node);
+  virtual void visitNewNode(NewNode* node);
+  virtual void visitIntegerTypeNode(IntegerTypeNode* node);
+  virtual void visitBooleanTypeNode(BooleanTypeNode* node);
+  virtual void visitObjectTypeNode(ObjectTypeNode* node);
+  virtual void visitNoneNode(NoneNode* node);
+  virtual void visitIdentifierNode(IdentifierNode* node);
+  virtual void visitIntegerNode(IntegerNode* node);
+};
+
+#endif
+
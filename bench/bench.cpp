@@ -0,0 +1,157 @@
+#include "langcheck.hpp"
+#include "workload.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Times each phase of the checker over generated programs of
+// growing size. Every repetition checks the program in a fresh
+// compilation, and the fastest repetition of each phase is
+// reported, one JSON object per size, so runs can be compared
+// by scripts.
+
+typedef std::chrono::steady_clock Clock;
+
+typedef struct timing {
+    size_t tokens;
+    double scan;
+    double parse;
+    double typecheck;
+    double print;
+} Timing;
+
+void usage() {
+    std::cerr << "usage: bench [options]" << std::endl;
+    std::cerr << "Times scanning, parsing, type checking and printing the symbol" << std::endl;
+    std::cerr << "table of generated programs, one JSON line per size." << std::endl;
+    std::cerr << "  --sizes N,N,...        numbers of classes to time (10,100,1000,10000)" << std::endl;
+    std::cerr << "  --repeat N             repetitions per size; the fastest is kept (5)" << std::endl;
+    std::cerr << "  --threads N            threads to check method bodies on (1)" << std::endl;
+    printKnobs(std::cerr);
+    exit(2);
+}
+
+double milliseconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Checks the program once, timing each phase on its own. The
+// scanner runs once by itself and again as part of parsing, so
+// the parse time includes scanning.
+bool measure(const std::string &program, int threads, Timing &timing) {
+    Compilation scanned;
+    if (!scanned.source.load(program.data(), program.size())) {
+        std::cerr << "bench: " << strerror(errno) << std::endl;
+        return false;
+    }
+    Clock::time_point start = Clock::now();
+    timing.tokens = scan(scanned);
+    timing.scan = milliseconds(start, Clock::now());
+
+    Compilation compilation;
+    compilation.threads = threads;
+    if (!compilation.source.load(program.data(), program.size())) {
+        std::cerr << "bench: " << strerror(errno) << std::endl;
+        return false;
+    }
+    start = Clock::now();
+    bool checked = parse(compilation);
+    timing.parse = milliseconds(start, Clock::now());
+    if (checked) {
+        start = Clock::now();
+        checked = typecheck(compilation);
+        timing.typecheck = milliseconds(start, Clock::now());
+    }
+    if (!checked) {
+        std::cerr << "bench: the generated program has errors" << std::endl;
+        compilation.diagnostics.print(std::cerr);
+        return false;
+    }
+
+    std::ostringstream table;
+    start = Clock::now();
+    print(table, compilation.symbols, *compilation.classTable, 0, false);
+    timing.print = milliseconds(start, Clock::now());
+    return true;
+}
+
+void report(const Workload &workload, size_t bytes, int repeat, int threads, const Timing &timing) {
+    std::cout << "{\"classes\": " << workload.classes
+              << ", \"depth\": " << workload.depth
+              << ", \"methods\": " << workload.methods
+              << ", \"members\": " << workload.members
+              << ", \"locals\": " << workload.locals
+              << ", \"expression_depth\": " << workload.expressionDepth
+              << ", \"call_density\": " << workload.callDensity
+              << ", \"seed\": " << workload.seed
+              << ", \"repeat\": " << repeat
+              << ", \"threads\": " << threads
+              << ", \"bytes\": " << bytes
+              << ", \"tokens\": " << timing.tokens
+              << ", \"scan_ms\": " << timing.scan
+              << ", \"parse_ms\": " << timing.parse
+              << ", \"typecheck_ms\": " << timing.typecheck
+              << ", \"print_ms\": " << timing.print
+              << "}" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Workload workload = defaultWorkload();
+    std::vector<int> sizes;
+    int repeat = 5;
+    int threads = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc)
+            usage();
+        if (!strcmp(argv[i], "--sizes")) {
+            std::istringstream list(argv[i + 1]);
+            std::string size;
+            while (std::getline(list, size, ','))
+                sizes.push_back(atoi(size.c_str()));
+        } else if (!strcmp(argv[i], "--repeat")) {
+            repeat = atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "--threads")) {
+            threads = atoi(argv[i + 1]);
+        } else if (!setKnob(workload, argv[i], argv[i + 1])) {
+            usage();
+        }
+        i++;
+    }
+    if (sizes.empty()) {
+        sizes.push_back(10);
+        sizes.push_back(100);
+        sizes.push_back(1000);
+        sizes.push_back(10000);
+    }
+    if (repeat < 1 || threads < 1)
+        usage();
+
+    for (size_t i = 0; i < sizes.size(); i++) {
+        workload.classes = sizes[i];
+        std::string program = generate(workload);
+
+        Timing best;
+        for (int r = 0; r < repeat; r++) {
+            Timing timing;
+            if (!measure(program, threads, timing))
+                return 1;
+            if (r == 0) {
+                best = timing;
+                continue;
+            }
+            best.scan = std::min(best.scan, timing.scan);
+            best.parse = std::min(best.parse, timing.parse);
+            best.typecheck = std::min(best.typecheck, timing.typecheck);
+            best.print = std::min(best.print, timing.print);
+        }
+        report(workload, program.size(), repeat, threads, best);
+    }
+    return 0;
+}
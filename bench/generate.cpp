@@ -0,0 +1,22 @@
+#include "workload.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+void usage() {
+    std::cerr << "usage: generate [options] > program.lang" << std::endl;
+    std::cerr << "Prints a well-typed program with the given shape." << std::endl;
+    printKnobs(std::cerr);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    Workload workload = defaultWorkload();
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc || !setKnob(workload, argv[i], argv[i + 1]))
+            usage();
+        i++;
+    }
+    std::cout << generate(workload);
+    return 0;
+}
@@ -0,0 +1,508 @@
+#include "workload.hpp"
+
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+// Defines the kinds of values the generator gives variables,
+// parameters and methods.
+typedef enum {k_integer, k_boolean, k_object, k_none} Kind;
+
+typedef struct variable {
+  std::string name;
+  Kind kind;
+  int objectClass;
+} Variable;
+
+typedef struct method {
+  std::string name;
+  std::vector<Variable> parameters;
+  Kind returns;
+} Method;
+
+// Defines what the generator knows of a class it has generated:
+// its members and methods, own and inherited, through which later
+// classes use it, and how many super classes it has.
+typedef struct classshape {
+  std::string name;
+  int depth;
+  std::vector<Variable> members;
+  std::vector<Method> methods;
+} ClassShape;
+
+Workload defaultWorkload() {
+  Workload workload;
+  workload.classes = 20;
+  workload.depth = 4;
+  workload.methods = 4;
+  workload.members = 3;
+  workload.locals = 4;
+  workload.expressionDepth = 3;
+  workload.callDensity = 10;
+  workload.seed = 1;
+  return workload;
+}
+
+bool setKnob(Workload &workload, const char *option, const char *value) {
+  std::string name(option);
+  int number = atoi(value);
+  if (name == "--classes")
+    workload.classes = number;
+  else if (name == "--depth")
+    workload.depth = number;
+  else if (name == "--methods")
+    workload.methods = number;
+  else if (name == "--members")
+    workload.members = number;
+  else if (name == "--locals")
+    workload.locals = number;
+  else if (name == "--expression-depth")
+    workload.expressionDepth = number;
+  else if (name == "--call-density")
+    workload.callDensity = number;
+  else if (name == "--seed")
+    workload.seed = number;
+  else
+    return false;
+  return true;
+}
+
+void printKnobs(std::ostream &out) {
+  Workload workload = defaultWorkload();
+  out << "  --classes N            classes besides Main (" << workload.classes << ")" << std::endl;
+  out << "  --depth N              longest chain of super classes (" << workload.depth << ")" << std::endl;
+  out << "  --methods N            methods per class (" << workload.methods << ")" << std::endl;
+  out << "  --members N            members per class (" << workload.members << ")" << std::endl;
+  out << "  --locals N             locals per method (" << workload.locals << ")" << std::endl;
+  out << "  --expression-depth N   depth of expressions (" << workload.expressionDepth << ")" << std::endl;
+  out << "  --call-density N       percent of expression leaves that are calls (" << workload.callDensity << ")" << std::endl;
+  out << "  --seed N               seed of the generator (" << workload.seed << ")" << std::endl;
+}
+
+std::string number(long value) {
+  std::ostringstream ss;
+  ss << value;
+  return ss.str();
+}
+
+// Generates a program one class at a time, keeping track of what
+// is in scope so that every name it uses is declared, has the
+// type it is used at, and is visible to the type checker where it
+// is used:
+// - a class only uses classes declared before it;
+// - a call without an object only calls methods declared earlier
+//   in the same class;
+// - objects are only used through locals and parameters, which
+//   always hold a new object, and never returned.
+class Generator {
+public:
+  Generator(const Workload &workload);
+  std::string program();
+
+private:
+  const Workload &workload;
+  std::ostringstream out;
+  unsigned long long state;
+  std::vector<ClassShape> classes;
+  std::vector<int> extendable;
+
+  // The scope of the method being generated
+  std::vector<Method> ownMethods;
+  std::vector<Variable> values;
+  std::vector<Variable> objects;
+  bool inLoop;
+
+  unsigned int random(unsigned int n);
+  bool chance(int percent);
+  Kind valueKind();
+  Variable newVariable(const std::string &name, bool objects);
+  std::string typeName(const Variable &variable);
+  void indent(int level);
+
+  void generateClass(int index);
+  void generateMain();
+  void generateMethod(const Method &method, const std::vector<Variable> &members);
+  void statement(int level);
+  void block(int level);
+  std::string expression(Kind kind, int depth);
+  std::string leaf(Kind kind, int depth);
+  std::string value(Kind kind);
+  std::string call(Kind kind);
+  std::string arguments(const Method &method);
+};
+
+Generator::Generator(const Workload &workload) : workload(workload) {
+  this->state = 0x9e3779b97f4a7c15ull * (workload.seed + 1);
+  this->inLoop = false;
+}
+
+// xorshift64*, so the same seed gives the same program everywhere
+unsigned int Generator::random(unsigned int n) {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return (unsigned int) ((state * 0x2545f4914f6cdd1dull) >> 33) % n;
+}
+
+bool Generator::chance(int percent) {
+  return (int) random(100) < percent;
+}
+
+Kind Generator::valueKind() {
+  return random(2) ? k_integer : k_boolean;
+}
+
+Variable Generator::newVariable(const std::string &name, bool objects) {
+  Variable variable;
+  variable.name = name;
+  variable.kind = valueKind();
+  variable.objectClass = -1;
+  if (objects && !classes.empty() && chance(30)) {
+    variable.kind = k_object;
+    variable.objectClass = random(classes.size());
+  }
+  return variable;
+}
+
+std::string Generator::typeName(const Variable &variable) {
+  switch (variable.kind) {
+    case k_integer:
+      return "integer";
+    case k_boolean:
+      return "boolean";
+    case k_object:
+      return classes[variable.objectClass].name;
+    default:
+      return "none";
+  }
+}
+
+void Generator::indent(int level) {
+  for (int i = 0; i < level; i++)
+    out << "    ";
+}
+
+std::string Generator::program() {
+  for (int i = 0; i < workload.classes; i++)
+    generateClass(i);
+  generateMain();
+  return out.str();
+}
+
+void Generator::generateClass(int index) {
+  ClassShape shape;
+  shape.name = "C" + number(index);
+  shape.depth = 0;
+  std::string prefix = "c" + number(index);
+
+  int super = -1;
+  if (!extendable.empty() && chance(75))
+    super = extendable[random(extendable.size())];
+  out << shape.name;
+  if (super >= 0) {
+    out << " extends " << classes[super].name;
+    shape.depth = classes[super].depth + 1;
+    shape.members = classes[super].members;
+    shape.methods = classes[super].methods;
+  }
+  out << " {\n";
+
+  for (int i = 0; i < workload.members; i++) {
+    Variable member = newVariable(prefix + "m" + number(i), false);
+    indent(1);
+    out << typeName(member) << " " << member.name << ";\n";
+    shape.members.push_back(member);
+  }
+  out << "\n";
+
+  ownMethods.clear();
+  for (int i = 0; i < workload.methods; i++) {
+    Method method;
+    // Override an inherited method now and then, keeping its
+    // signature, so that virtual tables have overrides in them
+    size_t overridden = shape.methods.size();
+    if (super >= 0 && !classes[super].methods.empty() && chance(30)) {
+      size_t candidate = random(classes[super].methods.size());
+      bool taken = false;
+      for (size_t j = 0; j < ownMethods.size(); j++)
+        taken = taken || ownMethods[j].name == classes[super].methods[candidate].name;
+      if (!taken)
+        overridden = candidate;
+    }
+    if (overridden < shape.methods.size()) {
+      method = shape.methods[overridden];
+    } else {
+      method.name = prefix + "f" + number(i);
+      int parameters = random(4);
+      for (int j = 0; j < parameters; j++)
+        method.parameters.push_back(newVariable("arg" + number(j), true));
+      unsigned int returns = random(3);
+      method.returns = returns == 0 ? k_none : returns == 1 ? k_integer : k_boolean;
+    }
+
+    generateMethod(method, shape.members);
+    ownMethods.push_back(method);
+    if (overridden < shape.methods.size())
+      shape.methods[overridden] = method;
+    else
+      shape.methods.push_back(method);
+  }
+
+  out << "}\n\n";
+  classes.push_back(shape);
+  if (shape.depth < workload.depth)
+    extendable.push_back(index);
+}
+
+void Generator::generateMain() {
+  Method main;
+  main.name = "main";
+  main.returns = k_none;
+  ownMethods.clear();
+  out << "Main {\n";
+  generateMethod(main, std::vector<Variable>());
+  out << "}\n";
+}
+
+void Generator::generateMethod(const Method &method, const std::vector<Variable> &members) {
+  values = members;
+  objects.clear();
+
+  indent(1);
+  out << method.name << "(";
+  for (size_t i = 0; i < method.parameters.size(); i++) {
+    const Variable &parameter = method.parameters[i];
+    out << (i ? ", " : "") << parameter.name << " : " << typeName(parameter);
+    (parameter.kind == k_object ? objects : values).push_back(parameter);
+  }
+  out << ") -> " << (method.returns == k_integer ? "integer" : method.returns == k_boolean ? "boolean" : "none") << " {\n";
+
+  std::vector<Variable> locals;
+  for (int i = 0; i < workload.locals; i++) {
+    Variable local = newVariable("local" + number(i), true);
+    indent(2);
+    out << typeName(local) << " " << local.name << ";\n";
+    locals.push_back(local);
+  }
+  indent(2);
+  out << "integer counter;\n\n";
+
+  // Every local holds a value before it is used
+  for (size_t i = 0; i < locals.size(); i++) {
+    indent(2);
+    out << locals[i].name << " = ";
+    if (locals[i].kind == k_object)
+      out << "new " << classes[locals[i].objectClass].name;
+    else
+      out << value(locals[i].kind);
+    out << ";\n";
+    (locals[i].kind == k_object ? objects : values).push_back(locals[i]);
+  }
+
+  int statements = workload.locals > 2 ? workload.locals : 2;
+  for (int i = 0; i < statements; i++)
+    statement(2);
+
+  if (method.returns != k_none) {
+    indent(2);
+    out << "return " << expression(method.returns, workload.expressionDepth) << ";\n";
+  }
+  indent(1);
+  out << "}\n\n";
+}
+
+void Generator::statement(int level) {
+  bool nested = level < 4;
+  switch (random(10)) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+      if (!values.empty()) {
+        const Variable &target = values[random(values.size())];
+        indent(level);
+        out << target.name << " = " << expression(target.kind, workload.expressionDepth) << ";\n";
+        return;
+      }
+      break;
+    case 4:
+      if (!objects.empty()) {
+        const Variable &object = objects[random(objects.size())];
+        const std::vector<Variable> &members = classes[object.objectClass].members;
+        if (!members.empty()) {
+          const Variable &member = members[random(members.size())];
+          indent(level);
+          out << object.name << "." << member.name << " = " << expression(member.kind, workload.expressionDepth) << ";\n";
+          return;
+        }
+      }
+      break;
+    case 5:
+    case 6:
+      if (nested) {
+        indent(level);
+        out << "if " << expression(k_boolean, workload.expressionDepth) << " {\n";
+        block(level);
+        if (chance(50)) {
+          indent(level);
+          out << "} else {\n";
+          block(level);
+        }
+        indent(level);
+        out << "}\n";
+        return;
+      }
+      break;
+    case 7:
+      // Loops count to a small bound, so generated programs also
+      // terminate when they are run
+      if (nested && !inLoop) {
+        inLoop = true;
+        indent(level);
+        out << "counter = 0;\n";
+        if (chance(50)) {
+          indent(level);
+          out << "while counter < 3 {\n";
+          block(level);
+          indent(level + 1);
+          out << "counter = counter + 1;\n";
+          indent(level);
+          out << "}\n";
+        } else {
+          indent(level);
+          out << "repeat {\n";
+          block(level);
+          indent(level + 1);
+          out << "counter = counter + 1;\n";
+          indent(level);
+          out << "} until (2 < counter);\n";
+        }
+        inLoop = false;
+        return;
+      }
+      break;
+    case 8: {
+      std::string called = call(k_none);
+      if (!called.empty()) {
+        indent(level);
+        out << called << ";\n";
+        return;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  indent(level);
+  out << "print " << expression(valueKind(), workload.expressionDepth) << ";\n";
+}
+
+void Generator::block(int level) {
+  int statements = 1 + random(2);
+  for (int i = 0; i < statements; i++)
+    statement(level + 1);
+}
+
+std::string Generator::expression(Kind kind, int depth) {
+  if (depth <= 0 || chance(30))
+    return leaf(kind, depth);
+  if (kind == k_integer) {
+    switch (random(5)) {
+      case 0:
+        return "(" + expression(k_integer, depth - 1) + " + " + expression(k_integer, depth - 1) + ")";
+      case 1:
+        return "(" + expression(k_integer, depth - 1) + " - " + expression(k_integer, depth - 1) + ")";
+      case 2:
+        return "(" + expression(k_integer, depth - 1) + " * " + expression(k_integer, depth - 1) + ")";
+      case 3:
+        return "(" + expression(k_integer, depth - 1) + " / " + number(1 + random(9)) + ")";
+      default:
+        return "(-" + expression(k_integer, depth - 1) + ")";
+    }
+  }
+  switch (random(6)) {
+    case 0:
+      return "(" + expression(k_integer, depth - 1) + " < " + expression(k_integer, depth - 1) + ")";
+    case 1:
+      return "(" + expression(k_integer, depth - 1) + " <= " + expression(k_integer, depth - 1) + ")";
+    case 2:
+      return "(" + expression(k_integer, depth - 1) + " equals " + expression(k_integer, depth - 1) + ")";
+    case 3:
+      return "(" + expression(k_boolean, depth - 1) + " and " + expression(k_boolean, depth - 1) + ")";
+    case 4:
+      return "(" + expression(k_boolean, depth - 1) + " or " + expression(k_boolean, depth - 1) + ")";
+    default:
+      return "(not " + expression(k_boolean, depth - 1) + ")";
+  }
+}
+
+std::string Generator::leaf(Kind kind, int depth) {
+  if (chance(workload.callDensity)) {
+    std::string called = call(kind);
+    if (!called.empty())
+      return called;
+  }
+  if (!objects.empty() && chance(20)) {
+    const Variable &object = objects[random(objects.size())];
+    const std::vector<Variable> &members = classes[object.objectClass].members;
+    for (size_t i = 0; i < members.size(); i++)
+      if (members[i].kind == kind)
+        return object.name + "." + members[i].name;
+  }
+  return value(kind);
+}
+
+// Returns a literal or a variable of the kind
+std::string Generator::value(Kind kind) {
+  if (chance(50)) {
+    for (size_t i = 0, start = values.empty() ? 0 : random(values.size()); i < values.size(); i++) {
+      const Variable &variable = values[(start + i) % values.size()];
+      if (variable.kind == kind)
+        return variable.name;
+    }
+  }
+  if (kind == k_integer)
+    return number(random(1000));
+  return chance(50) ? "true" : "false";
+}
+
+// Returns a call of a method returning the kind (any method for
+// k_none), or an empty string if there is none in scope
+std::string Generator::call(Kind kind) {
+  if (!ownMethods.empty() && chance(50)) {
+    const Method &method = ownMethods[random(ownMethods.size())];
+    if (kind == k_none || method.returns == kind)
+      return method.name + "(" + arguments(method) + ")";
+  }
+  if (!objects.empty()) {
+    const Variable &object = objects[random(objects.size())];
+    const std::vector<Method> &methods = classes[object.objectClass].methods;
+    for (size_t i = 0, start = methods.empty() ? 0 : random(methods.size()); i < methods.size(); i++) {
+      const Method &method = methods[(start + i) % methods.size()];
+      if (kind == k_none || method.returns == kind)
+        return object.name + "." + method.name + "(" + arguments(method) + ")";
+    }
+  }
+  return "";
+}
+
+// Arguments are literals, variables or new objects, so calls do
+// not nest
+std::string Generator::arguments(const Method &method) {
+  std::string arguments;
+  for (size_t i = 0; i < method.parameters.size(); i++) {
+    const Variable &parameter = method.parameters[i];
+    if (i)
+      arguments += ", ";
+    if (parameter.kind == k_object)
+      arguments += "new " + classes[parameter.objectClass].name;
+    else
+      arguments += value(parameter.kind);
+  }
+  return arguments;
+}
+
+std::string generate(const Workload &workload) {
+  Generator generator(workload);
+  return generator.program();
+}
@@ -0,0 +1,43 @@
+#ifndef __WORKLOAD_HPP
+#define __WORKLOAD_HPP
+
+#include <iostream>
+#include <string>
+
+// Defines the shape of a generated program. Every generated
+// program is well typed, so the checker runs every phase over
+// all of it; the knobs only change how much of each construct
+// there is.
+typedef struct workload {
+  // Number of classes, not counting Main
+  int classes;
+  // Length of the longest chain of super classes
+  int depth;
+  // Methods and members declared by each class
+  int methods;
+  int members;
+  // Locals declared by each method
+  int locals;
+  // Depth of the expressions in statements and returns
+  int expressionDepth;
+  // Percentage of expression leaves that are method calls
+  int callDensity;
+  unsigned int seed;
+} Workload;
+
+// Returns the workload the generator and benchmark use when no
+// knobs are given.
+Workload defaultWorkload();
+
+// Sets the knob named by an option such as "--classes" to value.
+// Returns false if there is no such knob.
+bool setKnob(Workload &workload, const char *option, const char *value);
+
+// Prints the knob options, for usage messages.
+void printKnobs(std::ostream &out);
+
+// Returns the source of a program with the shape of the workload.
+// The same workload always gives the same program.
+std::string generate(const Workload &workload);
+
+#endif
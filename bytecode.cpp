@@ -0,0 +1,756 @@
+#include "bytecode.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+#define OPCODE_NAME(name) #name,
+
+const char *opcodeName(Opcode opcode) {
+  static const char *names[] = {OPCODES(OPCODE_NAME)};
+  return opcode < op_opcodes ? names[opcode] : "?";
+}
+
+#undef OPCODE_NAME
+
+const Operands &operandsOf(Opcode opcode) {
+  // In the order of OPCODES
+  static const Operands operands[] = {
+      {o_register, o_register, o_none},      // move
+      {o_register, o_integer, o_none},       // constant
+      {o_register, o_register, o_register},  // add
+      {o_register, o_register, o_integer},   // addConstant
+      {o_register, o_register, o_register},  // subtract
+      {o_register, o_register, o_register},  // multiply
+      {o_register, o_register, o_register},  // divide
+      {o_register, o_register, o_register},  // less
+      {o_register, o_register, o_register},  // lessEqual
+      {o_register, o_register, o_register},  // equal
+      {o_register, o_register, o_register},  // and
+      {o_register, o_register, o_register},  // or
+      {o_register, o_register, o_none},      // not
+      {o_register, o_register, o_none},      // negate
+      {o_none, o_target, o_none},            // jump
+      {o_register, o_target, o_none},        // jumpIf
+      {o_register, o_target, o_none},        // jumpUnless
+      {o_register, o_register, o_target},    // jumpUnlessLess
+      {o_register, o_register, o_target},    // jumpUnlessLessEqual
+      {o_register, o_register, o_target},    // jumpUnlessEqual
+      {o_register, o_register, o_offset},    // getField
+      {o_register, o_register, o_offset},    // setField
+      {o_register, o_register, o_offset},    // getByte
+      {o_register, o_register, o_offset},    // setByte
+      {o_register, o_class, o_none},         // checkClass
+      {o_register, o_none, o_none},          // checkObject
+      {o_register, o_class, o_none},         // new
+      {o_register, o_function, o_register},  // call
+      {o_register, o_function, o_register},  // callDirect
+      {o_register, o_slot, o_register},      // callMethod
+      {o_register, o_none, o_none},          // print
+      {o_register, o_none, o_none},          // return
+      {o_none, o_none, o_none},              // returnNone
+  };
+  static_assert(sizeof(operands) / sizeof(operands[0]) == op_opcodes, "an opcode has no operands");
+  return operands[opcode];
+}
+
+Bytecode::Bytecode() {
+  mainClass = -1;
+  mainConstructor = -1;
+  mainMethod = -1;
+  methodCalls = 0;
+  directCalls = 0;
+  inlinedCalls = 0;
+}
+
+// The bytes of an object before its members: the number of its class
+const int objectHeader = 4;
+
+// Defines what lowering a program keeps track of: the number of
+// every class, the function of every method by class number, and,
+// while a method is lowered, its class, its variables and the
+// first free register of its frame.
+typedef struct lowering {
+  Compilation *compilation;
+  Bytecode *bytecode;
+  SymbolMap<int> classNumbers;
+  std::vector<SymbolMap<int> > functions;
+  bool failed;
+
+  Symbol className;
+  ClassInfo *classInfo;
+  VariableTable *variables;
+  Function *function;
+  int top;
+} Lowering;
+
+void fail(Lowering &lowering, const std::string &message, ASTNode *node) {
+  lowering.compilation->diagnostics.error(message, node, 0);
+  lowering.failed = true;
+}
+
+ClassInfo &classInfo(Lowering &lowering, Symbol className) {
+  return lowering.compilation->classTable->at(className);
+}
+
+// Returns true if objects of class from are objects of class to.
+bool conforms(Lowering &lowering, Symbol from, Symbol to) {
+  for (Symbol className = from; className != noSymbol; className = classInfo(lowering, className).superClassName)
+    if (className == to)
+      return true;
+  return false;
+}
+
+// Returns the base type of the value an instruction writes, for the
+// opcodes whose values always have the same one, and bt_none for
+// the rest.
+BaseType resultType(Opcode op) {
+  switch (op) {
+    case op_add:
+    case op_addConstant:
+    case op_subtract:
+    case op_multiply:
+    case op_divide:
+    case op_negate:
+      return bt_integer;
+    case op_less:
+    case op_lessEqual:
+    case op_equal:
+    case op_and:
+    case op_or:
+    case op_not:
+      return bt_boolean;
+    case op_new:
+      return bt_object;
+    default:
+      return bt_none;
+  }
+}
+
+// Emits an instruction that writes a value of the given type, which
+// moves, constants, member reads and calls take from the expression
+// they lower.
+size_t emitValue(Lowering &lowering, BaseType type, Opcode op, int a, int b = 0, int c = 0, int d = 0) {
+  Instruction instruction = {op, (unsigned char) type, (unsigned short) a, b, c, d};
+  lowering.function->code.push_back(instruction);
+  return lowering.function->code.size() - 1;
+}
+
+size_t emit(Lowering &lowering, Opcode op, int a, int b = 0, int c = 0, int d = 0) {
+  return emitValue(lowering, resultType(op), op, a, b, c, d);
+}
+
+// Points the jump at the given instruction to the next instruction
+// to be emitted.
+void patch(Lowering &lowering, size_t jump) {
+  Instruction &instruction = lowering.function->code[jump];
+  int target = lowering.function->code.size();
+  if (instruction.op == op_jumpUnlessLess || instruction.op == op_jumpUnlessLessEqual ||
+      instruction.op == op_jumpUnlessEqual)
+    instruction.c = target;
+  else
+    instruction.b = target;
+}
+
+// Returns a free register for a temporary. Temporaries are freed
+// all at once, by setting top back, once the statement or call
+// that needed them has been lowered.
+int temporary(Lowering &lowering) {
+  int reg = lowering.top++;
+  if (lowering.top > lowering.function->registers)
+    lowering.function->registers = lowering.top;
+  return reg;
+}
+
+// Returns the register of a parameter or local, or -1 if the name
+// is a member of the object the method runs on. Parameters are at
+// offsets from 12 up and locals at offsets from -4 down.
+int variableRegister(Lowering &lowering, Symbol name) {
+  VariableInfo *variable = lowering.variables->lookup(name);
+  if (!variable)
+    return -1;
+  if (variable->offset > 0)
+    return 1 + (variable->offset - 12) / 4;
+  return lowering.function->parameters + (-variable->offset - 4) / 4;
+}
+
+// Returns the type of a parameter, local or member of the object
+// the method runs on.
+TypeId variableType(Lowering &lowering, Symbol name) {
+  VariableInfo *variable = lowering.variables->lookup(name);
+  if (variable)
+    return variable->type;
+  return lowering.classInfo->memberLayout->at(name).info.type;
+}
+
+void lowerExpression(Lowering &lowering, ExpressionNode *node, int target);
+
+// Returns a register holding the value of an expression: the
+// register of a variable, or a temporary it is lowered into.
+int operand(Lowering &lowering, ExpressionNode *node) {
+  if (node->kind == nk_Variable) {
+    int reg = variableRegister(lowering, ((VariableNode *) node)->identifier->symbol);
+    if (reg >= 0)
+      return reg;
+  }
+  int reg = temporary(lowering);
+  lowerExpression(lowering, node, reg);
+  return reg;
+}
+
+// Reads a member of the object in a register into the target, or
+// sets it to the value in a register, with the instructions for the
+// size it takes.
+void emitGetField(Lowering &lowering, const MemberSlot &member, int target, int object) {
+  emitValue(lowering, baseTypeOf(member.info.type), member.info.size == 1 ? op_getByte : op_getField, target,
+            object, objectHeader + member.info.offset);
+}
+
+void emitSetField(Lowering &lowering, const MemberSlot &member, int object, int value) {
+  emit(lowering, member.info.size == 1 ? op_setByte : op_setField, object, value, objectHeader + member.info.offset);
+}
+
+// Returns a register holding the object a parameter, local or
+// member of the object the method runs on refers to.
+int objectOperand(Lowering &lowering, Symbol name) {
+  int reg = variableRegister(lowering, name);
+  if (reg >= 0)
+    return reg;
+  reg = temporary(lowering);
+  emitGetField(lowering, lowering.classInfo->memberLayout->at(name), reg, 0);
+  return reg;
+}
+
+// Checks at run time that an object stored in a variable of type
+// type is of its class, unless it is known to be. The type checker
+// only compares the base types of assignments and arguments.
+void checkClass(Lowering &lowering, int reg, ExpressionNode *value, TypeId type) {
+  if (baseTypeOf(type) != bt_object || conforms(lowering, value->objectClassName(), classNameOf(type)))
+    return;
+  emit(lowering, op_checkClass, reg, lowering.classNumbers.at(classNameOf(type)));
+}
+
+// Lowers the arguments of a call into the registers after base,
+// where the callee's parameters will be.
+void lowerArguments(Lowering &lowering, NodeList<ExpressionNode *> *arguments, std::list<TypeId> *parameters,
+                    int base) {
+  std::list<TypeId>::iterator parameter = parameters->begin();
+  int reg = base + 1;
+  for (NodeList<ExpressionNode *>::iterator it = arguments->begin(); it != arguments->end(); ++it, ++parameter) {
+    lowerExpression(lowering, *it, reg);
+    checkClass(lowering, reg, *it, *parameter);
+    reg++;
+  }
+}
+
+// Reserves the registers a call passes the object and arguments
+// in, at the top of the frame.
+int reserveCall(Lowering &lowering, size_t arguments) {
+  int base = temporary(lowering);
+  for (size_t i = 0; i < arguments; i++)
+    temporary(lowering);
+  return base;
+}
+
+// Returns the function that objects of a class and of all its
+// subclasses run for a slot of their virtual table, or -1 if they
+// do not all run the same one. The whole program is known when it
+// is lowered, and the subclasses of a class are numbered right
+// after it, so this is class hierarchy analysis over a range of
+// classes.
+int devirtualize(Lowering &lowering, Symbol className, int slot) {
+  std::vector<ClassCode> &classes = lowering.bytecode->classes;
+  int number = lowering.classNumbers.at(className);
+  int function = classes[number].methods[slot];
+  for (int i = number + 1; i <= classes[number].lastSubclass; i++)
+    if (classes[i].methods[slot] != function)
+      return -1;
+  return function;
+}
+
+void lowerMethodCall(Lowering &lowering, MethodCallNode *node, int target) {
+  int top = lowering.top;
+  int base = reserveCall(lowering, node->expression_list->size());
+  Symbol className = lowering.className;
+  Symbol method = node->identifier_1->symbol;
+  if (node->identifier_2) {
+    Symbol object = node->identifier_1->symbol;
+    int reg = variableRegister(lowering, object);
+    if (reg >= 0)
+      emitValue(lowering, bt_object, op_move, base, reg);
+    else
+      emitGetField(lowering, lowering.classInfo->memberLayout->at(object), base, 0);
+    className = classNameOf(variableType(lowering, object));
+    method = node->identifier_2->symbol;
+  } else {
+    emitValue(lowering, bt_object, op_move, base, 0);
+  }
+  MethodSlot &slot = classInfo(lowering, className).methodLayout->at(method);
+  lowerArguments(lowering, node->expression_list, slot.info.parameters, base);
+  int registers = 1 + node->expression_list->size();
+  int function = devirtualize(lowering, className, slot.slot);
+  lowering.bytecode->methodCalls++;
+  BaseType type = baseTypeOf(slot.info.returnType);
+  if (function < 0) {
+    emitValue(lowering, type, op_callMethod, target, slot.slot, base, registers);
+  } else {
+    // The object a method runs on is never none
+    emitValue(lowering, type, node->identifier_2 ? op_callDirect : op_call, target, function, base, registers);
+    lowering.bytecode->directCalls++;
+  }
+  lowering.top = top;
+}
+
+void lowerNew(Lowering &lowering, NewNode *node, int target) {
+  Symbol className = node->identifier->symbol;
+  int number = lowering.classNumbers.at(className);
+  // The constructor is the method named after the class
+  MethodInfo *constructor = classInfo(lowering, className).methods->lookup(className);
+  if (!constructor) {
+    if (!node->expression_list->empty())
+      fail(lowering, "Class has no constructor to pass arguments to.", node);
+    emit(lowering, op_new, target, number);
+    return;
+  }
+  if (constructor->parameters->size() != node->expression_list->size()) {
+    fail(lowering, "Constructor called with incorrect number of arguments.", node);
+    return;
+  }
+  std::list<TypeId>::iterator parameter = constructor->parameters->begin();
+  for (NodeList<ExpressionNode *>::iterator it = node->expression_list->begin(); it != node->expression_list->end();
+       ++it, ++parameter)
+    if ((*it)->basetype() != baseTypeOf(*parameter)) {
+      fail(lowering, "Constructor called with argument of incorrect type.", *it);
+      return;
+    }
+
+  int top = lowering.top;
+  int base = reserveCall(lowering, node->expression_list->size());
+  emit(lowering, op_new, base, number);
+  lowerArguments(lowering, node->expression_list, constructor->parameters, base);
+  emitValue(lowering, baseTypeOf(constructor->returnType), op_call, target, lowering.functions[number].at(className),
+            base, 1 + node->expression_list->size());
+  emitValue(lowering, bt_object, op_move, target, base);
+  lowering.top = top;
+}
+
+// Lowers a binary operator, folding an integer literal on the
+// right of an addition or subtraction into the instruction.
+void lowerBinary(Lowering &lowering, Opcode op, ExpressionNode *left, ExpressionNode *right, int target) {
+  int top = lowering.top;
+  if ((op == op_add || op == op_subtract) && right->kind == nk_IntegerLiteral) {
+    unsigned int value = ((IntegerLiteralNode *) right)->integer->value;
+    emit(lowering, op_addConstant, target, operand(lowering, left), op == op_add ? value : 0u - value);
+  } else {
+    int a = operand(lowering, left);
+    int b = operand(lowering, right);
+    emit(lowering, op, target, a, b);
+  }
+  lowering.top = top;
+}
+
+void lowerUnary(Lowering &lowering, Opcode op, ExpressionNode *expression, int target) {
+  int top = lowering.top;
+  emit(lowering, op, target, operand(lowering, expression));
+  lowering.top = top;
+}
+
+// Lowers an expression so that its value ends up in target. The
+// target is only written once everything the expression reads has
+// been read, so it may be a variable the expression uses.
+void lowerExpression(Lowering &lowering, ExpressionNode *node, int target) {
+  switch (node->kind) {
+    case nk_Plus:
+      lowerBinary(lowering, op_add, ((PlusNode *) node)->expression_1, ((PlusNode *) node)->expression_2, target);
+      break;
+    case nk_Minus:
+      lowerBinary(lowering, op_subtract, ((MinusNode *) node)->expression_1, ((MinusNode *) node)->expression_2,
+                  target);
+      break;
+    case nk_Times:
+      lowerBinary(lowering, op_multiply, ((TimesNode *) node)->expression_1, ((TimesNode *) node)->expression_2,
+                  target);
+      break;
+    case nk_Divide:
+      lowerBinary(lowering, op_divide, ((DivideNode *) node)->expression_1, ((DivideNode *) node)->expression_2,
+                  target);
+      break;
+    case nk_Less:
+      lowerBinary(lowering, op_less, ((LessNode *) node)->expression_1, ((LessNode *) node)->expression_2, target);
+      break;
+    case nk_LessEqual:
+      lowerBinary(lowering, op_lessEqual, ((LessEqualNode *) node)->expression_1,
+                  ((LessEqualNode *) node)->expression_2, target);
+      break;
+    case nk_Equal:
+      lowerBinary(lowering, op_equal, ((EqualNode *) node)->expression_1, ((EqualNode *) node)->expression_2, target);
+      break;
+    case nk_And:
+      lowerBinary(lowering, op_and, ((AndNode *) node)->expression_1, ((AndNode *) node)->expression_2, target);
+      break;
+    case nk_Or:
+      lowerBinary(lowering, op_or, ((OrNode *) node)->expression_1, ((OrNode *) node)->expression_2, target);
+      break;
+    case nk_Not:
+      lowerUnary(lowering, op_not, ((NotNode *) node)->expression, target);
+      break;
+    case nk_Negation:
+      lowerUnary(lowering, op_negate, ((NegationNode *) node)->expression, target);
+      break;
+    case nk_MethodCall:
+      lowerMethodCall(lowering, (MethodCallNode *) node, target);
+      break;
+    case nk_MemberAccess: {
+      MemberAccessNode *access = (MemberAccessNode *) node;
+      int top = lowering.top;
+      Symbol object = access->identifier_1->symbol;
+      int reg = objectOperand(lowering, object);
+      ClassInfo &objectClass = classInfo(lowering, classNameOf(variableType(lowering, object)));
+      emitGetField(lowering, objectClass.memberLayout->at(access->identifier_2->symbol), target, reg);
+      lowering.top = top;
+      break;
+    }
+    case nk_Variable: {
+      Symbol name = ((VariableNode *) node)->identifier->symbol;
+      int reg = variableRegister(lowering, name);
+      if (reg < 0)
+        emitGetField(lowering, lowering.classInfo->memberLayout->at(name), target, 0);
+      else if (reg != target)
+        emitValue(lowering, node->basetype(), op_move, target, reg);
+      break;
+    }
+    case nk_IntegerLiteral:
+      emitValue(lowering, bt_integer, op_constant, target, ((IntegerLiteralNode *) node)->integer->value);
+      break;
+    case nk_BooleanLiteral:
+      emitValue(lowering, bt_boolean, op_constant, target, ((BooleanLiteralNode *) node)->integer->value);
+      break;
+    case nk_New:
+      lowerNew(lowering, (NewNode *) node, target);
+      break;
+    default:
+      fail(lowering, "Expression cannot be lowered.", node);
+      break;
+  }
+}
+
+// Lowers a condition into a jump that is taken when it is false,
+// comparing with a single instruction where it can, and returns
+// the jump, to be patched or pointed at its target.
+size_t lowerCondition(Lowering &lowering, ExpressionNode *node) {
+  int top = lowering.top;
+  size_t jump;
+  if (node->kind == nk_Less || node->kind == nk_LessEqual || node->kind == nk_Equal) {
+    // All three have their operands in the same place
+    LessNode *comparison = (LessNode *) node;
+    int a = operand(lowering, comparison->expression_1);
+    int b = operand(lowering, comparison->expression_2);
+    Opcode op = node->kind == nk_Less ? op_jumpUnlessLess
+                                      : node->kind == nk_LessEqual ? op_jumpUnlessLessEqual : op_jumpUnlessEqual;
+    jump = emit(lowering, op, a, b);
+  } else if (node->kind == nk_Not) {
+    jump = emit(lowering, op_jumpIf, operand(lowering, ((NotNode *) node)->expression));
+  } else {
+    jump = emit(lowering, op_jumpUnless, operand(lowering, node));
+  }
+  lowering.top = top;
+  return jump;
+}
+
+void lowerStatements(Lowering &lowering, NodeList<StatementNode *> *statements);
+
+void lowerAssignment(Lowering &lowering, AssignmentNode *node) {
+  Symbol name = node->identifier_1->symbol;
+  if (node->identifier_2) {
+    // The value is computed before the object is read
+    int value = operand(lowering, node->expression);
+    int object = objectOperand(lowering, name);
+    MemberSlot &member = classInfo(lowering, classNameOf(variableType(lowering, name))).memberLayout->at(
+        node->identifier_2->symbol);
+    checkClass(lowering, value, node->expression, member.info.type);
+    emitSetField(lowering, member, object, value);
+    return;
+  }
+  int reg = variableRegister(lowering, name);
+  if (reg >= 0) {
+    lowerExpression(lowering, node->expression, reg);
+    checkClass(lowering, reg, node->expression, variableType(lowering, name));
+    return;
+  }
+  MemberSlot &member = lowering.classInfo->memberLayout->at(name);
+  int value = operand(lowering, node->expression);
+  checkClass(lowering, value, node->expression, member.info.type);
+  emitSetField(lowering, member, 0, value);
+}
+
+void lowerStatement(Lowering &lowering, StatementNode *node) {
+  int top = lowering.top;
+  switch (node->kind) {
+    case nk_Assignment:
+      lowerAssignment(lowering, (AssignmentNode *) node);
+      break;
+    case nk_Call:
+      lowerMethodCall(lowering, ((CallNode *) node)->methodcall, temporary(lowering));
+      break;
+    case nk_IfElse: {
+      IfElseNode *ifElse = (IfElseNode *) node;
+      size_t skipThen = lowerCondition(lowering, ifElse->expression);
+      lowerStatements(lowering, ifElse->statement_list_1);
+      if (ifElse->statement_list_2->empty()) {
+        patch(lowering, skipThen);
+        break;
+      }
+      size_t skipElse = emit(lowering, op_jump, 0);
+      patch(lowering, skipThen);
+      lowerStatements(lowering, ifElse->statement_list_2);
+      patch(lowering, skipElse);
+      break;
+    }
+    case nk_While: {
+      WhileNode *loop = (WhileNode *) node;
+      int start = lowering.function->code.size();
+      size_t exit = lowerCondition(lowering, loop->expression);
+      lowerStatements(lowering, loop->statement_list);
+      emit(lowering, op_jump, 0, start);
+      patch(lowering, exit);
+      break;
+    }
+    case nk_Repeat: {
+      RepeatNode *loop = (RepeatNode *) node;
+      int start = lowering.function->code.size();
+      lowerStatements(lowering, loop->statement_list);
+      // Go round again while the condition is false
+      size_t again = lowerCondition(lowering, loop->expression);
+      Instruction &jump = lowering.function->code[again];
+      if (jump.op == op_jumpUnless || jump.op == op_jumpIf)
+        jump.b = start;
+      else
+        jump.c = start;
+      break;
+    }
+    case nk_Print: {
+      ExpressionNode *expression = ((PrintNode *) node)->expression;
+      if (expression->basetype() != bt_integer && expression->basetype() != bt_boolean) {
+        fail(lowering, "Only integers and booleans can be printed.", node);
+        break;
+      }
+      emit(lowering, op_print, operand(lowering, expression));
+      break;
+    }
+    default:
+      fail(lowering, "Statement cannot be lowered.", node);
+      break;
+  }
+  lowering.top = top;
+}
+
+void lowerStatements(Lowering &lowering, NodeList<StatementNode *> *statements) {
+  for (NodeList<StatementNode *>::iterator it = statements->begin(); it != statements->end(); ++it)
+    lowerStatement(lowering, *it);
+}
+
+void lowerMethod(Lowering &lowering, Symbol className, MethodNode *node, Function &function) {
+  lowering.className = className;
+  lowering.classInfo = &classInfo(lowering, className);
+  MethodInfo &info = lowering.classInfo->methods->at(node->identifier->symbol);
+  lowering.variables = info.variables;
+  lowering.function = &function;
+
+  // A local declared twice keeps the offset of the second, so the
+  // locals are counted from the offsets rather than the table
+  function.parameters = 1 + info.parameters->size();
+  function.locals = 0;
+  for (VariableTable::const_iterator it = info.variables->begin(); it != info.variables->end(); ++it)
+    if (it->second.offset < 0 && (-it->second.offset) / 4 > function.locals)
+      function.locals = (-it->second.offset) / 4;
+  function.registers = function.parameters + function.locals;
+  function.variables.assign(function.registers, bt_none);
+  function.variables[0] = bt_object;
+  for (VariableTable::const_iterator it = info.variables->begin(); it != info.variables->end(); ++it)
+    function.variables[variableRegister(lowering, it->first)] = baseTypeOf(it->second.type);
+  lowering.top = function.registers;
+
+  MethodBodyNode *body = node->methodbody;
+  lowerStatements(lowering, body->statement_list);
+  if (body->returnstatement) {
+    int top = lowering.top;
+    emit(lowering, op_return, operand(lowering, body->returnstatement->expression));
+    lowering.top = top;
+  } else {
+    emit(lowering, op_returnNone, 0);
+  }
+  if (function.registers > maxRegisters)
+    fail(lowering, "Method needs too many registers to be lowered.", node);
+}
+
+// Numbers a class and its subclasses in preorder, filling in the
+// class code of each.
+void numberClasses(Lowering &lowering, Symbol className, std::vector<std::vector<Symbol> > &subclasses,
+                   SymbolMap<int> &order) {
+  int number = lowering.bytecode->classes.size();
+  lowering.classNumbers[className] = number;
+  ClassCode code;
+  code.name = className;
+  const ClassInfo &info = classInfo(lowering, className);
+  code.size = objectHeader + (info.membersSize + 3) / 4 * 4;
+  // A member an own member hides keeps its place in the map of the
+  // super class
+  if (info.superClassName != noSymbol)
+    code.references = lowering.bytecode->classes[lowering.classNumbers.at(info.superClassName)].references;
+  std::vector<int> own;
+  for (MemberLayout::const_iterator it = info.memberLayout->begin(); it != info.memberLayout->end(); ++it)
+    if (it->second.owner == className && baseTypeOf(it->second.info.type) == bt_object)
+      own.push_back(objectHeader + it->second.info.offset);
+  std::sort(own.begin(), own.end());
+  code.references.insert(code.references.end(), own.begin(), own.end());
+  lowering.bytecode->classes.push_back(code);
+  std::vector<Symbol> &children = subclasses[order.at(className)];
+  for (size_t i = 0; i < children.size(); i++)
+    numberClasses(lowering, children[i], subclasses, order);
+  lowering.bytecode->classes[number].lastSubclass = lowering.bytecode->classes.size() - 1;
+}
+
+bool lower(Compilation &compilation, Bytecode &bytecode) {
+  Lowering lowering;
+  lowering.compilation = &compilation;
+  lowering.bytecode = &bytecode;
+  lowering.failed = false;
+  ClassTable &classTable = *compilation.classTable;
+
+  // The class table has the last class of each name, and the
+  // program runs on the last class, which is Main
+  std::vector<ClassNode *> classes;
+  SymbolMap<int> order;
+  NodeList<ClassNode *> *classList = compilation.program->class_list;
+  for (NodeList<ClassNode *>::iterator it = classList->begin(); it != classList->end(); ++it) {
+    int *index = order.lookup((*it)->identifier_1->symbol);
+    if (index) {
+      classes[*index] = *it;
+      continue;
+    }
+    order[(*it)->identifier_1->symbol] = classes.size();
+    classes.push_back(*it);
+  }
+  if (classes.size() != classTable.size()) {
+    fail(lowering, "Classes imported from class libraries cannot be run.", NULL);
+    return false;
+  }
+
+  // Number the classes, the roots of the hierarchy and the
+  // subclasses of each class in the order they are declared
+  std::vector<std::vector<Symbol> > subclasses(classes.size());
+  for (size_t i = 0; i < classes.size(); i++) {
+    Symbol superClassName = classTable.at(classes[i]->identifier_1->symbol).superClassName;
+    if (superClassName != noSymbol)
+      subclasses[order.at(superClassName)].push_back(classes[i]->identifier_1->symbol);
+  }
+  for (size_t i = 0; i < classes.size(); i++)
+    if (classTable.at(classes[i]->identifier_1->symbol).superClassName == noSymbol)
+      numberClasses(lowering, classes[i]->identifier_1->symbol, subclasses, order);
+
+  // Give every method a function, then fill in the virtual tables
+  lowering.functions.resize(classes.size());
+  std::vector<std::pair<Symbol, MethodNode *> > methods;
+  for (size_t i = 0; i < classes.size(); i++) {
+    Symbol className = classes[i]->identifier_1->symbol;
+    NodeList<MethodNode *> *methodList = classes[i]->method_list;
+    for (NodeList<MethodNode *>::iterator it = methodList->begin(); it != methodList->end(); ++it) {
+      // A method declared twice is the second
+      SymbolMap<int> &functions = lowering.functions[lowering.classNumbers.at(className)];
+      int *function = functions.lookup((*it)->identifier->symbol);
+      if (function) {
+        methods[*function].second = *it;
+        continue;
+      }
+      functions[(*it)->identifier->symbol] = methods.size();
+      methods.push_back(std::make_pair(className, *it));
+    }
+  }
+  for (size_t i = 0; i < bytecode.classes.size(); i++) {
+    ClassCode &code = bytecode.classes[i];
+    MethodLayout &layout = *classTable.at(code.name).methodLayout;
+    code.methods.resize(layout.size());
+    for (MethodLayout::const_iterator it = layout.begin(); it != layout.end(); ++it)
+      code.methods[it->second.slot] = lowering.functions[lowering.classNumbers.at(it->second.owner)].at(it->first);
+  }
+
+  bytecode.functions.resize(methods.size());
+  for (size_t i = 0; i < methods.size(); i++) {
+    bytecode.functions[i].className = methods[i].first;
+    bytecode.functions[i].name = methods[i].second->identifier->symbol;
+    lowerMethod(lowering, methods[i].first, methods[i].second, bytecode.functions[i]);
+  }
+
+  Symbol mainClass = classList->back()->identifier_1->symbol;
+  bytecode.mainClass = lowering.classNumbers.at(mainClass);
+  SymbolMap<int> &mainFunctions = lowering.functions[bytecode.mainClass];
+  bytecode.mainMethod = mainFunctions.at(compilation.symbols.intern("main"));
+  int *constructor = mainFunctions.lookup(mainClass);
+  if (constructor) {
+    if (bytecode.functions[*constructor].parameters != 1)
+      fail(lowering, "The constructor of the \"Main\" class has parameters.", NULL);
+    bytecode.mainConstructor = *constructor;
+  }
+  return !lowering.failed;
+}
+
+// Prints an operand of an instruction.
+void printOperand(std::ostream &out, const SymbolInterner &symbols, const Bytecode &bytecode, OperandKind kind,
+                  int operand) {
+  switch (kind) {
+    case o_register:
+      out << "r" << operand;
+      break;
+    case o_integer:
+      out << operand;
+      break;
+    case o_offset:
+      out << "+" << operand;
+      break;
+    case o_target:
+      out << "@" << operand;
+      break;
+    case o_class:
+      out << symbols.name(bytecode.classes[operand].name);
+      break;
+    case o_function:
+      out << symbols.name(bytecode.functions[operand].className) << "."
+          << symbols.name(bytecode.functions[operand].name);
+      break;
+    case o_slot:
+      out << "slot " << operand;
+      break;
+    default:
+      break;
+  }
+}
+
+void disassemble(std::ostream &out, const SymbolInterner &symbols, const Bytecode &bytecode) {
+  for (size_t f = 0; f < bytecode.functions.size(); f++) {
+    const Function &function = bytecode.functions[f];
+    out << symbols.name(function.className) << "." << symbols.name(function.name) << ": parameters "
+        << function.parameters << ", locals " << function.locals << ", registers " << function.registers
+        << std::endl;
+    for (size_t i = 0; i < function.code.size(); i++) {
+      const Instruction &instruction = function.code[i];
+      const Operands &operands = operandsOf(instruction.op);
+      out << std::setw(6) << i << "  " << std::left << std::setw(20) << opcodeName(instruction.op) << std::right;
+      const char *separator = "";
+      if (operands.a != o_none) {
+        printOperand(out, symbols, bytecode, operands.a, instruction.a);
+        separator = ", ";
+      }
+      if (operands.b != o_none) {
+        out << separator;
+        printOperand(out, symbols, bytecode, operands.b, instruction.b);
+        separator = ", ";
+      }
+      if (operands.c != o_none) {
+        out << separator;
+        printOperand(out, symbols, bytecode, operands.c, instruction.c);
+      }
+      if (operands.b == o_function || operands.b == o_slot)
+        out << ", " << instruction.d;
+      out << std::endl;
+    }
+  }
+}
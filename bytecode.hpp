@@ -0,0 +1,173 @@
+#ifndef __BYTECODE_HPP
+#define __BYTECODE_HPP
+
+#include "langcheck.hpp"
+
+#include <iostream>
+#include <vector>
+
+// Defines the register bytecode a checked program is lowered to,
+// to be run by the VM. Every method is a function whose frame is a
+// window of 32 bit registers: register 0 holds the object the
+// method runs on, the parameters follow in order, then the locals,
+// numbered from the offsets the type checker gave them, then the
+// temporaries of expressions. A call passes the object and the
+// arguments in consecutive registers at the top of the caller's
+// frame, which become the bottom of the callee's.
+//
+// Integers are 32 bits and wrap around, booleans are 0 or 1, and
+// objects are references: the byte offset of the object in the
+// heap, or 0 for none. An object is a word holding the number of
+// its class followed by its members, at the offsets of its class's
+// member layout, padded to a whole word. A boolean member takes a
+// byte there, read and written with getByte and setByte; every
+// other value fits a 32 bit word.
+//
+// Classes are numbered in preorder of the class hierarchy, so the
+// subclasses of a class are numbered right after it, and an object
+// is of a class exactly when its class number lies between the
+// class's and that of the class's last subclass.
+
+// The opcodes. In the comments, rN is register N of the frame and
+// a, b and c are the operands of the instruction.
+#define OPCODES(X)                                                        \
+  X(move)            /* ra = rb */                                        \
+  X(constant)        /* ra = b */                                         \
+  X(add)             /* ra = rb + rc */                                   \
+  X(addConstant)     /* ra = rb + c */                                    \
+  X(subtract)        /* ra = rb - rc */                                   \
+  X(multiply)        /* ra = rb * rc */                                   \
+  X(divide)          /* ra = rb / rc, failing if rc is 0 */               \
+  X(less)            /* ra = rb < rc */                                   \
+  X(lessEqual)       /* ra = rb <= rc */                                  \
+  X(equal)           /* ra = rb == rc */                                  \
+  X(and)             /* ra = rb and rc */                                 \
+  X(or)              /* ra = rb or rc */                                  \
+  X(not)             /* ra = not rb */                                    \
+  X(negate)          /* ra = -rb */                                       \
+  X(jump)            /* continue at instruction b */                      \
+  X(jumpIf)          /* continue at b if ra */                            \
+  X(jumpUnless)      /* continue at b unless ra */                        \
+  X(jumpUnlessLess)  /* continue at c unless ra < rb */                   \
+  X(jumpUnlessLessEqual) /* continue at c unless ra <= rb */              \
+  X(jumpUnlessEqual) /* continue at c unless ra == rb */                  \
+  X(getField)        /* ra = the member of object rb at offset c */       \
+  X(setField)        /* the member of object ra at offset c = rb */       \
+  X(getByte)         /* ra = the boolean member of object rb at c */      \
+  X(setByte)         /* the boolean member of object ra at c = rb */      \
+  X(checkClass)      /* fail unless ra is none or of class b */           \
+  X(checkObject)     /* fail if ra is none */                             \
+  X(new)             /* ra = a new object of class b */                   \
+  X(call)            /* ra = function b, passing d registers from rc */   \
+  X(callDirect)      /* the same, failing if rc is none                */ \
+  X(callMethod)      /* ra = the method in slot b of the class of rc,  */ \
+                     /* passing d registers from rc, failing if rc is  */ \
+                     /* none                                           */ \
+  X(print)           /* print ra */                                       \
+  X(return)          /* return ra */                                      \
+  X(returnNone)      /* return nothing */
+
+#define OPCODE_ENUM(name) op_##name,
+typedef enum : unsigned char { OPCODES(OPCODE_ENUM) op_opcodes } Opcode;
+#undef OPCODE_ENUM
+
+// Returns the name of an opcode, as disassembly prints it.
+const char *opcodeName(Opcode opcode);
+
+// Defines what an operand of an instruction is: a register, an
+// integer (a constant, or the offset of a member), the index of an
+// instruction to jump to, the number of a class or of a function,
+// or a slot of a virtual table.
+typedef enum {o_none, o_register, o_integer, o_offset, o_target, o_class, o_function, o_slot} OperandKind;
+
+// Defines the kinds of the operands a, b and c of an opcode. The
+// fourth operand of calls is always the number of registers they
+// pass.
+typedef struct operands {
+  OperandKind a;
+  OperandKind b;
+  OperandKind c;
+} Operands;
+
+const Operands &operandsOf(Opcode opcode);
+
+// Defines an instruction: its opcode, the base type of the value
+// it writes to ra, bt_none if it writes none, and up to four
+// operands. The first is always a register, so it is kept short;
+// only calls have a fourth. After a call of a function that returns
+// nothing, its ra holds nothing of use.
+typedef struct instruction {
+  Opcode op;
+  unsigned char type;
+  unsigned short a;
+  int b;
+  int c;
+  int d;
+} Instruction;
+
+// The most registers a frame can have
+const int maxRegisters = 0xffff;
+
+// Defines the code of a method. The registers after the
+// parameters up to the temporaries are the locals, which start
+// out 0. The base types of the object, the parameters and the
+// locals are in variables.
+typedef struct function {
+  Symbol className;
+  Symbol name;
+  int parameters;
+  int locals;
+  int registers;
+  std::vector<BaseType> variables;
+  std::vector<Instruction> code;
+} Function;
+
+// Defines a class as the VM sees it: the size of its objects, the
+// number of its last subclass, the function of each slot of its
+// virtual table, and the offsets of the members of its objects that
+// hold references, inherited ones first, which the garbage
+// collector follows.
+typedef struct classcode {
+  Symbol name;
+  int size;
+  int lastSubclass;
+  std::vector<int> methods;
+  std::vector<int> references;
+} ClassCode;
+
+// Defines a lowered program: its classes, numbered in preorder,
+// and its functions. The program runs by creating a Main object,
+// running its constructor if it has one, and calling main on it.
+// Lowering counts the method calls of the program and how many of
+// them it made direct, and inlining the calls it inlined, for
+// lang --opt-report.
+class Bytecode {
+public:
+  std::vector<ClassCode> classes;
+  std::vector<Function> functions;
+  int mainClass;
+  int mainConstructor;
+  int mainMethod;
+
+  int methodCalls;
+  int directCalls;
+  int inlinedCalls;
+
+  Bytecode();
+
+private:
+  Bytecode(const Bytecode &);
+  Bytecode &operator=(const Bytecode &);
+};
+
+// Lowers a program that checked without errors to bytecode. What
+// the type checker lets through but cannot be run, such as classes
+// imported from class libraries, whose methods have no code, is
+// reported to the diagnostics of the compilation. Returns true if
+// nothing was.
+bool lower(Compilation &compilation, Bytecode &bytecode);
+
+// Prints the bytecode of every function, for --bytecode.
+void disassemble(std::ostream &out, const SymbolInterner &symbols, const Bytecode &bytecode);
+
+#endif
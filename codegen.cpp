@@ -0,0 +1,1072 @@
+#include "codegen.hpp"
+#include "regalloc.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// The bytes of stack the program may use before it fails with a
+// stack overflow, the bytes of address space the heap takes, the
+// bytes of its nursery, and how big the old generation grows before
+// it is collected the first time, which are the VM's
+const int stackLimit = 1 << 22;
+const int heapLimit = 1 << 29;
+const int nurserySize = 1 << 22;
+const int firstThreshold = 1 << 24;
+
+// The bytes of each half of the old generation
+const int halfSize = ((heapLimit - nurserySize) / 2) & ~4095;
+
+// The callee-saved registers, in the order stack maps number them
+const int calleeSaved = allocatableRegisters - firstCalleeSaved;
+
+// The runtime errors, each with the routine the code jumps to and
+// the message it reports, which are the VM's
+const char *runtimeErrors[][2] = {
+    {"lang_division_by_zero", "division by zero"},
+    {"lang_none_accessed", "member of none accessed"},
+    {"lang_none_assigned", "member of none assigned"},
+    {"lang_none_called", "method called on none"},
+    {"lang_class_mismatch", "object used as an object of a class it is not of"},
+    {"lang_stack_overflow", "stack overflow"},
+    {"lang_out_of_memory", "out of memory"},
+};
+
+// Writes the runtime: the C main and the routines the code calls.
+//
+// The heap is the VM's, with references that are addresses rather
+// than offsets: a nursery objects are allocated from, and an old
+// generation of two halves that what survives the nursery is copied
+// into, collected as the heap of the VM is. Objects are forwarded by
+// setting the lowest bit of their first word, which a descriptor's
+// address never has. The roots are the Main object and what the
+// stack map of each call in progress, looked up by its return
+// address, says is live in its frame and its callee-saved
+// registers, which are found where the functions it called saved
+// them, or where lang_new saved them last. Old objects given a
+// reference to a young one are remembered by lang_remember, with a
+// bit for each word of the heap, and listed in memory mapped after
+// the heap.
+void generateRuntime(std::ostream &out, const Bytecode &bytecode) {
+  out << "\t.text\n"
+         "\t.globl\tmain\n"
+         "main:\n"
+         "\tpush\t%rbp\n"
+         "\tmov\t%rsp, %rbp\n"
+      << "\tlea\t-" << stackLimit << "(%rsp), %rax\n"
+      << "\tmov\t%rax, lang_stack_limit(%rip)\n"
+         "\t# mmap(NULL, heapLimit, PROT_READ | PROT_WRITE,\n"
+         "\t#      MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT | MAP_NORESERVE, -1, 0)\n"
+         "\txor\t%edi, %edi\n"
+      << "\tmov\t$" << heapLimit << ", %esi\n"
+      << "\tmov\t$3, %edx\n"
+         "\tmov\t$0x4062, %ecx\n"
+         "\tmov\t$-1, %r8d\n"
+         "\txor\t%r9d, %r9d\n"
+         "\tcall\tmmap\n"
+         "\tcmp\t$-1, %rax\n"
+         "\tje\tlang_out_of_memory\n"
+         "\tmov\t%rax, lang_heap(%rip)\n"
+         "\tmov\t%rax, lang_heap_next(%rip)\n"
+      << "\tadd\t$" << nurserySize << ", %rax\n"
+      << "\tmov\t%rax, lang_heap_limit(%rip)\n"
+         "\tmov\t%rax, lang_nursery_end(%rip)\n"
+         "\tmov\t%rax, lang_halves(%rip)\n"
+         "\tmov\t%rax, lang_old_next(%rip)\n"
+      << "\tadd\t$" << halfSize << ", %rax\n"
+      << "\tmov\t%rax, lang_halves+8(%rip)\n"
+      << "\tmovq\t$" << firstThreshold << ", lang_threshold(%rip)\n"
+      << "\t# mmap(NULL, heapLimit + heapLimit / 32, PROT_READ | PROT_WRITE,\n"
+         "\t#      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)\n"
+         "\txor\t%edi, %edi\n"
+      << "\tmov\t$" << heapLimit + heapLimit / 32 << ", %esi\n"
+      << "\tmov\t$3, %edx\n"
+         "\tmov\t$0x4022, %ecx\n"
+         "\tmov\t$-1, %r8d\n"
+         "\txor\t%r9d, %r9d\n"
+         "\tcall\tmmap\n"
+         "\tcmp\t$-1, %rax\n"
+         "\tje\tlang_out_of_memory\n"
+         "\tmov\t%rax, lang_remembered(%rip)\n"
+         "\tmov\t%rax, lang_remembered_next(%rip)\n"
+      << "\tadd\t$" << heapLimit << ", %rax\n"
+      << "\tmov\t%rax, lang_remembered_bits(%rip)\n"
+         "\t# A stressed nursery is full from the start\n"
+         "\tlea\t.Lstress(%rip), %rdi\n"
+         "\tcall\tgetenv\n"
+         "\ttest\t%rax, %rax\n"
+         "\tjz\t1f\n"
+         "\tmov\t%rax, %rdi\n"
+         "\tcall\tatoi\n"
+         "\ttest\t%eax, %eax\n"
+         "\tjle\t1f\n"
+         "\tcltq\n"
+         "\tmov\t%rax, lang_stress(%rip)\n"
+         "\tmov\tlang_heap_next(%rip), %rax\n"
+         "\tmov\t%rax, lang_heap_limit(%rip)\n"
+         "1:\n"
+      << "\tmov\t$lang_class" << bytecode.mainClass << ", %edi\n"
+      << "\tcall\tlang_new\n"
+         "\tmov\t%eax, lang_main(%rip)\n";
+  if (bytecode.mainConstructor >= 0)
+    out << "\tmov\tlang_main(%rip), %edi\n"
+           "\tcall\tlang_f" << bytecode.mainConstructor << "\n";
+  out << "\tmov\tlang_main(%rip), %edi\n"
+         "\tcall\tlang_f" << bytecode.mainMethod << "\n"
+      << "\txor\t%eax, %eax\n"
+         "\tpop\t%rbp\n"
+         "\tret\n"
+         "\n"
+         "# Prints the integer in %edi on a line of its own\n"
+         "lang_print:\n"
+         "\tmov\t%edi, %esi\n"
+         "\tlea\t.Lprint_format(%rip), %rdi\n"
+         "\txor\t%eax, %eax\n"
+         "\tjmp\tprintf\n"
+         "\n"
+         "# Returns a new object of the class whose descriptor is at %edi.\n"
+         "# The nursery is zero, so the object needs nothing but its class.\n"
+         "lang_new:\n"
+         "\tmov\tlang_heap_next(%rip), %rax\n"
+         "\tmov\t8(%rdi), %ecx\n"
+         "\tadd\t%rax, %rcx\n"
+         "\tcmp\tlang_heap_limit(%rip), %rcx\n"
+         "\tja\tlang_new_slowly\n"
+         "\tmov\t%rcx, lang_heap_next(%rip)\n"
+         "\tmov\t%edi, (%rax)\n"
+         "\tret\n"
+         "\n"
+         "# Collects, then allocates as lang_new does, or in the old\n"
+         "# generation an object bigger than the nursery. The callee-saved\n"
+         "# registers are saved for the collector to update.\n"
+         "lang_new_slowly:\n"
+         "\tpush\t%rbp\n"
+         "\tmov\t%rsp, %rbp\n"
+         "\tpush\t%rdi\n";
+  for (int i = 0; i < calleeSaved; i++)
+    out << "\tmov\t" << wideRegisterName(firstCalleeSaved + i) << ", lang_registers+" << 8 * i << "(%rip)\n";
+  out << "\tand\t$-16, %rsp\n"
+         "\tmov\t8(%rdi), %edi\n"
+         "\tmov\t%rbp, %rsi\n"
+         "\tcall\tlang_collect\n"
+         "\ttest\t%eax, %eax\n"
+         "\tjz\tlang_out_of_memory\n";
+  for (int i = 0; i < calleeSaved; i++)
+    out << "\tmov\tlang_registers+" << 8 * i << "(%rip), " << wideRegisterName(firstCalleeSaved + i) << "\n";
+  out << "\tmov\t-8(%rbp), %rdi\n"
+         "\tmov\tlang_nursery_end(%rip), %rax\n"
+         "\tmov\t%rax, lang_heap_limit(%rip)\n"
+         "\tmov\tlang_heap_next(%rip), %rax\n"
+         "\tmov\t8(%rdi), %ecx\n"
+         "\tadd\t%rax, %rcx\n"
+         "\tcmp\tlang_heap_limit(%rip), %rcx\n"
+         "\tja\t1f\n"
+         "\tmov\t%rcx, lang_heap_next(%rip)\n"
+         "\t# A stressed nursery is full once it holds an object\n"
+         "\tcmpq\t$0, lang_stress(%rip)\n"
+         "\tje\t2f\n"
+         "\tmov\t%rcx, lang_heap_limit(%rip)\n"
+         "\tjmp\t2f\n"
+         "1:\tmov\tlang_old_next(%rip), %rax\n"
+         "\tmov\t8(%rdi), %ecx\n"
+         "\tadd\t%rax, %rcx\n"
+         "\tmov\t%rcx, lang_old_next(%rip)\n"
+         "2:\tmov\t%edi, (%rax)\n"
+         "\tleave\n"
+         "\tret\n"
+         "\n"
+         "# Remembers the old object at %rax, which was given a reference to\n"
+         "# a young one, changing nothing but %rcx\n"
+         "lang_remember:\n"
+         "\tpush\t%rdx\n"
+         "\tmov\t%rax, %rcx\n"
+         "\tsub\tlang_heap(%rip), %rcx\n"
+         "\tshr\t$2, %rcx\n"
+         "\tmov\tlang_remembered_bits(%rip), %rdx\n"
+         "\tbts\t%rcx, (%rdx)\n"
+         "\tjc\t1f\n"
+         "\tmov\tlang_remembered_next(%rip), %rdx\n"
+         "\tmov\t%eax, (%rdx)\n"
+         "\tadd\t$4, %rdx\n"
+         "\tmov\t%rdx, lang_remembered_next(%rip)\n"
+         "1:\tpop\t%rdx\n"
+         "\tret\n"
+         "\n"
+         "# Copies what is reachable out of the nursery, into the half of\n"
+         "# the old generation in use, or into the other half along with\n"
+         "# every reachable old object, as Heap::collect does, needing %rdi\n"
+         "# bytes free after, from the frame of lang_new_slowly at %rsi.\n"
+         "# Returns 0 if they are not free. The frame holds the bytes\n"
+         "# needed, where objects are copied from, and where each\n"
+         "# callee-saved register of the frame being visited is.\n"
+         "lang_collect:\n"
+         "\tpush\t%rbp\n"
+         "\tmov\t%rsp, %rbp\n"
+         "\tsub\t$64, %rsp\n"
+         "\tmov\t%rdi, -8(%rbp)\n"
+         "\tmov\t%rsi, %r12\n"
+         "\t# A major collection when the old generation has grown past the\n"
+         "\t# threshold, or would not have room for the nursery, or is due\n"
+         "\tmov\tlang_heap_next(%rip), %rax\n"
+         "\tsub\tlang_heap(%rip), %rax\n"
+         "\tmov\tlang_old_next(%rip), %rcx\n"
+         "\tsub\tlang_halves(%rip), %rcx\n"
+         "\tadd\t%rax, %rcx\n"
+         "\tcmp\tlang_threshold(%rip), %rcx\n"
+         "\tja\t1f\n"
+         "\tmov\tlang_old_next(%rip), %rcx\n"
+         "\tadd\t%rax, %rcx\n"
+         "\tmov\tlang_halves(%rip), %rdx\n"
+      << "\tadd\t$" << halfSize - nurserySize << ", %rdx\n"
+      << "\tcmp\t%rdx, %rcx\n"
+         "\tja\t1f\n"
+         "\tmov\tlang_stress(%rip), %rcx\n"
+         "\ttest\t%rcx, %rcx\n"
+         "\tjz\t2f\n"
+         "\tmov\tlang_collections(%rip), %rax\n"
+         "\tinc\t%rax\n"
+         "\txor\t%edx, %edx\n"
+         "\tdiv\t%rcx\n"
+         "\ttest\t%rdx, %rdx\n"
+         "\tjz\t1f\n"
+         "2:\tmovq\t$0, lang_major(%rip)\n"
+         "\tmov\tlang_old_next(%rip), %rax\n"
+         "\tjmp\t3f\n"
+         "1:\tmovq\t$1, lang_major(%rip)\n"
+         "\tmov\tlang_halves+8(%rip), %rax\n"
+         "3:\tmov\t%rax, lang_copy_next(%rip)\n"
+         "\tmov\t%rax, -16(%rbp)\n"
+         "\tlea\tlang_main(%rip), %rdi\n"
+         "\tcall\tlang_update\n";
+  for (int i = 0; i < calleeSaved; i++)
+    out << "\tlea\tlang_registers+" << 8 * i << "(%rip), %rax\n"
+        << "\tmov\t%rax, " << -56 + 8 * i << "(%rbp)\n";
+  out << "\t# Each frame, with the return address into it above the frame\n"
+         "\t# it called, in %r12\n"
+         ".Lcollect_frame:\n"
+         "\tmov\t8(%r12), %rdi\n"
+         "\tmov\t(%r12), %r12\n"
+         "\tcall\tlang_site\n"
+         "\ttest\t%rax, %rax\n"
+         "\tjz\t.Lcollect_remembered\n"
+         "\tmov\t%rax, %r13\n"
+         "\tmov\t8(%r13), %r14d\n"
+         "\tmov\t(%r14), %r15d\n"
+         "\txor\t%ebx, %ebx\n"
+         "1:\tbt\t%ebx, %r15d\n"
+         "\tjnc\t2f\n"
+         "\tmov\t-56(%rbp,%rbx,8), %rdi\n"
+         "\tcall\tlang_update\n"
+         "2:\tinc\t%ebx\n"
+      << "\tcmp\t$" << calleeSaved << ", %ebx\n"
+      << "\tjb\t1b\n"
+         "\tmov\t4(%r14), %ebx\n"
+         "\tadd\t$8, %r14\n"
+         "1:\ttest\t%ebx, %ebx\n"
+         "\tjz\t2f\n"
+         "\tmovslq\t(%r14), %rdi\n"
+         "\tadd\t%r12, %rdi\n"
+         "\tcall\tlang_update\n"
+         "\tadd\t$4, %r14\n"
+         "\tdec\t%ebx\n"
+         "\tjmp\t1b\n"
+         "2:\t# The registers the function saved are its caller's\n"
+         "\tmov\t12(%r13), %r14d\n"
+         "\tmov\t(%r14), %ebx\n"
+         "\tadd\t$4, %r14\n"
+         "1:\ttest\t%ebx, %ebx\n"
+         "\tjz\t.Lcollect_frame\n"
+         "\tmov\t(%r14), %eax\n"
+         "\tmovslq\t4(%r14), %rcx\n"
+         "\tadd\t%r12, %rcx\n"
+         "\tmov\t%rcx, -56(%rbp,%rax,8)\n"
+         "\tadd\t$8, %r14\n"
+         "\tdec\t%ebx\n"
+         "\tjmp\t1b\n"
+         "\t# The references of remembered objects, in a minor collection\n"
+         ".Lcollect_remembered:\n"
+         "\tmov\tlang_remembered(%rip), %r13\n"
+         "1:\tcmp\tlang_remembered_next(%rip), %r13\n"
+         "\tjae\t2f\n"
+         "\tmov\t(%r13), %edi\n"
+         "\tmov\t%rdi, %rax\n"
+         "\tsub\tlang_heap(%rip), %rax\n"
+         "\tshr\t$2, %rax\n"
+         "\tmov\tlang_remembered_bits(%rip), %rcx\n"
+         "\tbtr\t%rax, (%rcx)\n"
+         "\tcmpq\t$0, lang_major(%rip)\n"
+         "\tjne\t3f\n"
+         "\tcall\tlang_update_object\n"
+         "3:\tadd\t$4, %r13\n"
+         "\tjmp\t1b\n"
+         "2:\tmov\tlang_remembered(%rip), %rax\n"
+         "\tmov\t%rax, lang_remembered_next(%rip)\n"
+         "\t# The references of the objects copied, until none is left\n"
+         "\tmov\t-16(%rbp), %rbx\n"
+         "1:\tcmp\tlang_copy_next(%rip), %rbx\n"
+         "\tjae\t2f\n"
+         "\tmov\t%rbx, %rdi\n"
+         "\tcall\tlang_update_object\n"
+         "\tadd\t%rax, %rbx\n"
+         "\tjmp\t1b\n"
+         "2:\tmov\tlang_heap(%rip), %rdi\n"
+         "\tmov\tlang_heap_next(%rip), %rcx\n"
+         "\tsub\t%rdi, %rcx\n"
+         "\txor\t%eax, %eax\n"
+         "\trep stosb\n"
+         "\tmov\tlang_heap(%rip), %rax\n"
+         "\tmov\t%rax, lang_heap_next(%rip)\n"
+         "\tcmpq\t$0, lang_major(%rip)\n"
+         "\tje\t1f\n"
+         "\t# The old half is zero again once given back:\n"
+         "\t# madvise(halves[0], oldNext - halves[0], MADV_DONTNEED)\n"
+         "\tmov\tlang_halves(%rip), %rdi\n"
+         "\tmov\tlang_old_next(%rip), %rsi\n"
+         "\tsub\t%rdi, %rsi\n"
+         "\tmov\t$4, %edx\n"
+         "\tcall\tmadvise\n"
+         "\tmov\tlang_halves(%rip), %rax\n"
+         "\tmov\tlang_halves+8(%rip), %rcx\n"
+         "\tmov\t%rcx, lang_halves(%rip)\n"
+         "\tmov\t%rax, lang_halves+8(%rip)\n"
+         "\tmov\tlang_copy_next(%rip), %rax\n"
+         "\tsub\t%rcx, %rax\n"
+         "\tadd\t%rax, %rax\n"
+      << "\tmov\t$" << firstThreshold << ", %ecx\n"
+      << "\tcmp\t%rcx, %rax\n"
+         "\tcmovb\t%rcx, %rax\n"
+         "\tmov\t%rax, lang_threshold(%rip)\n"
+         "1:\tincq\tlang_collections(%rip)\n"
+         "\tmov\tlang_copy_next(%rip), %rax\n"
+         "\tmov\t%rax, lang_old_next(%rip)\n"
+         "\tadd\t-8(%rbp), %rax\n"
+         "\tmov\tlang_halves(%rip), %rcx\n"
+      << "\tadd\t$" << halfSize - nurserySize << ", %rcx\n"
+      << "\tcmp\t%rcx, %rax\n"
+         "\tsetbe\t%al\n"
+         "\tmovzbl\t%al, %eax\n"
+         "\tleave\n"
+         "\tret\n"
+         "\n"
+         "# Returns the entry of the site table for the return address in\n"
+         "# %rdi, or 0 if it is not that of a call of the program\n"
+         "lang_site:\n"
+         "\tlea\tlang_sites(%rip), %rsi\n"
+         "\tlea\tlang_sites_end(%rip), %rdx\n"
+         "1:\tcmp\t%rdx, %rsi\n"
+         "\tjae\t3f\n"
+         "\tmov\t%rdx, %rax\n"
+         "\tsub\t%rsi, %rax\n"
+         "\tshr\t$5, %rax\n"
+         "\tshl\t$4, %rax\n"
+         "\tadd\t%rsi, %rax\n"
+         "\tcmp\t(%rax), %rdi\n"
+         "\tje\t4f\n"
+         "\tjb\t2f\n"
+         "\tlea\t16(%rax), %rsi\n"
+         "\tjmp\t1b\n"
+         "2:\tmov\t%rax, %rdx\n"
+         "\tjmp\t1b\n"
+         "3:\txor\t%eax, %eax\n"
+         "4:\tret\n"
+         "\n"
+         "# Updates the references of the object at %rdi and returns its size\n"
+         "lang_update_object:\n"
+         "\tpush\t%rbx\n"
+         "\tpush\t%r12\n"
+         "\tpush\t%r13\n"
+         "\tmov\t%rdi, %rbx\n"
+         "\tmov\t(%rbx), %eax\n"
+         "\tmov\t12(%rax), %r12d\n"
+         "\tmov\t(%r12), %r13d\n"
+         "1:\ttest\t%r13d, %r13d\n"
+         "\tjz\t2f\n"
+         "\tadd\t$4, %r12\n"
+         "\tmov\t(%r12), %edi\n"
+         "\tadd\t%rbx, %rdi\n"
+         "\tcall\tlang_update\n"
+         "\tdec\t%r13d\n"
+         "\tjmp\t1b\n"
+         "2:\tmov\t(%rbx), %eax\n"
+         "\tmov\t8(%rax), %eax\n"
+         "\tpop\t%r13\n"
+         "\tpop\t%r12\n"
+         "\tpop\t%rbx\n"
+         "\tret\n"
+         "\n"
+         "# Points the reference at %rdi to where its object is after the\n"
+         "# collection, copying the object there if it has not been, as\n"
+         "# Heap::forward does, changing %rax, %rcx, %rdx, %rsi, %rdi, %r8\n"
+         "# and %r9\n"
+         "lang_update:\n"
+         "\tmov\t(%rdi), %eax\n"
+         "\ttest\t%eax, %eax\n"
+         "\tjz\t2f\n"
+         "\tcmp\tlang_nursery_end(%rip), %rax\n"
+         "\tjb\t1f\n"
+         "\tcmpq\t$0, lang_major(%rip)\n"
+         "\tje\t2f\n"
+         "\tmov\t%rax, %rcx\n"
+         "\tsub\tlang_halves+8(%rip), %rcx\n"
+      << "\tcmp\t$" << halfSize << ", %rcx\n"
+      << "\tjb\t2f\n"
+         "1:\tmov\t(%rax), %ecx\n"
+         "\ttest\t$1, %ecx\n"
+         "\tjz\t3f\n"
+         "\tand\t$-2, %ecx\n"
+         "\tmov\t%ecx, (%rdi)\n"
+         "2:\tret\n"
+         "3:\tmov\t%rdi, %rdx\n"
+         "\tmov\t%rax, %rsi\n"
+         "\tmov\t%rax, %r8\n"
+         "\tmov\tlang_copy_next(%rip), %rdi\n"
+         "\tmov\t%rdi, %r9\n"
+         "\tmov\t%edi, (%rdx)\n"
+         "\tmov\t8(%rcx), %ecx\n"
+         "\tlea\t(%rdi,%rcx), %rax\n"
+         "\tmov\t%rax, lang_copy_next(%rip)\n"
+         "\trep movsb\n"
+         "\tlea\t1(%r9), %rax\n"
+         "\tmov\t%eax, (%r8)\n"
+         "\tret\n"
+         "\n"
+         "# Reports the runtime error whose message is at %rdi and exits\n"
+         "lang_fail:\n"
+         "\tand\t$-16, %rsp\n"
+         "\tmov\t%rdi, %rbx\n"
+         "\txor\t%edi, %edi\n"
+         "\tcall\tfflush\n"
+         "\tmov\t%rbx, %rdx\n"
+         "\tmov\tstderr(%rip), %rdi\n"
+         "\tlea\t.Lfail_format(%rip), %rsi\n"
+         "\txor\t%eax, %eax\n"
+         "\tcall\tfprintf\n"
+         "\tmov\t$1, %edi\n"
+         "\tcall\texit\n";
+  for (size_t i = 0; i < sizeof(runtimeErrors) / sizeof(runtimeErrors[0]); i++)
+    out << runtimeErrors[i][0] << ":\n"
+        << "\tlea\t.Lerror" << i << "(%rip), %rdi\n"
+        << "\tjmp\tlang_fail\n";
+
+  out << "\n"
+         "\t.section\t.rodata\n"
+         ".Lprint_format:\n"
+         "\t.string\t\"%d\\n\"\n"
+         ".Lfail_format:\n"
+         "\t.string\t\"runtime error: %s\\n\"\n"
+         ".Lstress:\n"
+         "\t.string\t\"LANG_GC_STRESS\"\n";
+  for (size_t i = 0; i < sizeof(runtimeErrors) / sizeof(runtimeErrors[0]); i++)
+    out << ".Lerror" << i << ":\n"
+        << "\t.string\t\"" << runtimeErrors[i][1] << "\"\n";
+  out << "\n"
+         "\t.bss\n"
+         "\t.p2align\t3\n";
+  const char *globals[] = {"lang_stack_limit", "lang_main", "lang_heap", "lang_heap_next", "lang_heap_limit",
+                           "lang_nursery_end", "lang_old_next", "lang_threshold", "lang_copy_next", "lang_major",
+                           "lang_stress", "lang_collections", "lang_remembered", "lang_remembered_next",
+                           "lang_remembered_bits"};
+  for (size_t i = 0; i < sizeof(globals) / sizeof(globals[0]); i++)
+    out << globals[i] << ":\n"
+        << "\t.zero\t8\n";
+  out << "lang_halves:\n"
+         "\t.zero\t16\n"
+         "lang_registers:\n"
+      << "\t.zero\t" << 8 * calleeSaved << "\n";
+}
+
+// Writes the descriptor of every class: its number, the number of
+// its last subclass, the size of its objects, its map of references
+// and its method table. A map is the number of the members that hold
+// references and their offsets. Descriptors are data of the
+// executable, which is not position independent, so their addresses
+// fit in the header of an object.
+void generateClasses(std::ostream &out, const SymbolInterner &symbols, const Bytecode &bytecode) {
+  out << "\n"
+         "\t.section\t.rodata\n";
+  for (size_t i = 0; i < bytecode.classes.size(); i++) {
+    const ClassCode &code = bytecode.classes[i];
+    out << "\t.p2align\t3\n"
+        << "lang_class" << i << ":\t# " << symbols.name(code.name) << "\n"
+        << "\t.long\t" << i << ", " << code.lastSubclass << ", " << code.size << ", lang_references" << i << "\n";
+    for (size_t j = 0; j < code.methods.size(); j++)
+      out << "\t.quad\tlang_f" << code.methods[j] << "\n";
+    out << "lang_references" << i << ":\n"
+        << "\t.long\t" << code.references.size();
+    for (size_t j = 0; j < code.references.size(); j++)
+      out << ", " << code.references[j];
+    out << "\n";
+  }
+}
+
+// Defines the scratch registers the code uses for its own: %eax and
+// %ecx, and the registers arguments are passed in.
+const Location eax = {l_register, r_rax};
+const Location ecx = {l_register, r_rcx};
+const Location argumentLocations[] = {{l_register, r_rdi}, {l_register, r_rsi}, {l_register, r_rdx},
+                                      {l_register, r_rcx}, {l_register, r_r8},  {l_register, r_r9}};
+
+// Defines the function code is generated for: its IR and where its
+// values are, and where the entries of the site table and the stack
+// maps they point to are written.
+typedef struct generator {
+  std::ostream *out;
+  std::ostream *sites;
+  std::ostream *maps;
+  const Bytecode *bytecode;
+  const IrFunction *function;
+  Allocation allocation;
+} Generator;
+
+Location at(const Generator &generator, int value) {
+  return generator.allocation.locations[value];
+}
+
+// Writes the label of a block of a function.
+std::ostream &label(std::ostream &out, const Generator &generator, int block) {
+  return out << ".Lf" << generator.function->number << "_" << block;
+}
+
+// Writes a move of a value from one place to another, through %ecx
+// if both are in the frame.
+void move(std::ostream &out, const Location &from, const Location &to) {
+  if (from == to || to.kind == l_none)
+    return;
+  if (from.kind == l_frame && to.kind == l_frame) {
+    out << "\tmovl\t" << from << ", %ecx\n"
+        << "\tmovl\t%ecx, " << to << "\n";
+    return;
+  }
+  out << "\tmovl\t" << from << ", " << to << "\n";
+}
+
+// Defines a move of a value to a place.
+typedef struct move {
+  Location to;
+  Location from;
+} Move;
+
+// Writes moves that all happen at once, so that one may write where
+// another reads: each move is made once nothing is left to read
+// where it writes, and a cycle of moves is broken by keeping what
+// one of them overwrites in %eax.
+void parallelMove(std::ostream &out, std::vector<Move> &moves) {
+  for (size_t i = moves.size(); i-- > 0;)
+    if (moves[i].to == moves[i].from || moves[i].to.kind == l_none)
+      moves.erase(moves.begin() + i);
+  while (!moves.empty()) {
+    size_t i, j;
+    for (i = 0; i < moves.size(); i++) {
+      for (j = 0; j < moves.size(); j++)
+        if (j != i && moves[j].from == moves[i].to)
+          break;
+      if (j == moves.size())
+        break;
+    }
+    if (i == moves.size()) {
+      Location to = moves[0].to;
+      move(out, to, eax);
+      for (j = 0; j < moves.size(); j++)
+        if (moves[j].from == to)
+          moves[j].from = eax;
+      continue;
+    }
+    move(out, moves[i].from, moves[i].to);
+    moves.erase(moves.begin() + i);
+  }
+}
+
+// Writes the moves into the phis of the successor of a block.
+void generatePhiMoves(std::ostream &out, const Generator &generator, int block) {
+  const IrFunction &function = *generator.function;
+  int successor = function.blocks[block].successors[0];
+  const IrBlock &target = function.blocks[successor];
+  size_t from;
+  for (from = 0; target.predecessors[from] != block; from++)
+    ;
+  std::vector<Move> moves;
+  for (size_t i = 0; i < target.instructions.size(); i++) {
+    const IrInstruction &phi = function.instructions[target.instructions[i]];
+    if (phi.op != ir_phi)
+      break;
+    Move phiMove = {at(generator, target.instructions[i]), at(generator, phi.operands[from])};
+    moves.push_back(phiMove);
+  }
+  parallelMove(out, moves);
+}
+
+// Writes a binary operator on a and b into to, computing it in to
+// if it is a register b is not in, or else in %eax.
+void generateBinary(std::ostream &out, const char *operation, Location a, Location b, const Location &to,
+                    bool commutative) {
+  if (to.kind == l_none)
+    return;
+  if (commutative && to == b)
+    std::swap(a, b);
+  Location result = to.kind == l_register && to != b ? to : eax;
+  move(out, a, result);
+  out << "\t" << operation << "\t" << b << ", " << result << "\n";
+  move(out, result, to);
+}
+
+// Writes a comparison of a with b, setting the flags.
+void generateCompare(std::ostream &out, Location a, const Location &b) {
+  if (a.kind == l_constant || (a.kind == l_frame && b.kind == l_frame)) {
+    move(out, a, eax);
+    a = eax;
+  }
+  out << "\tcmpl\t" << b << ", " << a << "\n";
+}
+
+// Writes a test of a value for 0, setting the flags.
+void generateTest(std::ostream &out, const Location &value) {
+  if (value.kind == l_register)
+    out << "\ttestl\t" << value << ", " << value << "\n";
+  else
+    out << "\tcmpl\t$0, " << value << "\n";
+}
+
+// Writes a comparison of a with b into to.
+void generateComparison(std::ostream &out, const Location &a, const Location &b, const Location &to,
+                        const char *condition) {
+  if (to.kind == l_none)
+    return;
+  generateCompare(out, a, b);
+  out << "\tset" << condition << "\t%al\n";
+  if (to.kind == l_register) {
+    out << "\tmovzbl\t%al, " << to << "\n";
+    return;
+  }
+  out << "\tmovzbl\t%al, %eax\n";
+  move(out, eax, to);
+}
+
+// Writes a jump to the first block if the condition holds and to the
+// second if not, leaving out the one to the block laid out next.
+void generateBranch(std::ostream &out, const Generator &generator, int block, const char *condition,
+                    const char *inverse) {
+  const std::vector<int> &successors = generator.function->blocks[block].successors;
+  if (successors[0] == block + 1) {
+    out << "\tj" << inverse << "\t";
+    label(out, generator, successors[1]) << "\n";
+    return;
+  }
+  out << "\tj" << condition << "\t";
+  label(out, generator, successors[0]) << "\n";
+  if (successors[1] != block + 1) {
+    out << "\tjmp\t";
+    label(out, generator, successors[1]) << "\n";
+  }
+}
+
+// Returns the 64 bit register an object is in, loading it into %rax
+// if it is elsewhere, after checking that it is not none.
+int generateObject(std::ostream &out, const Location &object, const char *failure) {
+  int reg = r_rax;
+  if (object.kind == l_register)
+    reg = object.value;
+  else
+    move(out, object, eax);
+  out << "\ttestl\t" << registerName(reg) << ", " << registerName(reg) << "\n"
+      << "\tjz\t" << failure << "\n";
+  return reg;
+}
+
+// Writes the label of the return address of a call or a new, and
+// its entry in the site table: the address, its stack map and the
+// registers its function saves. A map is a bit for each
+// callee-saved register that holds a reference live after the call,
+// the number of the slots of the frame that do, and their offsets.
+void generateSite(std::ostream &out, const Generator &generator, int value) {
+  int number = generator.function->number;
+  out << ".Ls" << number << "_" << value << ":\n";
+  *generator.sites << "\t.quad\t.Ls" << number << "_" << value << "\n"
+                   << "\t.long\t.Lm" << number << "_" << value << ", lang_saves" << number << "\n";
+
+  int mask = 0;
+  std::vector<int> slots;
+  const std::vector<int> &live = generator.allocation.liveAfter.at(value);
+  for (size_t i = 0; i < live.size(); i++) {
+    if (generator.function->instructions[live[i]].type != bt_object)
+      continue;
+    Location location = at(generator, live[i]);
+    if (location.kind == l_register)
+      mask |= 1 << (location.value - firstCalleeSaved);
+    else if (location.kind == l_frame)
+      slots.push_back(location.value);
+  }
+  std::ostream &maps = *generator.maps;
+  maps << ".Lm" << number << "_" << value << ":\n"
+       << "\t.long\t" << mask << ", " << slots.size();
+  for (size_t i = 0; i < slots.size(); i++)
+    maps << ", " << slots[i];
+  maps << "\n";
+}
+
+// Writes a call of a function or a method, passing its operands,
+// the first six in registers and the rest on the stack, as the ABI
+// has them.
+void generateCall(std::ostream &out, const Generator &generator, int value) {
+  const IrInstruction &instruction = generator.function->instructions[value];
+  int count = instruction.operands.size();
+  int stacked = count > 6 ? count - 6 : 0;
+  // The stack is kept aligned to 16 bytes at every call
+  int padding = stacked % 2 ? 8 : 0;
+  if (padding)
+    out << "\tsub\t$8, %rsp\n";
+  for (int i = count - 1; i >= 6; i--) {
+    Location argument = at(generator, instruction.operands[i]);
+    if (argument.kind == l_register) {
+      out << "\tpush\t" << wideRegisterName(argument.value) << "\n";
+    } else if (argument.kind == l_constant) {
+      out << "\tpush\t" << argument << "\n";
+    } else {
+      move(out, argument, eax);
+      out << "\tpush\t%rax\n";
+    }
+  }
+  std::vector<Move> moves;
+  for (int i = 0; i < count && i < 6; i++) {
+    Move argument = {argumentLocations[i], at(generator, instruction.operands[i])};
+    moves.push_back(argument);
+  }
+  parallelMove(out, moves);
+  if (instruction.op != ir_call)
+    out << "\ttestl\t%edi, %edi\n"
+           "\tjz\tlang_none_called\n";
+  if (instruction.op == ir_callMethod)
+    out << "\tmovl\t(%rdi), %eax\n"
+        << "\tcall\t*" << 16 + 8 * instruction.immediate << "(%rax)\n";
+  else
+    out << "\tcall\tlang_f" << instruction.immediate << "\n";
+  generateSite(out, generator, value);
+  if (stacked)
+    out << "\tadd\t$" << 8 * stacked + padding << ", %rsp\n";
+  move(out, eax, at(generator, value));
+}
+
+// Writes the return from a function, restoring the registers it saved.
+void generateReturn(std::ostream &out, const Generator &generator) {
+  for (size_t i = 0; i < generator.allocation.saved.size(); i++)
+    out << "\tmov\t" << generator.allocation.savedAt[i] << "(%rbp), "
+        << wideRegisterName(generator.allocation.saved[i]) << "\n";
+  out << "\tleave\n"
+         "\tret\n";
+}
+
+void generateInstruction(std::ostream &out, const Generator &generator, int block, int value) {
+  const IrInstruction &instruction = generator.function->instructions[value];
+  Location to = at(generator, value);
+  Location a = {l_none, 0}, b = {l_none, 0};
+  if (instruction.operands.size() > 0 && instruction.op != ir_phi)
+    a = at(generator, instruction.operands[0]);
+  if (instruction.operands.size() > 1 && instruction.op != ir_phi)
+    b = at(generator, instruction.operands[1]);
+  switch (instruction.op) {
+    case ir_add:
+      generateBinary(out, "addl", a, b, to, true);
+      break;
+    case ir_subtract:
+      generateBinary(out, "subl", a, b, to, false);
+      break;
+    case ir_multiply:
+      generateBinary(out, "imull", a, b, to, true);
+      break;
+    case ir_and:
+      generateBinary(out, "andl", a, b, to, true);
+      break;
+    case ir_or:
+      generateBinary(out, "orl", a, b, to, true);
+      break;
+    case ir_divide:
+      // idiv faults on the one quotient that does not fit, which
+      // wraps around instead
+      move(out, b, ecx);
+      out << "\ttestl\t%ecx, %ecx\n"
+             "\tjz\tlang_division_by_zero\n";
+      move(out, a, eax);
+      out << "\tcmpl\t$-1, %ecx\n"
+             "\tjne\t1f\n"
+             "\tnegl\t%eax\n"
+             "\tjmp\t2f\n"
+             "1:\tcltd\n"
+             "\tidivl\t%ecx\n"
+             "2:\n";
+      move(out, eax, to);
+      break;
+    case ir_less:
+      generateComparison(out, a, b, to, "l");
+      break;
+    case ir_lessEqual:
+      generateComparison(out, a, b, to, "le");
+      break;
+    case ir_equal:
+      generateComparison(out, a, b, to, "e");
+      break;
+    case ir_not:
+    case ir_negate: {
+      if (to.kind == l_none)
+        break;
+      Location result = to.kind == l_register ? to : eax;
+      move(out, a, result);
+      if (instruction.op == ir_not)
+        out << "\txorl\t$1, " << result << "\n";
+      else
+        out << "\tnegl\t" << result << "\n";
+      move(out, result, to);
+      break;
+    }
+    case ir_getField: {
+      int object = generateObject(out, a, "lang_none_accessed");
+      if (to.kind == l_none)
+        break;
+      Location result = to.kind == l_register ? to : eax;
+      out << (instruction.type == bt_boolean ? "\tmovzbl\t" : "\tmovl\t") << instruction.immediate << "("
+          << wideRegisterName(object) << "), " << result << "\n";
+      move(out, result, to);
+      break;
+    }
+    case ir_setField: {
+      int object = generateObject(out, a, "lang_none_assigned");
+      if (generator.function->instructions[instruction.operands[1]].type == bt_boolean) {
+        // The byte of the value is stored from %cl, or as a constant
+        if (b.kind != l_constant)
+          move(out, b, ecx);
+        out << "\tmovb\t";
+        if (b.kind == l_constant)
+          out << b;
+        else
+          out << "%cl";
+        out << ", " << instruction.immediate << "(" << wideRegisterName(object) << ")\n";
+        break;
+      }
+      if (b.kind == l_frame) {
+        move(out, b, ecx);
+        b = ecx;
+      }
+      out << "\tmovl\t" << b << ", " << instruction.immediate << "(" << wideRegisterName(object) << ")\n";
+      // An old object given a young one is remembered
+      if (b.kind == l_constant || generator.function->instructions[instruction.operands[1]].type != bt_object)
+        break;
+      out << "\tcmp\tlang_nursery_end(%rip), " << wideRegisterName(object) << "\n"
+          << "\tjb\t1f\n";
+      move(out, b, ecx);
+      out << "\tsub\tlang_heap(%rip), %rcx\n"
+          << "\tcmp\t$" << nurserySize << ", %rcx\n"
+          << "\tjae\t1f\n";
+      if (object != r_rax)
+        out << "\tmov\t" << wideRegisterName(object) << ", %rax\n";
+      out << "\tcall\tlang_remember\n"
+             "1:\n";
+      break;
+    }
+    case ir_checkClass:
+      move(out, a, eax);
+      out << "\ttestl\t%eax, %eax\n"
+             "\tjz\t1f\n"
+             "\tmovl\t(%rax), %eax\n"
+             "\tmovl\t(%rax), %eax\n"
+          << "\tcmpl\t$" << instruction.immediate << ", %eax\n"
+          << "\tjl\tlang_class_mismatch\n"
+          << "\tcmpl\t$" << generator.bytecode->classes[instruction.immediate].lastSubclass << ", %eax\n"
+          << "\tjg\tlang_class_mismatch\n"
+             "1:\n";
+      break;
+    case ir_checkObject:
+      if (a.kind == l_constant) {
+        if (!a.value)
+          out << "\tjmp\tlang_none_called\n";
+        break;
+      }
+      generateTest(out, a);
+      out << "\tjz\tlang_none_called\n";
+      break;
+    case ir_new:
+      out << "\tmovl\t$lang_class" << instruction.immediate << ", %edi\n"
+          << "\tcall\tlang_new\n";
+      generateSite(out, generator, value);
+      move(out, eax, to);
+      break;
+    case ir_call:
+    case ir_callDirect:
+    case ir_callMethod:
+      generateCall(out, generator, value);
+      break;
+    case ir_print:
+      move(out, a, argumentLocations[0]);
+      out << "\tcall\tlang_print\n";
+      break;
+    case ir_jump:
+      generatePhiMoves(out, generator, block);
+      if (generator.function->blocks[block].successors[0] != block + 1) {
+        out << "\tjmp\t";
+        label(out, generator, generator.function->blocks[block].successors[0]) << "\n";
+      }
+      break;
+    case ir_branch:
+      if (a.kind == l_constant) {
+        int successor = generator.function->blocks[block].successors[a.value ? 0 : 1];
+        if (successor != block + 1) {
+          out << "\tjmp\t";
+          label(out, generator, successor) << "\n";
+        }
+        break;
+      }
+      generateTest(out, a);
+      generateBranch(out, generator, block, "nz", "z");
+      break;
+    case ir_branchLess:
+      generateCompare(out, a, b);
+      generateBranch(out, generator, block, "l", "ge");
+      break;
+    case ir_branchLessEqual:
+      generateCompare(out, a, b);
+      generateBranch(out, generator, block, "le", "g");
+      break;
+    case ir_branchEqual:
+      generateCompare(out, a, b);
+      generateBranch(out, generator, block, "e", "ne");
+      break;
+    case ir_return:
+      move(out, a, eax);
+      generateReturn(out, generator);
+      break;
+    case ir_returnNone:
+      generateReturn(out, generator);
+      break;
+    default:
+      // Parameters, constants and phis are where they are put
+      break;
+  }
+}
+
+void generateFunction(std::ostream &out, std::ostream &sites, std::ostream &maps, const SymbolInterner &symbols,
+                      const Bytecode &bytecode, const IrFunction &function) {
+  const Function &code = bytecode.functions[function.number];
+  Generator generator;
+  generator.out = &out;
+  generator.sites = &sites;
+  generator.maps = &maps;
+  generator.bytecode = &bytecode;
+  generator.function = &function;
+  allocateRegisters(code, function, generator.allocation);
+  const Allocation &allocation = generator.allocation;
+
+  out << "\n"
+         "\t.p2align\t4\n"
+      << "lang_f" << function.number << ":\t# " << symbols.name(code.className) << "."
+      << symbols.name(code.name) << "\n"
+      << "\tpush\t%rbp\n"
+         "\tmov\t%rsp, %rbp\n";
+  if (allocation.frameSize)
+    out << "\tsub\t$" << allocation.frameSize << ", %rsp\n";
+  maps << "lang_saves" << function.number << ":\n"
+       << "\t.long\t" << allocation.saved.size();
+  for (size_t i = 0; i < allocation.saved.size(); i++)
+    maps << ", " << allocation.saved[i] - firstCalleeSaved << ", " << allocation.savedAt[i];
+  maps << "\n";
+  out << "\tcmp\tlang_stack_limit(%rip), %rsp\n"
+         "\tjb\tlang_stack_overflow\n";
+  for (size_t i = 0; i < allocation.saved.size(); i++)
+    out << "\tmov\t" << wideRegisterName(allocation.saved[i]) << ", " << allocation.savedAt[i] << "(%rbp)\n";
+
+  // The object and the first five parameters arrive in registers,
+  // which may be where others go, and the rest on the stack
+  std::vector<Move> moves;
+  std::vector<int> stacked;
+  const std::vector<int> &entry = function.blocks[0].instructions;
+  for (size_t i = 0; i < entry.size(); i++) {
+    const IrInstruction &instruction = function.instructions[entry[i]];
+    if (instruction.op != ir_parameter)
+      continue;
+    if (instruction.immediate >= 6) {
+      stacked.push_back(entry[i]);
+      continue;
+    }
+    Move parameter = {at(generator, entry[i]), argumentLocations[instruction.immediate]};
+    moves.push_back(parameter);
+  }
+  parallelMove(out, moves);
+  for (size_t i = 0; i < stacked.size(); i++) {
+    Location argument = {l_frame, 16 + 8 * (function.instructions[stacked[i]].immediate - 6)};
+    move(out, argument, at(generator, stacked[i]));
+  }
+
+  for (size_t b = 0; b < function.blocks.size(); b++) {
+    label(out, generator, b) << ":\n";
+    const std::vector<int> &instructions = function.blocks[b].instructions;
+    for (size_t i = 0; i < instructions.size(); i++)
+      generateInstruction(out, generator, b, instructions[i]);
+  }
+}
+
+void generate(std::ostream &out, const SymbolInterner &symbols, const Bytecode &bytecode,
+              const std::vector<IrFunction> &functions) {
+  generateRuntime(out, bytecode);
+  out << "\n"
+         "\t.text\n";
+  // Sites are written in the order of their addresses, so that the
+  // table is sorted for lang_site to search
+  std::ostringstream sites, maps;
+  for (size_t i = 0; i < functions.size(); i++)
+    generateFunction(out, sites, maps, symbols, bytecode, functions[i]);
+  generateClasses(out, symbols, bytecode);
+  out << "\t.p2align\t3\n"
+         "lang_sites:\n"
+      << sites.str() << "lang_sites_end:\n"
+      << maps.str();
+  out << "\n"
+         "\t.section\t.note.GNU-stack,\"\",@progbits\n";
+}
+
+bool assemble(const std::string &assembly, const char *path, std::string &error) {
+  const char *compiler = getenv("CC");
+  if (!compiler || !*compiler)
+    compiler = "cc";
+
+  int input[2];
+  if (pipe(input)) {
+    error = std::string("cannot run ") + compiler + ": " + strerror(errno);
+    return false;
+  }
+  pid_t child = fork();
+  if (child < 0) {
+    error = std::string("cannot run ") + compiler + ": " + strerror(errno);
+    close(input[0]);
+    close(input[1]);
+    return false;
+  }
+  if (!child) {
+    dup2(input[0], 0);
+    close(input[0]);
+    close(input[1]);
+    execlp(compiler, compiler, "-no-pie", "-o", path, "-x", "assembler", "-", (char *) NULL);
+    _exit(127);
+  }
+  close(input[0]);
+  // A compiler that gives up early must not take lang down with it
+  void (*handler)(int) = signal(SIGPIPE, SIG_IGN);
+  const char *text = assembly.data();
+  size_t left = assembly.size();
+  while (left) {
+    ssize_t written = write(input[1], text, left);
+    if (written <= 0)
+      break;
+    text += written;
+    left -= written;
+  }
+  close(input[1]);
+  signal(SIGPIPE, handler);
+
+  int status;
+  if (waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) {
+    error = std::string("cannot assemble ") + path + " with " + compiler;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,45 @@
+#ifndef __CODEGEN_HPP
+#define __CODEGEN_HPP
+
+#include "bytecode.hpp"
+#include "ir.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Writes a lowered program as x86-64 assembly for the System V ABI,
+// in the syntax of the GNU assembler, from the IR of its functions,
+// along with the runtime it needs: the C main, which sets up the
+// heap and runs Main.main, and the routines behind print, new and
+// runtime errors, which call the C library. Link the result with
+// the C library and -no-pie.
+//
+// The values of every function are given registers by linear scan,
+// and those it spills are kept in its stack frame, 4 bytes each: a
+// local or parameter at its own slot, the locals at the offsets the
+// type checker gave them, -4 and down, so that they take localsSize
+// bytes right below the frame pointer, then the object the method
+// runs on and the parameters, then the other values. The object and
+// the parameters arrive in registers and on the stack as the ABI
+// has them.
+//
+// Objects are allocated from a heap mapped in the low 2GB of the
+// address space, so that a reference is a 32 bit pointer and takes
+// the 4 bytes the type checker gives every variable and member.
+// The first word of an object points to its class's descriptor:
+// the number of the class, the number of its last subclass, the
+// size of its objects, the offsets of its references, and its
+// method table. The heap is collected as the VM's is, by a
+// generational copying collector, which finds the references of
+// every frame with the stack map written for each call and new,
+// and LANG_GC_STRESS stresses it as it does the VM's.
+void generate(std::ostream &out, const SymbolInterner &symbols, const Bytecode &bytecode,
+              const std::vector<IrFunction> &functions);
+
+// Assembles and links assembly written by generate into the
+// executable at path with the system's C compiler, cc or $CC.
+// Returns false, with the reason in error, if that failed.
+bool assemble(const std::string &assembly, const char *path, std::string &error);
+
+#endif
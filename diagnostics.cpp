@@ -0,0 +1,40 @@
+#include "diagnostics.hpp"
+
+Diagnostics::Diagnostics() {
+  maxErrors = 0;
+  dropped = 0;
+}
+
+void Diagnostics::error(const std::string &message, ASTNode *node, int line, const std::string &where) {
+  if (full()) {
+    dropped++;
+    return;
+  }
+  Diagnostic diagnostic = {
+      message,
+      node,
+      line,
+      where
+  };
+  errors.push_back(diagnostic);
+}
+
+bool Diagnostics::hasErrors() const {
+  return !errors.empty();
+}
+
+bool Diagnostics::full() const {
+  return maxErrors > 0 && (int) errors.size() >= maxErrors;
+}
+
+void Diagnostics::print(std::ostream &out, const std::string &prefix) const {
+  for (std::vector<Diagnostic>::const_iterator it = errors.begin(); it != errors.end(); it++) {
+    out << prefix;
+    if (!it->where.empty())
+      out << it->where << ": ";
+    out << it->message << "\n";
+  }
+  if (dropped > 0)
+    out << prefix << "and " << dropped << (dropped == 1 ? " more error" : " more errors") << "\n";
+  out.flush();
+}
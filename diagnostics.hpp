@@ -0,0 +1,46 @@
+#ifndef __DIAGNOSTICS_HPP
+#define __DIAGNOSTICS_HPP
+
+#include "ast.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Defines a single reported error. Type errors keep the AST node
+// they were reported against, and where it is: the class, and the
+// method if it is in one, as Class.method. Syntax errors have no
+// node, only the line the scanner was on, which their message
+// gives.
+typedef struct diagnostic {
+  std::string message;
+  ASTNode *node;
+  int line;
+  std::string where;
+} Diagnostic;
+
+// Collects every error of one compilation, so that scanning,
+// parsing and type checking can carry on after the first one
+// instead of exiting. Once maxErrors errors have been recorded
+// (0 means no limit) any further errors are only counted.
+class Diagnostics {
+public:
+  std::vector<Diagnostic> errors;
+  int maxErrors;
+  int dropped;
+
+  Diagnostics();
+
+  void error(const std::string &message, ASTNode *node, int line, const std::string &where = "");
+  bool hasErrors() const;
+  bool full() const;
+
+  // Prints the recorded errors, one per line, in the order
+  // they were reported, each after where it is, then how many
+  // more there were if the cap dropped any. Each line starts with
+  // prefix, which the driver sets to the file name when checking
+  // named files.
+  void print(std::ostream &out, const std::string &prefix = "") const;
+};
+
+#endif
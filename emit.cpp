@@ -0,0 +1,564 @@
+#include "emit.hpp"
+
+#include <algorithm>
+#include <vector>
+
+bool formatNamed(const char *name, Format &format) {
+  if (!strcmp(name, "text"))
+    format = f_text;
+  else if (!strcmp(name, "json"))
+    format = f_json;
+  else if (!strcmp(name, "binary"))
+    format = f_binary;
+  else
+    return false;
+  return true;
+}
+
+Emitter::Emitter(std::ostream &out) {
+  this->out = &out;
+  this->buffer = new char[capacity];
+  this->used = 0;
+}
+
+Emitter::~Emitter() {
+  flush();
+  delete[] buffer;
+}
+
+void Emitter::drain() {
+  out->write(buffer, used);
+  used = 0;
+}
+
+void Emitter::flush() {
+  drain();
+  out->flush();
+}
+
+Emitter &Emitter::operator<<(long number) {
+  char digits[24];
+  char *end = digits + sizeof(digits);
+  char *start = end;
+  unsigned long magnitude = number < 0 ? -(unsigned long) number : number;
+  do {
+    *--start = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude);
+  if (number < 0)
+    *--start = '-';
+  write(start, end - start);
+  return *this;
+}
+
+void Emitter::indent(int count) {
+  static const char spaces[] = "                                ";
+  while (count > 0) {
+    int length = std::min(count, (int) sizeof(spaces) - 1);
+    write(spaces, length);
+    count -= length;
+  }
+}
+
+void Emitter::word(unsigned int word) {
+  char bytes[4] = {
+      (char) (word & 0xff),
+      (char) ((word >> 8) & 0xff),
+      (char) ((word >> 16) & 0xff),
+      (char) ((word >> 24) & 0xff)
+  };
+  write(bytes, 4);
+}
+
+// Orders table entries by the name of their symbol, which is the
+// order std::map kept the tables in.
+struct NameOrder {
+  const SymbolInterner &symbols;
+
+  NameOrder(const SymbolInterner &symbols) : symbols(symbols) {}
+
+  template <typename Entry>
+  bool operator()(const Entry *a, const Entry *b) const {
+    return symbols.name(a->first) < symbols.name(b->first);
+  }
+};
+
+// Orders member layout entries by offset
+bool offsetOrder(const MemberLayout::Entry *a, const MemberLayout::Entry *b) {
+  return a->second.info.offset < b->second.info.offset;
+}
+
+// Orders method layout entries by virtual table slot
+bool slotOrder(const MethodLayout::Entry *a, const MethodLayout::Entry *b) {
+  return a->second.slot < b->second.slot;
+}
+
+// Returns the entries of a table sorted by name. The tables are
+// hash tables, so this is only done when printing.
+template <typename T>
+std::vector<const typename SymbolMap<T>::Entry *> sorted(const SymbolMap<T> &table, const SymbolInterner &symbols) {
+  std::vector<const typename SymbolMap<T>::Entry *> entries;
+  entries.reserve(table.size());
+  for (typename SymbolMap<T>::const_iterator it = table.begin(); it != table.end(); ++it)
+    entries.push_back(&*it);
+  std::sort(entries.begin(), entries.end(), NameOrder(symbols));
+  return entries;
+}
+
+// Returns the entries of a layout in the order of the objects and
+// virtual tables they lay out.
+template <typename T, typename Order>
+std::vector<const typename SymbolMap<T>::Entry *> sorted(const SymbolMap<T> &table, Order order) {
+  std::vector<const typename SymbolMap<T>::Entry *> entries;
+  entries.reserve(table.size());
+  for (typename SymbolMap<T>::const_iterator it = table.begin(); it != table.end(); ++it)
+    entries.push_back(&*it);
+  std::sort(entries.begin(), entries.end(), order);
+  return entries;
+}
+
+// The text format
+
+void emitType(Emitter &emitter, const SymbolInterner &symbols, TypeId type) {
+  switch (baseTypeOf(type)) {
+    case bt_integer:
+      emitter << "Integer";
+      break;
+    case bt_boolean:
+      emitter << "Boolean";
+      break;
+    case bt_none:
+      emitter << "None";
+      break;
+    case bt_object:
+      emitter << "Object(" << symbols.name(classNameOf(type)) << ")";
+      break;
+    default:
+      break;
+  }
+}
+
+void emitText(Emitter &emitter, const SymbolInterner &symbols, const VariableTable &variableTable, int indent) {
+  emitter.indent(indent);
+  emitter << "VariableTable {";
+  if (variableTable.size() == 0) {
+    emitter << "}";
+    return;
+  }
+  emitter << "\n";
+  std::vector<const VariableTable::Entry *> entries = sorted(variableTable, symbols);
+  for (size_t i = 0; i < entries.size(); i++) {
+    const VariableInfo &info = entries[i]->second;
+    emitter.indent(indent + 2);
+    emitter << symbols.name(entries[i]->first) << " -> {";
+    emitType(emitter, symbols, info.type);
+    emitter << ", " << (long) info.offset << ", " << (long) info.size << "}";
+    if (i != entries.size() - 1)
+      emitter << ",";
+    emitter << "\n";
+  }
+  emitter.indent(indent);
+  emitter << "}";
+}
+
+void emitText(Emitter &emitter, const SymbolInterner &symbols, const MethodTable &methodTable, int indent) {
+  emitter.indent(indent);
+  emitter << "MethodTable {";
+  if (methodTable.size() == 0) {
+    emitter << "}";
+    return;
+  }
+  emitter << "\n";
+  std::vector<const MethodTable::Entry *> entries = sorted(methodTable, symbols);
+  for (size_t i = 0; i < entries.size(); i++) {
+    const MethodInfo &info = entries[i]->second;
+    emitter.indent(indent + 2);
+    emitter << symbols.name(entries[i]->first) << " -> {\n";
+    emitter.indent(indent + 4);
+    emitType(emitter, symbols, info.returnType);
+    emitter << ",\n";
+    emitter.indent(indent + 4);
+    emitter << (long) info.localsSize << ",\n";
+    emitText(emitter, symbols, *info.variables, indent + 4);
+    emitter << "\n";
+    emitter.indent(indent + 2);
+    emitter << "}";
+    if (i != entries.size() - 1)
+      emitter << ",";
+    emitter << "\n";
+  }
+  emitter.indent(indent);
+  emitter << "}";
+}
+
+void emitText(Emitter &emitter, const SymbolInterner &symbols, const MemberLayout &memberLayout, int indent) {
+  emitter.indent(indent);
+  emitter << "MemberLayout {";
+  if (memberLayout.size() == 0) {
+    emitter << "}";
+    return;
+  }
+  emitter << "\n";
+  std::vector<const MemberLayout::Entry *> entries = sorted(memberLayout, offsetOrder);
+  for (size_t i = 0; i < entries.size(); i++) {
+    const MemberSlot &slot = entries[i]->second;
+    emitter.indent(indent + 2);
+    emitter << symbols.name(entries[i]->first) << " -> {";
+    emitType(emitter, symbols, slot.info.type);
+    emitter << ", " << (long) slot.info.offset << ", " << (long) slot.info.size;
+    emitter << ", " << symbols.name(slot.owner) << "}";
+    if (i != entries.size() - 1)
+      emitter << ",";
+    emitter << "\n";
+  }
+  emitter.indent(indent);
+  emitter << "}";
+}
+
+void emitText(Emitter &emitter, const SymbolInterner &symbols, const MethodLayout &methodLayout, int indent) {
+  emitter.indent(indent);
+  emitter << "VirtualTable {";
+  if (methodLayout.size() == 0) {
+    emitter << "}";
+    return;
+  }
+  emitter << "\n";
+  std::vector<const MethodLayout::Entry *> entries = sorted(methodLayout, slotOrder);
+  for (size_t i = 0; i < entries.size(); i++) {
+    emitter.indent(indent + 2);
+    emitter << (long) entries[i]->second.slot << " -> ";
+    emitter << symbols.name(entries[i]->second.owner) << "." << symbols.name(entries[i]->first);
+    if (i != entries.size() - 1)
+      emitter << ",";
+    emitter << "\n";
+  }
+  emitter.indent(indent);
+  emitter << "}";
+}
+
+void emitText(Emitter &emitter, const SymbolInterner &symbols, const ClassTable &classTable, int indent, bool layouts) {
+  emitter.indent(indent);
+  emitter << "ClassTable {\n";
+  std::vector<const ClassTable::Entry *> entries = sorted(classTable, symbols);
+  for (size_t i = 0; i < entries.size(); i++) {
+    const ClassInfo &info = entries[i]->second;
+    emitter.indent(indent + 2);
+    emitter << symbols.name(entries[i]->first) << " -> {\n";
+    if (info.superClassName != noSymbol) {
+      emitter.indent(indent + 4);
+      emitter << symbols.name(info.superClassName) << ",\n";
+    }
+    emitText(emitter, symbols, *info.members, indent + 4);
+    emitter << ",\n";
+    emitText(emitter, symbols, *info.methods, indent + 4);
+    if (layouts) {
+      emitter << ",\n";
+      emitter.indent(indent + 4);
+      emitter << "Layout {\n";
+      emitter.indent(indent + 6);
+      emitter << (long) info.membersSize << ",\n";
+      emitText(emitter, symbols, *info.memberLayout, indent + 6);
+      emitter << ",\n";
+      emitText(emitter, symbols, *info.methodLayout, indent + 6);
+      emitter << "\n";
+      emitter.indent(indent + 4);
+      emitter << "}";
+    }
+    emitter << "\n";
+    emitter.indent(indent + 2);
+    emitter << "}";
+    if (i != entries.size() - 1)
+      emitter << ",";
+    emitter << "\n";
+  }
+  emitter.indent(indent);
+  emitter << "}\n";
+}
+
+// The JSON format. Tables are arrays of objects sorted the same
+// way as in the text format. Names are identifiers, which need no
+// escaping. Unlike in the text format, the members of a class have
+// the offsets and sizes they take in an object.
+
+void emitJSONType(Emitter &emitter, const SymbolInterner &symbols, const char *key, TypeId type) {
+  static const char *names[] = {"integer", "boolean", "none", "object", "error"};
+  emitter << "\"" << key << "\": \"" << names[baseTypeOf(type)] << "\"";
+  if (baseTypeOf(type) == bt_object)
+    emitter << ", \"" << key << "Class\": \"" << symbols.name(classNameOf(type)) << "\"";
+}
+
+// Returns where a variable is: for a member of a class, given its
+// layout, the offset and size it has in an object, and otherwise
+// the variable info itself.
+const VariableInfo &placed(const VariableTable::Entry *entry, const MemberLayout *layout) {
+  return layout ? layout->at(entry->first).info : entry->second;
+}
+
+void emitJSON(Emitter &emitter, const SymbolInterner &symbols, const VariableTable &variableTable,
+              const MemberLayout *layout = NULL) {
+  emitter << "[";
+  std::vector<const VariableTable::Entry *> entries = sorted(variableTable, symbols);
+  for (size_t i = 0; i < entries.size(); i++) {
+    const VariableInfo &info = placed(entries[i], layout);
+    if (i != 0)
+      emitter << ", ";
+    emitter << "{\"name\": \"" << symbols.name(entries[i]->first) << "\", ";
+    emitJSONType(emitter, symbols, "type", info.type);
+    emitter << ", \"offset\": " << (long) info.offset << ", \"size\": " << (long) info.size << "}";
+  }
+  emitter << "]";
+}
+
+void emitJSON(Emitter &emitter, const SymbolInterner &symbols, const MethodTable &methodTable) {
+  emitter << "[";
+  std::vector<const MethodTable::Entry *> entries = sorted(methodTable, symbols);
+  for (size_t i = 0; i < entries.size(); i++) {
+    const MethodInfo &info = entries[i]->second;
+    if (i != 0)
+      emitter << ",";
+    emitter << "\n      {\"name\": \"" << symbols.name(entries[i]->first) << "\", ";
+    emitJSONType(emitter, symbols, "returns", info.returnType);
+    emitter << ", \"localsSize\": " << (long) info.localsSize << ", \"parameters\": [";
+    for (std::list<TypeId>::const_iterator it = info.parameters->begin(); it != info.parameters->end(); ++it) {
+      if (it != info.parameters->begin())
+        emitter << ", ";
+      emitter << "{";
+      emitJSONType(emitter, symbols, "type", *it);
+      emitter << "}";
+    }
+    emitter << "], \"variables\": ";
+    emitJSON(emitter, symbols, *info.variables);
+    emitter << "}";
+  }
+  emitter << "]";
+}
+
+void emitJSONLayout(Emitter &emitter, const SymbolInterner &symbols, const ClassInfo &info) {
+  emitter << "{\"size\": " << (long) info.membersSize << ", \"members\": [";
+  std::vector<const MemberLayout::Entry *> members = sorted(*info.memberLayout, offsetOrder);
+  for (size_t i = 0; i < members.size(); i++) {
+    const MemberSlot &slot = members[i]->second;
+    if (i != 0)
+      emitter << ", ";
+    emitter << "{\"name\": \"" << symbols.name(members[i]->first) << "\", ";
+    emitJSONType(emitter, symbols, "type", slot.info.type);
+    emitter << ", \"offset\": " << (long) slot.info.offset << ", \"size\": " << (long) slot.info.size;
+    emitter << ", \"owner\": \"" << symbols.name(slot.owner) << "\"}";
+  }
+  emitter << "], \"virtualTable\": [";
+  std::vector<const MethodLayout::Entry *> methods = sorted(*info.methodLayout, slotOrder);
+  for (size_t i = 0; i < methods.size(); i++) {
+    if (i != 0)
+      emitter << ", ";
+    emitter << "{\"slot\": " << (long) methods[i]->second.slot;
+    emitter << ", \"name\": \"" << symbols.name(methods[i]->first) << "\"";
+    emitter << ", \"owner\": \"" << symbols.name(methods[i]->second.owner) << "\"}";
+  }
+  emitter << "]}";
+}
+
+void emitJSON(Emitter &emitter, const SymbolInterner &symbols, const ClassTable &classTable, bool layouts) {
+  emitter << "{\"classes\": [";
+  std::vector<const ClassTable::Entry *> entries = sorted(classTable, symbols);
+  for (size_t i = 0; i < entries.size(); i++) {
+    const ClassInfo &info = entries[i]->second;
+    if (i != 0)
+      emitter << ",";
+    emitter << "\n  {\"name\": \"" << symbols.name(entries[i]->first) << "\",";
+    if (info.superClassName != noSymbol)
+      emitter << " \"super\": \"" << symbols.name(info.superClassName) << "\",";
+    emitter << "\n    \"members\": ";
+    emitJSON(emitter, symbols, *info.members, info.memberLayout);
+    emitter << ",\n    \"methods\": ";
+    emitJSON(emitter, symbols, *info.methods);
+    if (layouts) {
+      emitter << ",\n    \"layout\": ";
+      emitJSONLayout(emitter, symbols, info);
+    }
+    emitter << "}";
+  }
+  emitter << "]}\n";
+}
+
+// The binary format, which is also the format of class libraries.
+// Every number is a 32 bit little endian word. The file starts
+// with the magic "LANGSYMS" and the version, then the names the
+// tables use: their count, then each one's length and characters.
+// Everywhere else a name is its index in that list, and a type is
+// two words, its base type and the index of its class name
+// (noName if it is not an object). The classes follow, sorted by
+// name, each as:
+//
+//   name, super class name (noName if none), members size,
+//   members: count, then name, type, offset, size of each, where
+//     offset and size are those of the member layout;
+//   methods: count, then name, return type, locals size,
+//     parameters (count, then types) and variables (as members);
+//   member layout: count, then name, type, offset, size, owner;
+//   virtual table: count, then slot, name, owner.
+
+// Numbers the names written to the binary format in the order
+// they are first used.
+class NameNumbers {
+private:
+  std::vector<unsigned int> numbers;
+
+public:
+  std::vector<Symbol> names;
+
+  NameNumbers(const SymbolInterner &symbols) : numbers(symbols.size(), noName) {}
+
+  void use(Symbol symbol) {
+    if (symbol != noSymbol && numbers[symbol] == noName) {
+      numbers[symbol] = names.size();
+      names.push_back(symbol);
+    }
+  }
+
+  unsigned int operator[](Symbol symbol) const {
+    return symbol == noSymbol ? noName : numbers[symbol];
+  }
+};
+
+void numberNames(NameNumbers &numbers, const std::vector<const ClassTable::Entry *> &classes) {
+  for (size_t i = 0; i < classes.size(); i++) {
+    const ClassInfo &info = classes[i]->second;
+    numbers.use(classes[i]->first);
+    numbers.use(info.superClassName);
+    for (MemberLayout::const_iterator it = info.memberLayout->begin(); it != info.memberLayout->end(); ++it) {
+      numbers.use(it->first);
+      numbers.use(classNameOf(it->second.info.type));
+    }
+    for (MethodTable::const_iterator it = info.methods->begin(); it != info.methods->end(); ++it) {
+      numbers.use(it->first);
+      numbers.use(classNameOf(it->second.returnType));
+      for (VariableTable::const_iterator variable = it->second.variables->begin();
+           variable != it->second.variables->end(); ++variable) {
+        numbers.use(variable->first);
+        numbers.use(classNameOf(variable->second.type));
+      }
+    }
+  }
+}
+
+void emitBinaryType(Emitter &emitter, const NameNumbers &numbers, TypeId type) {
+  emitter.word(baseTypeOf(type));
+  emitter.word(numbers[classNameOf(type)]);
+}
+
+void emitBinary(Emitter &emitter, const SymbolInterner &symbols, const NameNumbers &numbers,
+                const VariableTable &variableTable, const MemberLayout *layout = NULL) {
+  std::vector<const VariableTable::Entry *> entries = sorted(variableTable, symbols);
+  emitter.word(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    const VariableInfo &info = placed(entries[i], layout);
+    emitter.word(numbers[entries[i]->first]);
+    emitBinaryType(emitter, numbers, info.type);
+    emitter.word(info.offset);
+    emitter.word(info.size);
+  }
+}
+
+void emitBinary(Emitter &emitter, const SymbolInterner &symbols, const ClassTable &classTable) {
+  std::vector<const ClassTable::Entry *> classes = sorted(classTable, symbols);
+  NameNumbers numbers(symbols);
+  numberNames(numbers, classes);
+
+  emitter << BINARY_MAGIC;
+  emitter.word(binaryVersion);
+  emitter.word(numbers.names.size());
+  for (size_t i = 0; i < numbers.names.size(); i++) {
+    Name name = symbols.name(numbers.names[i]);
+    emitter.word(name.length);
+    emitter << name;
+  }
+
+  emitter.word(classes.size());
+  for (size_t i = 0; i < classes.size(); i++) {
+    const ClassInfo &info = classes[i]->second;
+    emitter.word(numbers[classes[i]->first]);
+    emitter.word(numbers[info.superClassName]);
+    emitter.word(info.membersSize);
+    emitBinary(emitter, symbols, numbers, *info.members, info.memberLayout);
+
+    std::vector<const MethodTable::Entry *> methods = sorted(*info.methods, symbols);
+    emitter.word(methods.size());
+    for (size_t j = 0; j < methods.size(); j++) {
+      const MethodInfo &method = methods[j]->second;
+      emitter.word(numbers[methods[j]->first]);
+      emitBinaryType(emitter, numbers, method.returnType);
+      emitter.word(method.localsSize);
+      emitter.word(method.parameters->size());
+      for (std::list<TypeId>::const_iterator it = method.parameters->begin(); it != method.parameters->end(); ++it)
+        emitBinaryType(emitter, numbers, *it);
+      emitBinary(emitter, symbols, numbers, *method.variables);
+    }
+
+    std::vector<const MemberLayout::Entry *> members = sorted(*info.memberLayout, offsetOrder);
+    emitter.word(members.size());
+    for (size_t j = 0; j < members.size(); j++) {
+      const MemberSlot &slot = members[j]->second;
+      emitter.word(numbers[members[j]->first]);
+      emitBinaryType(emitter, numbers, slot.info.type);
+      emitter.word(slot.info.offset);
+      emitter.word(slot.info.size);
+      emitter.word(numbers[slot.owner]);
+    }
+
+    std::vector<const MethodLayout::Entry *> virtualTable = sorted(*info.methodLayout, slotOrder);
+    emitter.word(virtualTable.size());
+    for (size_t j = 0; j < virtualTable.size(); j++) {
+      emitter.word(virtualTable[j]->second.slot);
+      emitter.word(numbers[virtualTable[j]->first]);
+      emitter.word(numbers[virtualTable[j]->second.owner]);
+    }
+  }
+}
+
+void emit(Emitter &emitter, const SymbolInterner &symbols, const ClassTable &classTable, Format format,
+          int indent, bool layouts) {
+  switch (format) {
+    case f_text:
+      emitText(emitter, symbols, classTable, indent, layouts);
+      break;
+    case f_json:
+      emitJSON(emitter, symbols, classTable, layouts);
+      break;
+    case f_binary:
+      emitBinary(emitter, symbols, classTable);
+      break;
+  }
+}
+
+void print(std::ostream &out, const SymbolInterner &symbols, const VariableTable &variableTable, int indent) {
+  Emitter emitter(out);
+  emitText(emitter, symbols, variableTable, indent);
+}
+
+void print(std::ostream &out, const SymbolInterner &symbols, const MethodTable &methodTable, int indent) {
+  Emitter emitter(out);
+  emitText(emitter, symbols, methodTable, indent);
+}
+
+void print(std::ostream &out, const SymbolInterner &symbols, const MemberLayout &memberLayout, int indent) {
+  Emitter emitter(out);
+  emitText(emitter, symbols, memberLayout, indent);
+}
+
+void print(std::ostream &out, const SymbolInterner &symbols, const MethodLayout &methodLayout, int indent) {
+  Emitter emitter(out);
+  emitText(emitter, symbols, methodLayout, indent);
+}
+
+void print(std::ostream &out, const SymbolInterner &symbols, const ClassTable &classTable, int indent, bool layouts) {
+  Emitter emitter(out);
+  emitText(emitter, symbols, classTable, indent, layouts);
+}
+
+void print(std::ostream &out, const SymbolInterner &symbols, const ClassTable &classTable, int indent) {
+  print(out, symbols, classTable, indent, false);
+}
+
+void print(std::ostream &out, const SymbolInterner &symbols, const ClassTable &classTable) {
+  print(out, symbols, classTable, 0);
+}
@@ -0,0 +1,101 @@
+#ifndef __EMIT_HPP
+#define __EMIT_HPP
+
+#include "symbols.hpp"
+#include "typecheck.hpp"
+
+#include <iostream>
+
+// Defines the formats the symbol table can be written in. Text is
+// the format the tests compare against; JSON and binary are for
+// other tools to read.
+typedef enum {f_text, f_json, f_binary} Format;
+
+// Returns the format named by name ("text", "json" or "binary"),
+// or false if there is no such format.
+bool formatNamed(const char *name, Format &format);
+
+// The magic and version that start the binary format. The version
+// changes whenever the format does, since class libraries are
+// files in this format that are read back by the checker.
+#define BINARY_MAGIC "LANGSYMS"
+const unsigned int binaryVersion = 2;
+
+// The name index written for no name
+const unsigned int noName = 0xffffffff;
+
+// Defines a writer that collects output in one large buffer and
+// hands it to the stream only when the buffer fills up or the
+// emitter is flushed or destroyed, so that writing a large symbol
+// table costs a few large writes instead of one per token.
+class Emitter {
+private:
+  std::ostream *out;
+  char *buffer;
+  size_t used;
+
+  Emitter(const Emitter &);
+  Emitter &operator=(const Emitter &);
+
+  void drain();
+
+public:
+  static const size_t capacity = 1 << 16;
+
+  Emitter(std::ostream &out);
+  ~Emitter();
+
+  void write(const char *text, size_t length) {
+    if (used + length > capacity) {
+      drain();
+      if (length > capacity) {
+        out->write(text, length);
+        return;
+      }
+    }
+    memcpy(buffer + used, text, length);
+    used += length;
+  }
+
+  Emitter &operator<<(const char *text) {
+    write(text, strlen(text));
+    return *this;
+  }
+
+  Emitter &operator<<(const Name &name) {
+    write(name.text, name.length);
+    return *this;
+  }
+
+  Emitter &operator<<(long number);
+
+  // Writes count spaces.
+  void indent(int count);
+
+  // Writes an unsigned 32 bit word in little endian order, for
+  // the binary format.
+  void word(unsigned int word);
+
+  void flush();
+};
+
+// Writes the symbol table in the given format. The text format is
+// indented by indent spaces; if layouts is set, the flattened
+// layout of every class is written too. The binary format always
+// has the layouts.
+void emit(Emitter &emitter, const SymbolInterner &symbols, const ClassTable &classTable, Format format,
+          int indent, bool layouts);
+
+// These functions print the symbol table, or parts of it, to out
+// in the text format, with the entries of every table sorted by
+// name. If layouts is set, the flattened layout of every class is
+// printed after its method table.
+void print(std::ostream &out, const SymbolInterner &symbols, const ClassTable &classTable);
+void print(std::ostream &out, const SymbolInterner &symbols, const ClassTable &classTable, int indent);
+void print(std::ostream &out, const SymbolInterner &symbols, const ClassTable &classTable, int indent, bool layouts);
+void print(std::ostream &out, const SymbolInterner &symbols, const VariableTable &variableTable, int indent);
+void print(std::ostream &out, const SymbolInterner &symbols, const MethodTable &methodTable, int indent);
+void print(std::ostream &out, const SymbolInterner &symbols, const MemberLayout &memberLayout, int indent);
+void print(std::ostream &out, const SymbolInterner &symbols, const MethodLayout &methodLayout, int indent);
+
+#endif
@@ -0,0 +1,245 @@
+#include "escape.hpp"
+
+#include <algorithm>
+#include <map>
+
+// Returns true if the object value is used for nothing but reading
+// and setting its members and checking it.
+bool staysLocal(const IrFunction &function, int object) {
+  for (size_t b = 0; b < function.blocks.size(); b++)
+    for (size_t i = 0; i < function.blocks[b].instructions.size(); i++) {
+      const IrInstruction &instruction = function.instructions[function.blocks[b].instructions[i]];
+      for (size_t j = 0; j < instruction.operands.size(); j++) {
+        if (instruction.operands[j] != object)
+          continue;
+        bool local = j == 0 && (instruction.op == ir_getField || instruction.op == ir_checkObject ||
+                                (instruction.op == ir_setField && instruction.operands[1] != object));
+        if (!local)
+          return false;
+      }
+    }
+  return true;
+}
+
+// Replaces the objects of one function.
+struct ObjectReplacer {
+  ObjectReplacer(IrFunction &function) : function(function) {}
+
+  IrFunction &function;
+  std::vector<int> idom;
+  std::vector<std::vector<int> > children;
+  std::vector<std::vector<int> > frontier;
+  // The phi made for the member at each offset in each block
+  std::map<std::pair<int, int>, int> phis;
+  // The types of the members of the object being replaced
+  std::map<int, BaseType> members;
+
+  void analyze();
+  void replace(int block, int object);
+  void placePhis(int home, int object);
+  void rename(int block, int object, std::map<int, int> current);
+  void removeDeadPhis();
+  int make(IrOpcode op, BaseType type, int immediate);
+
+private:
+  ObjectReplacer(const ObjectReplacer &);
+  ObjectReplacer &operator=(const ObjectReplacer &);
+};
+
+// Finds the dominator tree and the dominance frontier of every block.
+void ObjectReplacer::analyze() {
+  size_t blocks = function.blocks.size();
+  dominators(function, idom);
+  children.assign(blocks, std::vector<int>());
+  frontier.assign(blocks, std::vector<int>());
+  for (size_t b = 0; b < blocks; b++) {
+    if (idom[b] >= 0)
+      children[idom[b]].push_back(b);
+    const std::vector<int> &predecessors = function.blocks[b].predecessors;
+    if (predecessors.size() < 2)
+      continue;
+    for (size_t i = 0; i < predecessors.size(); i++)
+      for (int runner = predecessors[i]; runner != idom[b]; runner = idom[runner])
+        if (std::find(frontier[runner].begin(), frontier[runner].end(), (int) b) == frontier[runner].end())
+          frontier[runner].push_back(b);
+  }
+}
+
+int ObjectReplacer::make(IrOpcode op, BaseType type, int immediate) {
+  IrInstruction instruction;
+  instruction.op = op;
+  instruction.type = type;
+  instruction.immediate = immediate;
+  instruction.variable = -1;
+  function.instructions.push_back(instruction);
+  return function.instructions.size() - 1;
+}
+
+// Places a phi for every member of the object in the blocks strictly
+// dominated by its home that the values set to it reach from more
+// than one side. Other blocks of the frontier have no use of it.
+void ObjectReplacer::placePhis(int home, int object) {
+  for (std::map<int, BaseType>::iterator member = members.begin(); member != members.end(); ++member) {
+    std::vector<int> work(1, home);
+    std::vector<bool> setIn(function.blocks.size(), false), placed(function.blocks.size(), false);
+    for (size_t b = 0; b < function.blocks.size(); b++)
+      for (size_t i = 0; i < function.blocks[b].instructions.size(); i++) {
+        const IrInstruction &instruction = function.instructions[function.blocks[b].instructions[i]];
+        if (instruction.op == ir_setField && instruction.operands[0] == object &&
+            instruction.immediate == member->first && !setIn[b]) {
+          setIn[b] = true;
+          work.push_back(b);
+        }
+      }
+    while (!work.empty()) {
+      int block = work.back();
+      work.pop_back();
+      for (size_t i = 0; i < frontier[block].size(); i++) {
+        int join = frontier[block][i];
+        if (placed[join] || join == home || !dominates(idom, home, join))
+          continue;
+        placed[join] = true;
+        int phi = make(ir_phi, member->second, 0);
+        function.instructions[phi].operands.assign(function.blocks[join].predecessors.size(), -1);
+        std::vector<int> &instructions = function.blocks[join].instructions;
+        instructions.insert(instructions.begin(), phi);
+        phis[std::make_pair(join, member->first)] = phi;
+        if (!setIn[join])
+          work.push_back(join);
+      }
+    }
+  }
+}
+
+// Walks the blocks the home of the object dominates, replacing reads
+// of its members with their current values, and giving the phis of
+// the successors of each block the values they take from it.
+void ObjectReplacer::rename(int block, int object, std::map<int, int> current) {
+  for (std::map<int, BaseType>::iterator member = members.begin(); member != members.end(); ++member) {
+    std::map<std::pair<int, int>, int>::iterator phi = phis.find(std::make_pair(block, member->first));
+    if (phi != phis.end())
+      current[member->first] = phi->second;
+  }
+
+  std::vector<int> &instructions = function.blocks[block].instructions;
+  for (size_t i = 0; i < instructions.size();) {
+    int value = instructions[i];
+    const IrInstruction &instruction = function.instructions[value];
+    if (instruction.op == ir_new && value == object) {
+      // The members start as 0
+      instructions.erase(instructions.begin() + i);
+      for (std::map<int, BaseType>::iterator member = members.begin(); member != members.end(); ++member) {
+        int zero = make(ir_constant, member->second, 0);
+        instructions.insert(instructions.begin() + i++, zero);
+        current[member->first] = zero;
+      }
+      continue;
+    }
+    if (instruction.operands.empty() || instruction.operands[0] != object) {
+      i++;
+      continue;
+    }
+    if (instruction.op == ir_getField) {
+      int read = current[instruction.immediate];
+      for (size_t b = 0; b < function.blocks.size(); b++)
+        for (size_t j = 0; j < function.blocks[b].instructions.size(); j++) {
+          std::vector<int> &operands = function.instructions[function.blocks[b].instructions[j]].operands;
+          std::replace(operands.begin(), operands.end(), value, read);
+        }
+    } else if (instruction.op == ir_setField) {
+      current[instruction.immediate] = instruction.operands[1];
+    }
+    instructions.erase(instructions.begin() + i);
+  }
+
+  const std::vector<int> &successors = function.blocks[block].successors;
+  for (size_t s = 0; s < successors.size(); s++) {
+    const std::vector<int> &predecessors = function.blocks[successors[s]].predecessors;
+    size_t from = std::find(predecessors.begin(), predecessors.end(), block) - predecessors.begin();
+    for (std::map<int, BaseType>::iterator member = members.begin(); member != members.end(); ++member) {
+      std::map<std::pair<int, int>, int>::iterator phi = phis.find(std::make_pair(successors[s], member->first));
+      if (phi != phis.end())
+        function.instructions[phi->second].operands[from] = current[member->first];
+    }
+  }
+  for (size_t i = 0; i < children[block].size(); i++)
+    rename(children[block][i], object, current);
+}
+
+// Removes the phis made that nothing but themselves uses, such as
+// those of members that are set in a loop but never read.
+void ObjectReplacer::removeDeadPhis() {
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    std::vector<int> uses(function.instructions.size(), 0);
+    for (size_t b = 0; b < function.blocks.size(); b++)
+      for (size_t i = 0; i < function.blocks[b].instructions.size(); i++) {
+        int value = function.blocks[b].instructions[i];
+        const std::vector<int> &operands = function.instructions[value].operands;
+        for (size_t j = 0; j < operands.size(); j++)
+          if (operands[j] != value)
+            uses[operands[j]]++;
+      }
+    for (std::map<std::pair<int, int>, int>::iterator phi = phis.begin(); phi != phis.end();) {
+      if (uses[phi->second]) {
+        ++phi;
+        continue;
+      }
+      std::vector<int> &instructions = function.blocks[phi->first.first].instructions;
+      instructions.erase(std::find(instructions.begin(), instructions.end(), phi->second));
+      phis.erase(phi++);
+      changed = true;
+    }
+  }
+}
+
+// Replaces an object made in a block with its members.
+void ObjectReplacer::replace(int block, int object) {
+  members.clear();
+  phis.clear();
+  for (size_t b = 0; b < function.blocks.size(); b++)
+    for (size_t i = 0; i < function.blocks[b].instructions.size(); i++) {
+      const IrInstruction &instruction = function.instructions[function.blocks[b].instructions[i]];
+      if (instruction.op == ir_getField && instruction.operands[0] == object)
+        members[instruction.immediate] = instruction.type;
+      else if (instruction.op == ir_setField && instruction.operands[0] == object)
+        members[instruction.immediate] = function.instructions[instruction.operands[1]].type;
+    }
+  placePhis(block, object);
+  rename(block, object, std::map<int, int>());
+  removeDeadPhis();
+}
+
+void replaceObjects(std::vector<IrFunction> &functions, std::vector<EscapeReport> &reports) {
+  reports.clear();
+  for (size_t f = 0; f < functions.size(); f++) {
+    IrFunction &function = functions[f];
+    EscapeReport report = {0, 0};
+    for (size_t b = 0; b < function.blocks.size(); b++)
+      for (size_t i = 0; i < function.blocks[b].instructions.size(); i++)
+        if (function.instructions[function.blocks[b].instructions[i]].op == ir_new)
+          report.objects++;
+
+    // An object only kept in the members of objects that do not escape
+    // does not escape either once those are replaced
+    ObjectReplacer replacer(function);
+    if (report.objects)
+      replacer.analyze();
+    bool changed = report.objects > 0;
+    while (changed) {
+      changed = false;
+      for (size_t b = 0; b < function.blocks.size(); b++)
+        for (size_t i = 0; i < function.blocks[b].instructions.size(); i++) {
+          int value = function.blocks[b].instructions[i];
+          if (function.instructions[value].op != ir_new || !staysLocal(function, value))
+            continue;
+          replacer.replace(b, value);
+          report.replaced++;
+          changed = true;
+          i = -1;
+        }
+    }
+    reports.push_back(report);
+  }
+}
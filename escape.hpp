@@ -0,0 +1,32 @@
+#ifndef __ESCAPE_HPP
+#define __ESCAPE_HPP
+
+#include "ir.hpp"
+
+#include <vector>
+
+// Defines what replacing objects did to a function: how many objects
+// it makes with new, and how many of those were replaced with their
+// members.
+typedef struct escapereport {
+  int objects;
+  int replaced;
+} EscapeReport;
+
+// Replaces the objects every function makes with new that never
+// escape it with their members. An object escapes when it is
+// assigned to a member, returned, passed to a call or a print,
+// merged with other values by a phi, compared or cast: anything but
+// reading and setting its members, and checking it is not none, which
+// it never is. Objects are references of 32 bits into the heap, so
+// one that escapes is allocated there as it is.
+//
+// The members of an object that does not escape become values:
+// 0 where new makes it, the value set where a member is set, and a
+// phi where the values set on different paths meet, placed as SSA
+// construction places them, at the iterated dominance frontier of
+// the blocks that set the member, within the blocks new dominates.
+// Allocations of helper objects in loops so go away.
+void replaceObjects(std::vector<IrFunction> &functions, std::vector<EscapeReport> &reports);
+
+#endif
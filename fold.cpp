@@ -0,0 +1,286 @@
+#include "fold.hpp"
+
+// Returns true and the value of an expression if it is a literal.
+bool literal(ExpressionNode *node, int &value) {
+  if (node->kind == nk_IntegerLiteral) {
+    value = ((IntegerLiteralNode *) node)->integer->value;
+    return true;
+  }
+  if (node->kind == nk_BooleanLiteral) {
+    value = ((BooleanLiteralNode *) node)->integer->value;
+    return true;
+  }
+  return false;
+}
+
+// Returns true if an expression is the given literal.
+bool isLiteral(ExpressionNode *node, int value) {
+  int found;
+  return literal(node, found) && found == value;
+}
+
+// Returns true if evaluating an expression cannot fail or do
+// anything but give its value: it calls nothing, divides by nothing
+// that may be zero and accesses no member of another object, which
+// may be none. Members of the object a method runs on are safe.
+bool pure(ExpressionNode *node) {
+  int divisor;
+  switch (node->kind) {
+    case nk_IntegerLiteral:
+    case nk_BooleanLiteral:
+    case nk_Variable:
+      return true;
+    case nk_Plus:
+    case nk_Minus:
+    case nk_Times:
+    case nk_Less:
+    case nk_LessEqual:
+    case nk_Equal:
+    case nk_And:
+    case nk_Or:
+      // All binary operators have their operands in the same place
+      return pure(((PlusNode *) node)->expression_1) && pure(((PlusNode *) node)->expression_2);
+    case nk_Divide:
+      return literal(((DivideNode *) node)->expression_2, divisor) && divisor &&
+             pure(((DivideNode *) node)->expression_1);
+    case nk_Not:
+      return pure(((NotNode *) node)->expression);
+    case nk_Negation:
+      return pure(((NegationNode *) node)->expression);
+    default:
+      return false;
+  }
+}
+
+ExpressionNode *integerLiteral(Compilation &compilation, int value) {
+  ExpressionNode *node = new (compilation.arena) IntegerLiteralNode(new (compilation.arena) IntegerNode(value));
+  node->typeId = bt_integer;
+  return node;
+}
+
+ExpressionNode *booleanLiteral(Compilation &compilation, bool value) {
+  ExpressionNode *node = new (compilation.arena) BooleanLiteralNode(new (compilation.arena) IntegerNode(value));
+  node->typeId = bt_boolean;
+  return node;
+}
+
+ExpressionNode *foldExpression(Compilation &compilation, ExpressionNode *node);
+
+void foldArguments(Compilation &compilation, NodeList<ExpressionNode *> *arguments) {
+  for (NodeList<ExpressionNode *>::iterator it = arguments->begin(); it != arguments->end(); ++it)
+    *it = foldExpression(compilation, *it);
+}
+
+// Folds a binary operator whose operands have been folded, or
+// returns NULL if it cannot be.
+ExpressionNode *foldBinary(Compilation &compilation, NodeKind kind, ExpressionNode *left, ExpressionNode *right) {
+  int a, b;
+  if (literal(left, a) && literal(right, b)) {
+    unsigned int x = a, y = b;
+    switch (kind) {
+      case nk_Plus:
+        return integerLiteral(compilation, x + y);
+      case nk_Minus:
+        return integerLiteral(compilation, x - y);
+      case nk_Times:
+        return integerLiteral(compilation, x * y);
+      case nk_Divide:
+        if (!b)
+          return NULL;
+        // The one quotient that does not fit wraps around
+        return integerLiteral(compilation, b == -1 ? 0u - x : a / b);
+      case nk_Less:
+        return booleanLiteral(compilation, a < b);
+      case nk_LessEqual:
+        return booleanLiteral(compilation, a <= b);
+      case nk_Equal:
+        return booleanLiteral(compilation, a == b);
+      case nk_And:
+        return booleanLiteral(compilation, a && b);
+      case nk_Or:
+        return booleanLiteral(compilation, a || b);
+      default:
+        return NULL;
+    }
+  }
+
+  // Both operands are always evaluated, so one can only be dropped
+  // if it is pure
+  switch (kind) {
+    case nk_Plus:
+      if (isLiteral(left, 0))
+        return right;
+      if (isLiteral(right, 0))
+        return left;
+      break;
+    case nk_Minus:
+      if (isLiteral(right, 0))
+        return left;
+      break;
+    case nk_Times:
+      if (isLiteral(left, 1))
+        return right;
+      if (isLiteral(right, 1))
+        return left;
+      if ((isLiteral(left, 0) && pure(right)) || (isLiteral(right, 0) && pure(left)))
+        return integerLiteral(compilation, 0);
+      break;
+    case nk_Divide:
+      if (isLiteral(right, 1))
+        return left;
+      break;
+    case nk_And:
+      if (isLiteral(left, 1))
+        return right;
+      if (isLiteral(right, 1))
+        return left;
+      if ((isLiteral(left, 0) && pure(right)) || (isLiteral(right, 0) && pure(left)))
+        return booleanLiteral(compilation, false);
+      break;
+    case nk_Or:
+      if (isLiteral(left, 0))
+        return right;
+      if (isLiteral(right, 0))
+        return left;
+      if ((isLiteral(left, 1) && pure(right)) || (isLiteral(right, 1) && pure(left)))
+        return booleanLiteral(compilation, true);
+      break;
+    default:
+      break;
+  }
+  return NULL;
+}
+
+// Returns the expression that replaces an expression: itself, with
+// its operands folded, or something simpler that gives the same
+// value.
+ExpressionNode *foldExpression(Compilation &compilation, ExpressionNode *node) {
+  int value;
+  switch (node->kind) {
+    case nk_Plus:
+    case nk_Minus:
+    case nk_Times:
+    case nk_Divide:
+    case nk_Less:
+    case nk_LessEqual:
+    case nk_Equal:
+    case nk_And:
+    case nk_Or: {
+      // All binary operators have their operands in the same place
+      PlusNode *binary = (PlusNode *) node;
+      binary->expression_1 = foldExpression(compilation, binary->expression_1);
+      binary->expression_2 = foldExpression(compilation, binary->expression_2);
+      ExpressionNode *folded = foldBinary(compilation, node->kind, binary->expression_1, binary->expression_2);
+      return folded ? folded : node;
+    }
+    case nk_Not: {
+      NotNode *inverse = (NotNode *) node;
+      inverse->expression = foldExpression(compilation, inverse->expression);
+      if (literal(inverse->expression, value))
+        return booleanLiteral(compilation, !value);
+      if (inverse->expression->kind == nk_Not)
+        return ((NotNode *) inverse->expression)->expression;
+      return node;
+    }
+    case nk_Negation: {
+      NegationNode *negation = (NegationNode *) node;
+      negation->expression = foldExpression(compilation, negation->expression);
+      if (literal(negation->expression, value))
+        return integerLiteral(compilation, 0u - (unsigned int) value);
+      if (negation->expression->kind == nk_Negation)
+        return ((NegationNode *) negation->expression)->expression;
+      return node;
+    }
+    case nk_MethodCall:
+      foldArguments(compilation, ((MethodCallNode *) node)->expression_list);
+      return node;
+    case nk_New:
+      foldArguments(compilation, ((NewNode *) node)->expression_list);
+      return node;
+    default:
+      return node;
+  }
+}
+
+// Folds a statement into the list that replaces a statement list:
+// the statement itself, nothing, or the statements of the branch
+// that always runs.
+void foldStatement(Compilation &compilation, StatementNode *node, NodeList<StatementNode *> *folded);
+
+NodeList<StatementNode *> *foldStatements(Compilation &compilation, NodeList<StatementNode *> *statements) {
+  NodeList<StatementNode *> *folded = new (compilation.arena) NodeList<StatementNode *>(compilation.arena);
+  for (NodeList<StatementNode *>::iterator it = statements->begin(); it != statements->end(); ++it)
+    foldStatement(compilation, *it, folded);
+  return folded;
+}
+
+void splice(NodeList<StatementNode *> *statements, NodeList<StatementNode *> *into) {
+  for (NodeList<StatementNode *>::iterator it = statements->begin(); it != statements->end(); ++it)
+    into->push_back(*it);
+}
+
+void foldStatement(Compilation &compilation, StatementNode *node, NodeList<StatementNode *> *folded) {
+  int value;
+  switch (node->kind) {
+    case nk_Assignment: {
+      AssignmentNode *assignment = (AssignmentNode *) node;
+      assignment->expression = foldExpression(compilation, assignment->expression);
+      break;
+    }
+    case nk_Call:
+      foldArguments(compilation, ((CallNode *) node)->methodcall->expression_list);
+      break;
+    case nk_IfElse: {
+      IfElseNode *ifElse = (IfElseNode *) node;
+      ifElse->expression = foldExpression(compilation, ifElse->expression);
+      if (literal(ifElse->expression, value)) {
+        splice(foldStatements(compilation, value ? ifElse->statement_list_1 : ifElse->statement_list_2), folded);
+        return;
+      }
+      ifElse->statement_list_1 = foldStatements(compilation, ifElse->statement_list_1);
+      ifElse->statement_list_2 = foldStatements(compilation, ifElse->statement_list_2);
+      break;
+    }
+    case nk_While: {
+      WhileNode *loop = (WhileNode *) node;
+      loop->expression = foldExpression(compilation, loop->expression);
+      if (isLiteral(loop->expression, 0))
+        return;
+      loop->statement_list = foldStatements(compilation, loop->statement_list);
+      break;
+    }
+    case nk_Repeat: {
+      RepeatNode *loop = (RepeatNode *) node;
+      loop->statement_list = foldStatements(compilation, loop->statement_list);
+      loop->expression = foldExpression(compilation, loop->expression);
+      // The body of a loop that stops after the first time round
+      // runs once
+      if (isLiteral(loop->expression, 1)) {
+        splice(loop->statement_list, folded);
+        return;
+      }
+      break;
+    }
+    case nk_Print: {
+      PrintNode *print = (PrintNode *) node;
+      print->expression = foldExpression(compilation, print->expression);
+      break;
+    }
+    default:
+      break;
+  }
+  folded->push_back(node);
+}
+
+void fold(Compilation &compilation) {
+  NodeList<ClassNode *> *classes = compilation.program->class_list;
+  for (NodeList<ClassNode *>::iterator c = classes->begin(); c != classes->end(); ++c) {
+    NodeList<MethodNode *> *methods = (*c)->method_list;
+    for (NodeList<MethodNode *>::iterator m = methods->begin(); m != methods->end(); ++m) {
+      MethodBodyNode *body = (*m)->methodbody;
+      body->statement_list = foldStatements(compilation, body->statement_list);
+      if (body->returnstatement)
+        body->returnstatement->expression = foldExpression(compilation, body->returnstatement->expression);
+    }
+  }
+}
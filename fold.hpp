@@ -0,0 +1,17 @@
+#ifndef __FOLD_HPP
+#define __FOLD_HPP
+
+#include "langcheck.hpp"
+
+// Simplifies the method bodies of a program that checked without
+// errors, before it is lowered: folds operators whose operands are
+// literals, applies identities such as x * 1 = x, x + 0 = x and
+// not not x = x, and removes the branches of if, while and repeat
+// statements whose condition is a literal and that can never run.
+// An expression is only dropped if evaluating it can have no effect
+// and cannot fail, so the program does what it did. Integers wrap
+// around and division by zero is left for run time, as the backends
+// have them. New nodes come from the arena of the compilation.
+void fold(Compilation &compilation);
+
+#endif
@@ -0,0 +1,106 @@
+#include "frames.hpp"
+
+#include <algorithm>
+
+// What a register holds at an instruction on every path to it:
+// nothing known, a value that is not a reference, or a reference.
+enum { rs_unknown, rs_value, rs_reference };
+
+// Builds the stack map of a function by following the types of the
+// values written to registers forward through its code. A register
+// is a root at an instruction only if it holds a reference on every
+// path there, from the types of the object, the parameters and the
+// locals, or from the type of the last instruction that wrote it. A
+// call leaves the registers it passes and those above them as its
+// callee left them, so it forgets them, and its own registers are
+// the callee's frame, which the callee's map covers.
+void buildStackMap(const Function &function, StackMap &map) {
+  size_t size = function.code.size();
+  std::vector<std::vector<unsigned char> > states(size);
+  std::vector<unsigned char> state(function.registers, rs_unknown);
+  for (size_t i = 0; i < function.variables.size(); i++)
+    if (function.variables[i] != bt_none)
+      state[i] = function.variables[i] == bt_object ? rs_reference : rs_value;
+  states[0] = state;
+  std::vector<int> work(1, 0);
+  while (!work.empty()) {
+    int index = work.back();
+    work.pop_back();
+    const Instruction &instruction = function.code[index];
+    state = states[index];
+    if (instruction.op == op_call || instruction.op == op_callDirect || instruction.op == op_callMethod)
+      std::fill(state.begin() + instruction.c, state.end(), (unsigned char) rs_unknown);
+    if (instruction.type != bt_none)
+      state[instruction.a] = instruction.type == bt_object ? rs_reference : rs_value;
+
+    int successors[2] = {index + 1, -1};
+    switch (instruction.op) {
+      case op_jump:
+        successors[0] = instruction.b;
+        break;
+      case op_jumpIf:
+      case op_jumpUnless:
+        successors[1] = instruction.b;
+        break;
+      case op_jumpUnlessLess:
+      case op_jumpUnlessLessEqual:
+      case op_jumpUnlessEqual:
+        successors[1] = instruction.c;
+        break;
+      case op_return:
+      case op_returnNone:
+        successors[0] = -1;
+        break;
+      default:
+        break;
+    }
+    for (int i = 0; i < 2; i++) {
+      int successor = successors[i];
+      if (successor < 0 || successor >= (int) size)
+        continue;
+      std::vector<unsigned char> &merged = states[successor];
+      if (merged.empty()) {
+        merged = state;
+        work.push_back(successor);
+        continue;
+      }
+      bool changed = false;
+      for (size_t r = 0; r < merged.size(); r++)
+        if (merged[r] != state[r] && merged[r] != rs_unknown) {
+          merged[r] = rs_unknown;
+          changed = true;
+        }
+      if (changed)
+        work.push_back(successor);
+    }
+  }
+
+  for (size_t i = 0; i < size; i++) {
+    const Instruction &instruction = function.code[i];
+    bool call = instruction.op == op_call || instruction.op == op_callDirect || instruction.op == op_callMethod;
+    if ((!call && instruction.op != op_new) || states[i].empty())
+      continue;
+    std::vector<int> &references = map.references[i];
+    int end = call ? instruction.c : function.registers;
+    for (int r = 0; r < end; r++)
+      if (states[i][r] == rs_reference)
+        references.push_back(r);
+  }
+  map.built = true;
+}
+
+void FrameRoots::visit(Heap &heap) {
+  for (size_t i = 0; i < count; i++)
+    visitFrame(heap, calls[i].function, calls[i].pc, calls[i].frame);
+  if (function)
+    visitFrame(heap, function, pc, frame);
+}
+
+void FrameRoots::visitFrame(Heap &heap, const Function *function, const Instruction *pc, int *frame) {
+  StackMap &map = stackMaps[function - &bytecode.functions[0]];
+  if (!map.built)
+    buildStackMap(*function, map);
+  const std::vector<int> &references = map.references[pc - &function->code[0]];
+  for (size_t i = 0; i < references.size(); i++)
+    heap.update(&frame[references[i]]);
+}
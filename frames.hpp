@@ -0,0 +1,64 @@
+#ifndef __FRAMES_HPP
+#define __FRAMES_HPP
+
+#include "bytecode.hpp"
+#include "heap.hpp"
+
+#include <map>
+#include <vector>
+
+// Defines the frames of running bytecode, which the VM interprets and
+// the JIT compiles the same way: every frame is a window of the
+// registers of all frames, and a call records what it saves of its
+// caller, so that the collector can find the references in every
+// frame with the stack maps of their functions.
+
+// The registers of all frames
+const size_t stackRegisters = 1 << 22;
+
+// Defines what a call saves of its caller: where to continue, the
+// caller's frame, and the register the result goes to.
+typedef struct callrecord {
+  const Function *function;
+  const Instruction *pc;
+  int *frame;
+  int target;
+} CallRecord;
+
+// Defines the registers of a function's frame that hold references
+// at each instruction that may collect: new, which allocates, and
+// calls, whose callees may. Maps are built the first time a frame of
+// the function is on the stack when the heap is collected.
+typedef struct stackmap {
+  bool built;
+  std::map<int, std::vector<int> > references;
+} StackMap;
+
+// Builds the stack map of a function.
+void buildStackMap(const Function &function, StackMap &map);
+
+// Visits the references in the frames of a running program: those of
+// the calls it is in, and the one it is running, stopped at an
+// instruction that collects, if there is one.
+class FrameRoots : public Roots {
+public:
+  FrameRoots(const Bytecode &bytecode, std::vector<StackMap> &stackMaps, const CallRecord *calls, size_t count,
+             const Function *function, const Instruction *pc, int *frame)
+      : bytecode(bytecode), stackMaps(stackMaps), calls(calls), count(count), function(function), pc(pc),
+        frame(frame) {}
+
+  void visit(Heap &heap);
+
+private:
+  void visitFrame(Heap &heap, const Function *function, const Instruction *pc, int *frame);
+
+  const Bytecode &bytecode;
+  std::vector<StackMap> &stackMaps;
+  const CallRecord *calls;
+  size_t count;
+  const Function *function;
+  const Instruction *pc;
+  int *frame;
+};
+
+#endif
@@ -151,14 +151,39 @@ writeline(headerfile, "#ifndef __AST_HPP")
 writeline(headerfile, "#define __AST_HPP")
 writeline(headerfile, "")
 writeline(headerfile, "#include <iostream>")
-writeline(headerfile, "#include <list>")
 writeline(headerfile, "#include <vector>")
 writeline(headerfile, "#include <stack>")
 writeline(headerfile, "#include <string>")
 writeline(headerfile, "#include <sstream>")
 writeline(headerfile, "")
-writeline(headerfile, "// Enumaration of all base types in the language")
-writeline(headerfile, "typedef enum {bt_integer, bt_boolean, bt_none, bt_object} BaseType;")
+writeline(headerfile, "#include \"arena.hpp\"")
+writeline(headerfile, "#include \"stats.hpp\"")
+writeline(headerfile, "#include \"symbols.hpp\"")
+writeline(headerfile, "")
+writeline(headerfile, "// Enumaration of all base types in the language. bt_error is the poison")
+writeline(headerfile, "//   type given to expressions whose type could not be determined")
+writeline(headerfile, "typedef enum {bt_integer, bt_boolean, bt_none, bt_object, bt_error} BaseType;")
+writeline(headerfile, "")
+writeline(headerfile, "// Types are numbered by small ids, which are what nodes and the symbol")
+writeline(headerfile, "//   table store. A base type other than object is its own id, and the")
+writeline(headerfile, "//   type of the objects of a class is numbered after them by the symbol")
+writeline(headerfile, "//   of the class name, so the symbol interner of a compilation is also")
+writeline(headerfile, "//   its table of types and ids are taken apart without a lookup")
+writeline(headerfile, "typedef unsigned int TypeId;")
+writeline(headerfile, "const TypeId firstObjectType = bt_error + 1;")
+writeline(headerfile, "")
+writeline(headerfile, "inline TypeId typeId(BaseType baseType, Symbol className = noSymbol) {")
+writeline(headerfile, "  return baseType == bt_object ? firstObjectType + className : baseType;")
+writeline(headerfile, "}")
+writeline(headerfile, "")
+writeline(headerfile, "inline BaseType baseTypeOf(TypeId type) {")
+writeline(headerfile, "  return type < firstObjectType ? (BaseType) type : bt_object;")
+writeline(headerfile, "}")
+writeline(headerfile, "")
+writeline(headerfile, "// Returns the class of an object type, or noSymbol for other types")
+writeline(headerfile, "inline Symbol classNameOf(TypeId type) {")
+writeline(headerfile, "  return type < firstObjectType ? noSymbol : type - firstObjectType;")
+writeline(headerfile, "}")
 writeline(headerfile, "")
 writeline(headerfile, "// Forward declarations of AST Node classes")
 for node in nodes:
@@ -172,6 +197,19 @@ writeline(headerfile, "")
 writeline(headerfile, "class IdentifierNode;")
 writeline(headerfile, "class IntegerNode;")
 writeline(headerfile, "")
+writeline(headerfile, "// Enumeration of the kinds of AST nodes. Every node stores its kind, so that")
+writeline(headerfile, "//   statically dispatched visitors can switch on it, and the kinds number")
+writeline(headerfile, "//   the nodes counted in --stats")
+writeline(headerfile, "typedef enum : unsigned char {")
+for node in nodes:
+    writeline(headerfile, "  nk_" + node.name + ",")
+writeline(headerfile, "  nk_Identifier,")
+writeline(headerfile, "  nk_Integer")
+writeline(headerfile, "} NodeKind;")
+writeline(headerfile, "#define AST_NODE_KINDS " + str(len(nodes) + 2))
+writeline(headerfile, "static_assert(AST_NODE_KINDS <= STATS_NODE_KINDS, \"too many kinds of nodes to count\");")
+writeline(headerfile, "extern const char* const astNodeNames[AST_NODE_KINDS];")
+writeline(headerfile, "")
 writeline(headerfile, "// Check order of inclusion")
 writeline(headerfile, "#ifdef YYSTYPE_IS_TRIVIAL")
 writeline(headerfile, "#error Make sure to include this file BEFORE parser.hpp")
@@ -189,7 +227,7 @@ for node in nodes:
         newtype = child.name + "Node*"
         newname = child.name.lower()
         if (child.list):
-            newtype = "std::list<" + child.name + "Node*" + ">*"
+            newtype = "NodeList<" + child.name + "Node*" + ">*"
             newname = child.name.lower() + "_list"
         if ((newtype, newname) not in types):
             types.append((newtype, newname))
@@ -220,11 +258,28 @@ writeline(headerfile, "// Define abstract base class for all AST Nodes")
 writeline(headerfile, "//   (this also serves to define the visitable objects)")
 writeline(headerfile, "class ASTNode {")
 writeline(headerfile, "public:")
-writeline(headerfile, "  // All AST nodes have a member which stores their basetype (int, bool, none, object)")
-writeline(headerfile, "  BaseType basetype;")
-writeline(headerfile, "  // All AST nodes have a member which stores the class name, applicable if the base type")
-writeline(headerfile, "  // is object. Otherwise this field may be unused")
-writeline(headerfile, "  std::string objectClassName;")
+writeline(headerfile, "  // All AST nodes have a member which stores their type id, which gives")
+writeline(headerfile, "  //   their basetype (int, bool, none, object) and, if the base type is")
+writeline(headerfile, "  //   object, the class name (as an interned symbol)")
+writeline(headerfile, "  TypeId typeId;")
+writeline(headerfile, "  // All AST nodes store their kind, which is set by the constructor")
+writeline(headerfile, "  //   of each concrete node class. The kind is a byte, so that it fits")
+writeline(headerfile, "  //   beside the type id and a node with no children takes 16 bytes")
+writeline(headerfile, "  NodeKind kind;")
+writeline(headerfile, "")
+writeline(headerfile, "  ASTNode() : typeId(bt_none) {}")
+writeline(headerfile, "")
+writeline(headerfile, "  BaseType basetype() const { return baseTypeOf(typeId); }")
+writeline(headerfile, "  Symbol objectClassName() const { return classNameOf(typeId); }")
+writeline(headerfile, "")
+writeline(headerfile, "  // All AST nodes are allocated from the arena of their compilation,")
+writeline(headerfile, "  //   with new (arena) Node(...), and are freed with it all at once,")
+writeline(headerfile, "  //   so deleting a single node does nothing. Each kind of node")
+writeline(headerfile, "  //   allocates itself the same way and counts itself for --stats,")
+writeline(headerfile, "  //   and declares the matching deletes beside its new")
+writeline(headerfile, "  static void* operator new(size_t size, Arena& arena) { return arena.allocate(size); }")
+writeline(headerfile, "  static void operator delete(void*, Arena&) {}")
+writeline(headerfile, "  static void operator delete(void*) {}")
 writeline(headerfile, "")
 writeline(headerfile, "  // All AST nodes provide visit children and accept methods")
 writeline(headerfile, "  virtual void visit_children(Visitor* v) = 0;")
@@ -237,13 +292,16 @@ for abstractnode in abstractnodes:
 
 writeline(headerfile, "")
 writeline(headerfile, "// Define leaf AST nodes for ids and ints (also used for bools)")
-writeline(headerfile, "// Identifiers have a member name, which is a string")
+writeline(headerfile, "// Identifiers have a member symbol, which is the interned name")
 writeline(headerfile, "class IdentifierNode : public ASTNode {")
 writeline(headerfile, "public:")
-writeline(headerfile, "  std::string name;")
+writeline(headerfile, "  Symbol symbol;")
+writeline(headerfile, "  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Identifier); return arena.allocate(size); }")
+writeline(headerfile, "  static void operator delete(void*, Arena&) {}")
+writeline(headerfile, "  static void operator delete(void*) {}")
 writeline(headerfile, "  virtual void visit_children(Visitor* v) { /* No Children */ }")
 writeline(headerfile, "  virtual void accept(Visitor* v) { v->visitIdentifierNode(this); }")
-writeline(headerfile, "  IdentifierNode(std::string name) { this->name = name; }")
+writeline(headerfile, "  IdentifierNode(Symbol symbol) { this->kind = nk_Identifier; this->symbol = symbol; }")
 writeline(headerfile, "")
 writeline(headerfile, "};")
 writeline(headerfile, "")
@@ -251,11 +309,14 @@ writeline(headerfile, "// Integers have a member value, which is a C int")
 writeline(headerfile, "class IntegerNode : public ASTNode {")
 writeline(headerfile, "public:")
 writeline(headerfile, "  int value;")
+writeline(headerfile, "  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_Integer); return arena.allocate(size); }")
+writeline(headerfile, "  static void operator delete(void*, Arena&) {}")
+writeline(headerfile, "  static void operator delete(void*) {}")
 writeline(headerfile, "")
 writeline(headerfile, "  virtual void visit_children(Visitor* v) {/* No Children */ }")
 writeline(headerfile, "  virtual void accept(Visitor* v) { v->visitIntegerNode(this); }")
 writeline(headerfile, "")
-writeline(headerfile, "  IntegerNode(int value) { this->value = value; }")
+writeline(headerfile, "  IntegerNode(int value) { this->kind = nk_Integer; this->value = value; }")
 writeline(headerfile, "};")
 writeline(headerfile, "")
 writeline(headerfile, "// Define all other AST nodes")
@@ -267,6 +328,9 @@ for node in nodes:
     else:
         writeline(headerfile, "class " + node.name + "Node : public ASTNode {")
     writeline(headerfile, "public:")
+    writeline(headerfile, "  static void* operator new(size_t size, Arena& arena) { STATS_NODE(nk_" + node.name + "); return arena.allocate(size); }")
+    writeline(headerfile, "  static void operator delete(void*, Arena&) {}")
+    writeline(headerfile, "  static void operator delete(void*) {}")
     writeline(headerfile, "  virtual void visit_children(Visitor* v);")
     writeline(headerfile, "  virtual void accept(Visitor* v) { v->visit" + node.name + "Node(this); }")
     if (len(node.children) > 0):
@@ -289,7 +353,7 @@ for node in nodes:
         if (not child.list):
             members.append(child.name + "Node* " + child.name.lower() + number)
         else:
-            members.append("std::list<" + child.name + "Node*" + ">* " + child.name.lower() + "_list" + number)
+            members.append("NodeList<" + child.name + "Node*" + ">* " + child.name.lower() + "_list" + number)
     
     for member in members:
         writeline(headerfile, "  " + member + ";")
@@ -297,9 +361,100 @@ for node in nodes:
     if (len(members) > 0):
         writeline(headerfile, "")
         writeline(headerfile, "  " + node.name + "Node(" + (", ".join(members)) + ");")
+    else:
+        writeline(headerfile, "")
+        writeline(headerfile, "  " + node.name + "Node() { this->kind = nk_" + node.name + "; }")
     writeline(headerfile, "};")
     writeline(headerfile, "")
 
+# Returns the statement with which a statically dispatched visitor visits
+#   the child expr of type name: concrete children are visited by a direct
+#   call to the handler of the pass, abstract ones by a switch on their kind
+def staticvisit(name, expr):
+    if (name in abstractnodes):
+        return "visit(" + expr + ");"
+    return "pass()->visit" + name + "Node(" + expr + ");"
+
+writeline(headerfile, "// Define the base class of statically dispatched visitors. A pass")
+writeline(headerfile, "//   derives from StaticVisitor<Pass> and defines the visitXNode")
+writeline(headerfile, "//   functions of the kinds of nodes it handles, without virtual. The")
+writeline(headerfile, "//   kind of a node picks its handler in a switch, and children whose")
+writeline(headerfile, "//   kind is known from the definition of their parent are handed to")
+writeline(headerfile, "//   their handler directly, so a traversal makes no indirect calls")
+writeline(headerfile, "//   and the compiler can inline the handlers. The handlers a pass does")
+writeline(headerfile, "//   not define visit the children, and are empty for leaves")
+writeline(headerfile, "template <typename Pass>")
+writeline(headerfile, "class StaticVisitor {")
+writeline(headerfile, "public:")
+writeline(headerfile, "  // Visit a node of any kind")
+writeline(headerfile, "  void visit(ASTNode* node);")
+writeline(headerfile, "")
+writeline(headerfile, "  // Visit the children of a node, in the same order as visit_children")
+for node in nodes:
+    writeline(headerfile, "  void visitChildren(" + node.name + "Node* node);")
+writeline(headerfile, "  void visitChildren(IdentifierNode* node) {}")
+writeline(headerfile, "  void visitChildren(IntegerNode* node) {}")
+writeline(headerfile, "")
+writeline(headerfile, "  // Default handlers, hidden by those the pass defines")
+for node in nodes:
+    writeline(headerfile, "  void visit" + node.name + "Node(" + node.name + "Node* node) { visitChildren(node); }")
+writeline(headerfile, "  void visitIdentifierNode(IdentifierNode* node) {}")
+writeline(headerfile, "  void visitIntegerNode(IntegerNode* node) {}")
+writeline(headerfile, "")
+writeline(headerfile, "private:")
+writeline(headerfile, "  Pass* pass() { return static_cast<Pass*>(this); }")
+writeline(headerfile, "};")
+writeline(headerfile, "")
+writeline(headerfile, "template <typename Pass>")
+writeline(headerfile, "inline void StaticVisitor<Pass>::visit(ASTNode* node) {")
+writeline(headerfile, "  switch (node->kind) {")
+for node in nodes:
+    writeline(headerfile, "  case nk_" + node.name + ":")
+    writeline(headerfile, "    pass()->visit" + node.name + "Node(static_cast<" + node.name + "Node*>(node));")
+    writeline(headerfile, "    break;")
+writeline(headerfile, "  case nk_Identifier:")
+writeline(headerfile, "    pass()->visitIdentifierNode(static_cast<IdentifierNode*>(node));")
+writeline(headerfile, "    break;")
+writeline(headerfile, "  case nk_Integer:")
+writeline(headerfile, "    pass()->visitIntegerNode(static_cast<IntegerNode*>(node));")
+writeline(headerfile, "    break;")
+writeline(headerfile, "  }")
+writeline(headerfile, "}")
+for node in nodes:
+    writeline(headerfile, "")
+    writeline(headerfile, "template <typename Pass>")
+    writeline(headerfile, "inline void StaticVisitor<Pass>::visitChildren(" + node.name + "Node* node) {")
+    dupnames = {}
+    childnames = []
+    for child in node.children:
+        if (child.name in childnames):
+            dupnames[child.name] = 1
+        else:
+            childnames.append(child.name)
+    for child in node.children:
+        number = ""
+        if (child.name in dupnames.keys()):
+            number = "_" + str(dupnames[child.name])
+            dupnames[child.name] = dupnames[child.name] + 1
+
+        if (child.list):
+            member = "node->" + child.name.lower() + "_list" + number
+            writeline(headerfile, "  if (" + member + ") {")
+            writeline(headerfile, "    for(NodeList<" + child.name + "Node*" + ">::iterator iter = " + member + "->begin();")
+            writeline(headerfile, "        iter != " + member + "->end(); iter++) {")
+            writeline(headerfile, "      " + staticvisit(child.name, "*iter"))
+            writeline(headerfile, "    }")
+            writeline(headerfile, "  }")
+        elif (child.optional):
+            member = "node->" + child.name.lower() + number
+            writeline(headerfile, "  if (" + member + ") {")
+            writeline(headerfile, "    " + staticvisit(child.name, member))
+            writeline(headerfile, "  }")
+        else:
+            writeline(headerfile, "  " + staticvisit(child.name, "node->" + child.name.lower() + number))
+    writeline(headerfile, "}")
+writeline(headerfile, "")
+
 writeline(headerfile, "// Define the provided Print visitor, which will print the AST,")
 writeline(headerfile, "//   this is an example of a concrete visitor which visit the tree")
 writeline(headerfile, "class Print : public Visitor {")
@@ -307,12 +462,17 @@ writeline(headerfile, "private:")
 writeline(headerfile, "  std::vector<std::string>* elements;")
 writeline(headerfile, "  std::stack<std::vector<std::string>*> stack;")
 writeline(headerfile, "  unsigned int indent;")
+writeline(headerfile, "  const SymbolInterner* symbols;")
 writeline(headerfile, "")
 writeline(headerfile, "  void pushLevel(std::string, bool);")
 writeline(headerfile, "  void addElement(std::string);")
 writeline(headerfile, "  void popLevel(bool, bool);")
 writeline(headerfile, "")
 writeline(headerfile, "public:")
+writeline(headerfile, "  // Identifiers are printed by name, looked up in the interner")
+writeline(headerfile, "  //   of the compilation the tree belongs to")
+writeline(headerfile, "  Print(const SymbolInterner& symbols) : elements(NULL), indent(0), symbols(&symbols) {}")
+writeline(headerfile, "")
 for node in nodes:
     writeline(headerfile, "  virtual void visit" + node.name + "Node(" + node.name + "Node* node);")
 writeline(headerfile, "  virtual void visitIdentifierNode(IdentifierNode* node);")
@@ -329,10 +489,19 @@ headerfile.close()
 
 # Output the code file (refer to inline C comments for meaning of C code)
 writeline(codefile, "#include \"" + headerfilename + "\"")
+writeline(codefile, "")
+writeline(codefile, "// Names of the kinds of nodes, in the order they are numbered")
+writeline(codefile, "const char* const astNodeNames[AST_NODE_KINDS] = {")
+for node in nodes:
+    writeline(codefile, "  \"" + node.name + "\",")
+writeline(codefile, "  \"Identifier\",")
+writeline(codefile, "  \"Integer\"")
+writeline(codefile, "};")
+writeline(codefile, "")
 writeline(codefile, "// For node constructors, all children are taken as")
 writeline(codefile, "//   parameters, and must be passed in. Optional children")
 writeline(codefile, "//   may be NULL pointers. List children are pointers to")
-writeline(codefile, "//    std::lists of the appropriate type (pointer to some node type).")
+writeline(codefile, "//    arena NodeLists of the appropriate type (pointer to some node type).")
 for node in nodes:
     writeline(codefile, "")
     writeline(codefile, "// Visit Children method for " + node.name + " AST node")
@@ -354,12 +523,12 @@ for node in nodes:
         
         if (child.list):
             writeline(codefile, "  if (this->" + child.name.lower() + "_list" + number + ") {")
-            writeline(codefile, "    for(std::list<" + child.name + "Node*" + ">::iterator iter = this->" + child.name.lower() + "_list" + number + "->begin();")
+            writeline(codefile, "    for(NodeList<" + child.name + "Node*" + ">::iterator iter = this->" + child.name.lower() + "_list" + number + "->begin();")
             writeline(codefile, "        iter != this->" + child.name.lower() + "_list" + number + "->end(); iter++) {")
             writeline(codefile, "      (*iter)->accept(v);")
             writeline(codefile, "    }")
             writeline(codefile, "  }")
-            members.append(("std::list<" + child.name + "Node*" + ">*", child.name.lower() + "_list" + number))
+            members.append(("NodeList<" + child.name + "Node*" + ">*", child.name.lower() + "_list" + number))
         elif (child.optional):
             writeline(codefile, "  if (this->" + child.name.lower() + number + ") {")
             writeline(codefile, "    this->" + child.name.lower() + number + "->accept(v);")
@@ -374,6 +543,7 @@ for node in nodes:
         writeline(codefile, "")
         writeline(codefile, "// Constructor for " + node.name + " AST node")
         writeline(codefile, "" + node.name + "Node::" + node.name + "Node(" + (", ".join(map(lambda x: x[0] + " " + x[1], members))) + ") {")
+        writeline(codefile, "  this->kind = nk_" + node.name + ";")
         for member in members:
             writeline(codefile, "  this->" + member[1] + " = " + member[1] + ";")
         writeline(codefile, "}")
@@ -458,7 +628,7 @@ writeline(codefile, "// Concrete visit function for Identifiers (leaf nodes)")
 writeline(codefile, "void Print::visitIdentifierNode(IdentifierNode* node) {")
 writeline(codefile, "  std::stringstream ss;")
 writeline(codefile, "  // Print the name of the indentifier surrounded by quotes")
-writeline(codefile, "  ss << \"\\\"\" << node->name << \"\\\"\";")
+writeline(codefile, "  ss << \"\\\"\" << this->symbols->name(node->symbol) << \"\\\"\";")
 writeline(codefile, "  this->addElement(ss.str());")
 writeline(codefile, "  node->visit_children(this);")
 writeline(codefile, "}")
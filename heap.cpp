@@ -0,0 +1,165 @@
+#include "heap.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+
+// The bytes of address space the heap takes, since references are
+// 32 bit byte offsets, the bytes of the nursery, and how big the old
+// generation grows before it is collected the first time
+const size_t heapReserve = 1u << 30;
+const unsigned nurserySize = 1u << 22;
+const unsigned firstThreshold = 1u << 24;
+
+// A forwarded object's first word is its new place shifted right by
+// 2 with the sign bit set; a class number never has it.
+const unsigned forwarded = 0x80000000u;
+
+#define WORD(object, offset) (*(int *) (base + (object) + (offset)))
+
+Heap::Heap(const std::vector<ClassCode> &classes)
+    : base(NULL), next(0), limit(0), nurseryEnd(0), minorCollections(0), majorCollections(0), classes(&classes),
+      reservedSize(heapReserve), stress(0), rememberedBits(NULL) {
+  void *memory = mmap(NULL, heapReserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  void *bits = mmap(NULL, heapReserve / 32, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                    -1, 0);
+  if (memory == MAP_FAILED || bits == MAP_FAILED) {
+    if (memory != MAP_FAILED)
+      munmap(memory, heapReserve);
+    if (bits != MAP_FAILED)
+      munmap(bits, heapReserve / 32);
+    return;
+  }
+  base = (char *) memory;
+  rememberedBits = (unsigned char *) bits;
+  // Offset 0 is none, and objects start on an 8 byte boundary
+  next = 8;
+  limit = nurseryEnd = nurserySize;
+  halfSize = ((heapReserve - nurserySize) / 2) & ~4095u;
+  halves[0] = nurserySize;
+  halves[1] = nurserySize + halfSize;
+  oldNext = halves[0];
+  threshold = firstThreshold;
+  const char *stressed = getenv("LANG_GC_STRESS");
+  if (stressed && atoi(stressed) > 0) {
+    stress = atoi(stressed);
+    limit = next;
+  }
+}
+
+Heap::~Heap() {
+  if (base) {
+    munmap(base, reservedSize);
+    munmap(rememberedBits, reservedSize / 32);
+  }
+}
+
+void Heap::rememberSlowly(int object) {
+  unsigned char &bits = rememberedBits[object / 32];
+  unsigned char bit = 1 << (object / 4 % 8);
+  if (bits & bit)
+    return;
+  bits |= bit;
+  remembered.push_back(object);
+}
+
+// Returns where an object is after the collection, copying it there
+// if it has not been: young objects are copied, and old ones too in
+// a major collection, unless they are where objects are copied to.
+int Heap::forward(int object) {
+  if (!object)
+    return 0;
+  if (object >= (int) nurseryEnd && (!major || (unsigned) object - halves[1] < halfSize))
+    return object;
+  int header = WORD(object, 0);
+  if (header < 0)
+    return ((unsigned) header & ~forwarded) << 2;
+  unsigned size = (*classes)[header].size;
+  int moved = copyNext;
+  memcpy(base + moved, base + object, size);
+  copyNext += size;
+  WORD(object, 0) = (int) (forwarded | moved >> 2);
+  return moved;
+}
+
+void Heap::update(int *place) {
+  *place = forward(*place);
+}
+
+// Updates the references of the objects copied from an offset on,
+// and of those they copy in turn, until none is left.
+void Heap::scan(unsigned from) {
+  while (from < copyNext) {
+    const ClassCode &code = (*classes)[WORD(from, 0)];
+    for (size_t i = 0; i < code.references.size(); i++)
+      update(&WORD(from, code.references[i]));
+    from += code.size;
+  }
+}
+
+// Copies what is reachable out of the nursery, into the half of the
+// old generation in use, or into the other half along with every
+// reachable old object, which it then uses. Returns false if what
+// is reachable does not leave needed bytes free. A half keeps the
+// size of the nursery free, so that a major collection always has
+// room for all that was in the nursery.
+bool Heap::collect(Roots &roots, unsigned needed) {
+  unsigned young = next - 8;
+  unsigned end = halves[0] + halfSize - nurserySize;
+  major = oldNext - halves[0] + young > threshold || oldNext + young > end ||
+          (stress && (minorCollections + majorCollections + 1) % stress == 0);
+  unsigned from = major ? halves[1] : oldNext;
+  copyNext = from;
+  roots.visit(*this);
+  for (size_t i = 0; i < remembered.size(); i++) {
+    int object = remembered[i];
+    rememberedBits[object / 32] = 0;
+    if (major)
+      continue;
+    const ClassCode &code = (*classes)[WORD(object, 0)];
+    for (size_t j = 0; j < code.references.size(); j++)
+      update(&WORD(object, code.references[j]));
+  }
+  remembered.clear();
+  scan(from);
+
+  memset(base + 8, 0, young);
+  next = 8;
+  if (major) {
+    // The old half is zero again once given back
+    madvise(base + halves[0], oldNext - halves[0], MADV_DONTNEED);
+    unsigned half = halves[0];
+    halves[0] = halves[1];
+    halves[1] = half;
+    threshold = 2 * (copyNext - halves[0]);
+    if (threshold < firstThreshold)
+      threshold = firstThreshold;
+    majorCollections++;
+  } else {
+    minorCollections++;
+  }
+  oldNext = copyNext;
+  return oldNext + needed <= halves[0] + halfSize - nurserySize;
+}
+
+int Heap::allocateSlowly(int classNumber, Roots &roots) {
+  unsigned size = (*classes)[classNumber].size;
+  if (!collect(roots, size))
+    return 0;
+  limit = nurseryEnd;
+  if (size <= limit - next) {
+    int object = allocate(classNumber, roots);
+    // A stressed nursery is full once it holds an object
+    if (stress)
+      limit = next;
+    return object;
+  }
+  // An object bigger than the nursery goes straight to the old
+  // generation, whose memory past oldNext is still zero
+  int object = oldNext;
+  oldNext += size;
+  WORD(object, 0) = classNumber;
+  return object;
+}
+
+#undef WORD
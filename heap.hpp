@@ -0,0 +1,118 @@
+#ifndef __HEAP_HPP
+#define __HEAP_HPP
+
+#include "bytecode.hpp"
+
+#include <vector>
+
+class Heap;
+
+// Defines what the collector asks of the program that uses the heap:
+// to hand every place outside the heap that holds a reference to
+// Heap::update, which points it to where its object moved. Every
+// such place must be visited, and nothing else, since objects move.
+class Roots {
+public:
+  virtual ~Roots() {}
+  virtual void visit(Heap &heap) = 0;
+};
+
+// Defines a heap with a precise generational copying collector.
+// References are byte offsets into the memory at base, 0 being none,
+// and the first word of an object is the number of its class.
+//
+// New objects are allocated in the nursery by bumping next up to
+// limit, which takes a few instructions: the nursery is zero, so
+// objects need nothing but their class. When it is full, the objects
+// in it that are still reachable, from the roots or from old objects
+// that were given references to them, are copied into the old
+// generation, and the nursery is zeroed again. The old generation is
+// two halves: objects are copied into one, and when that has grown
+// to twice what was reachable after the last time, every reachable
+// object is copied into the other, and the memory of the first is
+// given back to the system, so that a program that runs for long
+// takes memory in proportion to what it keeps. The collector finds
+// the references of objects with the maps of their classes.
+//
+// Old objects given a reference to a young one are remembered by
+// the write barrier, remember, which every store of a member must
+// be followed by.
+//
+// To find what misses a root or a barrier, the environment variable
+// LANG_GC_STRESS set to a number N makes the heap collect before
+// every allocation, every Nth collection a major one, so that every
+// object is moved as soon as another is made.
+class Heap {
+public:
+  explicit Heap(const std::vector<ClassCode> &classes);
+  ~Heap();
+
+  // Returns false if the memory of the heap could not be reserved.
+  bool reserved() const { return base != NULL; }
+
+  // Returns a new zeroed object of a class, collecting first if the
+  // nursery is full, or 0 if the heap is full.
+  int allocate(int classNumber, Roots &roots) {
+    unsigned size = (*classes)[classNumber].size;
+    if (size > limit - next)
+      return allocateSlowly(classNumber, roots);
+    int object = next;
+    next += size;
+    *(int *) (base + object) = classNumber;
+    return object;
+  }
+
+  // Remembers an object given a value that may be a reference to a
+  // young object.
+  void remember(int object, int value) {
+    if (object >= (int) nurseryEnd && (unsigned) value - 1 < nurseryEnd - 1)
+      rememberSlowly(object);
+  }
+
+  // Points a place that holds a reference to where its object moved,
+  // during a collection.
+  void update(int *place);
+
+  char *base;
+  unsigned next;
+  unsigned limit;
+  // Where the nursery ends: the references below it are young
+  unsigned nurseryEnd;
+
+  // How many times the nursery and the whole heap were collected
+  int minorCollections;
+  int majorCollections;
+
+private:
+  Heap(const Heap &);
+  Heap &operator=(const Heap &);
+
+  int allocateSlowly(int classNumber, Roots &roots);
+  void rememberSlowly(int object);
+  bool collect(Roots &roots, unsigned needed);
+  int forward(int object);
+  void scan(unsigned from);
+
+  const std::vector<ClassCode> *classes;
+  size_t reservedSize;
+  // The two halves of the old generation, the one in use first, and
+  // where the next object copied into it goes
+  unsigned halves[2];
+  unsigned halfSize;
+  unsigned oldNext;
+  unsigned threshold;
+  // Where a collection copies objects to, and whether it copies old
+  // ones too
+  unsigned copyNext;
+  bool major;
+  // The collections from one major collection to the next under
+  // LANG_GC_STRESS, or 0 if the heap is not stressed
+  int stress;
+  // The old objects that may hold references to young ones, with a
+  // bit for each word of the heap that starts one of them, in memory
+  // mapped like the heap's, which only takes pages as bits are set
+  std::vector<int> remembered;
+  unsigned char *rememberedBits;
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include "inliner.hpp"
+
+// Returns true if a call of a function from another may be replaced
+// with the code of the function it calls.
+bool inlinable(const Bytecode &bytecode, int caller, const Instruction &call) {
+  if ((call.op != op_call && call.op != op_callDirect) || call.b == caller)
+    return false;
+  const Function &callee = bytecode.functions[call.b];
+  return callee.code.size() <= inlineLimit && callee.parameters == call.d &&
+         call.c + callee.registers <= maxRegisters;
+}
+
+// Moves an operand of an instruction of a callee to where the
+// callee's code is inlined: its registers up to the base of the
+// call, and its jumps to where their targets went.
+int moveOperand(OperandKind kind, int operand, int base, const std::vector<int> &position) {
+  if (kind == o_register)
+    return operand + base;
+  if (kind == o_target)
+    return position[operand];
+  return operand;
+}
+
+// Appends the code of the function a call calls to code, in place
+// of the call.
+void inlineCall(Bytecode &bytecode, Function &caller, const Instruction &call, std::vector<Instruction> &code) {
+  const Function &callee = bytecode.functions[call.b];
+  int base = call.c;
+  if (call.op == op_callDirect) {
+    Instruction check = {op_checkObject, bt_none, (unsigned short) base, 0, 0, 0};
+    code.push_back(check);
+  }
+  for (int i = 0; i < callee.locals; i++) {
+    Instruction clear = {op_constant, (unsigned char) callee.variables[callee.parameters + i],
+                         (unsigned short) (base + callee.parameters + i), 0, 0, 0};
+    code.push_back(clear);
+  }
+
+  // Where each instruction of the callee goes. A return moves its
+  // value into the call's register and, unless it is the last
+  // instruction, jumps past the rest.
+  size_t last = callee.code.size() - 1;
+  std::vector<int> position(callee.code.size() + 1);
+  int next = code.size();
+  for (size_t i = 0; i < callee.code.size(); i++) {
+    position[i] = next;
+    Opcode op = callee.code[i].op;
+    if (op == op_return)
+      next += i == last ? 1 : 2;
+    else if (op == op_returnNone)
+      next += i == last ? 0 : 1;
+    else
+      next++;
+  }
+  position[callee.code.size()] = next;
+
+  for (size_t i = 0; i < callee.code.size(); i++) {
+    const Instruction &instruction = callee.code[i];
+    if (instruction.op == op_return) {
+      Instruction result = {op_move, call.type, call.a, instruction.a + base, 0, 0};
+      code.push_back(result);
+    }
+    if (instruction.op == op_return || instruction.op == op_returnNone) {
+      if (i != last) {
+        Instruction jump = {op_jump, bt_none, 0, position[callee.code.size()], 0, 0};
+        code.push_back(jump);
+      }
+      continue;
+    }
+    const Operands &operands = operandsOf(instruction.op);
+    Instruction moved = instruction;
+    moved.a = moveOperand(operands.a, instruction.a, base, position);
+    moved.b = moveOperand(operands.b, instruction.b, base, position);
+    moved.c = moveOperand(operands.c, instruction.c, base, position);
+    code.push_back(moved);
+  }
+  if (base + callee.registers > caller.registers)
+    caller.registers = base + callee.registers;
+}
+
+// Inlines the calls of a function, then points its own jumps to
+// where their targets went.
+void inlineFunction(Bytecode &bytecode, int number) {
+  Function &function = bytecode.functions[number];
+  std::vector<Instruction> code;
+  std::vector<int> position(function.code.size() + 1);
+  std::vector<size_t> jumps;
+  for (size_t i = 0; i < function.code.size(); i++) {
+    position[i] = code.size();
+    const Instruction &instruction = function.code[i];
+    if (inlinable(bytecode, number, instruction) &&
+        code.size() + function.code.size() - i + inlineLimit <= inlinedFunctionLimit) {
+      inlineCall(bytecode, function, instruction, code);
+      bytecode.inlinedCalls++;
+      continue;
+    }
+    const Operands &operands = operandsOf(instruction.op);
+    if (operands.b == o_target || operands.c == o_target)
+      jumps.push_back(code.size());
+    code.push_back(instruction);
+  }
+  position[function.code.size()] = code.size();
+
+  for (size_t i = 0; i < jumps.size(); i++) {
+    Instruction &jump = code[jumps[i]];
+    if (operandsOf(jump.op).b == o_target)
+      jump.b = position[jump.b];
+    else
+      jump.c = position[jump.c];
+  }
+  function.code.swap(code);
+}
+
+void inlineCalls(Bytecode &bytecode) {
+  for (size_t i = 0; i < bytecode.functions.size(); i++)
+    inlineFunction(bytecode, i);
+}
@@ -0,0 +1,23 @@
+#ifndef __INLINER_HPP
+#define __INLINER_HPP
+
+#include "bytecode.hpp"
+
+// The most instructions a function may have to be inlined, and the
+// most a function may grow to by having calls inlined into it
+const size_t inlineLimit = 12;
+const size_t inlinedFunctionLimit = 4000;
+
+// Replaces direct calls of small functions with their code: the
+// callee's registers are moved up to the registers the call passes
+// its object and arguments in, where its frame would have started,
+// its locals are cleared, and its returns become moves into the
+// call's register and jumps past the inlined code. The caller's
+// frame grows to hold the callee's. Calls through virtual tables,
+// calls of a function from itself, and calls that pass a function
+// other than the number of registers it has parameters are left as
+// they are. Each call is inlined once, so inlining ends even where
+// functions call each other.
+void inlineCalls(Bytecode &bytecode);
+
+#endif
@@ -0,0 +1,948 @@
+#include "ir.hpp"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+#define IR_OPCODE_NAME(name) #name,
+
+const char *irOpcodeName(IrOpcode opcode) {
+  static const char *names[] = {IR_OPCODES(IR_OPCODE_NAME)};
+  return opcode < ir_opcodes ? names[opcode] : "?";
+}
+
+#undef IR_OPCODE_NAME
+
+bool isTerminator(IrOpcode opcode) {
+  return opcode >= ir_jump;
+}
+
+bool isCall(IrOpcode opcode) {
+  return opcode == ir_call || opcode == ir_callDirect || opcode == ir_callMethod;
+}
+
+// Defines what building the IR of a function keeps track of: for
+// every block, the value each variable has at its end, or where it
+// has been read so far, the phis made for variables read before
+// all its predecessors were built, which are given their operands
+// when the block is sealed, and the phis made in it.
+typedef struct builder {
+  const Function *code;
+  IrFunction *function;
+  std::vector<std::map<int, int> > definitions;
+  std::vector<std::map<int, int> > incomplete;
+  std::vector<std::vector<int> > phis;
+  std::vector<int> built;
+  std::vector<bool> sealed;
+} Builder;
+
+// Makes an instruction, not yet in any block, and returns its value.
+int make(IrFunction &function, IrOpcode op, BaseType type, int immediate, int variable) {
+  IrInstruction instruction;
+  instruction.op = op;
+  instruction.type = type;
+  instruction.immediate = immediate;
+  instruction.variable = variable;
+  function.instructions.push_back(instruction);
+  return function.instructions.size() - 1;
+}
+
+// Makes an instruction at the end of a block.
+int append(Builder &builder, int block, IrOpcode op, BaseType type = bt_none, int immediate = 0,
+           int variable = -1) {
+  int value = make(*builder.function, op, type, immediate, variable);
+  builder.function->blocks[block].instructions.push_back(value);
+  return value;
+}
+
+int makePhi(Builder &builder, int block, int variable) {
+  int phi = make(*builder.function, ir_phi, bt_none, 0, variable);
+  builder.phis[block].push_back(phi);
+  return phi;
+}
+
+int readVariable(Builder &builder, int block, int variable);
+
+void addPhiOperands(Builder &builder, int block, int phi) {
+  const std::vector<int> &predecessors = builder.function->blocks[block].predecessors;
+  int variable = builder.function->instructions[phi].variable;
+  for (size_t i = 0; i < predecessors.size(); i++) {
+    int value = readVariable(builder, predecessors[i], variable);
+    builder.function->instructions[phi].operands.push_back(value);
+  }
+}
+
+// Returns the value a variable has at the end of a block, looking
+// it up in the predecessors if the block does not write it. The
+// locals and parameters are written in the entry block, and the
+// bytecode writes every temporary before it reads it, so only a
+// variable of code that cannot run is read unwritten; it is 0.
+int readVariable(Builder &builder, int block, int variable) {
+  std::map<int, int>::iterator it = builder.definitions[block].find(variable);
+  if (it != builder.definitions[block].end())
+    return it->second;
+  const IrBlock &ir = builder.function->blocks[block];
+  int value;
+  if (!builder.sealed[block]) {
+    value = makePhi(builder, block, variable);
+    builder.incomplete[block][variable] = value;
+  } else if (ir.predecessors.size() == 1) {
+    value = readVariable(builder, ir.predecessors[0], variable);
+  } else if (ir.predecessors.empty()) {
+    value = make(*builder.function, ir_constant, bt_none, 0, variable);
+    std::vector<int> &entry = builder.function->blocks[block].instructions;
+    entry.insert(entry.begin(), value);
+  } else {
+    // Written first, so that a loop back to the block finds the phi
+    value = makePhi(builder, block, variable);
+    builder.definitions[block][variable] = value;
+    addPhiOperands(builder, block, value);
+  }
+  builder.definitions[block][variable] = value;
+  return value;
+}
+
+void writeVariable(Builder &builder, int block, int variable, int value) {
+  builder.definitions[block][variable] = value;
+}
+
+void seal(Builder &builder, int block) {
+  std::map<int, int> incomplete;
+  incomplete.swap(builder.incomplete[block]);
+  builder.sealed[block] = true;
+  for (std::map<int, int>::iterator it = incomplete.begin(); it != incomplete.end(); ++it)
+    addPhiOperands(builder, block, it->second);
+}
+
+// Adds the value a variable has to the operands of an instruction.
+// Reading it may make phis, so the instruction is only looked up
+// once it has.
+void use(Builder &builder, int block, int instruction, int variable) {
+  int value = readVariable(builder, block, variable);
+  builder.function->instructions[instruction].operands.push_back(value);
+}
+
+// Makes an instruction that reads the registers of the bytecode in
+// operands, and writes its value to register a if it has one.
+int translate(Builder &builder, int block, IrOpcode op, const Instruction &instruction, int operand1 = -1,
+              int operand2 = -1) {
+  int value = append(builder, block, op, (BaseType) instruction.type, 0, instruction.a);
+  if (operand1 >= 0)
+    use(builder, block, value, operand1);
+  if (operand2 >= 0)
+    use(builder, block, value, operand2);
+  return value;
+}
+
+// Translates an instruction of the bytecode that neither jumps nor
+// returns into the block.
+void translateInstruction(Builder &builder, int block, const Instruction &instruction) {
+  IrFunction &function = *builder.function;
+  int value;
+  switch (instruction.op) {
+    case op_move:
+      writeVariable(builder, block, instruction.a, readVariable(builder, block, instruction.b));
+      return;
+    case op_constant:
+      value = translate(builder, block, ir_constant, instruction);
+      function.instructions[value].immediate = instruction.b;
+      break;
+    case op_add:
+      value = translate(builder, block, ir_add, instruction, instruction.b, instruction.c);
+      break;
+    case op_addConstant: {
+      int constant = append(builder, block, ir_constant, bt_integer, instruction.c);
+      value = translate(builder, block, ir_add, instruction, instruction.b);
+      function.instructions[value].operands.push_back(constant);
+      break;
+    }
+    case op_subtract:
+      value = translate(builder, block, ir_subtract, instruction, instruction.b, instruction.c);
+      break;
+    case op_multiply:
+      value = translate(builder, block, ir_multiply, instruction, instruction.b, instruction.c);
+      break;
+    case op_divide:
+      value = translate(builder, block, ir_divide, instruction, instruction.b, instruction.c);
+      break;
+    case op_less:
+      value = translate(builder, block, ir_less, instruction, instruction.b, instruction.c);
+      break;
+    case op_lessEqual:
+      value = translate(builder, block, ir_lessEqual, instruction, instruction.b, instruction.c);
+      break;
+    case op_equal:
+      value = translate(builder, block, ir_equal, instruction, instruction.b, instruction.c);
+      break;
+    case op_and:
+      value = translate(builder, block, ir_and, instruction, instruction.b, instruction.c);
+      break;
+    case op_or:
+      value = translate(builder, block, ir_or, instruction, instruction.b, instruction.c);
+      break;
+    case op_not:
+      value = translate(builder, block, ir_not, instruction, instruction.b);
+      break;
+    case op_negate:
+      value = translate(builder, block, ir_negate, instruction, instruction.b);
+      break;
+    case op_getField:
+    case op_getByte:
+      value = translate(builder, block, ir_getField, instruction, instruction.b);
+      function.instructions[value].immediate = instruction.c;
+      break;
+    case op_setField:
+    case op_setByte:
+      value = translate(builder, block, ir_setField, instruction, instruction.a, instruction.b);
+      function.instructions[value].immediate = instruction.c;
+      function.instructions[value].variable = -1;
+      return;
+    case op_checkClass:
+      value = translate(builder, block, ir_checkClass, instruction, instruction.a);
+      function.instructions[value].immediate = instruction.b;
+      function.instructions[value].variable = -1;
+      return;
+    case op_checkObject:
+      value = translate(builder, block, ir_checkObject, instruction, instruction.a);
+      function.instructions[value].variable = -1;
+      return;
+    case op_new:
+      value = translate(builder, block, ir_new, instruction);
+      function.instructions[value].immediate = instruction.b;
+      break;
+    case op_call:
+    case op_callDirect:
+    case op_callMethod:
+      value = translate(builder, block,
+                        instruction.op == op_call ? ir_call : instruction.op == op_callDirect ? ir_callDirect
+                                                                                                : ir_callMethod,
+                        instruction);
+      function.instructions[value].immediate = instruction.b;
+      for (int i = 0; i < instruction.d; i++) {
+        int operand = readVariable(builder, block, instruction.c + i);
+        function.instructions[value].operands.push_back(operand);
+      }
+      break;
+    case op_print:
+      value = translate(builder, block, ir_print, instruction, instruction.a);
+      function.instructions[value].variable = -1;
+      return;
+    default:
+      return;
+  }
+  writeVariable(builder, block, instruction.a, value);
+}
+
+// Defines a block of the bytecode, between one jump target or jump
+// and the next: its instructions, its successors, and the block of
+// the IR it becomes.
+typedef struct codeblock {
+  size_t start;
+  size_t end;
+  std::vector<int> successors;
+  int predecessors;
+  bool reachable;
+  int block;
+} CodeBlock;
+
+// Splits the bytecode of a function into blocks and finds their
+// successors, in the order IR branches have them.
+void splitCode(const Function &code, std::vector<CodeBlock> &blocks) {
+  std::vector<bool> leader(code.code.size() + 1, false);
+  leader[0] = true;
+  for (size_t i = 0; i < code.code.size(); i++) {
+    const Instruction &instruction = code.code[i];
+    const Operands &operands = operandsOf(instruction.op);
+    if (operands.b == o_target)
+      leader[instruction.b] = true;
+    else if (operands.c == o_target)
+      leader[instruction.c] = true;
+    else if (instruction.op != op_return && instruction.op != op_returnNone)
+      continue;
+    leader[i + 1] = true;
+  }
+
+  std::vector<int> blockAt(code.code.size() + 1, -1);
+  for (size_t i = 0; i < code.code.size(); i++) {
+    if (!leader[i])
+      continue;
+    CodeBlock block;
+    block.start = i;
+    block.predecessors = 0;
+    block.reachable = false;
+    block.block = -1;
+    blockAt[i] = blocks.size();
+    if (!blocks.empty())
+      blocks.back().end = i;
+    blocks.push_back(block);
+  }
+  blocks.back().end = code.code.size();
+
+  for (size_t i = 0; i < blocks.size(); i++) {
+    const Instruction &last = code.code[blocks[i].end - 1];
+    int next = blockAt[blocks[i].end];
+    std::vector<int> &successors = blocks[i].successors;
+    switch (last.op) {
+      case op_jump:
+        successors.push_back(blockAt[last.b]);
+        break;
+      case op_jumpIf:
+        successors.push_back(blockAt[last.b]);
+        successors.push_back(next);
+        break;
+      case op_jumpUnless:
+        successors.push_back(next);
+        successors.push_back(blockAt[last.b]);
+        break;
+      case op_jumpUnlessLess:
+      case op_jumpUnlessLessEqual:
+      case op_jumpUnlessEqual:
+        successors.push_back(next);
+        successors.push_back(blockAt[last.c]);
+        break;
+      case op_return:
+      case op_returnNone:
+        break;
+      default:
+        successors.push_back(next);
+        break;
+    }
+    // A branch whose ways meet at once is a jump
+    if (successors.size() == 2 && successors[0] == successors[1])
+      successors.pop_back();
+  }
+
+  std::vector<int> work(1, 0);
+  blocks[0].reachable = true;
+  while (!work.empty()) {
+    int block = work.back();
+    work.pop_back();
+    for (size_t i = 0; i < blocks[block].successors.size(); i++) {
+      CodeBlock &successor = blocks[blocks[block].successors[i]];
+      if (!successor.reachable) {
+        successor.reachable = true;
+        work.push_back(blocks[block].successors[i]);
+      }
+    }
+  }
+  for (size_t i = 0; i < blocks.size(); i++)
+    if (blocks[i].reachable)
+      for (size_t j = 0; j < blocks[i].successors.size(); j++)
+        blocks[blocks[i].successors[j]].predecessors++;
+}
+
+// Lays out the blocks of the IR of a function: the reachable blocks
+// of the bytecode in order, each preceded by an empty block for
+// every critical edge into it, so that the way into a loop or
+// around it does not have to jump over it. The origin of each
+// block is the block of the bytecode it holds, or -1 - that of the
+// block an empty one jumps to.
+void layOut(IrFunction &function, std::vector<CodeBlock> &code, std::vector<int> &origin) {
+  // The block each successor of each block of the bytecode goes
+  // through, where an edge is split
+  std::vector<std::vector<int> > through(code.size());
+  for (size_t i = 0; i < code.size(); i++)
+    through[i].assign(code[i].successors.size(), -1);
+  // The entry has no predecessors, so a loop at the start of the
+  // body gets a block of its own to come from
+  if (code[0].predecessors) {
+    origin.push_back(-1);
+    code[0].predecessors++;
+  }
+  for (size_t i = 0; i < code.size(); i++) {
+    if (!code[i].reachable)
+      continue;
+    if (code[i].predecessors > 1)
+      for (size_t j = 0; j < code.size(); j++)
+        if (code[j].reachable && code[j].successors.size() > 1)
+          for (size_t k = 0; k < code[j].successors.size(); k++)
+            if (code[j].successors[k] == (int) i) {
+              through[j][k] = origin.size();
+              origin.push_back(-1 - (int) i);
+            }
+    code[i].block = origin.size();
+    origin.push_back(i);
+  }
+
+  function.blocks.resize(origin.size());
+  for (size_t b = 0; b < origin.size(); b++) {
+    std::vector<int> &successors = function.blocks[b].successors;
+    if (origin[b] < 0) {
+      successors.push_back(code[-1 - origin[b]].block);
+      continue;
+    }
+    const CodeBlock &block = code[origin[b]];
+    for (size_t k = 0; k < block.successors.size(); k++)
+      successors.push_back(through[origin[b]][k] >= 0 ? through[origin[b]][k] : code[block.successors[k]].block);
+  }
+  for (size_t b = 0; b < function.blocks.size(); b++)
+    for (size_t k = 0; k < function.blocks[b].successors.size(); k++)
+      function.blocks[function.blocks[b].successors[k]].predecessors.push_back(b);
+}
+
+// Ends a block of the bytecode with the jump, branch or return its
+// last instruction becomes.
+void terminate(Builder &builder, int block, const Instruction &last) {
+  size_t successors = builder.function->blocks[block].successors.size();
+  if (successors == 1) {
+    append(builder, block, ir_jump);
+    return;
+  }
+  int value;
+  switch (last.op) {
+    case op_jumpIf:
+    case op_jumpUnless:
+      value = append(builder, block, ir_branch);
+      use(builder, block, value, last.a);
+      break;
+    case op_jumpUnlessLess:
+    case op_jumpUnlessLessEqual:
+    case op_jumpUnlessEqual:
+      value = append(builder, block, last.op == op_jumpUnlessLess        ? ir_branchLess
+                                     : last.op == op_jumpUnlessLessEqual ? ir_branchLessEqual
+                                                                         : ir_branchEqual);
+      use(builder, block, value, last.a);
+      use(builder, block, value, last.b);
+      break;
+    case op_return:
+      value = append(builder, block, ir_return);
+      use(builder, block, value, last.a);
+      break;
+    default:
+      append(builder, block, ir_returnNone);
+      break;
+  }
+}
+
+int find(std::vector<int> &replacement, int value) {
+  while (replacement[value] >= 0)
+    value = replacement[value];
+  return value;
+}
+
+// Removes the phis that choose between one value and themselves,
+// which reading a variable in a loop before it is sealed makes, and
+// then those nothing uses, and gives the rest their types.
+void simplifyPhis(Builder &builder) {
+  IrFunction &function = *builder.function;
+  std::vector<int> replacement(function.instructions.size(), -1);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t b = 0; b < builder.phis.size(); b++)
+      for (size_t i = 0; i < builder.phis[b].size(); i++) {
+        int phi = builder.phis[b][i];
+        if (replacement[phi] >= 0)
+          continue;
+        int same = -1;
+        const std::vector<int> &operands = function.instructions[phi].operands;
+        size_t j;
+        for (j = 0; j < operands.size(); j++) {
+          int operand = find(replacement, operands[j]);
+          if (operand == phi || operand == same)
+            continue;
+          if (same >= 0)
+            break;
+          same = operand;
+        }
+        if (j == operands.size() && same >= 0) {
+          replacement[phi] = same;
+          changed = true;
+        }
+      }
+  }
+  for (size_t i = 0; i < function.instructions.size(); i++) {
+    std::vector<int> &operands = function.instructions[i].operands;
+    for (size_t j = 0; j < operands.size(); j++)
+      operands[j] = find(replacement, operands[j]);
+  }
+
+  // A phi is used if an instruction other than a phi uses it, or a
+  // used phi does
+  std::vector<bool> used(function.instructions.size(), false);
+  std::vector<int> work;
+  for (size_t b = 0; b < function.blocks.size(); b++)
+    for (size_t i = 0; i < function.blocks[b].instructions.size(); i++) {
+      const std::vector<int> &operands = function.instructions[function.blocks[b].instructions[i]].operands;
+      for (size_t j = 0; j < operands.size(); j++)
+        if (function.instructions[operands[j]].op == ir_phi && !used[operands[j]]) {
+          used[operands[j]] = true;
+          work.push_back(operands[j]);
+        }
+    }
+  while (!work.empty()) {
+    int phi = work.back();
+    work.pop_back();
+    const std::vector<int> &operands = function.instructions[phi].operands;
+    for (size_t j = 0; j < operands.size(); j++)
+      if (function.instructions[operands[j]].op == ir_phi && !used[operands[j]]) {
+        used[operands[j]] = true;
+        work.push_back(operands[j]);
+      }
+  }
+
+  // The locals and parameters have the types they were declared
+  // with, and the phis of other registers that of their operands
+  const std::vector<BaseType> &variables = builder.code->variables;
+  for (changed = true; changed;) {
+    changed = false;
+    for (size_t b = 0; b < builder.phis.size(); b++)
+      for (size_t i = 0; i < builder.phis[b].size(); i++) {
+        IrInstruction &phi = function.instructions[builder.phis[b][i]];
+        if (phi.type != bt_none)
+          continue;
+        if (phi.variable < (int) variables.size()) {
+          phi.type = variables[phi.variable];
+          changed = true;
+          continue;
+        }
+        for (size_t j = 0; j < phi.operands.size(); j++)
+          if (function.instructions[phi.operands[j]].type != bt_none) {
+            phi.type = function.instructions[phi.operands[j]].type;
+            changed = true;
+            break;
+          }
+      }
+  }
+
+  for (size_t b = 0; b < builder.phis.size(); b++) {
+    std::vector<int> phis;
+    for (size_t i = 0; i < builder.phis[b].size(); i++)
+      if (replacement[builder.phis[b][i]] < 0 && used[builder.phis[b][i]])
+        phis.push_back(builder.phis[b][i]);
+    std::vector<int> &instructions = function.blocks[b].instructions;
+    instructions.insert(instructions.begin(), phis.begin(), phis.end());
+  }
+}
+
+// Builds the IR of a function from its bytecode.
+void buildFunction(const Bytecode &bytecode, int number, IrFunction &function) {
+  const Function &code = bytecode.functions[number];
+  function.number = number;
+  std::vector<CodeBlock> blocks;
+  splitCode(code, blocks);
+  std::vector<int> origin;
+  layOut(function, blocks, origin);
+
+  Builder builder;
+  builder.code = &code;
+  builder.function = &function;
+  builder.definitions.resize(function.blocks.size());
+  builder.incomplete.resize(function.blocks.size());
+  builder.phis.resize(function.blocks.size());
+  builder.built.assign(function.blocks.size(), 0);
+  builder.sealed.assign(function.blocks.size(), false);
+  builder.sealed[0] = true;
+
+  // The object and the parameters arrive in the first registers,
+  // and the locals start out 0
+  for (int i = 0; i < code.parameters; i++)
+    writeVariable(builder, 0, i, append(builder, 0, ir_parameter, code.variables[i], i, i));
+  for (int i = code.parameters; i < code.parameters + code.locals; i++)
+    writeVariable(builder, 0, i, append(builder, 0, ir_constant, code.variables[i], 0, i));
+
+  // A block is sealed once all its predecessors have been built,
+  // when no more of them can find a variable unwritten
+  for (size_t b = 0; b < function.blocks.size(); b++) {
+    if (origin[b] >= 0) {
+      const CodeBlock &block = blocks[origin[b]];
+      for (size_t i = block.start; i + 1 < block.end; i++)
+        translateInstruction(builder, b, code.code[i]);
+      const Instruction &last = code.code[block.end - 1];
+      if (operandsOf(last.op).b == o_target || operandsOf(last.op).c == o_target || last.op == op_return ||
+          last.op == op_returnNone)
+        terminate(builder, b, last);
+      else {
+        translateInstruction(builder, b, last);
+        append(builder, b, ir_jump);
+      }
+    } else {
+      append(builder, b, ir_jump);
+    }
+    const std::vector<int> &successors = function.blocks[b].successors;
+    for (size_t i = 0; i < successors.size(); i++)
+      if (++builder.built[successors[i]] == (int) function.blocks[successors[i]].predecessors.size())
+        seal(builder, successors[i]);
+  }
+  simplifyPhis(builder);
+}
+
+void buildIr(const Bytecode &bytecode, std::vector<IrFunction> &functions) {
+  functions.resize(bytecode.functions.size());
+  for (size_t i = 0; i < bytecode.functions.size(); i++)
+    buildFunction(bytecode, i, functions[i]);
+}
+
+// Returns the blocks of a function reachable from the entry in
+// reverse postorder.
+void reversePostorder(const IrFunction &function, std::vector<int> &order) {
+  std::vector<bool> visited(function.blocks.size(), false);
+  std::vector<std::pair<int, size_t> > stack(1, std::make_pair(0, 0));
+  visited[0] = true;
+  while (!stack.empty()) {
+    int block = stack.back().first;
+    size_t &next = stack.back().second;
+    const std::vector<int> &successors = function.blocks[block].successors;
+    if (next < successors.size()) {
+      int successor = successors[next++];
+      if (!visited[successor]) {
+        visited[successor] = true;
+        stack.push_back(std::make_pair(successor, 0));
+      }
+      continue;
+    }
+    order.push_back(block);
+    stack.pop_back();
+  }
+  std::reverse(order.begin(), order.end());
+}
+
+// Finds the immediate dominators as Cooper, Harvey and Kennedy do,
+// walking up from the two predecessors until they meet.
+void dominators(const IrFunction &function, std::vector<int> &idom) {
+  std::vector<int> order;
+  reversePostorder(function, order);
+  std::vector<int> rank(function.blocks.size(), -1);
+  for (size_t i = 0; i < order.size(); i++)
+    rank[order[i]] = i;
+  idom.assign(function.blocks.size(), -1);
+  idom[0] = 0;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 1; i < order.size(); i++) {
+      const std::vector<int> &predecessors = function.blocks[order[i]].predecessors;
+      int dominator = -1;
+      for (size_t j = 0; j < predecessors.size(); j++) {
+        int other = predecessors[j];
+        if (rank[other] < 0 || idom[other] < 0)
+          continue;
+        if (dominator < 0) {
+          dominator = other;
+          continue;
+        }
+        while (dominator != other) {
+          while (rank[dominator] > rank[other])
+            dominator = idom[dominator];
+          while (rank[other] > rank[dominator])
+            other = idom[other];
+        }
+      }
+      if (idom[order[i]] != dominator) {
+        idom[order[i]] = dominator;
+        changed = true;
+      }
+    }
+  }
+  idom[0] = -1;
+}
+
+bool dominates(const std::vector<int> &idom, int a, int b) {
+  for (; b >= 0; b = idom[b])
+    if (b == a)
+      return true;
+  return false;
+}
+
+// A loop is made of the edges back to a block from blocks it
+// dominates, and the blocks that reach them without passing it.
+void findLoops(const IrFunction &function, const std::vector<int> &idom, std::vector<IrLoop> &loops) {
+  for (size_t header = 0; header < function.blocks.size(); header++) {
+    IrLoop loop;
+    loop.header = header;
+    loop.blocks.assign(function.blocks.size(), false);
+    std::vector<int> work;
+    const std::vector<int> &predecessors = function.blocks[header].predecessors;
+    for (size_t i = 0; i < predecessors.size(); i++)
+      if (dominates(idom, header, predecessors[i])) {
+        loop.latches.push_back(predecessors[i]);
+        if (!loop.blocks[predecessors[i]]) {
+          loop.blocks[predecessors[i]] = true;
+          work.push_back(predecessors[i]);
+        }
+      }
+    if (work.empty())
+      continue;
+    loop.blocks[header] = true;
+    while (!work.empty()) {
+      int block = work.back();
+      work.pop_back();
+      if (block == (int) header)
+        continue;
+      for (size_t i = 0; i < function.blocks[block].predecessors.size(); i++) {
+        int predecessor = function.blocks[block].predecessors[i];
+        if (!loop.blocks[predecessor]) {
+          loop.blocks[predecessor] = true;
+          work.push_back(predecessor);
+        }
+      }
+    }
+    loop.size = std::count(loop.blocks.begin(), loop.blocks.end(), true);
+    loops.push_back(loop);
+  }
+}
+
+void loopDepths(const IrFunction &function, std::vector<int> &depth) {
+  std::vector<int> idom;
+  dominators(function, idom);
+  std::vector<IrLoop> loops;
+  findLoops(function, idom, loops);
+  depth.assign(function.blocks.size(), 0);
+  for (size_t i = 0; i < loops.size(); i++)
+    for (size_t b = 0; b < function.blocks.size(); b++)
+      if (loops[i].blocks[b])
+        depth[b]++;
+}
+
+bool invalid(std::string &error, int block, int value, const char *problem) {
+  std::ostringstream out;
+  out << "b" << block;
+  if (value >= 0)
+    out << ": v" << value;
+  out << ": " << problem;
+  error = out.str();
+  return false;
+}
+
+// Returns the number of operands an instruction with the opcode
+// takes, or -1 if it takes any number.
+int operandCount(IrOpcode op) {
+  switch (op) {
+    case ir_parameter:
+    case ir_constant:
+    case ir_new:
+    case ir_jump:
+    case ir_returnNone:
+      return 0;
+    case ir_not:
+    case ir_negate:
+    case ir_getField:
+    case ir_checkClass:
+    case ir_checkObject:
+    case ir_print:
+    case ir_branch:
+    case ir_return:
+      return 1;
+    case ir_call:
+    case ir_callDirect:
+    case ir_callMethod:
+    case ir_phi:
+      return -1;
+    default:
+      return 2;
+  }
+}
+
+// Returns the problem with the types of an instruction, or NULL.
+const char *typeProblem(const IrFunction &function, const IrInstruction &instruction) {
+  std::vector<BaseType> types;
+  for (size_t i = 0; i < instruction.operands.size(); i++)
+    types.push_back(function.instructions[instruction.operands[i]].type);
+  switch (instruction.op) {
+    case ir_add:
+    case ir_subtract:
+    case ir_multiply:
+    case ir_divide:
+    case ir_negate:
+    case ir_less:
+    case ir_lessEqual:
+    case ir_branchLess:
+    case ir_branchLessEqual:
+      for (size_t i = 0; i < types.size(); i++)
+        if (types[i] != bt_integer)
+          return "takes integers";
+      break;
+    case ir_and:
+    case ir_or:
+    case ir_not:
+    case ir_branch:
+      for (size_t i = 0; i < types.size(); i++)
+        if (types[i] != bt_boolean)
+          return "takes booleans";
+      break;
+    case ir_equal:
+    case ir_branchEqual:
+      if (types[0] != types[1])
+        return "compares values of different types";
+      break;
+    case ir_getField:
+    case ir_setField:
+    case ir_checkClass:
+    case ir_checkObject:
+    case ir_call:
+    case ir_callDirect:
+    case ir_callMethod:
+      if (types.empty() || types[0] != bt_object)
+        return "takes an object";
+      break;
+    case ir_print:
+      if (types[0] != bt_integer && types[0] != bt_boolean)
+        return "prints neither an integer nor a boolean";
+      break;
+    case ir_phi:
+      for (size_t i = 0; i < types.size(); i++)
+        if (types[i] != instruction.type)
+          return "chooses between values of different types";
+      break;
+    default:
+      break;
+  }
+  return NULL;
+}
+
+bool verify(const IrFunction &function, std::string &error) {
+  const std::vector<IrBlock> &blocks = function.blocks;
+  if (blocks.empty() || !blocks[0].predecessors.empty())
+    return invalid(error, 0, -1, "the entry has predecessors");
+
+  // Where each value is defined
+  std::vector<int> block(function.instructions.size(), -1);
+  std::vector<int> index(function.instructions.size(), -1);
+  std::vector<std::pair<int, int> > edges, reverseEdges;
+  for (size_t b = 0; b < blocks.size(); b++) {
+    const std::vector<int> &instructions = blocks[b].instructions;
+    if (instructions.empty())
+      return invalid(error, b, -1, "is empty");
+    for (size_t i = 0; i < instructions.size(); i++) {
+      int value = instructions[i];
+      if (value < 0 || value >= (int) function.instructions.size())
+        return invalid(error, b, value, "is no instruction");
+      if (block[value] >= 0)
+        return invalid(error, b, value, "is in two places");
+      block[value] = b;
+      index[value] = i;
+      IrOpcode op = function.instructions[value].op;
+      if (op == ir_phi && i > 0 && function.instructions[instructions[i - 1]].op != ir_phi)
+        return invalid(error, b, value, "is a phi after an instruction that is not");
+      if (isTerminator(op) != (i + 1 == instructions.size()))
+        return invalid(error, b, value, "ends its block or does not");
+    }
+    IrOpcode last = function.instructions[instructions.back()].op;
+    size_t successors = last == ir_jump ? 1 : last == ir_return || last == ir_returnNone ? 0 : 2;
+    if (blocks[b].successors.size() != successors)
+      return invalid(error, b, -1, "has successors its end does not go to");
+    for (size_t i = 0; i < successors; i++) {
+      int successor = blocks[b].successors[i];
+      if (successor < 0 || successor >= (int) blocks.size())
+        return invalid(error, b, -1, "goes to no block");
+      if (successors > 1 && blocks[successor].predecessors.size() > 1)
+        return invalid(error, b, -1, "has a critical edge");
+      edges.push_back(std::make_pair(b, successor));
+    }
+    for (size_t i = 0; i < blocks[b].predecessors.size(); i++)
+      reverseEdges.push_back(std::make_pair(blocks[b].predecessors[i], b));
+  }
+  std::sort(edges.begin(), edges.end());
+  std::sort(reverseEdges.begin(), reverseEdges.end());
+  if (edges != reverseEdges)
+    return invalid(error, 0, -1, "predecessors and successors disagree");
+
+  std::vector<int> idom;
+  dominators(function, idom);
+  for (size_t b = 1; b < blocks.size(); b++)
+    if (idom[b] < 0)
+      return invalid(error, b, -1, "cannot be reached");
+
+  for (size_t b = 0; b < blocks.size(); b++) {
+    const std::vector<int> &instructions = blocks[b].instructions;
+    for (size_t i = 0; i < instructions.size(); i++) {
+      const IrInstruction &instruction = function.instructions[instructions[i]];
+      int count = operandCount(instruction.op);
+      if (instruction.op == ir_phi) {
+        if (instruction.operands.size() != blocks[b].predecessors.size())
+          return invalid(error, b, instructions[i], "has an operand for other than each predecessor");
+        for (size_t j = 0; j < blocks[b].predecessors.size(); j++)
+          if (blocks[blocks[b].predecessors[j]].successors.size() != 1)
+            return invalid(error, b, instructions[i], "has a predecessor that branches");
+      } else if (count >= 0 ? (int) instruction.operands.size() != count : instruction.operands.empty()) {
+        return invalid(error, b, instructions[i], "has the wrong number of operands");
+      }
+      for (size_t j = 0; j < instruction.operands.size(); j++) {
+        int operand = instruction.operands[j];
+        if (operand < 0 || operand >= (int) function.instructions.size() || block[operand] < 0)
+          return invalid(error, b, instructions[i], "uses a value no block defines");
+        if (function.instructions[operand].type == bt_none)
+          return invalid(error, b, instructions[i], "uses an instruction that gives no value");
+        // The operands of a phi are used at the end of the
+        // predecessors they come from
+        int user = instruction.op == ir_phi ? blocks[b].predecessors[j] : b;
+        bool before = block[operand] == user ? instruction.op == ir_phi || index[operand] < (int) i
+                                             : dominates(idom, block[operand], user);
+        if (!before)
+          return invalid(error, b, instructions[i], "uses a value not defined on every path to it");
+      }
+      const char *problem = typeProblem(function, instruction);
+      if (problem)
+        return invalid(error, b, instructions[i], problem);
+    }
+  }
+  return true;
+}
+
+// Prints an instruction, with its value if it has one.
+void printInstruction(std::ostream &out, const SymbolInterner &symbols, const Bytecode &bytecode,
+                      const IrFunction &function, const IrBlock &block, int value) {
+  static const char *typeNames[] = {"integer", "boolean", "none", "object", "error"};
+  const IrInstruction &instruction = function.instructions[value];
+  out << "    ";
+  if (instruction.type != bt_none)
+    out << "v" << value << ": " << typeNames[instruction.type] << " = ";
+  out << irOpcodeName(instruction.op);
+  const char *separator = " ";
+  switch (instruction.op) {
+    case ir_parameter:
+    case ir_constant:
+      out << " " << instruction.immediate;
+      separator = ", ";
+      break;
+    case ir_checkClass:
+    case ir_new:
+      out << " " << symbols.name(bytecode.classes[instruction.immediate].name);
+      separator = ", ";
+      break;
+    case ir_call:
+    case ir_callDirect:
+      out << " " << symbols.name(bytecode.functions[instruction.immediate].className) << "."
+          << symbols.name(bytecode.functions[instruction.immediate].name);
+      separator = ", ";
+      break;
+    case ir_callMethod:
+      out << " slot " << instruction.immediate;
+      separator = ", ";
+      break;
+    default:
+      break;
+  }
+  for (size_t i = 0; i < instruction.operands.size(); i++) {
+    out << separator << "v" << instruction.operands[i];
+    if (instruction.op == ir_phi)
+      out << " (b" << block.predecessors[i] << ")";
+    separator = ", ";
+  }
+  if (instruction.op == ir_getField || instruction.op == ir_setField)
+    out << ", +" << instruction.immediate;
+  for (size_t i = 0; isTerminator(instruction.op) && i < block.successors.size(); i++) {
+    out << separator << "b" << block.successors[i];
+    separator = ", ";
+  }
+  out << std::endl;
+}
+
+void printIr(std::ostream &out, const SymbolInterner &symbols, const Bytecode &bytecode,
+             const std::vector<IrFunction> &functions) {
+  for (size_t f = 0; f < functions.size(); f++) {
+    const IrFunction &function = functions[f];
+    const Function &code = bytecode.functions[function.number];
+    out << symbols.name(code.className) << "." << symbols.name(code.name) << ": parameters " << code.parameters
+        << ", blocks " << function.blocks.size() << std::endl;
+    for (size_t b = 0; b < function.blocks.size(); b++) {
+      const IrBlock &block = function.blocks[b];
+      out << "  b" << b << ":";
+      for (size_t i = 0; i < block.predecessors.size(); i++)
+        out << (i ? ", b" : " from b") << block.predecessors[i];
+      out << std::endl;
+      for (size_t i = 0; i < block.instructions.size(); i++)
+        printInstruction(out, symbols, bytecode, function, block, block.instructions[i]);
+    }
+  }
+}
@@ -0,0 +1,149 @@
+#ifndef __IR_HPP
+#define __IR_HPP
+
+#include "bytecode.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Defines the typed SSA form native code is generated from: the
+// executables of -o and the assembly of -S, but not the code the
+// JIT of --run compiles from the bytecode, so the passes over it
+// (replacing objects and optimizing loops) apply to those only. A
+// function is a graph of basic blocks, built from the bytecode of
+// its method body, whose jumps are the if, while and repeat
+// statements of the body. Every instruction that gives a value
+// defines a value of its own, named after the index of the
+// instruction, which is never assigned again; where the values of a
+// variable from different predecessors meet, a phi at the start of
+// the block picks the one of the predecessor control came from.
+// Moves are gone: a move makes the variable it writes name the
+// value it reads. Constants are instructions of the entry block or
+// of the block that needs them, and cost nothing at run time. A
+// member is read and written as a byte when it is a boolean, which
+// the type of getField and of the value setField sets tell.
+//
+// Every block ends with exactly one jump, branch or return. No
+// edge leads from a block with two successors to a block with two
+// predecessors, so the moves of the phis of a block can be made at
+// the end of each predecessor.
+
+// The opcodes. In the comments, the operands of an instruction are
+// v0, v1 and on, and n is its immediate.
+#define IR_OPCODES(X)                                                    \
+  X(parameter)       /* the parameter numbered n, 0 being the object */ \
+  X(constant)        /* n */                                             \
+  X(add)             /* v0 + v1 */                                       \
+  X(subtract)        /* v0 - v1 */                                       \
+  X(multiply)        /* v0 * v1 */                                       \
+  X(divide)          /* v0 / v1, failing if v1 is 0 */                   \
+  X(less)            /* v0 < v1 */                                       \
+  X(lessEqual)       /* v0 <= v1 */                                      \
+  X(equal)           /* v0 == v1 */                                      \
+  X(and)             /* v0 and v1 */                                     \
+  X(or)              /* v0 or v1 */                                      \
+  X(not)             /* not v0 */                                        \
+  X(negate)          /* -v0 */                                           \
+  X(getField)        /* the member of object v0 at offset n */           \
+  X(setField)        /* the member of object v0 at offset n = v1 */      \
+  X(checkClass)      /* fail unless v0 is none or of class n */          \
+  X(checkObject)     /* fail if v0 is none */                            \
+  X(new)             /* a new object of class n */                       \
+  X(call)            /* function n, passing the operands */              \
+  X(callDirect)      /* the same, failing if v0 is none */               \
+  X(callMethod)      /* the method in slot n of the class of v0, */      \
+                     /* passing the operands, failing if v0 is none */   \
+  X(print)           /* print v0 */                                      \
+  X(phi)             /* the operand of the predecessor control came */   \
+                     /* from, in the order of the predecessors */        \
+  X(jump)            /* continue at the successor */                     \
+  X(branch)          /* continue at the first successor if v0, */        \
+                     /* else at the second */                            \
+  X(branchLess)      /* the same, if v0 < v1 */                          \
+  X(branchLessEqual) /* the same, if v0 <= v1 */                         \
+  X(branchEqual)     /* the same, if v0 == v1 */                         \
+  X(return)          /* return v0 */                                     \
+  X(returnNone)      /* return nothing */
+
+#define IR_OPCODE_ENUM(name) ir_##name,
+typedef enum : unsigned char { IR_OPCODES(IR_OPCODE_ENUM) ir_opcodes } IrOpcode;
+#undef IR_OPCODE_ENUM
+
+// Returns the name of an opcode, as the IR is printed with it.
+const char *irOpcodeName(IrOpcode opcode);
+
+// Returns true if an instruction with the opcode ends its block, or
+// calls out of the function.
+bool isTerminator(IrOpcode opcode);
+bool isCall(IrOpcode opcode);
+
+// Defines an instruction: its opcode, the base type of its value,
+// bt_none if it gives none, its immediate and its operands, which
+// are the values of other instructions. The variable is the
+// register of the bytecode the value was written to, or -1.
+typedef struct irinstruction {
+  IrOpcode op;
+  BaseType type;
+  int immediate;
+  int variable;
+  std::vector<int> operands;
+} IrInstruction;
+
+// Defines a basic block: its instructions, phis first and the jump,
+// branch or return last, and the blocks control comes from and goes
+// to. A branch goes to the first successor when its condition holds.
+typedef struct irblock {
+  std::vector<int> instructions;
+  std::vector<int> predecessors;
+  std::vector<int> successors;
+} IrBlock;
+
+// Defines the IR of a function. Instructions are numbered in the
+// order they were made, and those no block holds any more are dead.
+// Block 0 is the entry, and blocks are laid out in their order.
+typedef struct irfunction {
+  int number;
+  std::vector<IrInstruction> instructions;
+  std::vector<IrBlock> blocks;
+} IrFunction;
+
+// Builds the IR of every function of a lowered program.
+void buildIr(const Bytecode &bytecode, std::vector<IrFunction> &functions);
+
+// Checks that a function is well formed: that every block ends as it
+// should and its edges agree with its predecessors, that no edge is
+// critical, that every value is defined once, before it is used on
+// every path, and that the types of operands are those their
+// instructions take. Returns false, with what is wrong in error,
+// if not. Passes over the IR keep it well formed, so that each can
+// be checked on its own.
+bool verify(const IrFunction &function, std::string &error);
+
+// Prints the IR of every function, for lang --ir.
+void printIr(std::ostream &out, const SymbolInterner &symbols, const Bytecode &bytecode,
+             const std::vector<IrFunction> &functions);
+
+// Computes the immediate dominator of every block of a function,
+// -1 for the entry, and returns true if block a dominates block b.
+void dominators(const IrFunction &function, std::vector<int> &idom);
+bool dominates(const std::vector<int> &idom, int a, int b);
+
+// Defines a loop: its header, which dominates every block in it, the
+// blocks in it, the blocks in it that jump back to the header, and
+// how many blocks it has.
+typedef struct irloop {
+  int header;
+  std::vector<bool> blocks;
+  std::vector<int> latches;
+  int size;
+} IrLoop;
+
+// Finds the loops of a function, one for each block that blocks it
+// dominates jump back to.
+void findLoops(const IrFunction &function, const std::vector<int> &idom, std::vector<IrLoop> &loops);
+
+// Counts for every block the loops it is in.
+void loopDepths(const IrFunction &function, std::vector<int> &depth);
+
+#endif
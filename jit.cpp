@@ -0,0 +1,761 @@
+#include "jit.hpp"
+#include "vm.hpp"
+
+#ifdef __x86_64__
+
+#include "frames.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+// The bytes of address space compiled code may take, and of the
+// stack it runs on: a frame takes 16 bytes of it, and what runs
+// below the deepest frame, the collector and the compiler, takes
+// less than the rest.
+const size_t codeReserve = 1 << 26;
+const size_t nativeStackSize = stackRegisters * 16 + (1 << 20);
+
+// The registers of x86-64, numbered as instructions number them.
+// While compiled code runs, %rbx is the frame, %r12 the base of the
+// heap, %r13 the top of the call records, %r14 the table of the
+// code of every function, %r15 the end of the registers of all
+// frames and %rbp the context; the others are free.
+enum {
+  x_rax, x_rcx, x_rdx, x_rbx, x_rsp, x_rbp, x_rsi, x_rdi,
+  x_r8, x_r9, x_r10, x_r11, x_r12, x_r13, x_r14, x_r15
+};
+
+// The conditions of jumps and sets, as instructions number them
+enum { c_below = 2, c_aboveEqual = 3, c_equal = 4, c_notEqual = 5, c_above = 7,
+       c_less = 12, c_greaterEqual = 13, c_lessEqual = 14, c_greater = 15 };
+
+// The runtime errors, with the VM's messages
+enum { f_division, f_accessed, f_assigned, f_called, f_mismatch, f_overflow, f_memory, f_failures };
+
+const char *failureMessages[f_failures] = {
+    "division by zero",
+    "member of none accessed",
+    "member of none assigned",
+    "method called on none",
+    "object used as an object of a class it is not of",
+    "stack overflow",
+    "out of memory",
+};
+
+class Jit;
+
+// Defines what compiled code finds at fixed offsets from %rbp, and
+// what the routines it calls are given first: where to go back to
+// once the program returns or fails, the values of the registers it
+// keeps, and the error it failed with.
+typedef struct context {
+  void *savedStack;
+  void *stackTop;
+  char *heapBase;
+  CallRecord *calls;
+  void **entries;
+  int *stackEnd;
+  int failure;
+  Jit *jit;
+} Context;
+
+// Defines machine code being written.
+typedef struct assembler {
+  std::vector<unsigned char> bytes;
+
+  size_t size() const { return bytes.size(); }
+  void byte(int value) { bytes.push_back(value); }
+  void dword(int value) {
+    for (int i = 0; i < 4; i++)
+      byte(value >> 8 * i);
+  }
+  void qword(const void *pointer) {
+    unsigned long value = (unsigned long) pointer;
+    for (int i = 0; i < 8; i++)
+      byte(value >> 8 * i);
+  }
+  void patch(size_t at, int value) {
+    for (int i = 0; i < 4; i++)
+      bytes[at + i] = value >> 8 * i;
+  }
+} Assembler;
+
+// Writes the REX prefix of an instruction, if it needs one: for 64
+// bit operands, or registers numbered 8 and up.
+void encodePrefix(Assembler &a, bool wide, int reg, int index, int base) {
+  int prefix = 0x40 | (wide ? 8 : 0) | (reg & 8 ? 4 : 0) | (index & 8 ? 2 : 0) | (base & 8 ? 1 : 0);
+  if (prefix != 0x40)
+    a.byte(prefix);
+}
+
+void encodeOpcode(Assembler &a, int opcode) {
+  if (opcode > 0xff)
+    a.byte(opcode >> 8);
+  a.byte(opcode);
+}
+
+// Writes an instruction on a register and the memory at base plus
+// index shifted left by scale, if index is not -1, plus disp.
+void encodeMemory(Assembler &a, int opcode, bool wide, int reg, int base, int index, int scale, int disp) {
+  encodePrefix(a, wide, reg, index < 0 ? 0 : index, base);
+  encodeOpcode(a, opcode);
+  int mod = disp == 0 && (base & 7) != x_rbp ? 0 : disp >= -128 && disp < 128 ? 1 : 2;
+  if (index < 0 && (base & 7) != x_rsp) {
+    a.byte(mod << 6 | (reg & 7) << 3 | (base & 7));
+  } else {
+    a.byte(mod << 6 | (reg & 7) << 3 | 4);
+    a.byte(scale << 6 | (index < 0 ? 4 : index & 7) << 3 | (base & 7));
+  }
+  if (mod == 1)
+    a.byte(disp);
+  else if (mod == 2)
+    a.dword(disp);
+}
+
+// Writes an instruction on two registers, reg and rm.
+void encodeRegisters(Assembler &a, int opcode, bool wide, int reg, int rm) {
+  encodePrefix(a, wide, reg, 0, rm);
+  encodeOpcode(a, opcode);
+  a.byte(0xc0 | (reg & 7) << 3 | (rm & 7));
+}
+
+// Writes an instruction on a register or the register of a frame
+// and an immediate, with the opcode extension of the operation.
+void encodeImmediate(Assembler &a, int extension, bool wide, int rm, int value) {
+  bool small = value >= -128 && value < 128;
+  encodeRegisters(a, small ? 0x83 : 0x81, wide, extension, rm);
+  if (small)
+    a.byte(value);
+  else
+    a.dword(value);
+}
+
+void encodeFrameImmediate(Assembler &a, int extension, int slot, int value) {
+  bool small = value >= -128 && value < 128;
+  encodeMemory(a, small ? 0x83 : 0x81, false, extension, x_rbx, -1, 0, 4 * slot);
+  if (small)
+    a.byte(value);
+  else
+    a.dword(value);
+}
+
+void encodeMoveImmediate(Assembler &a, int reg, int value) {
+  encodePrefix(a, false, 0, 0, reg);
+  a.byte(0xb8 + (reg & 7));
+  a.dword(value);
+}
+
+void encodeMovePointer(Assembler &a, int reg, const void *pointer) {
+  encodePrefix(a, true, 0, 0, reg);
+  a.byte(0xb8 + (reg & 7));
+  a.qword(pointer);
+}
+
+void encodePush(Assembler &a, int reg) {
+  encodePrefix(a, false, 0, 0, reg);
+  a.byte(0x50 + (reg & 7));
+}
+
+void encodePop(Assembler &a, int reg) {
+  encodePrefix(a, false, 0, 0, reg);
+  a.byte(0x58 + (reg & 7));
+}
+
+// Reads a register of the frame into a machine register, or writes
+// one to it.
+void encodeLoad(Assembler &a, int reg, int slot) {
+  encodeMemory(a, 0x8b, false, reg, x_rbx, -1, 0, 4 * slot);
+}
+
+void encodeStore(Assembler &a, int slot, int reg) {
+  encodeMemory(a, 0x89, false, reg, x_rbx, -1, 0, 4 * slot);
+}
+
+// Writes a jump, taken if the condition holds unless it is -1, and
+// returns where its displacement is, to be bound to its target.
+size_t encodeJump(Assembler &a, int condition) {
+  if (condition < 0) {
+    a.byte(0xe9);
+  } else {
+    a.byte(0x0f);
+    a.byte(0x80 + condition);
+  }
+  a.dword(0);
+  return a.size() - 4;
+}
+
+// Writes a jump back to code already written.
+void encodeJumpTo(Assembler &a, size_t target) {
+  size_t at = encodeJump(a, -1);
+  a.patch(at, target - a.size());
+}
+
+// Points the jump whose displacement is at a position here.
+void bindJump(Assembler &a, size_t at) {
+  a.patch(at, a.size() - (at + 4));
+}
+
+// Calls a routine of the JIT with the context as its first argument,
+// keeping the stack aligned as the ABI wants it: every frame takes
+// 16 bytes, the return address and 8 bytes under it.
+void encodeHelperCall(Assembler &a, const void *routine) {
+  encodeRegisters(a, 0x89, true, x_rbp, x_rdi);
+  encodeMovePointer(a, x_rax, routine);
+  encodeRegisters(a, 0xff, false, 2, x_rax);
+}
+
+// Defines a compiled program: the code of the functions compiled so
+// far, the routines it enters and leaves through, and the state of
+// the running program the VM keeps as well.
+class Jit {
+public:
+  Jit(const Bytecode &bytecode, Emitter &out);
+  ~Jit();
+
+  // Returns false if the memory of the program could not be mapped,
+  // or the code that enters it made executable.
+  bool ready() const { return code != NULL && enter != NULL && heap.reserved(); }
+
+  // Runs a function whose frame starts at frame until it returns.
+  bool run(int function, int *frame);
+
+  // Compiles a function, and points the calls of the program at its
+  // code, which is returned, or NULL if there is no room for it.
+  void *compile(int function);
+
+  const Bytecode &bytecode;
+  Emitter &out;
+  Heap heap;
+  int *stack;
+  std::vector<StackMap> stackMaps;
+  Context context;
+  // Cleared once code could not be made executable
+  bool executable;
+
+private:
+  Jit(const Jit &);
+  Jit &operator=(const Jit &);
+
+  // Compiles one instruction, or everything a method does on entry.
+  void compileInstruction(Assembler &a, int function, size_t index);
+  void compileEntry(Assembler &a, const Function &function);
+  void compileCall(Assembler &a, int function, size_t index);
+  void compileNew(Assembler &a, int function, size_t index);
+  void compileSetField(Assembler &a, const Instruction &instruction, bool byte);
+
+  // Copies code into the code of the program, makes it executable
+  // and returns where it is, or NULL if there is no room for it.
+  unsigned char *place(const Assembler &a);
+  bool protect(size_t from, size_t to, int protection);
+
+  unsigned char *code;
+  size_t used;
+  CallRecord *calls;
+  char *nativeStack;
+  std::vector<void *> entries;
+  // The function of each slot of the virtual table of each class, a
+  // row of slots for each
+  std::vector<int> methods;
+  int slots;
+
+  unsigned char *enter;
+  unsigned char *fail;
+  unsigned char *compileStub;
+
+  // While a function is compiled, the jumps to its instructions and
+  // to each of its failures
+  std::vector<std::pair<size_t, int> > jumps;
+  std::vector<size_t> failures[f_failures];
+};
+
+void *compileFunction(Context *context, int function) {
+  return context->jit->compile(function);
+}
+
+int allocateObject(Context *context, int classNumber, int function, const Instruction *pc, int *frame,
+                   CallRecord *top) {
+  Jit &jit = *context->jit;
+  FrameRoots roots(jit.bytecode, jit.stackMaps, context->calls, top - context->calls,
+                   &jit.bytecode.functions[function], pc, frame);
+  return jit.heap.allocate(classNumber, roots);
+}
+
+void rememberObject(Context *context, int object, int value) {
+  context->jit->heap.remember(object, value);
+}
+
+void printValue(Context *context, int value) {
+  context->jit->out << (long) value << "\n";
+}
+
+Jit::Jit(const Bytecode &bytecode, Emitter &out)
+    : bytecode(bytecode), out(out), heap(bytecode.classes), executable(true), code(NULL), used(0), calls(NULL),
+      nativeStack(NULL), slots(1), enter(NULL) {
+  stack = (int *) calloc(stackRegisters, sizeof(int));
+  StackMap unbuilt;
+  unbuilt.built = false;
+  stackMaps.assign(bytecode.functions.size(), unbuilt);
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+  void *codeMemory = mmap(NULL, codeReserve, PROT_READ | PROT_WRITE, flags, -1, 0);
+  void *callMemory = mmap(NULL, stackRegisters * sizeof(CallRecord), PROT_READ | PROT_WRITE, flags, -1, 0);
+  void *stackMemory = mmap(NULL, nativeStackSize, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (codeMemory != MAP_FAILED)
+    code = (unsigned char *) codeMemory;
+  if (callMemory != MAP_FAILED)
+    calls = (CallRecord *) callMemory;
+  if (stackMemory != MAP_FAILED)
+    nativeStack = (char *) stackMemory;
+  if (!stack || !code || !calls || !nativeStack) {
+    if (code)
+      munmap(code, codeReserve);
+    code = NULL;
+    return;
+  }
+
+  for (size_t i = 0; i < bytecode.classes.size(); i++)
+    if ((int) bytecode.classes[i].methods.size() > slots)
+      slots = bytecode.classes[i].methods.size();
+  methods.assign(bytecode.classes.size() * slots, 0);
+  for (size_t i = 0; i < bytecode.classes.size(); i++)
+    for (size_t j = 0; j < bytecode.classes[i].methods.size(); j++)
+      methods[i * slots + j] = bytecode.classes[i].methods[j];
+
+  Assembler a;
+  // Enters the code at %rsi with the context at %rdi and the frame
+  // at %rdx on the stack of the program, returning 1 once it
+  // returns, or 0 once it fails, with the failure in the context
+  size_t enterAt = a.size();
+  int saved[] = {x_rbx, x_rbp, x_r12, x_r13, x_r14, x_r15};
+  for (int i = 0; i < 6; i++)
+    encodePush(a, saved[i]);
+  encodeMemory(a, 0x89, true, x_rsp, x_rdi, -1, 0, offsetof(Context, savedStack));
+  encodeMemory(a, 0x8b, true, x_rsp, x_rdi, -1, 0, offsetof(Context, stackTop));
+  encodeRegisters(a, 0x89, true, x_rdi, x_rbp);
+  encodeRegisters(a, 0x89, true, x_rdx, x_rbx);
+  encodeMemory(a, 0x8b, true, x_r12, x_rbp, -1, 0, offsetof(Context, heapBase));
+  encodeMemory(a, 0x8b, true, x_r13, x_rbp, -1, 0, offsetof(Context, calls));
+  encodeMemory(a, 0x8b, true, x_r14, x_rbp, -1, 0, offsetof(Context, entries));
+  encodeMemory(a, 0x8b, true, x_r15, x_rbp, -1, 0, offsetof(Context, stackEnd));
+  encodeRegisters(a, 0xff, false, 2, x_rsi);
+  encodeMoveImmediate(a, x_rax, 1);
+  size_t leave = a.size();
+  encodeMemory(a, 0x8b, true, x_rsp, x_rbp, -1, 0, offsetof(Context, savedStack));
+  for (int i = 5; i >= 0; i--)
+    encodePop(a, saved[i]);
+  a.byte(0xc3);
+
+  // Fails with the failure in %esi, from anywhere in the program
+  size_t failAt = a.size();
+  encodeMemory(a, 0x89, false, x_rsi, x_rbp, -1, 0, offsetof(Context, failure));
+  encodeRegisters(a, 0x31, false, x_rax, x_rax);
+  encodeJumpTo(a, leave);
+
+  // Compiles the function numbered %eax, called through its stub,
+  // and goes on to its code
+  size_t compileAt = a.size();
+  encodeImmediate(a, 5, true, x_rsp, 8);
+  encodeRegisters(a, 0x89, true, x_rbp, x_rdi);
+  encodeRegisters(a, 0x89, false, x_rax, x_rsi);
+  encodeMovePointer(a, x_rax, (const void *) compileFunction);
+  encodeRegisters(a, 0xff, false, 2, x_rax);
+  encodeImmediate(a, 0, true, x_rsp, 8);
+  encodeRegisters(a, 0x85, true, x_rax, x_rax);
+  size_t compiled = encodeJump(a, c_notEqual);
+  encodeMoveImmediate(a, x_rsi, f_memory);
+  encodeJumpTo(a, failAt);
+  bindJump(a, compiled);
+  encodeRegisters(a, 0xff, false, 4, x_rax);
+
+  // The stub of every function
+  std::vector<size_t> stubs;
+  for (size_t i = 0; i < bytecode.functions.size(); i++) {
+    stubs.push_back(a.size());
+    encodeMoveImmediate(a, x_rax, i);
+    encodeJumpTo(a, compileAt);
+  }
+
+  unsigned char *start = place(a);
+  if (!start)
+    return;
+  enter = start + enterAt;
+  fail = start + failAt;
+  compileStub = start + compileAt;
+  for (size_t i = 0; i < stubs.size(); i++)
+    entries.push_back(start + stubs[i]);
+
+  context.stackTop = nativeStack + nativeStackSize;
+  context.heapBase = heap.base;
+  context.calls = calls;
+  context.entries = entries.empty() ? NULL : &entries[0];
+  context.stackEnd = stack + stackRegisters;
+  context.failure = -1;
+  context.jit = this;
+}
+
+Jit::~Jit() {
+  free(stack);
+  if (code)
+    munmap(code, codeReserve);
+  if (calls)
+    munmap(calls, stackRegisters * sizeof(CallRecord));
+  if (nativeStack)
+    munmap(nativeStack, nativeStackSize);
+}
+
+bool Jit::protect(size_t from, size_t to, int protection) {
+  size_t page = sysconf(_SC_PAGESIZE);
+  from = from / page * page;
+  return mprotect(code + from, to - from, protection) == 0;
+}
+
+unsigned char *Jit::place(const Assembler &a) {
+  size_t at = (used + 15) & ~(size_t) 15;
+  if (at + a.size() > codeReserve)
+    return NULL;
+  if (!protect(used, at + a.size(), PROT_READ | PROT_WRITE))
+    return NULL;
+  memcpy(code + at, &a.bytes[0], a.size());
+  // Where the system keeps memory that was written from being
+  // executed, no more code can run, and the code before it, which
+  // shares its first page, is given back what it had
+  if (!protect(used, at + a.size(), PROT_READ | PROT_EXEC)) {
+    protect(used, used, PROT_READ | PROT_EXEC);
+    executable = false;
+    return NULL;
+  }
+  used = at + a.size();
+  return code + at;
+}
+
+bool Jit::run(int function, int *frame) {
+  typedef int (*Enter)(Context *, void *, int *);
+  return ((Enter) enter)(&context, entries[function], frame);
+}
+
+// Checks that the frame fits in the registers of all frames, and
+// zeroes the locals.
+void Jit::compileEntry(Assembler &a, const Function &function) {
+  encodeImmediate(a, 5, true, x_rsp, 8);
+  encodeMemory(a, 0x8d, true, x_rax, x_rbx, -1, 0, 4 * function.registers);
+  encodeRegisters(a, 0x39, true, x_r15, x_rax);
+  failures[f_overflow].push_back(encodeJump(a, c_above));
+  if (function.locals <= 8) {
+    for (int i = 0; i < function.locals; i++) {
+      encodeMemory(a, 0xc7, false, 0, x_rbx, -1, 0, 4 * (function.parameters + i));
+      a.dword(0);
+    }
+  } else {
+    encodeMemory(a, 0x8d, true, x_rdi, x_rbx, -1, 0, 4 * function.parameters);
+    encodeRegisters(a, 0x31, false, x_rax, x_rax);
+    encodeMoveImmediate(a, x_rcx, function.locals);
+    a.byte(0xf3);
+    a.byte(0xab);
+  }
+}
+
+// Records the call, for the collector, calls the function or the
+// method, and writes the value it returns.
+void Jit::compileCall(Assembler &a, int function, size_t index) {
+  const Function &caller = bytecode.functions[function];
+  const Instruction &instruction = caller.code[index];
+  if (instruction.op != op_call) {
+    encodeLoad(a, x_rax, instruction.c);
+    encodeRegisters(a, 0x85, false, x_rax, x_rax);
+    failures[f_called].push_back(encodeJump(a, c_equal));
+  }
+  encodeMovePointer(a, x_rdx, &caller);
+  encodeMemory(a, 0x89, true, x_rdx, x_r13, -1, 0, offsetof(CallRecord, function));
+  encodeMovePointer(a, x_rdx, &instruction);
+  encodeMemory(a, 0x89, true, x_rdx, x_r13, -1, 0, offsetof(CallRecord, pc));
+  encodeMemory(a, 0x89, true, x_rbx, x_r13, -1, 0, offsetof(CallRecord, frame));
+  encodeMemory(a, 0xc7, false, 0, x_r13, -1, 0, offsetof(CallRecord, target));
+  a.dword(instruction.a);
+  encodeMemory(a, 0x8d, true, x_r13, x_r13, -1, 0, sizeof(CallRecord));
+  if (instruction.op == op_callMethod) {
+    // The function is in the row of the class of the object
+    encodeMemory(a, 0x8b, false, x_rax, x_r12, x_rax, 0, 0);
+    encodeRegisters(a, 0x69, false, x_rax, x_rax);
+    a.dword(slots);
+    encodeMovePointer(a, x_rdx, &methods[0]);
+    encodeMemory(a, 0x8b, false, x_rax, x_rdx, x_rax, 2, 4 * instruction.b);
+  }
+  encodeMemory(a, 0x8d, true, x_rbx, x_rbx, -1, 0, 4 * instruction.c);
+  if (instruction.op == op_callMethod)
+    encodeMemory(a, 0xff, false, 2, x_r14, x_rax, 3, 0);
+  else
+    encodeMemory(a, 0xff, false, 2, x_r14, -1, 0, 8 * instruction.b);
+  encodeMemory(a, 0x8d, true, x_rbx, x_rbx, -1, 0, -4 * instruction.c);
+  encodeMemory(a, 0x8d, true, x_r13, x_r13, -1, 0, -(int) sizeof(CallRecord));
+  if (instruction.type != bt_none)
+    encodeStore(a, instruction.a, x_rax);
+}
+
+// Allocates from the nursery as the heap does, and calls the heap
+// when it is full.
+void Jit::compileNew(Assembler &a, int function, size_t index) {
+  const Instruction &instruction = bytecode.functions[function].code[index];
+  int next = (char *) &heap.next - (char *) &heap;
+  int limit = (char *) &heap.limit - (char *) &heap;
+  encodeMovePointer(a, x_rdx, &heap);
+  encodeMemory(a, 0x8b, false, x_rax, x_rdx, -1, 0, next);
+  encodeMemory(a, 0x8d, false, x_rcx, x_rax, -1, 0, bytecode.classes[instruction.b].size);
+  encodeMemory(a, 0x3b, false, x_rcx, x_rdx, -1, 0, limit);
+  size_t full = encodeJump(a, c_above);
+  encodeMemory(a, 0x89, false, x_rcx, x_rdx, -1, 0, next);
+  encodeMemory(a, 0xc7, false, 0, x_r12, x_rax, 0, 0);
+  a.dword(instruction.b);
+  size_t done = encodeJump(a, -1);
+  bindJump(a, full);
+  encodeMoveImmediate(a, x_rsi, instruction.b);
+  encodeMoveImmediate(a, x_rdx, function);
+  encodeMovePointer(a, x_rcx, &instruction);
+  encodeRegisters(a, 0x89, true, x_rbx, x_r8);
+  encodeRegisters(a, 0x89, true, x_r13, x_r9);
+  encodeHelperCall(a, (const void *) allocateObject);
+  encodeRegisters(a, 0x85, false, x_rax, x_rax);
+  failures[f_memory].push_back(encodeJump(a, c_equal));
+  bindJump(a, done);
+  encodeStore(a, instruction.a, x_rax);
+}
+
+// Sets a member, remembering an old object given a value that may
+// be a young reference as the write barrier of the heap does.
+void Jit::compileSetField(Assembler &a, const Instruction &instruction, bool byte) {
+  encodeLoad(a, x_rax, instruction.a);
+  encodeRegisters(a, 0x85, false, x_rax, x_rax);
+  failures[f_assigned].push_back(encodeJump(a, c_equal));
+  encodeLoad(a, x_rcx, instruction.b);
+  encodeMemory(a, byte ? 0x88 : 0x89, false, x_rcx, x_r12, x_rax, 0, instruction.c);
+  if (byte)
+    return;
+  encodeImmediate(a, 7, false, x_rax, heap.nurseryEnd);
+  size_t young = encodeJump(a, c_below);
+  encodeMemory(a, 0x8d, false, x_rdx, x_rcx, -1, 0, -1);
+  encodeImmediate(a, 7, false, x_rdx, heap.nurseryEnd - 1);
+  size_t old = encodeJump(a, c_aboveEqual);
+  encodeRegisters(a, 0x89, false, x_rax, x_rsi);
+  encodeRegisters(a, 0x89, false, x_rcx, x_rdx);
+  encodeHelperCall(a, (const void *) rememberObject);
+  bindJump(a, young);
+  bindJump(a, old);
+}
+
+void Jit::compileInstruction(Assembler &a, int function, size_t index) {
+  const Instruction &instruction = bytecode.functions[function].code[index];
+  int condition = -1;
+  switch (instruction.op) {
+    case op_move:
+      encodeLoad(a, x_rax, instruction.b);
+      encodeStore(a, instruction.a, x_rax);
+      break;
+    case op_constant:
+      encodeMemory(a, 0xc7, false, 0, x_rbx, -1, 0, 4 * instruction.a);
+      a.dword(instruction.b);
+      break;
+    case op_add:
+    case op_subtract:
+    case op_multiply:
+    case op_and:
+    case op_or: {
+      int opcode = instruction.op == op_add        ? 0x03
+                   : instruction.op == op_subtract ? 0x2b
+                   : instruction.op == op_multiply ? 0x0faf
+                   : instruction.op == op_and      ? 0x23
+                                                   : 0x0b;
+      encodeLoad(a, x_rax, instruction.b);
+      encodeMemory(a, opcode, false, x_rax, x_rbx, -1, 0, 4 * instruction.c);
+      encodeStore(a, instruction.a, x_rax);
+      break;
+    }
+    case op_addConstant:
+      encodeLoad(a, x_rax, instruction.b);
+      encodeImmediate(a, 0, false, x_rax, instruction.c);
+      encodeStore(a, instruction.a, x_rax);
+      break;
+    case op_divide: {
+      // The one quotient that does not fit wraps around
+      encodeLoad(a, x_rcx, instruction.c);
+      encodeRegisters(a, 0x85, false, x_rcx, x_rcx);
+      failures[f_division].push_back(encodeJump(a, c_equal));
+      encodeLoad(a, x_rax, instruction.b);
+      encodeImmediate(a, 7, false, x_rcx, -1);
+      size_t divide = encodeJump(a, c_notEqual);
+      encodeRegisters(a, 0xf7, false, 3, x_rax);
+      size_t done = encodeJump(a, -1);
+      bindJump(a, divide);
+      a.byte(0x99);
+      encodeRegisters(a, 0xf7, false, 7, x_rcx);
+      bindJump(a, done);
+      encodeStore(a, instruction.a, x_rax);
+      break;
+    }
+    case op_less:
+    case op_lessEqual:
+    case op_equal:
+      condition = instruction.op == op_less ? c_less : instruction.op == op_lessEqual ? c_lessEqual : c_equal;
+      encodeLoad(a, x_rax, instruction.b);
+      encodeMemory(a, 0x3b, false, x_rax, x_rbx, -1, 0, 4 * instruction.c);
+      encodeRegisters(a, 0x0f90 + condition, false, 0, x_rax);
+      encodeRegisters(a, 0x0fb6, false, x_rax, x_rax);
+      encodeStore(a, instruction.a, x_rax);
+      break;
+    case op_not:
+      encodeFrameImmediate(a, 7, instruction.b, 0);
+      encodeRegisters(a, 0x0f90 + c_equal, false, 0, x_rax);
+      encodeRegisters(a, 0x0fb6, false, x_rax, x_rax);
+      encodeStore(a, instruction.a, x_rax);
+      break;
+    case op_negate:
+      encodeLoad(a, x_rax, instruction.b);
+      encodeRegisters(a, 0xf7, false, 3, x_rax);
+      encodeStore(a, instruction.a, x_rax);
+      break;
+    case op_jump:
+      jumps.push_back(std::make_pair(encodeJump(a, -1), instruction.b));
+      break;
+    case op_jumpIf:
+    case op_jumpUnless:
+      encodeFrameImmediate(a, 7, instruction.a, 0);
+      condition = instruction.op == op_jumpIf ? c_notEqual : c_equal;
+      jumps.push_back(std::make_pair(encodeJump(a, condition), instruction.b));
+      break;
+    case op_jumpUnlessLess:
+    case op_jumpUnlessLessEqual:
+    case op_jumpUnlessEqual:
+      condition = instruction.op == op_jumpUnlessLess        ? c_greaterEqual
+                  : instruction.op == op_jumpUnlessLessEqual ? c_greater
+                                                             : c_notEqual;
+      encodeLoad(a, x_rax, instruction.a);
+      encodeMemory(a, 0x3b, false, x_rax, x_rbx, -1, 0, 4 * instruction.b);
+      jumps.push_back(std::make_pair(encodeJump(a, condition), instruction.c));
+      break;
+    case op_getField:
+    case op_getByte:
+      encodeLoad(a, x_rax, instruction.b);
+      encodeRegisters(a, 0x85, false, x_rax, x_rax);
+      failures[f_accessed].push_back(encodeJump(a, c_equal));
+      encodeMemory(a, instruction.op == op_getByte ? 0x0fb6 : 0x8b, false, x_rax, x_r12, x_rax, 0, instruction.c);
+      encodeStore(a, instruction.a, x_rax);
+      break;
+    case op_setField:
+    case op_setByte:
+      compileSetField(a, instruction, instruction.op == op_setByte);
+      break;
+    case op_checkClass: {
+      encodeLoad(a, x_rax, instruction.a);
+      encodeRegisters(a, 0x85, false, x_rax, x_rax);
+      size_t none = encodeJump(a, c_equal);
+      encodeMemory(a, 0x8b, false, x_rax, x_r12, x_rax, 0, 0);
+      encodeImmediate(a, 7, false, x_rax, instruction.b);
+      failures[f_mismatch].push_back(encodeJump(a, c_less));
+      encodeImmediate(a, 7, false, x_rax, bytecode.classes[instruction.b].lastSubclass);
+      failures[f_mismatch].push_back(encodeJump(a, c_greater));
+      bindJump(a, none);
+      break;
+    }
+    case op_checkObject:
+      encodeFrameImmediate(a, 7, instruction.a, 0);
+      failures[f_called].push_back(encodeJump(a, c_equal));
+      break;
+    case op_new:
+      compileNew(a, function, index);
+      break;
+    case op_call:
+    case op_callDirect:
+    case op_callMethod:
+      compileCall(a, function, index);
+      break;
+    case op_print:
+      encodeLoad(a, x_rsi, instruction.a);
+      encodeHelperCall(a, (const void *) printValue);
+      break;
+    case op_return:
+    case op_returnNone:
+      if (instruction.op == op_return)
+        encodeLoad(a, x_rax, instruction.a);
+      encodeImmediate(a, 0, true, x_rsp, 8);
+      a.byte(0xc3);
+      break;
+    default:
+      break;
+  }
+}
+
+void *Jit::compile(int number) {
+  const Function &function = bytecode.functions[number];
+  Assembler a;
+  jumps.clear();
+  for (int i = 0; i < f_failures; i++)
+    failures[i].clear();
+
+  compileEntry(a, function);
+  std::vector<size_t> starts;
+  for (size_t i = 0; i < function.code.size(); i++) {
+    starts.push_back(a.size());
+    compileInstruction(a, number, i);
+  }
+  starts.push_back(a.size());
+  for (size_t i = 0; i < jumps.size(); i++)
+    a.patch(jumps[i].first, starts[jumps[i].second] - (jumps[i].first + 4));
+
+  // Each failure the function may have sets its error and goes to
+  // where the program fails
+  for (int i = 0; i < f_failures; i++) {
+    if (failures[i].empty())
+      continue;
+    for (size_t j = 0; j < failures[i].size(); j++)
+      bindJump(a, failures[i][j]);
+    encodeMoveImmediate(a, x_rsi, i);
+    encodeMovePointer(a, x_rax, fail);
+    encodeRegisters(a, 0xff, false, 4, x_rax);
+  }
+
+  unsigned char *start = place(a);
+  if (!start)
+    return NULL;
+  entries[number] = start;
+  return start;
+}
+
+// Runs the program of a ready JIT.
+bool runJit(Jit &jit, std::string &error) {
+  const Bytecode &bytecode = jit.bytecode;
+  // Nothing is running yet, so the Main object is made without roots
+  FrameRoots roots(bytecode, jit.stackMaps, NULL, 0, NULL, NULL, NULL);
+  bool ok = (jit.stack[0] = jit.heap.allocate(bytecode.mainClass, roots)) != 0;
+  if (ok && bytecode.mainConstructor >= 0)
+    ok = jit.run(bytecode.mainConstructor, jit.stack);
+  if (ok)
+    ok = jit.run(bytecode.mainMethod, jit.stack);
+  if (!ok && !jit.executable)
+    error = "cannot make compiled code executable";
+  else if (!ok)
+    error = failureMessages[jit.context.failure < 0 ? f_memory : jit.context.failure];
+  return ok;
+}
+
+bool runCompiled(const Bytecode &bytecode, Emitter &out, std::string &error, std::string &fallback) {
+  {
+    Jit jit(bytecode, out);
+    if (jit.ready())
+      return runJit(jit, error);
+    if (jit.executable) {
+      error = "out of memory";
+      return false;
+    }
+  }
+  fallback = "cannot make compiled code executable, interpreting the program instead";
+  return run(bytecode, out, error);
+}
+
+#else
+
+bool runCompiled(const Bytecode &bytecode, Emitter &out, std::string &error, std::string &fallback) {
+  return run(bytecode, out, error);
+}
+
+#endif
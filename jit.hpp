@@ -0,0 +1,35 @@
+#ifndef __JIT_HPP
+#define __JIT_HPP
+
+#include "bytecode.hpp"
+#include "emit.hpp"
+
+#include <string>
+
+// Runs a lowered program as run does, compiling its methods to
+// x86-64 machine code in memory of the process instead of
+// interpreting them: nothing is written to a file, and no assembler
+// or linker is run. A method is compiled the first time it is
+// called, through a stub that compiles it and points the calls of
+// the program at its code, so a program starts running as soon as
+// Main.main is compiled, and methods it never calls cost nothing.
+// Code is written to memory that is made executable, and no longer
+// writable, with mprotect once a method is compiled. Where the
+// system does not let it be, the program is interpreted instead,
+// with the reason in fallback; should that happen to a method
+// compiled once the program is running, the program fails.
+//
+// The frames of compiled methods are those of the VM: windows of
+// the registers of all frames, with the locals at the registers the
+// type checker's offsets give them and localsSize bytes of them,
+// which a method zeroes on entry. Compiled code reads and writes
+// registers in memory, allocates from the same heap, and records
+// its calls as the VM does, so the collector finds every reference
+// with the same stack maps. Running out of either stack is a stack
+// overflow, as in the VM, and the runtime errors are the VM's.
+//
+// Where the JIT is not available, on machines other than x86-64,
+// the program is interpreted.
+bool runCompiled(const Bytecode &bytecode, Emitter &out, std::string &error, std::string &fallback);
+
+#endif
@@ -0,0 +1,135 @@
+#include "langcheck.hpp"
+#include "parser.hpp"
+#include "pool.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+// The reentrant scanner interface generated by flex
+struct yy_buffer_state;
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+
+int yylex_init_extra(Compilation *compilation, yyscan_t *scanner);
+void yyset_in(FILE *in, yyscan_t scanner);
+YY_BUFFER_STATE yy_scan_buffer(char *base, size_t size, yyscan_t scanner);
+void yy_delete_buffer(YY_BUFFER_STATE buffer, yyscan_t scanner);
+int yylex(YYSTYPE *value, yyscan_t scanner);
+int yylex_destroy(yyscan_t scanner);
+
+Compilation::Compilation() {
+  program = NULL;
+  classTable = NULL;
+  library = false;
+  threads = 1;
+  clear(statistics);
+}
+
+Compilation::~Compilation() {
+  destroy(classTable);
+}
+
+// Creates a scanner for the compilation, reporting a failure to
+// its diagnostics.
+bool startScanner(Compilation &compilation, yyscan_t *scanner) {
+  if (yylex_init_extra(&compilation, scanner)) {
+    compilation.diagnostics.error(strerror(errno), NULL, 0);
+    return false;
+  }
+  return true;
+}
+
+bool parse(Compilation &compilation, FILE *in) {
+  STATS_ACTIVATE(compilation.statistics);
+  Stopwatch start = stopwatch();
+  yyscan_t scanner;
+  if (!startScanner(compilation, &scanner))
+    return false;
+  yyset_in(in, scanner);
+  yyparse(scanner, &compilation);
+  yylex_destroy(scanner);
+  if (compilation.statistics.timed)
+    record(compilation.statistics, t_parse, start);
+  return compilation.program && !compilation.diagnostics.hasErrors();
+}
+
+bool parse(Compilation &compilation) {
+  return parse(compilation, compilation.source.text, compilation.source.length);
+}
+
+bool parse(Compilation &compilation, char *text, size_t length) {
+  STATS_ACTIVATE(compilation.statistics);
+  Stopwatch start = stopwatch();
+  yyscan_t scanner;
+  if (!startScanner(compilation, &scanner))
+    return false;
+  // The buffer is the text and the two NULs after it
+  YY_BUFFER_STATE buffer = yy_scan_buffer(text, length + 2, scanner);
+  yyparse(scanner, &compilation);
+  yy_delete_buffer(buffer, scanner);
+  yylex_destroy(scanner);
+  if (compilation.statistics.timed)
+    record(compilation.statistics, t_parse, start);
+  return compilation.program && !compilation.diagnostics.hasErrors();
+}
+
+size_t scan(Compilation &compilation) {
+  yyscan_t scanner;
+  if (!startScanner(compilation, &scanner))
+    return 0;
+  YY_BUFFER_STATE buffer = yy_scan_buffer(compilation.source.text, compilation.source.length + 2, scanner);
+  YYSTYPE value;
+  size_t tokens = 0;
+  while (yylex(&value, scanner))
+    tokens++;
+  yy_delete_buffer(buffer, scanner);
+  yylex_destroy(scanner);
+  return tokens;
+}
+
+bool typecheck(Compilation &compilation) {
+  STATS_ACTIVATE(compilation.statistics);
+  Stopwatch start = stopwatch();
+  TypeCheck typecheck(compilation.symbols, compilation.diagnostics);
+  typecheck.classTable = compilation.classTable;
+  typecheck.library = compilation.library;
+  WorkPool *pool = compilation.threads > 1 ? new WorkPool(compilation.threads) : NULL;
+  typecheck.pool = pool;
+  typecheck.visit(compilation.program);
+  delete pool;
+  compilation.classTable = typecheck.classTable;
+  if (compilation.statistics.timed)
+    record(compilation.statistics, t_typecheck, start);
+  return !compilation.diagnostics.hasErrors();
+}
+
+// Checks the mapped source of the compilation. When the phases
+// are timed, the scanner first runs over the source on its own,
+// since it is otherwise only run by the parser as it goes.
+bool checkSource(Compilation &compilation) {
+  if (compilation.statistics.timed) {
+    Stopwatch start = stopwatch();
+    scan(compilation);
+    record(compilation.statistics, t_scan, start);
+  }
+  return parse(compilation) && typecheck(compilation);
+}
+
+bool check(Compilation &compilation, FILE *in) {
+  if (compilation.statistics.timed && compilation.source.read(in))
+    return checkSource(compilation);
+  return parse(compilation, in) && typecheck(compilation);
+}
+
+bool checkFile(Compilation &compilation, const char *path) {
+  if (compilation.source.map(path))
+    return checkSource(compilation);
+
+  FILE *in = fopen(path, "r");
+  if (!in) {
+    compilation.diagnostics.error(std::string("cannot open file: ") + strerror(errno), NULL, 0);
+    return false;
+  }
+  bool checked = check(compilation, in);
+  fclose(in);
+  return checked;
+}
@@ -0,0 +1,99 @@
+#ifndef __LANGCHECK_HPP
+#define __LANGCHECK_HPP
+
+#include "arena.hpp"
+#include "ast.hpp"
+#include "diagnostics.hpp"
+#include "emit.hpp"
+#include "library.hpp"
+#include "source.hpp"
+#include "stats.hpp"
+#include "symbols.hpp"
+#include "typecheck.hpp"
+
+#include <cstdio>
+
+// Defines a compilation: everything scanning, parsing and type
+// checking one source produces. The AST lives in the arena, its
+// names in the interner, and every error is in the diagnostics.
+// A source file that is checked by path stays mapped for as long
+// as the compilation lives, and its names are views into it.
+// Compilations share no state, so any number of them can be
+// checked at once, each on its own thread.
+class Compilation {
+public:
+  Source source;
+  Arena arena;
+  SymbolInterner symbols;
+  Diagnostics diagnostics;
+
+  // The root of the AST, or NULL if the source did not parse
+  ProgramNode *program;
+
+  // The symbol table built by the type checker, or NULL if the
+  // program was not type checked
+  ClassTable *classTable;
+
+  // Set to check a class library, which is a program without a
+  // Main class
+  bool library;
+
+  // The threads the method bodies of the program are checked on,
+  // once its classes have been declared; 1 checks everything as the
+  // tree is walked
+  int threads;
+
+  // What --time-report and --stats measured. Set statistics.timed
+  // before checking to time the phases.
+  Statistics statistics;
+
+  Compilation();
+  ~Compilation();
+
+  // Interns a name the scanner found. Names in the mapped source
+  // are kept as views of it; names read from a stream are copied,
+  // since the scanner reuses its buffer.
+  Symbol intern(const char *text, size_t length) {
+    return source.text ? symbols.internView(text, length) : symbols.intern(text, length);
+  }
+
+private:
+  Compilation(const Compilation &);
+  Compilation &operator=(const Compilation &);
+};
+
+// Scans and parses the source read from in into the compilation.
+// Returns true if it parsed without errors.
+bool parse(Compilation &compilation, FILE *in);
+
+// Scans and parses the mapped source of the compilation in place.
+bool parse(Compilation &compilation);
+
+// Scans and parses text, which must be followed by two NULs, in
+// place. Unless the compilation has a mapped source, the names in
+// text are copied, so text need not outlive the parse.
+bool parse(Compilation &compilation, char *text, size_t length);
+
+// Runs only the scanner over the mapped source of the compilation
+// and returns the number of tokens in it. Used to time scanning
+// on its own.
+size_t scan(Compilation &compilation);
+
+// Type checks a program that parsed without errors, building the
+// class table of the compilation. Returns true if there were no
+// errors.
+bool typecheck(Compilation &compilation);
+
+// Parses the source read from in and, if it parsed without
+// errors, type checks it. Returns true if there were no errors.
+// When the phases are timed, the stream is read into memory first
+// so that it can be scanned once on its own to time the scanner.
+bool check(Compilation &compilation, FILE *in);
+
+// Checks the source file at path. Regular files are mapped and
+// scanned in place; anything else, such as a pipe, is read as a
+// stream. A file that cannot be opened is reported to the
+// diagnostics of the compilation.
+bool checkFile(Compilation &compilation, const char *path);
+
+#endif
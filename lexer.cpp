@@ -0,0 +1,51 @@
+// Test-only stand-in for the reentrant flex scanner (flex is unavailable in this sandbox).
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <string>
+#include "ast.hpp"
+#include "parser.hpp"
+#include "langcheck.hpp"
+void yyerror(yyscan_t, Compilation *, const char *);
+struct Scanner { FILE *in; int line; Compilation *extra; std::string own; const char *p, *end; bool loaded; };
+struct yy_buffer_state;
+yy_buffer_state *yy_scan_buffer(char *b, size_t n, yyscan_t s) { Scanner *S=(Scanner*)s; if (n<2||b[n-1]||b[n-2]) return NULL; S->p=b; S->end=b+n-2; S->loaded=true; return (yy_buffer_state*)b; }
+void yy_delete_buffer(yy_buffer_state *, yyscan_t) {}
+int yylex_init_extra(Compilation *c, yyscan_t *s) { Scanner *sc = new Scanner; sc->in = stdin; sc->line = 1; sc->loaded = false; sc->extra = c; *s = sc; return 0; }
+void yyset_in(FILE *in, yyscan_t s) { ((Scanner *)s)->in = in; }
+int yylex_destroy(yyscan_t s) { delete (Scanner *)s; return 0; }
+int yyget_lineno(yyscan_t s) { return ((Scanner *)s)->line; }
+int yylex(YYSTYPE *lval, yyscan_t scanner) {
+  Scanner *S = (Scanner *)scanner; FILE *in = S->in; Compilation *cx = S->extra;
+  if (!S->loaded) { int ch; while ((ch = getc(in)) != EOF) S->own += (char)ch; S->p = S->own.data(); S->end = S->p + S->own.size(); S->loaded = true; }
+#define peekc() (S->p < S->end ? (unsigned char)*S->p : EOF)
+#define getc2() ({ int c_ = S->p < S->end ? (unsigned char)*S->p++ : EOF; if (c_ == '\n') S->line++; c_; })
+  for (;;) {
+    int c = getc2();
+    if (c == EOF) return 0;
+    if (isspace(c)) continue;
+    if (c == '/' && peekc() == '*') { getc2(); int p = 0; for (;;) { int d = getc2(); if (d == EOF) { yyerror(scanner, cx, "dangling comment"); return 0; } if (p == '*' && d == '/') break; p = d; } continue; }
+    if (isalpha(c)) {
+      const char *start = S->p - 1;
+      while (isalnum(peekc())) getc2();
+      std::string s(start, S->p - start);
+      static const struct { const char *k; int t; } kw[] = {{"print",T_PRINT},{"return",T_RETURN},{"if",T_IF},{"else",T_ELSE},{"while",T_WHILE},{"new",T_NEW},{"extends",T_EXTENDS},{"repeat",T_REPEAT},{"until",T_UNTIL},{"integer",T_INTEGER},{"boolean",T_BOOLEAN},{"none",T_NONE},{"equals",T_EQUALS},{"and",T_AND},{"or",T_OR},{"not",T_NOT},{"true",T_TRUE},{"false",T_FALSE}};
+      for (unsigned i = 0; i < sizeof(kw)/sizeof(kw[0]); i++) if (s == kw[i].k) return kw[i].t;
+#include "/tmp/h/ident.inc"
+      return T_IDENTIFIER;
+    }
+    if (isdigit(c)) {
+      std::string s(1, (char)c);
+      if (c != '0') while (isdigit(peekc())) s += (char)getc2();
+      long v = strtol(s.c_str(), NULL, 0); if (v > INT_MAX) yyerror(scanner, cx, "integer out of range");
+#include "/tmp/h/int.inc"
+      return T_NUMBER;
+    }
+    if (c == '-' && peekc() == '>') { getc2(); return T_ARROW; }
+    if (c == '<' && peekc() == '=') { getc2(); return T_LEQ; }
+    if (strchr("{}(),=:.;+-*/<", c)) return c;
+    yyerror(scanner, cx, "invalid character");
+  }
+}
@@ -0,0 +1,246 @@
+#include "library.hpp"
+#include "langcheck.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+Library::Library() {
+  this->path = NULL;
+}
+
+bool Library::open(const char *path) {
+  this->path = path;
+  if (!file.map(path)) {
+    error = strerror(errno);
+    return false;
+  }
+  size_t magic = strlen(BINARY_MAGIC);
+  if (file.length < magic + 4 || memcmp(file.text, BINARY_MAGIC, magic) != 0) {
+    error = "not a class library";
+    return false;
+  }
+  const unsigned char *version = (const unsigned char *) file.text + magic;
+  if ((version[0] | version[1] << 8 | version[2] << 16 | (unsigned int) version[3] << 24) != binaryVersion) {
+    error = "class library of another version";
+    return false;
+  }
+  return true;
+}
+
+// Defines a reader of the words and names of a mapped library.
+// Reading past the end, or an out of range name or type, marks
+// the reader as failed and yields zeros. Nothing read after that
+// is entered into a table, and the library is rejected.
+typedef struct reader {
+  const unsigned char *at;
+  const unsigned char *end;
+  std::vector<Symbol> names;
+  bool failed;
+} Reader;
+
+unsigned int word(Reader &reader) {
+  if (reader.end - reader.at < 4) {
+    reader.failed = true;
+    return 0;
+  }
+  const unsigned char *at = reader.at;
+  reader.at += 4;
+  return at[0] | at[1] << 8 | at[2] << 16 | (unsigned int) at[3] << 24;
+}
+
+// Returns a count of entries that are at least size bytes each,
+// failing if the rest of the library is too short for them, so
+// that a corrupt count cannot make the reader allocate or loop
+// without end.
+unsigned int count(Reader &reader, size_t size) {
+  unsigned int count = word(reader);
+  if ((size_t) (reader.end - reader.at) / size < count) {
+    reader.failed = true;
+    return 0;
+  }
+  return count;
+}
+
+Symbol name(Reader &reader) {
+  unsigned int index = word(reader);
+  if (index == noName)
+    return noSymbol;
+  if (index >= reader.names.size()) {
+    reader.failed = true;
+    return noSymbol;
+  }
+  return reader.names[index];
+}
+
+// Returns a name that keys a table entry, which cannot be none.
+Symbol key(Reader &reader) {
+  Symbol symbol = name(reader);
+  if (symbol == noSymbol)
+    reader.failed = true;
+  return symbol;
+}
+
+TypeId type(Reader &reader) {
+  unsigned int baseType = word(reader);
+  Symbol className = name(reader);
+  if (baseType >= bt_error) {
+    reader.failed = true;
+    return bt_none;
+  }
+  return typeId((BaseType) baseType, className);
+}
+
+VariableTable *variables(Reader &reader) {
+  VariableTable *table = new VariableTable();
+  unsigned int entries = count(reader, 20);
+  for (unsigned int i = 0; i < entries; i++) {
+    Symbol variable = key(reader);
+    VariableInfo info;
+    info.type = type(reader);
+    info.offset = (int) word(reader);
+    info.size = (int) word(reader);
+    if (!reader.failed)
+      (*table)[variable] = info;
+  }
+  return table;
+}
+
+// Defines an entry of a virtual table as it is read. The method
+// info of the entry is that of the method in the class that
+// defines it, which may not have been read yet, so entries are
+// only resolved once every class has been.
+typedef struct pendingslot {
+  Symbol className;
+  Symbol method;
+  Symbol owner;
+  int slot;
+} PendingSlot;
+
+void readClass(Reader &reader, Symbol &className, ClassInfo &info, std::vector<PendingSlot> &pending) {
+  className = key(reader);
+  info.superClassName = name(reader);
+  info.membersSize = (int) word(reader);
+  info.members = variables(reader);
+
+  info.methods = new MethodTable();
+  unsigned int methods = count(reader, 24);
+  for (unsigned int i = 0; i < methods && !reader.failed; i++) {
+    Symbol method = key(reader);
+    MethodInfo methodInfo;
+    methodInfo.returnType = type(reader);
+    methodInfo.localsSize = (int) word(reader);
+    methodInfo.parameters = new std::list<TypeId>();
+    unsigned int parameters = count(reader, 8);
+    for (unsigned int j = 0; j < parameters; j++)
+      methodInfo.parameters->push_back(type(reader));
+    methodInfo.variables = variables(reader);
+    if (reader.failed) {
+      delete methodInfo.parameters;
+      delete methodInfo.variables;
+      break;
+    }
+    MethodInfo &entry = (*info.methods)[method];
+    // A repeated method would leak the tables of the first
+    if (entry.variables) {
+      delete entry.variables;
+      delete entry.parameters;
+    }
+    entry = methodInfo;
+  }
+
+  info.memberLayout = new MemberLayout();
+  unsigned int members = count(reader, 24);
+  for (unsigned int i = 0; i < members; i++) {
+    Symbol member = key(reader);
+    MemberSlot slot;
+    slot.info.type = type(reader);
+    slot.info.offset = (int) word(reader);
+    slot.info.size = (int) word(reader);
+    slot.owner = key(reader);
+    if (!reader.failed)
+      (*info.memberLayout)[member] = slot;
+  }
+
+  info.methodLayout = new MethodLayout();
+  unsigned int slots = count(reader, 12);
+  for (unsigned int i = 0; i < slots; i++) {
+    PendingSlot slot;
+    slot.className = className;
+    slot.slot = (int) word(reader);
+    slot.method = key(reader);
+    slot.owner = key(reader);
+    pending.push_back(slot);
+  }
+}
+
+bool import(Compilation &compilation, const Library &library) {
+  Stopwatch start = stopwatch();
+  Reader reader;
+  reader.at = (const unsigned char *) library.file.text + strlen(BINARY_MAGIC) + 4;
+  reader.end = (const unsigned char *) library.file.text + library.file.length;
+  reader.failed = false;
+
+  unsigned int names = count(reader, 4);
+  for (unsigned int i = 0; i < names && !reader.failed; i++) {
+    unsigned int length = word(reader);
+    if ((size_t) (reader.end - reader.at) < length || length == 0) {
+      reader.failed = true;
+      break;
+    }
+    reader.names.push_back(compilation.symbols.internView((const char *) reader.at, length));
+    reader.at += length;
+  }
+
+  if (!compilation.classTable)
+    compilation.classTable = new ClassTable();
+  ClassTable &classTable = *compilation.classTable;
+
+  // Read every class, keeping those the table does not have yet
+  std::vector<PendingSlot> pending;
+  std::vector<Symbol> added;
+  unsigned int classes = count(reader, 28);
+  for (unsigned int i = 0; i < classes && !reader.failed; i++) {
+    Symbol className;
+    ClassInfo info;
+    std::vector<PendingSlot> slots;
+    readClass(reader, className, info, slots);
+    if (reader.failed || classTable.count(className)) {
+      destroy(info);
+      continue;
+    }
+    classTable[className] = info;
+    added.push_back(className);
+    pending.insert(pending.end(), slots.begin(), slots.end());
+  }
+
+  // Fill in the virtual tables of the added classes from the
+  // method tables of the classes that define their methods
+  for (size_t i = 0; i < pending.size() && !reader.failed; i++) {
+    ClassInfo *owner = classTable.lookup(pending[i].owner);
+    MethodInfo *method = owner ? owner->methods->lookup(pending[i].method) : NULL;
+    if (!method) {
+      reader.failed = true;
+      break;
+    }
+    MethodSlot slot = {
+        *method,
+        pending[i].owner,
+        pending[i].slot
+    };
+    (*classTable.at(pending[i].className).methodLayout)[pending[i].method] = slot;
+  }
+  for (size_t i = 0; i < added.size() && !reader.failed; i++) {
+    Symbol superClassName = classTable.at(added[i]).superClassName;
+    if (superClassName != noSymbol && !classTable.count(superClassName))
+      reader.failed = true;
+  }
+
+  if (compilation.statistics.timed)
+    record(compilation.statistics, t_import, start);
+  if (reader.failed || reader.at != reader.end) {
+    compilation.diagnostics.error(std::string("malformed class library: ") + library.path, NULL, 0);
+    return false;
+  }
+  return true;
+}
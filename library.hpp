@@ -0,0 +1,42 @@
+#ifndef __LIBRARY_HPP
+#define __LIBRARY_HPP
+
+#include "source.hpp"
+
+#include <string>
+
+class Compilation;
+
+// Defines a class library: the symbol table of a checked set of
+// classes, written by lang --make-lib in the binary format (see
+// emit.hpp) and mapped into memory. Importing a library puts its
+// classes in the class table of a compilation before the program
+// is checked, so the program can extend and use them without
+// their source being scanned, parsed and checked again. The names
+// of imported classes are views into the mapping, so a library
+// must stay open for as long as any compilation it was imported
+// into.
+class Library {
+public:
+  const char *path;
+  Source file;
+
+  // Why the library could not be opened or imported
+  std::string error;
+
+  Library();
+
+  // Maps the library at path and checks that it is a class
+  // library of the version this checker writes.
+  bool open(const char *path);
+};
+
+// Adds the classes of the library to the class table of the
+// compilation, creating the table if there is none yet. Classes
+// the table already has, such as those of a library both this
+// one and the program were built against, are kept as they are.
+// A library that turns out to be malformed is reported to the
+// diagnostics of the compilation.
+bool import(Compilation &compilation, const Library &library);
+
+#endif
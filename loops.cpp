@@ -0,0 +1,453 @@
+#include "loops.hpp"
+
+#include <algorithm>
+#include <map>
+
+// Defines what calling a function may do: a pure function only
+// reads members of its object, at the offsets in reads, and computes
+// with them, so it cannot fail, loop forever or change anything.
+typedef struct callee {
+  bool pure;
+  std::vector<int> reads;
+} Callee;
+
+// Returns true if an instruction computes its value from its
+// operands alone, and cannot fail.
+bool computes(const IrFunction &function, const IrInstruction &instruction) {
+  switch (instruction.op) {
+    case ir_constant:
+    case ir_add:
+    case ir_subtract:
+    case ir_multiply:
+    case ir_less:
+    case ir_lessEqual:
+    case ir_equal:
+    case ir_and:
+    case ir_or:
+    case ir_not:
+    case ir_negate:
+      return true;
+    case ir_divide: {
+      const IrInstruction &divisor = function.instructions[instruction.operands[1]];
+      return divisor.op == ir_constant && divisor.immediate != 0;
+    }
+    default:
+      return false;
+  }
+}
+
+void summarize(const IrFunction &function, Callee &callee) {
+  callee.pure = true;
+  std::vector<int> depth;
+  loopDepths(function, depth);
+  for (size_t b = 0; b < function.blocks.size() && callee.pure; b++) {
+    if (depth[b] > 0)
+      callee.pure = false;
+    const std::vector<int> &instructions = function.blocks[b].instructions;
+    for (size_t i = 0; i < instructions.size() && callee.pure; i++) {
+      const IrInstruction &instruction = function.instructions[instructions[i]];
+      if (computes(function, instruction) || instruction.op == ir_parameter || instruction.op == ir_phi ||
+          isTerminator(instruction.op))
+        continue;
+      const IrInstruction *object =
+          instruction.op == ir_getField ? &function.instructions[instruction.operands[0]] : NULL;
+      if (object && object->op == ir_parameter && object->immediate == 0)
+        callee.reads.push_back(instruction.immediate);
+      else
+        callee.pure = false;
+    }
+  }
+}
+
+// Optimizes the loops of one function.
+struct LoopOptimizer {
+  LoopOptimizer(IrFunction &function, const std::map<int, Callee> &callees, LoopReport &report)
+      : function(function), callees(callees), report(report) {}
+
+  IrFunction &function;
+  const std::map<int, Callee> &callees;
+  LoopReport &report;
+  std::vector<int> idom;
+  // The block of every instruction, -1 if it is dead
+  std::vector<int> blockOf;
+  // The preheader made for each block, or -1
+  std::vector<int> before;
+
+  void run();
+  void locate();
+  int preheader(const IrLoop &loop);
+  void hoist(const IrLoop &loop, int preheader);
+  void reduce(const IrLoop &loop, int preheader);
+  void placePreheaders();
+
+  int add(IrOpcode op, int immediate, int a, int b);
+  int multiply(int block, int a, int b);
+  void insertBeforeEnd(int block, int value);
+  void replaceUses(int value, int by);
+  bool inLoop(const IrLoop &loop, int value) const { return loop.blocks[blockOf[value]]; }
+  const Callee *pureCallee(const IrInstruction &instruction) const;
+
+private:
+  LoopOptimizer(const LoopOptimizer &);
+  LoopOptimizer &operator=(const LoopOptimizer &);
+};
+
+void LoopOptimizer::locate() {
+  blockOf.assign(function.instructions.size(), -1);
+  for (size_t b = 0; b < function.blocks.size(); b++)
+    for (size_t i = 0; i < function.blocks[b].instructions.size(); i++)
+      blockOf[function.blocks[b].instructions[i]] = b;
+}
+
+int LoopOptimizer::add(IrOpcode op, int immediate, int a, int b) {
+  IrInstruction instruction;
+  instruction.op = op;
+  instruction.type = bt_integer;
+  instruction.immediate = immediate;
+  instruction.variable = -1;
+  if (a >= 0)
+    instruction.operands.push_back(a);
+  if (b >= 0)
+    instruction.operands.push_back(b);
+  function.instructions.push_back(instruction);
+  blockOf.push_back(-1);
+  return function.instructions.size() - 1;
+}
+
+// Makes the product of two values in a block, a constant if both
+// are or one is 0, and the other value if one is 1.
+int LoopOptimizer::multiply(int block, int a, int b) {
+  const IrInstruction &x = function.instructions[a], &y = function.instructions[b];
+  if (x.op == ir_constant && x.immediate == 1)
+    return b;
+  if (y.op == ir_constant && y.immediate == 1)
+    return a;
+  int product;
+  if (x.op == ir_constant && y.op == ir_constant)
+    product = add(ir_constant, (int) ((unsigned) x.immediate * (unsigned) y.immediate), -1, -1);
+  else if ((x.op == ir_constant && x.immediate == 0) || (y.op == ir_constant && y.immediate == 0))
+    product = add(ir_constant, 0, -1, -1);
+  else
+    product = add(ir_multiply, 0, a, b);
+  insertBeforeEnd(block, product);
+  return product;
+}
+
+void LoopOptimizer::replaceUses(int value, int by) {
+  for (size_t b = 0; b < function.blocks.size(); b++)
+    for (size_t i = 0; i < function.blocks[b].instructions.size(); i++) {
+      std::vector<int> &operands = function.instructions[function.blocks[b].instructions[i]].operands;
+      std::replace(operands.begin(), operands.end(), value, by);
+    }
+}
+
+void LoopOptimizer::insertBeforeEnd(int block, int value) {
+  std::vector<int> &instructions = function.blocks[block].instructions;
+  instructions.insert(instructions.end() - 1, value);
+  blockOf[value] = block;
+}
+
+const Callee *LoopOptimizer::pureCallee(const IrInstruction &instruction) const {
+  if (instruction.op != ir_call && instruction.op != ir_callDirect)
+    return NULL;
+  std::map<int, Callee>::const_iterator callee = callees.find(instruction.immediate);
+  return callee != callees.end() && callee->second.pure ? &callee->second : NULL;
+}
+
+// Returns the block that enters a loop from outside it. Where more
+// than one does, they are made to jump to a new block instead, which
+// jumps to the header and takes over the operands they gave its
+// phis.
+int LoopOptimizer::preheader(const IrLoop &loop) {
+  const IrBlock &header = function.blocks[loop.header];
+  std::vector<int> outside, inside;
+  for (size_t i = 0; i < header.predecessors.size(); i++)
+    (loop.blocks[header.predecessors[i]] ? inside : outside).push_back(i);
+  if (outside.size() == 1)
+    return header.predecessors[outside[0]];
+
+  int block = function.blocks.size();
+  IrBlock made;
+  std::vector<int> predecessors(1, block);
+  for (size_t i = 0; i < outside.size(); i++)
+    made.predecessors.push_back(header.predecessors[outside[i]]);
+  for (size_t i = 0; i < inside.size(); i++)
+    predecessors.push_back(header.predecessors[inside[i]]);
+  made.successors.push_back(loop.header);
+  for (size_t i = 0; i < header.instructions.size(); i++) {
+    int phi = header.instructions[i];
+    if (function.instructions[phi].op != ir_phi)
+      break;
+    std::vector<int> operands = function.instructions[phi].operands, entering, remaining;
+    for (size_t j = 0; j < outside.size(); j++)
+      entering.push_back(operands[outside[j]]);
+    int value = entering[0];
+    if (std::count(entering.begin(), entering.end(), value) != (int) entering.size()) {
+      IrInstruction merged = function.instructions[phi];
+      merged.operands = entering;
+      function.instructions.push_back(merged);
+      blockOf.push_back(block);
+      value = function.instructions.size() - 1;
+      made.instructions.push_back(value);
+    }
+    remaining.push_back(value);
+    for (size_t j = 0; j < inside.size(); j++)
+      remaining.push_back(operands[inside[j]]);
+    function.instructions[phi].operands = remaining;
+  }
+  made.instructions.push_back(add(ir_jump, 0, -1, -1));
+  function.instructions.back().type = bt_none;
+  blockOf.back() = block;
+
+  for (size_t i = 0; i < made.predecessors.size(); i++) {
+    std::vector<int> &successors = function.blocks[made.predecessors[i]].successors;
+    std::replace(successors.begin(), successors.end(), loop.header, block);
+  }
+  function.blocks[loop.header].predecessors = predecessors;
+  function.blocks.push_back(made);
+  before.push_back(-1);
+  before[loop.header] = block;
+  dominators(function, idom);
+
+  // A phi the loop only gives itself is now the value it enters with
+  std::vector<int> &phis = function.blocks[loop.header].instructions;
+  for (size_t i = 0; i < phis.size() && function.instructions[phis[i]].op == ir_phi;) {
+    int phi = phis[i];
+    const std::vector<int> &operands = function.instructions[phi].operands;
+    if (std::count(operands.begin(), operands.end(), phi) + 1 != (int) operands.size()) {
+      i++;
+      continue;
+    }
+    phis.erase(phis.begin() + i);
+    blockOf[phi] = -1;
+    replaceUses(phi, operands[0]);
+    i = 0;
+  }
+  return block;
+}
+
+// Hoists the invariant instructions of a loop into its preheader,
+// over and over, since hoisting one may make those that use it
+// invariant.
+void LoopOptimizer::hoist(const IrLoop &loop, int preheader) {
+  // The offsets the loop sets members at, and whether it calls a
+  // function that may set any
+  std::vector<int> written;
+  bool calls = false;
+  for (size_t b = 0; b < function.blocks.size(); b++) {
+    if (!loop.blocks[b])
+      continue;
+    for (size_t i = 0; i < function.blocks[b].instructions.size(); i++) {
+      const IrInstruction &instruction = function.instructions[function.blocks[b].instructions[i]];
+      if (instruction.op == ir_setField)
+        written.push_back(instruction.immediate);
+      else if (isCall(instruction.op) && !pureCallee(instruction))
+        calls = true;
+    }
+  }
+
+  // The objects checked on every path to the preheader
+  std::vector<bool> checked(function.instructions.size(), false);
+  for (int b = preheader; b >= 0; b = idom[b])
+    for (size_t i = 0; i < function.blocks[b].instructions.size(); i++) {
+      const IrInstruction &instruction = function.instructions[function.blocks[b].instructions[i]];
+      if (instruction.op == ir_checkObject || instruction.op == ir_getField || instruction.op == ir_setField ||
+          instruction.op == ir_callDirect || instruction.op == ir_callMethod)
+        checked[instruction.operands[0]] = true;
+    }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t b = 0; b < function.blocks.size(); b++) {
+      if (!loop.blocks[b])
+        continue;
+      for (size_t i = 0; i < function.blocks[b].instructions.size();) {
+        int value = function.blocks[b].instructions[i];
+        const IrInstruction &instruction = function.instructions[value];
+        bool invariant = instruction.op != ir_phi && !isTerminator(instruction.op);
+        for (size_t j = 0; j < instruction.operands.size() && invariant; j++)
+          invariant = !inLoop(loop, instruction.operands[j]);
+        if (invariant) {
+          int object = instruction.operands.empty() ? -1 : instruction.operands[0];
+          bool known = object >= 0 && (checked[object] || function.instructions[object].op == ir_new ||
+                                       (function.instructions[object].op == ir_parameter &&
+                                        function.instructions[object].immediate == 0));
+          const Callee *callee = pureCallee(instruction);
+          if (computes(function, instruction)) {
+            if (instruction.op != ir_constant)
+              report.operators++;
+          } else if (instruction.op == ir_getField && known && !calls &&
+                     std::find(written.begin(), written.end(), instruction.immediate) == written.end()) {
+            report.memberReads++;
+          } else if (instruction.op == ir_checkObject && known) {
+            report.checks++;
+          } else if (callee && (known || instruction.op == ir_call) && !calls) {
+            for (size_t j = 0; j < callee->reads.size() && invariant; j++)
+              invariant = std::find(written.begin(), written.end(), callee->reads[j]) == written.end();
+            if (invariant)
+              report.calls++;
+          } else {
+            invariant = false;
+          }
+        }
+        if (!invariant) {
+          i++;
+          continue;
+        }
+        function.blocks[b].instructions.erase(function.blocks[b].instructions.begin() + i);
+        insertBeforeEnd(preheader, value);
+        changed = true;
+      }
+    }
+  }
+}
+
+// Makes the multiples of the induction variables of a loop
+// induction variables of their own.
+void LoopOptimizer::reduce(const IrLoop &loop, int preheader) {
+  const std::vector<int> &predecessors = function.blocks[loop.header].predecessors;
+  size_t entry = std::find(predecessors.begin(), predecessors.end(), preheader) - predecessors.begin();
+  std::vector<int> phis;
+  for (size_t i = 0; i < function.blocks[loop.header].instructions.size(); i++) {
+    int value = function.blocks[loop.header].instructions[i];
+    if (function.instructions[value].op != ir_phi)
+      break;
+    if (function.instructions[value].type == bt_integer)
+      phis.push_back(value);
+  }
+
+  for (size_t p = 0; p < phis.size(); p++) {
+    int phi = phis[p];
+    // The phi steps if every edge back gives it the same update of it
+    std::vector<int> operands = function.instructions[phi].operands;
+    int update = -1;
+    for (size_t j = 0; j < operands.size(); j++)
+      if (j != entry && (update < 0 || operands[j] == update))
+        update = operands[j];
+      else if (j != entry)
+        update = -2;
+    if (update < 0 || !inLoop(loop, update))
+      continue;
+    const IrInstruction &stepping = function.instructions[update];
+    int step = -1;
+    if ((stepping.op == ir_add || stepping.op == ir_subtract) && stepping.operands[0] == phi)
+      step = stepping.operands[1];
+    else if (stepping.op == ir_add && stepping.operands[1] == phi)
+      step = stepping.operands[0];
+    if (step < 0 || inLoop(loop, step))
+      continue;
+    IrOpcode op = stepping.op;
+
+    // The induction variable made for each factor
+    std::map<int, int> multiples;
+    for (size_t b = 0; b < function.blocks.size(); b++) {
+      if (!loop.blocks[b])
+        continue;
+      for (size_t i = 0; i < function.blocks[b].instructions.size();) {
+        int value = function.blocks[b].instructions[i];
+        const IrInstruction &instruction = function.instructions[value];
+        int factor = -1;
+        if (instruction.op == ir_multiply && instruction.operands[0] == phi)
+          factor = instruction.operands[1];
+        else if (instruction.op == ir_multiply && instruction.operands[1] == phi)
+          factor = instruction.operands[0];
+        if (factor < 0 || inLoop(loop, factor)) {
+          i++;
+          continue;
+        }
+
+        if (!multiples.count(factor)) {
+          int start = multiply(preheader, operands[entry], factor);
+          int by = multiply(preheader, step, factor);
+          int multiple = add(ir_phi, 0, -1, -1);
+          int next = add(op, 0, multiple, by);
+          for (size_t j = 0; j < operands.size(); j++)
+            function.instructions[multiple].operands.push_back(j == entry ? start : next);
+          std::vector<int> &header = function.blocks[loop.header].instructions;
+          header.insert(header.begin(), multiple);
+          blockOf[multiple] = loop.header;
+          std::vector<int> &stepped = function.blocks[blockOf[update]].instructions;
+          stepped.insert(std::find(stepped.begin(), stepped.end(), update) + 1, next);
+          blockOf[next] = blockOf[update];
+          multiples[factor] = multiple;
+          i = std::find(function.blocks[b].instructions.begin(), function.blocks[b].instructions.end(), value) -
+              function.blocks[b].instructions.begin();
+        }
+
+        function.blocks[b].instructions.erase(function.blocks[b].instructions.begin() + i);
+        blockOf[value] = -1;
+        replaceUses(value, multiples[factor]);
+        report.reductions++;
+      }
+    }
+  }
+}
+
+// Lays out every preheader made right before its header, so that
+// it falls through into the loop.
+void LoopOptimizer::placePreheaders() {
+  std::vector<int> order, number(function.blocks.size(), -1);
+  for (size_t b = 0; b < function.blocks.size(); b++) {
+    if (std::find(before.begin(), before.end(), (int) b) != before.end())
+      continue;
+    std::vector<int> chain(1, b);
+    while (before[chain.back()] >= 0)
+      chain.push_back(before[chain.back()]);
+    for (size_t i = chain.size(); i-- > 0;) {
+      number[chain[i]] = order.size();
+      order.push_back(chain[i]);
+    }
+  }
+  std::vector<IrBlock> blocks(order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    blocks[i] = function.blocks[order[i]];
+    for (size_t j = 0; j < blocks[i].predecessors.size(); j++)
+      blocks[i].predecessors[j] = number[blocks[i].predecessors[j]];
+    for (size_t j = 0; j < blocks[i].successors.size(); j++)
+      blocks[i].successors[j] = number[blocks[i].successors[j]];
+  }
+  function.blocks.swap(blocks);
+}
+
+// Optimizes the smallest loop not optimized yet until none is left,
+// finding the loops again after each, since making a preheader adds
+// a block to the loops around it.
+void LoopOptimizer::run() {
+  locate();
+  before.assign(function.blocks.size(), -1);
+  dominators(function, idom);
+  std::vector<bool> done(function.blocks.size(), false);
+  for (;;) {
+    std::vector<IrLoop> loops;
+    findLoops(function, idom, loops);
+    const IrLoop *next = NULL;
+    for (size_t i = 0; i < loops.size(); i++)
+      if (!done[loops[i].header] && (!next || loops[i].size < next->size))
+        next = &loops[i];
+    if (!next)
+      break;
+    IrLoop loop = *next;
+    done[loop.header] = true;
+    report.loops++;
+    int entering = preheader(loop);
+    done.resize(function.blocks.size(), false);
+    loop.blocks.resize(function.blocks.size(), false);
+    hoist(loop, entering);
+    reduce(loop, entering);
+  }
+  placePreheaders();
+}
+
+void optimizeLoops(std::vector<IrFunction> &functions, std::vector<LoopReport> &reports) {
+  std::map<int, Callee> callees;
+  for (size_t i = 0; i < functions.size(); i++)
+    summarize(functions[i], callees[functions[i].number]);
+  reports.clear();
+  for (size_t i = 0; i < functions.size(); i++) {
+    LoopReport report = {0, 0, 0, 0, 0, 0};
+    LoopOptimizer optimizer(functions[i], callees, report);
+    optimizer.run();
+    reports.push_back(report);
+  }
+}
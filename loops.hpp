@@ -0,0 +1,42 @@
+#ifndef __LOOPS_HPP
+#define __LOOPS_HPP
+
+#include "ir.hpp"
+
+#include <vector>
+
+// Defines what optimizing the loops of a function did: how many
+// loops it has, how many instructions of each kind were hoisted out
+// of them, and how many multiplications were made additions.
+typedef struct loopreport {
+  int loops;
+  int memberReads;
+  int calls;
+  int operators;
+  int checks;
+  int reductions;
+} LoopReport;
+
+// Optimizes the loops of every function, the while and repeat
+// statements of its method body, innermost first.
+//
+// An instruction of a loop whose operands are all defined outside it
+// is hoisted into its preheader, the block that enters it, which is
+// made where the loop has none, when running it there gives the same
+// value and cannot fail: arithmetic, division by a constant other
+// than 0, reading a member of an object that cannot be none when no
+// instruction of the loop sets a member at that offset or calls a
+// function that may, and calling a function that only reads members
+// of its object and computes with them. An object cannot be none if
+// it is the one the method runs on, was made with new, or was
+// checked on every path to the preheader.
+//
+// A value of the loop that is a multiple of an induction variable,
+// a phi of its header that each iteration adds the same value to or
+// subtracts it from, is made an induction variable of its own,
+// starting at the multiple of the start and stepping by the multiple
+// of the step, so that the multiplication becomes an addition.
+// Division is left alone: a quotient does not step evenly.
+void optimizeLoops(std::vector<IrFunction> &functions, std::vector<LoopReport> &reports);
+
+#endif
@@ -1,27 +1,642 @@
-#include "ast.hpp"
-#include "typecheck.hpp"
-#include "parser.hpp"
+#include "bytecode.hpp"
+#include "codegen.hpp"
+#include "escape.hpp"
+#include "fold.hpp"
+#include "inliner.hpp"
+#include "ir.hpp"
+#include "jit.hpp"
+#include "langcheck.hpp"
+#include "loops.hpp"
+#include "vm.hpp"
+#include "workspace.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 extern int yydebug;
-extern int yyparse();
 
-ASTNode* astRoot;
+void usage() {
+    std::cerr << "usage: lang [--max-errors N] [--layouts] [--format=F] [--lib L] [--make-lib L]" << std::endl;
+    std::cerr << "            [--time-report] [--stats] [-j N] [--threads N] [--server] [--run] [--interpret]" << std::endl;
+    std::cerr << "            [--bytecode] [--ir] [-S] [-o F] [--opt-report] [file.lang ...]" << std::endl;
+    std::cerr << "  --max-errors N   stop reporting after N errors (0, the default, reports all)" << std::endl;
+    std::cerr << "  --layouts        also print the flattened member and method layout of each class" << std::endl;
+    std::cerr << "  --format=F       print the symbol table as text (the default), json or binary; the" << std::endl;
+    std::cerr << "                   json of several files is one object with a member named by each path," << std::endl;
+    std::cerr << "                   and binary takes one file" << std::endl;
+    std::cerr << "  --lib L          import the classes of the class library L before checking" << std::endl;
+    std::cerr << "  --make-lib L     check the classes of one file, which needs no Main class, and" << std::endl;
+    std::cerr << "                   write them to the class library L instead of printing them" << std::endl;
+    std::cerr << "  --time-report    print the wall and CPU time of each phase to standard error" << std::endl;
+    std::cerr << "  --stats          print node, lookup and hardware counts and peak memory to standard error" << std::endl;
+    std::cerr << "  -j N             check N files at a time (default 1)" << std::endl;
+    std::cerr << "  --threads N      check the method bodies of each file on N threads (default 1)" << std::endl;
+    std::cerr << "  --server         serve check requests on standard input, re-checking only what changed" << std::endl;
+    std::cerr << "  --run            run Main.main of each program that checks instead of printing its symbol table" << std::endl;
+    std::cerr << "  --interpret      with --run, interpret the bytecode instead of compiling it to machine code" << std::endl;
+    std::cerr << "  --bytecode       print the bytecode --run would run instead of the symbol table" << std::endl;
+    std::cerr << "  --ir             print the SSA form -S and -o compile from instead of the symbol table" << std::endl;
+    std::cerr << "  -S               print the program as x86-64 assembly instead of the symbol table" << std::endl;
+    std::cerr << "  -o F             compile the program to the executable F, or with -S write its assembly to F" << std::endl;
+    std::cerr << "  --opt-report     with --run, --bytecode, --ir, -S or -o, print what optimizing the program did;" << std::endl;
+    std::cerr << "                   objects are replaced and loops optimized only for --ir, -S and -o" << std::endl;
+    std::cerr << "With no files, the program is read from standard input. With LANG_GC_STRESS=N in the" << std::endl;
+    std::cerr << "environment, --run and the executables of -o collect before every allocation, and fully" << std::endl;
+    std::cerr << "every Nth time." << std::endl;
+    exit(2);
+}
 
-int main(void) {
-    yydebug = 0; // Set this to 1 if you want the parser to output debug information and parse process
-    
-    astRoot = NULL;
-    
-    yyparse();
-    
-    if (astRoot) {
-        TypeCheck* typecheck = new TypeCheck();
-        astRoot->accept(typecheck);
-        ClassTable* classTable = typecheck->classTable;
-        if (classTable) {
-            print(*classTable);
+// Defines the options every file is checked with.
+typedef struct options {
+    int maxErrors;
+    bool layouts;
+    Format format;
+    std::vector<const Library*> libraries;
+    const char* makeLib;
+    bool timeReport;
+    bool stats;
+    int jobs;
+    int threads;
+    bool server;
+    bool run;
+    bool interpret;
+    bool bytecode;
+    bool ir;
+    bool assembly;
+    const char* output;
+    bool optReport;
+} Options;
+
+// Defines the standard output of files checked at once. Each file
+// writes to a stream of its own, which goes straight to standard
+// output while every file named before it has finished, and is held
+// until they have otherwise, so the output is in the order the files
+// were named whatever the thread count, and a program that runs for
+// long shows what it prints as it prints it. A file that is held
+// waits once it holds heldLimit bytes, so the memory held is bounded.
+// What a file writes to standard error is written once it finishes.
+class OrderedOutput {
+public:
+    static const size_t heldLimit = 1 << 20;
+
+    explicit OrderedOutput(size_t files) : held(files), errors(files), finished(files, false), head(0) {
+        for (size_t i = 0; i < files; i++)
+            buffers.push_back(new FileBuffer(*this, i));
+    }
+    ~OrderedOutput() {
+        for (size_t i = 0; i < buffers.size(); i++)
+            delete buffers[i];
+    }
+
+    // Returns the stream file writes its standard output to.
+    std::ostream& stream(size_t file) { return buffers[file]->stream; }
+
+    // Marks file finished, with what it writes to standard error.
+    void finish(size_t file, const std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        errors[file] = error;
+        finished[file] = true;
+        while (head < finished.size() && finished[head]) {
+            std::cerr << errors[head];
+            if (++head < held.size()) {
+                std::cout << held[head];
+                std::cout.flush();
+                std::string().swap(held[head]);
+            }
+        }
+        moved.notify_all();
+    }
+
+private:
+    // Defines the buffer behind the stream of one file, which hands
+    // every write to the output.
+    class FileBuffer : public std::streambuf {
+    public:
+        FileBuffer(OrderedOutput& output, size_t file) : output(output), file(file), stream(this) {}
+
+        OrderedOutput& output;
+        size_t file;
+        std::ostream stream;
+
+    protected:
+        std::streamsize xsputn(const char* text, std::streamsize length) {
+            output.write(file, text, length);
+            return length;
+        }
+        int overflow(int c) {
+            if (c != EOF) {
+                char text = c;
+                output.write(file, &text, 1);
+            }
+            return c;
+        }
+    };
+
+    OrderedOutput(const OrderedOutput&);
+    OrderedOutput& operator=(const OrderedOutput&);
+
+    void write(size_t file, const char* text, size_t length) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (file != head && held[file].size() >= heldLimit)
+            moved.wait(lock);
+        if (file == head) {
+            std::cout.write(text, length);
+            std::cout.flush();
+        } else {
+            held[file].append(text, length);
+        }
+    }
+
+    std::vector<FileBuffer*> buffers;
+    std::vector<std::string> held;
+    std::vector<std::string> errors;
+    std::vector<bool> finished;
+    size_t head;
+    std::mutex mutex;
+    std::condition_variable moved;
+};
+
+// Writes the symbol table of a checked compilation to the class
+// library at path.
+void writeLibrary(Compilation& compilation, const char* path) {
+    std::ofstream file(path, std::ios::binary);
+    if (file) {
+        Emitter emitter(file);
+        emit(emitter, compilation.symbols, *compilation.classTable, f_binary, 0, true);
+        emitter.flush();
+    }
+    if (!file)
+        compilation.diagnostics.error(std::string("cannot write class library: ") + path, NULL, 0);
+}
+
+// Writes the native code of a lowered program: prints its assembly,
+// writes it to the output file, or assembles it into an executable
+// there.
+void compileNative(Compilation& compilation, const Options& options, const Bytecode& bytecode,
+                   const std::vector<IrFunction>& functions, std::ostream& out) {
+    std::ostringstream assembly;
+    generate(assembly, compilation.symbols, bytecode, functions);
+    std::string error;
+    if (options.assembly && !options.output) {
+        out << assembly.str();
+    } else if (options.assembly) {
+        std::ofstream file(options.output);
+        file << assembly.str();
+        if (!file)
+            error = std::string("cannot write ") + options.output;
+    } else {
+        assemble(assembly.str(), options.output, error);
+    }
+    if (!error.empty())
+        compilation.diagnostics.error(error, NULL, 0);
+}
+
+// Checks that the IR of every function is well formed after a pass,
+// reporting what is not as an internal error.
+bool checkIr(Compilation& compilation, const Bytecode& bytecode, const std::vector<IrFunction>& functions,
+             const char* pass) {
+    for (size_t i = 0; i < functions.size(); i++) {
+        std::string error;
+        if (!verify(functions[i], error)) {
+            const Function& code = bytecode.functions[functions[i].number];
+            compilation.diagnostics.error("internal error: bad IR of " + compilation.symbols.name(code.className) +
+                                              "." + compilation.symbols.name(code.name) + " after " + pass + ": " +
+                                              error,
+                                          NULL, 0);
+            return false;
         }
     }
+    return true;
+}
+
+// Prints a count of things, with the plural of their name unless
+// there is one.
+void printCount(std::ostream& err, int count, const char* name) {
+    err << count << " " << name << (count == 1 ? "" : "s");
+}
+
+// Prints, for every method that makes objects, how many of them were
+// replaced with their members.
+void printEscapeReport(std::ostream& err, const std::string& prefix, const SymbolInterner& symbols,
+                       const Bytecode& bytecode, const std::vector<IrFunction>& functions,
+                       const std::vector<EscapeReport>& reports) {
+    for (size_t i = 0; i < functions.size(); i++) {
+        if (!reports[i].objects)
+            continue;
+        const Function& code = bytecode.functions[functions[i].number];
+        err << prefix << symbols.name(code.className) << "." << symbols.name(code.name) << ": replaced "
+            << reports[i].replaced << " of ";
+        printCount(err, reports[i].objects, "new object");
+        err << " with their members" << std::endl;
+    }
+}
+
+// Prints, for every method with loops, what optimizing them did.
+void printLoopReport(std::ostream& err, const std::string& prefix, const SymbolInterner& symbols,
+                     const Bytecode& bytecode, const std::vector<IrFunction>& functions,
+                     const std::vector<LoopReport>& reports) {
+    for (size_t i = 0; i < functions.size(); i++) {
+        const LoopReport& report = reports[i];
+        if (!report.loops)
+            continue;
+        const Function& code = bytecode.functions[functions[i].number];
+        err << prefix << symbols.name(code.className) << "." << symbols.name(code.name) << ": ";
+        printCount(err, report.loops, "loop");
+        err << ", hoisted ";
+        printCount(err, report.memberReads, "member read");
+        err << ", ";
+        printCount(err, report.calls, "call");
+        err << ", ";
+        printCount(err, report.operators, "operator");
+        err << " and ";
+        printCount(err, report.checks, "none check");
+        err << ", reduced ";
+        printCount(err, report.reductions, "multiplication");
+        err << std::endl;
+    }
+}
+
+// Builds the IR of a lowered program, replaces the objects that do
+// not escape their methods and optimizes loops, checking that it is well formed after each pass.
+bool buildCheckedIr(Compilation& compilation, const Options& options, const std::string& prefix,
+                    const Bytecode& bytecode, std::vector<IrFunction>& functions, std::ostream& err) {
+    buildIr(bytecode, functions);
+    if (!checkIr(compilation, bytecode, functions, "building"))
+        return false;
+    std::vector<EscapeReport> escapeReports;
+    replaceObjects(functions, escapeReports);
+    if (!checkIr(compilation, bytecode, functions, "replacing objects"))
+        return false;
+    std::vector<LoopReport> loopReports;
+    optimizeLoops(functions, loopReports);
+    if (!checkIr(compilation, bytecode, functions, "loop optimization"))
+        return false;
+    if (options.optReport) {
+        err << prefix << "in the IR of --ir, -S and -o:" << std::endl;
+        printEscapeReport(err, prefix, compilation.symbols, bytecode, functions, escapeReports);
+        printLoopReport(err, prefix, compilation.symbols, bytecode, functions, loopReports);
+    }
+    return true;
+}
+
+// Prints how many method calls lowering made direct, and how many
+// calls were inlined, which every backend runs the result of. The
+// passes over the IR are reported by buildCheckedIr, or said not to
+// run if there is none.
+void printOptimizationReport(std::ostream& err, const std::string& prefix, const Bytecode& bytecode, bool ir) {
+    err << prefix << "devirtualized " << bytecode.directCalls << " of " << bytecode.methodCalls << " method calls";
+    if (bytecode.methodCalls)
+        err << " (" << std::fixed << std::setprecision(1) << 100.0 * bytecode.directCalls / bytecode.methodCalls
+            << "%)";
+    err << std::endl;
+    err << prefix << "inlined " << bytecode.inlinedCalls << " calls" << std::endl;
+    if (!ir)
+        err << prefix << "replacing objects and optimizing loops run only on the IR of --ir, -S and -o" << std::endl;
+}
 
+// Simplifies and lowers a checked compilation to bytecode, inlines
+// small functions, and runs it, compiling its methods to machine
+// code as they are first called unless it is to be interpreted,
+// prints the bytecode, or builds its IR, optimizes it and prints it
+// or compiles it to native code. What keeps the program from being
+// lowered or makes it fail at run time is reported to the
+// diagnostics of the compilation. The optimization report is printed
+// to err.
+void runProgram(Compilation& compilation, const Options& options, const std::string& prefix,
+                std::ostream& out, std::ostream& err) {
+    fold(compilation);
+    Bytecode bytecode;
+    if (!lower(compilation, bytecode))
+        return;
+    inlineCalls(bytecode);
+    if (options.optReport)
+        printOptimizationReport(err, prefix, bytecode, options.ir || options.assembly || options.output);
+    if (options.bytecode) {
+        disassemble(out, compilation.symbols, bytecode);
+        return;
+    }
+    if (options.ir || options.assembly || options.output) {
+        std::vector<IrFunction> functions;
+        if (!buildCheckedIr(compilation, options, prefix, bytecode, functions, err))
+            return;
+        if (options.ir)
+            printIr(out, compilation.symbols, bytecode, functions);
+        else
+            compileNative(compilation, options, bytecode, functions, out);
+        return;
+    }
+    Emitter emitter(out);
+    std::string error, fallback;
+    bool ok = options.interpret ? run(bytecode, emitter, error) : runCompiled(bytecode, emitter, error, fallback);
+    emitter.flush();
+    if (!fallback.empty())
+        err << prefix << fallback << std::endl;
+    if (!ok)
+        compilation.diagnostics.error("runtime error: " + error, NULL, 0);
+}
+
+// Prints the symbol table of a checked compilation, or writes it
+// to a class library, or runs it, or prints its errors. Errors of named files
+// are prefixed with the file name.
+bool report(Compilation& compilation, const Options& options, const std::string& prefix,
+            std::ostream& out, std::ostream& err) {
+    if (compilation.classTable && !compilation.diagnostics.hasErrors()) {
+        Stopwatch start = stopwatch();
+        if (options.makeLib) {
+            writeLibrary(compilation, options.makeLib);
+        } else if (options.run || options.bytecode || options.ir || options.assembly || options.output) {
+            runProgram(compilation, options, prefix, out, err);
+        } else {
+            Emitter emitter(out);
+            emit(emitter, compilation.symbols, *compilation.classTable, options.format, 0, options.layouts);
+            emitter.flush();
+        }
+        if (compilation.statistics.timed)
+            record(compilation.statistics, t_print, start);
+    }
+    compilation.diagnostics.print(err, prefix);
+    return compilation.diagnostics.hasErrors();
+}
+
+// Sets a compilation up as the options ask, importing the class
+// libraries into it.
+void prepare(Compilation& compilation, const Options& options) {
+    compilation.diagnostics.maxErrors = options.maxErrors;
+    compilation.statistics.timed = options.timeReport;
+    compilation.library = options.makeLib != NULL;
+    compilation.threads = options.threads;
+    for (size_t i = 0; i < options.libraries.size(); i++)
+        import(compilation, *options.libraries[i]);
+}
+
+// Prints what was measured while checking and reporting a
+// compilation, once the hardware counters have been stopped.
+void reportMeasures(const Compilation& compilation, const Options& options, std::ostream& err) {
+    if (options.timeReport)
+        printTimeReport(err, compilation.statistics);
+    if (options.stats)
+        printStats(err, compilation.statistics);
+}
+
+// Returns true if the symbol table of each file checked is what is
+// printed, rather than what running or compiling it prints.
+bool printsSymbolTable(const Options& options) {
+    return !options.makeLib && !options.run && !options.bytecode && !options.ir && !options.assembly &&
+           !options.output;
+}
+
+// Returns text as a JSON string.
+std::string jsonString(const char* text) {
+    std::string quoted = "\"";
+    for (; *text; text++) {
+        if (*text == '"' || *text == '\\')
+            quoted += '\\';
+        quoted += *text;
+    }
+    return quoted + "\"";
+}
+
+// Checks one file, writing what it prints to out and err, and
+// returns true if it failed. With a header, the output of each file
+// is marked with its path: text gets a line with the path, and JSON
+// becomes a member of the object checkFiles wraps the files in,
+// named by the path, which is null if the file has errors.
+bool checkInto(const char* path, const Options& options, bool header, std::ostream& out, std::ostream& err) {
+    Compilation compilation;
+    prepare(compilation, options);
+    HardwareCounters counters;
+    if (options.stats)
+        counters.start();
+    checkFile(compilation, path);
+
+    bool failed;
+    std::string prefix = std::string(path) + ": ";
+    if (header && options.format == f_json && printsSymbolTable(options)) {
+        // The member ends where the table does, before its newline
+        std::ostringstream table;
+        failed = report(compilation, options, prefix, table, err);
+        std::string text = table.str();
+        out << jsonString(path) << ": " << (failed ? std::string("null") : text.substr(0, text.size() - 1));
+    } else {
+        if (header && options.format == f_text)
+            out << path << ":" << std::endl;
+        failed = report(compilation, options, prefix, out, err);
+    }
+    if (options.stats)
+        counters.stop(compilation.statistics);
+    reportMeasures(compilation, options, err);
+    out.flush();
+    return failed;
+}
+
+// Checks files, options.jobs at a time, and returns true if any
+// failed. One at a time, each writes straight to standard output.
+bool checkFiles(const std::vector<const char*>& files, const Options& options) {
+    bool header = files.size() > 1;
+    // Several files' JSON is one object, with a member for each
+    bool wrap = header && options.format == f_json && printsSymbolTable(options);
+    if (wrap)
+        std::cout << "{";
+
+    bool failed = false;
+    if (options.jobs == 1 || files.size() == 1) {
+        for (size_t i = 0; i < files.size(); i++) {
+            if (wrap && i != 0)
+                std::cout << ",\n";
+            failed = checkInto(files[i], options, header, std::cout, std::cerr) || failed;
+        }
+    } else {
+        OrderedOutput output(files.size());
+        std::mutex mutex;
+        size_t next = 0;
+        std::vector<std::thread> workers;
+        for (int i = 0; i < options.jobs && i < (int) files.size(); i++) {
+            workers.push_back(std::thread([&]() {
+                for (;;) {
+                    size_t index;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (next == files.size())
+                            return;
+                        index = next++;
+                    }
+                    std::ostream& out = output.stream(index);
+                    if (wrap && index != 0)
+                        out << ",\n";
+                    std::ostringstream err;
+                    bool fileFailed = checkInto(files[index], options, header, out, err);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    failed = fileFailed || failed;
+                    output.finish(index, err.str());
+                }
+            }));
+        }
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+    }
+
+    if (wrap)
+        std::cout << "}\n";
+    return failed;
+}
+
+// Answers a request with its status and the lengths of its output
+// and its errors, followed by the output and the errors themselves.
+void respond(bool failed, const std::string& out, const std::string& err) {
+    std::cout << (failed ? "failed " : "ok ") << out.size() << " " << err.size() << "\n" << out << err;
+    std::cout.flush();
+}
+
+// Serves requests read from standard input, one per line, until the
+// input ends or a quit request:
+//   check PATH    checks the file at PATH as lang PATH would
+//   forget PATH   drops what is kept of the file at PATH
+// The server keeps the classes of every file it checks, so checking
+// a file again only parses the classes whose text changed and only
+// type checks those and the classes that depend on what changed.
+// Each request is answered by a line with ok or failed and the byte
+// lengths of the output and the errors that follow it.
+int serve(const Options& options) {
+    std::map<std::string, Workspace*> workspaces;
+    std::string line;
+    while (std::getline(std::cin, line) && line != "quit") {
+        if (!line.compare(0, 6, "check ")) {
+            std::string path = line.substr(6);
+            Workspace*& workspace = workspaces[path];
+            if (!workspace)
+                workspace = new Workspace(options.libraries, options.maxErrors);
+            Compilation& compilation = workspace->check(path.c_str());
+            std::ostringstream out, err;
+            bool failed = report(compilation, options, path + ": ", out, err);
+            respond(failed, out.str(), err.str());
+        } else if (!line.compare(0, 7, "forget ")) {
+            std::map<std::string, Workspace*>::iterator it = workspaces.find(line.substr(7));
+            if (it != workspaces.end()) {
+                delete it->second;
+                workspaces.erase(it);
+            }
+            respond(false, "", "");
+        } else {
+            respond(true, "", "unknown request: " + line + "\n");
+        }
+    }
+    for (std::map<std::string, Workspace*>::iterator it = workspaces.begin(); it != workspaces.end(); ++it)
+        delete it->second;
     return 0;
 }
+
+int main(int argc, char** argv) {
+    yydebug = 0; // Set this to 1 if you want the parser to output debug information and parse process
+
+    Options options;
+    options.maxErrors = 0;
+    options.layouts = false;
+    options.format = f_text;
+    options.makeLib = NULL;
+    options.timeReport = false;
+    options.stats = false;
+    options.jobs = 1;
+    options.threads = 1;
+    options.server = false;
+    options.run = false;
+    options.interpret = false;
+    options.bytecode = false;
+    options.ir = false;
+    options.assembly = false;
+    options.output = NULL;
+    options.optReport = false;
+    std::vector<const char*> files;
+    // The libraries stay mapped until every file has been checked
+    std::list<Library> libraries;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--max-errors") && i + 1 < argc) {
+            options.maxErrors = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--layouts")) {
+            options.layouts = true;
+        } else if (!strncmp(argv[i], "--format=", 9)) {
+            if (!formatNamed(argv[i] + 9, options.format))
+                usage();
+        } else if (!strcmp(argv[i], "--lib") && i + 1 < argc) {
+            libraries.emplace_back();
+            Library& library = libraries.back();
+            if (!library.open(argv[++i])) {
+                std::cerr << "lang: cannot open class library " << argv[i] << ": " << library.error << std::endl;
+                return 2;
+            }
+            options.libraries.push_back(&library);
+        } else if (!strcmp(argv[i], "--make-lib") && i + 1 < argc) {
+            options.makeLib = argv[++i];
+        } else if (!strcmp(argv[i], "--time-report")) {
+            options.timeReport = true;
+        } else if (!strcmp(argv[i], "--stats")) {
+            options.stats = true;
+        } else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            options.jobs = atoi(argv[++i]);
+            if (options.jobs < 1)
+                usage();
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+            if (options.threads < 1)
+                usage();
+        } else if (!strcmp(argv[i], "--server")) {
+            options.server = true;
+        } else if (!strcmp(argv[i], "--run")) {
+            options.run = true;
+        } else if (!strcmp(argv[i], "--interpret")) {
+            options.interpret = true;
+        } else if (!strcmp(argv[i], "--bytecode")) {
+            options.bytecode = true;
+        } else if (!strcmp(argv[i], "--ir")) {
+            options.ir = true;
+        } else if (!strcmp(argv[i], "--opt-report")) {
+            options.optReport = true;
+        } else if (!strcmp(argv[i], "-S")) {
+            options.assembly = true;
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    // The binary format has no room for more than one symbol table
+    if ((options.makeLib || (options.format == f_binary && printsSymbolTable(options))) && files.size() > 1)
+        usage();
+    if (options.server && (options.makeLib || !files.empty()))
+        usage();
+    bool native = options.assembly || options.output;
+    if ((options.run || options.bytecode || options.ir || native) && (options.makeLib || options.server))
+        usage();
+    if (native && (options.run || options.bytecode || options.ir || files.size() > 1))
+        usage();
+    if (options.interpret && !options.run)
+        usage();
+    if (options.server)
+        return serve(options);
+    if (!files.empty())
+        return checkFiles(files, options) ? 1 : 0;
+
+    Compilation compilation;
+    prepare(compilation, options);
+    HardwareCounters counters;
+    if (options.stats)
+        counters.start();
+    check(compilation, stdin);
+    bool failed = report(compilation, options, "", std::cout, std::cerr);
+    if (options.stats)
+        counters.stop(compilation.statistics);
+    std::cout.flush();
+    reportMeasures(compilation, options, std::cerr);
+    return failed ? 1 : 0;
+}
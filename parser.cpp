@@ -0,0 +1,2231 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 2
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 1 "parser.y"
+
+    #include <cstdlib>
+    #include <cstdio>
+    #include <iostream>
+    #include <sstream>
+    #include "ast.hpp"
+    #include "langcheck.hpp"
+
+    #define YYDEBUG 1
+    #define YYINITDEPTH 10000
+
+#line 83 "parser.cpp"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "parser.hpp"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_T_ARROW = 3,                    /* T_ARROW  */
+  YYSYMBOL_T_LEQ = 4,                      /* T_LEQ  */
+  YYSYMBOL_T_EQUALS = 5,                   /* T_EQUALS  */
+  YYSYMBOL_T_AND = 6,                      /* T_AND  */
+  YYSYMBOL_T_OR = 7,                       /* T_OR  */
+  YYSYMBOL_T_NOT = 8,                      /* T_NOT  */
+  YYSYMBOL_T_NUMBER = 9,                   /* T_NUMBER  */
+  YYSYMBOL_T_TRUE = 10,                    /* T_TRUE  */
+  YYSYMBOL_T_FALSE = 11,                   /* T_FALSE  */
+  YYSYMBOL_T_INTEGER = 12,                 /* T_INTEGER  */
+  YYSYMBOL_T_BOOLEAN = 13,                 /* T_BOOLEAN  */
+  YYSYMBOL_T_NONE = 14,                    /* T_NONE  */
+  YYSYMBOL_T_PRINT = 15,                   /* T_PRINT  */
+  YYSYMBOL_T_RETURN = 16,                  /* T_RETURN  */
+  YYSYMBOL_T_IF = 17,                      /* T_IF  */
+  YYSYMBOL_T_ELSE = 18,                    /* T_ELSE  */
+  YYSYMBOL_T_WHILE = 19,                   /* T_WHILE  */
+  YYSYMBOL_T_NEW = 20,                     /* T_NEW  */
+  YYSYMBOL_T_EXTENDS = 21,                 /* T_EXTENDS  */
+  YYSYMBOL_T_IDENTIFIER = 22,              /* T_IDENTIFIER  */
+  YYSYMBOL_T_REPEAT = 23,                  /* "repeat"  */
+  YYSYMBOL_T_UNTIL = 24,                   /* "until"  */
+  YYSYMBOL_25_ = 25,                       /* '<'  */
+  YYSYMBOL_26_ = 26,                       /* '+'  */
+  YYSYMBOL_27_ = 27,                       /* '-'  */
+  YYSYMBOL_28_ = 28,                       /* '*'  */
+  YYSYMBOL_29_ = 29,                       /* '/'  */
+  YYSYMBOL_UMINUS = 30,                    /* UMINUS  */
+  YYSYMBOL_31_ = 31,                       /* '{'  */
+  YYSYMBOL_32_ = 32,                       /* '}'  */
+  YYSYMBOL_33_ = 33,                       /* ';'  */
+  YYSYMBOL_34_ = 34,                       /* '('  */
+  YYSYMBOL_35_ = 35,                       /* ')'  */
+  YYSYMBOL_36_ = 36,                       /* ','  */
+  YYSYMBOL_37_ = 37,                       /* ':'  */
+  YYSYMBOL_38_ = 38,                       /* '='  */
+  YYSYMBOL_39_ = 39,                       /* '.'  */
+  YYSYMBOL_YYACCEPT = 40,                  /* $accept  */
+  YYSYMBOL_Start = 41,                     /* Start  */
+  YYSYMBOL_Classes = 42,                   /* Classes  */
+  YYSYMBOL_Class = 43,                     /* Class  */
+  YYSYMBOL_Members = 44,                   /* Members  */
+  YYSYMBOL_Member = 45,                    /* Member  */
+  YYSYMBOL_Methods = 46,                   /* Methods  */
+  YYSYMBOL_ReversedMethods = 47,           /* ReversedMethods  */
+  YYSYMBOL_Method = 48,                    /* Method  */
+  YYSYMBOL_Parameters = 49,                /* Parameters  */
+  YYSYMBOL_ParameterList = 50,             /* ParameterList  */
+  YYSYMBOL_Parameter = 51,                 /* Parameter  */
+  YYSYMBOL_Body = 52,                      /* Body  */
+  YYSYMBOL_Declarations = 53,              /* Declarations  */
+  YYSYMBOL_Declaration = 54,               /* Declaration  */
+  YYSYMBOL_IdentifierList = 55,            /* IdentifierList  */
+  YYSYMBOL_Statements = 56,                /* Statements  */
+  YYSYMBOL_ReversedStatements = 57,        /* ReversedStatements  */
+  YYSYMBOL_Block = 58,                     /* Block  */
+  YYSYMBOL_ReturnStatement = 59,           /* ReturnStatement  */
+  YYSYMBOL_Statement = 60,                 /* Statement  */
+  YYSYMBOL_Assignment = 61,                /* Assignment  */
+  YYSYMBOL_IfElse = 62,                    /* IfElse  */
+  YYSYMBOL_WhileLoop = 63,                 /* WhileLoop  */
+  YYSYMBOL_repeat = 64,                    /* repeat  */
+  YYSYMBOL_Print = 65,                     /* Print  */
+  YYSYMBOL_Expression = 66,                /* Expression  */
+  YYSYMBOL_MethodCall = 67,                /* MethodCall  */
+  YYSYMBOL_Arguments = 68,                 /* Arguments  */
+  YYSYMBOL_ArgumentList = 69,              /* ArgumentList  */
+  YYSYMBOL_Argument = 70,                  /* Argument  */
+  YYSYMBOL_Type = 71,                      /* Type  */
+  YYSYMBOL_ReturnType = 72                 /* ReturnType  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+/* Unqualified %code blocks.  */
+#line 21 "parser.y"
+
+    int yylex(YYSTYPE *lvalp, yyscan_t scanner);
+    int yyget_lineno(yyscan_t scanner);
+    void yyerror(yyscan_t scanner, Compilation *compilation, const char *);
+
+#line 196 "parser.cpp"
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if 1
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* 1 */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  7
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   238
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  40
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  33
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  76
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  156
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   280
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+      34,    35,    28,    26,    36,    27,    39,    29,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,    37,    33,
+      25,    38,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    31,     2,    32,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      30
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_uint8 yyrline[] =
+{
+       0,    77,    77,    80,    81,    84,    85,    88,    89,    92,
+     100,   103,   104,   107,   110,   111,   114,   115,   118,   121,
+     124,   125,   128,   131,   132,   135,   138,   139,   142,   145,
+     146,   149,   150,   151,   152,   153,   154,   155,   158,   159,
+     162,   163,   166,   171,   173,   176,   177,   178,   179,   180,
+     181,   182,   183,   184,   185,   186,   187,   188,   189,   190,
+     191,   192,   193,   194,   195,   198,   199,   202,   203,   206,
+     207,   210,   213,   214,   215,   218,   219
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "T_ARROW", "T_LEQ",
+  "T_EQUALS", "T_AND", "T_OR", "T_NOT", "T_NUMBER", "T_TRUE", "T_FALSE",
+  "T_INTEGER", "T_BOOLEAN", "T_NONE", "T_PRINT", "T_RETURN", "T_IF",
+  "T_ELSE", "T_WHILE", "T_NEW", "T_EXTENDS", "T_IDENTIFIER", "\"repeat\"",
+  "\"until\"", "'<'", "'+'", "'-'", "'*'", "'/'", "UMINUS", "'{'", "'}'",
+  "';'", "'('", "')'", "','", "':'", "'='", "'.'", "$accept", "Start",
+  "Classes", "Class", "Members", "Member", "Methods", "ReversedMethods",
+  "Method", "Parameters", "ParameterList", "Parameter", "Body",
+  "Declarations", "Declaration", "IdentifierList", "Statements",
+  "ReversedStatements", "Block", "ReturnStatement", "Statement",
+  "Assignment", "IfElse", "WhileLoop", "repeat", "Print", "Expression",
+  "MethodCall", "Arguments", "ArgumentList", "Argument", "Type",
+  "ReturnType", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-112)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-28)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+     -14,    41,    33,   -14,  -112,    23,  -112,  -112,  -112,    28,
+       4,  -112,  -112,  -112,    13,  -112,    42,  -112,    43,    55,
+       4,    61,  -112,    13,  -112,    54,    62,    56,    69,    71,
+    -112,  -112,  -112,    24,   102,    61,  -112,  -112,    16,  -112,
+    -112,  -112,    77,  -112,    87,    63,  -112,    76,   176,   176,
+     176,    32,    95,  -112,   112,  -112,   126,   100,  -112,  -112,
+     101,   122,   124,   113,  -112,   176,  -112,  -112,  -112,   137,
+     -25,   176,   176,   195,  -112,   125,   166,   176,   176,   138,
+     215,   176,  -112,    32,  -112,  -112,  -112,  -112,  -112,  -112,
+      48,  -112,   110,   140,  -112,    85,   176,   176,   176,   176,
+     176,   176,   176,   176,   176,   215,   215,   195,   129,   130,
+    -112,   195,   -28,   135,   146,    15,  -112,   152,   176,   141,
+    -112,    70,    70,   200,    96,    70,    39,    39,  -112,  -112,
+     144,   145,  -112,   176,   176,   176,   155,  -112,  -112,  -112,
+     147,   162,  -112,  -112,   148,   195,   154,  -112,   150,  -112,
+     176,   215,   111,   157,  -112,  -112
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       0,     0,     0,     2,     4,     0,     8,     1,     3,     0,
+      12,     8,    72,    73,    74,     7,     0,    10,    12,     0,
+      12,    15,     5,     0,    11,     0,     0,     0,     0,    14,
+      17,     9,     6,     0,     0,     0,    74,    18,     0,    16,
+      76,    75,     0,    21,     0,     0,    13,     0,     0,     0,
+       0,    74,     0,    20,    30,    25,     0,     0,    33,    34,
+       0,     0,     0,     0,    37,     0,    60,    61,    62,     0,
+      59,     0,     0,    44,    56,     0,     0,    68,     0,     0,
+       0,     0,    19,     0,    26,    31,    36,    35,    32,    24,
+       0,    54,    64,     0,    55,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,    71,     0,    67,
+      70,    38,     0,     0,     0,     0,    22,     0,    68,    57,
+      58,    50,    51,    52,    53,    49,    45,    46,    47,    48,
+       0,     0,    66,     0,    68,     0,     0,    28,    29,    23,
+       0,    40,    42,    69,     0,    39,     0,    63,     0,    65,
+       0,     0,     0,     0,    43,    41
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+    -112,  -112,  -112,   187,   196,  -112,   186,   190,  -112,  -112,
+    -112,   174,  -112,  -112,  -112,  -112,  -112,   -51,   -93,  -112,
+     -41,  -112,  -112,  -112,  -112,  -112,   -47,   -45,  -111,  -112,
+      78,    -6,  -112
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     2,     3,     4,    10,    15,    16,    17,    18,    28,
+      29,    30,    44,    45,    53,    90,    54,    55,   113,    82,
+     114,    57,    58,    59,    60,    61,   107,    74,   108,   109,
+     110,    19,    42
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
+{
+      62,    73,    75,    76,    56,    84,   134,   140,     1,    77,
+     135,    62,   130,   131,    93,    56,    12,    13,    91,    96,
+      97,    98,    99,   144,    94,    95,    14,    37,    12,    13,
+      40,   111,    41,     7,   115,    62,    12,    13,    36,    63,
+     100,   101,   102,   103,   104,     9,    36,    21,   138,   121,
+     122,   123,   124,   125,   126,   127,   128,   129,   153,    11,
+      62,    62,     5,   137,    47,    23,    77,   103,   104,    62,
+      78,    79,     6,    56,    22,    12,    13,    25,    48,   -27,
+      49,   116,    50,    27,   117,    51,    52,    31,   145,    96,
+      97,    98,    99,    33,    32,   -27,   101,   102,   103,   104,
+      96,    97,    98,   152,    34,    38,    62,    35,    43,    64,
+     100,   101,   102,   103,   104,    96,    97,    98,    99,    46,
+     120,   100,   101,   102,   103,   104,    80,    47,    81,    96,
+      97,    98,    99,    85,    86,    89,   100,   101,   102,   103,
+     104,    48,   -27,    49,   118,    50,   154,    47,    83,    52,
+     100,   101,   102,   103,   104,    87,   105,    88,   -27,    92,
+     112,    48,   119,    49,   132,    50,   133,   136,    83,    52,
+      96,    97,    98,    99,   139,   134,   141,   142,   -27,   146,
+     148,   151,   147,   149,    65,    66,    67,    68,   150,   155,
+       8,   100,   101,   102,   103,   104,    69,   106,    70,    96,
+      97,    98,    99,    71,    96,    97,    26,    20,    24,    39,
+      72,   143,     0,     0,     0,     0,    47,     0,     0,     0,
+     100,   101,   102,   103,   104,   100,   101,   102,   103,   104,
+      48,     0,    49,     0,    50,     0,     0,    83,    52
+};
+
+static const yytype_int16 yycheck[] =
+{
+      45,    48,    49,    50,    45,    56,    34,   118,    22,    34,
+      38,    56,   105,   106,    39,    56,    12,    13,    65,     4,
+       5,     6,     7,   134,    71,    72,    22,    33,    12,    13,
+      14,    78,    38,     0,    81,    80,    12,    13,    22,    45,
+      25,    26,    27,    28,    29,    22,    22,    34,    33,    96,
+      97,    98,    99,   100,   101,   102,   103,   104,   151,    31,
+     105,   106,    21,   114,     1,    22,    34,    28,    29,   114,
+      38,    39,    31,   114,    32,    12,    13,    22,    15,    16,
+      17,    33,    19,    22,    36,    22,    23,    33,   135,     4,
+       5,     6,     7,    37,    32,    32,    26,    27,    28,    29,
+       4,     5,     6,   150,    35,     3,   151,    36,    31,    33,
+      25,    26,    27,    28,    29,     4,     5,     6,     7,    32,
+      35,    25,    26,    27,    28,    29,    31,     1,    16,     4,
+       5,     6,     7,    33,    33,    22,    25,    26,    27,    28,
+      29,    15,    16,    17,    34,    19,    35,     1,    22,    23,
+      25,    26,    27,    28,    29,    33,    31,    33,    32,    22,
+      22,    15,    22,    17,    35,    19,    36,    32,    22,    23,
+       4,     5,     6,     7,    22,    34,    32,    32,    32,    24,
+      18,    31,    35,    35,     8,     9,    10,    11,    34,    32,
+       3,    25,    26,    27,    28,    29,    20,    31,    22,     4,
+       5,     6,     7,    27,     4,     5,    20,    11,    18,    35,
+      34,   133,    -1,    -1,    -1,    -1,     1,    -1,    -1,    -1,
+      25,    26,    27,    28,    29,    25,    26,    27,    28,    29,
+      15,    -1,    17,    -1,    19,    -1,    -1,    22,    23
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,    22,    41,    42,    43,    21,    31,     0,    43,    22,
+      44,    31,    12,    13,    22,    45,    46,    47,    48,    71,
+      44,    34,    32,    22,    47,    22,    46,    22,    49,    50,
+      51,    33,    32,    37,    35,    36,    22,    71,     3,    51,
+      14,    71,    72,    31,    52,    53,    32,     1,    15,    17,
+      19,    22,    23,    54,    56,    57,    60,    61,    62,    63,
+      64,    65,    67,    71,    33,     8,     9,    10,    11,    20,
+      22,    27,    34,    66,    67,    66,    66,    34,    38,    39,
+      31,    16,    59,    22,    57,    33,    33,    33,    33,    22,
+      55,    66,    22,    39,    66,    66,     4,     5,     6,     7,
+      25,    26,    27,    28,    29,    31,    31,    66,    68,    69,
+      70,    66,    22,    58,    60,    66,    33,    36,    34,    22,
+      35,    66,    66,    66,    66,    66,    66,    66,    66,    66,
+      58,    58,    35,    36,    34,    38,    32,    57,    33,    22,
+      68,    32,    32,    70,    68,    66,    24,    35,    18,    35,
+      34,    31,    66,    58,    35,    32
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    40,    41,    42,    42,    43,    43,    44,    44,    45,
+      46,    47,    47,    48,    49,    49,    50,    50,    51,    52,
+      53,    53,    54,    55,    55,    56,    57,    57,    58,    59,
+      59,    60,    60,    60,    60,    60,    60,    60,    61,    61,
+      62,    62,    63,    64,    65,    66,    66,    66,    66,    66,
+      66,    66,    66,    66,    66,    66,    66,    66,    66,    66,
+      66,    66,    66,    66,    66,    67,    67,    68,    68,    69,
+      69,    70,    71,    71,    71,    72,    72
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     2,     1,     5,     7,     2,     0,     3,
+       1,     2,     0,     9,     1,     0,     3,     1,     3,     3,
+       2,     0,     3,     3,     1,     1,     2,     0,     2,     3,
+       0,     2,     2,     1,     1,     2,     2,     2,     3,     5,
+       5,     9,     5,     8,     2,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     2,     2,     1,     3,     3,     1,
+       1,     1,     1,     5,     2,     6,     4,     1,     0,     3,
+       1,     1,     1,     1,     1,     1,     1
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (scanner, compilation, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, scanner, compilation); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, yyscan_t scanner, Compilation *compilation)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (scanner);
+  YY_USE (compilation);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, yyscan_t scanner, Compilation *compilation)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep, scanner, compilation);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, yyscan_t scanner, Compilation *compilation)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], scanner, compilation);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, scanner, compilation); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
+
+
+
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
+/* Return the length of YYSTR.  */
+static YYPTRDIFF_T
+yystrlen (const char *yystr)
+{
+  YYPTRDIFF_T yylen;
+  for (yylen = 0; yystr[yylen]; yylen++)
+    continue;
+  return yylen;
+}
+# endif
+#endif
+
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
+/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
+   YYDEST.  */
+static char *
+yystpcpy (char *yydest, const char *yysrc)
+{
+  char *yyd = yydest;
+  const char *yys = yysrc;
+
+  while ((*yyd++ = *yys++) != '\0')
+    continue;
+
+  return yyd - 1;
+}
+# endif
+#endif
+
+#ifndef yytnamerr
+/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
+   quotes and backslashes, so that it's suitable for yyerror.  The
+   heuristic is that double-quoting is unnecessary unless the string
+   contains an apostrophe, a comma, or backslash (other than
+   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
+   null, do not copy; instead, return the length of what the result
+   would have been.  */
+static YYPTRDIFF_T
+yytnamerr (char *yyres, const char *yystr)
+{
+  if (*yystr == '"')
+    {
+      YYPTRDIFF_T yyn = 0;
+      char const *yyp = yystr;
+      for (;;)
+        switch (*++yyp)
+          {
+          case '\'':
+          case ',':
+            goto do_not_strip_quotes;
+
+          case '\\':
+            if (*++yyp != '\\')
+              goto do_not_strip_quotes;
+            else
+              goto append;
+
+          append:
+          default:
+            if (yyres)
+              yyres[yyn] = *yyp;
+            yyn++;
+            break;
+
+          case '"':
+            if (yyres)
+              yyres[yyn] = '\0';
+            return yyn;
+          }
+    do_not_strip_quotes: ;
+    }
+
+  if (yyres)
+    return yystpcpy (yyres, yystr) - yyres;
+  else
+    return yystrlen (yystr);
+}
+#endif
+
+
+static int
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  /* There are many possibilities here to consider:
+     - If this state is a consistent state with a default action, then
+       the only way this function was invoked is if the default action
+       is an error action.  In that case, don't check for expected
+       tokens because there are none.
+     - The only way there can be no lookahead present (in yychar) is if
+       this state is a consistent state with a default action.  Thus,
+       detecting the absence of a lookahead is sufficient to determine
+       that there is no unexpected or expected token to report.  In that
+       case, just report a simple "syntax error".
+     - Don't assume there isn't a lookahead just because this state is a
+       consistent state with a default action.  There might have been a
+       previous inconsistent state, consistent state with a non-default
+       action, or user semantic action that manipulated yychar.
+     - Of course, the expected token list depends on states to have
+       correct lookahead information, and it depends on the parser not
+       to perform extra reductions after fetching a lookahead from the
+       scanner and before detecting a syntax error.  Thus, state merging
+       (from LALR or IELR) and default reductions corrupt the expected
+       token list.  However, the list is correct for canonical LR with
+       one exception: it will still contain any token that will not be
+       accepted due to an error action in a later state.
+  */
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
+    {
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
+    }
+  return yycount;
+}
+
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
+
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
+
+  switch (yycount)
+    {
+#define YYCASE_(N, S)                       \
+      case N:                               \
+        yyformat = S;                       \
+        break
+    default: /* Avoid compiler warnings. */
+      YYCASE_(0, YY_("syntax error"));
+      YYCASE_(1, YY_("syntax error, unexpected %s"));
+      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
+      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
+      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
+      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
+#undef YYCASE_
+    }
+
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
+  {
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
+  }
+
+  if (*yymsg_alloc < yysize)
+    {
+      *yymsg_alloc = 2 * yysize;
+      if (! (yysize <= *yymsg_alloc
+             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
+        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
+      return -1;
+    }
+
+  /* Avoid sprintf, as that infringes on the user's name space.
+     Don't have undefined behavior even if the translation
+     produced a string with the wrong number of "%s"s.  */
+  {
+    char *yyp = *yymsg;
+    int yyi = 0;
+    while ((*yyp = *yyformat) != '\0')
+      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
+        {
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
+          yyformat += 2;
+        }
+      else
+        {
+          ++yyp;
+          ++yyformat;
+        }
+  }
+  return 0;
+}
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, yyscan_t scanner, Compilation *compilation)
+{
+  YY_USE (yyvaluep);
+  YY_USE (scanner);
+  YY_USE (compilation);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (yyscan_t scanner, Compilation *compilation)
+{
+/* Lookahead token kind.  */
+int yychar;
+
+
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
+
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+  /* Buffer for error messages, and its allocated size.  */
+  char yymsgbuf[128];
+  char *yymsg = yymsgbuf;
+  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex (&yylval, scanner);
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* Start: Classes  */
+#line 77 "parser.y"
+                                { (yyval.program_ptr) = new (compilation->arena) ProgramNode((yyvsp[0].class_list_ptr)); compilation->program = (yyval.program_ptr); }
+#line 1548 "parser.cpp"
+    break;
+
+  case 3: /* Classes: Classes Class  */
+#line 80 "parser.y"
+                                { (yyval.class_list_ptr) = (yyvsp[-1].class_list_ptr); (yyval.class_list_ptr)->push_back((yyvsp[0].class_ptr)); }
+#line 1554 "parser.cpp"
+    break;
+
+  case 4: /* Classes: Class  */
+#line 81 "parser.y"
+                                { (yyval.class_list_ptr) = new (compilation->arena) NodeList<ClassNode*>(compilation->arena); (yyval.class_list_ptr)->push_back((yyvsp[0].class_ptr)); }
+#line 1560 "parser.cpp"
+    break;
+
+  case 5: /* Class: T_IDENTIFIER '{' Members Methods '}'  */
+#line 84 "parser.y"
+                                                                          { (yyval.class_ptr) = new (compilation->arena) ClassNode((yyvsp[-4].identifier_ptr), NULL, (yyvsp[-2].declaration_list_ptr), (yyvsp[-1].method_list_ptr)); }
+#line 1566 "parser.cpp"
+    break;
+
+  case 6: /* Class: T_IDENTIFIER T_EXTENDS T_IDENTIFIER '{' Members Methods '}'  */
+#line 85 "parser.y"
+                                                                          { (yyval.class_ptr) = new (compilation->arena) ClassNode((yyvsp[-6].identifier_ptr), (yyvsp[-4].identifier_ptr), (yyvsp[-2].declaration_list_ptr), (yyvsp[-1].method_list_ptr)); }
+#line 1572 "parser.cpp"
+    break;
+
+  case 7: /* Members: Members Member  */
+#line 88 "parser.y"
+                                { (yyval.declaration_list_ptr) = (yyvsp[-1].declaration_list_ptr); (yyval.declaration_list_ptr)->push_back((yyvsp[0].declaration_ptr)); }
+#line 1578 "parser.cpp"
+    break;
+
+  case 8: /* Members: %empty  */
+#line 89 "parser.y"
+                                { (yyval.declaration_list_ptr) = new (compilation->arena) NodeList<DeclarationNode*>(compilation->arena); }
+#line 1584 "parser.cpp"
+    break;
+
+  case 9: /* Member: Type T_IDENTIFIER ';'  */
+#line 92 "parser.y"
+                                   { NodeList<IdentifierNode*>* list = new (compilation->arena) NodeList<IdentifierNode*>(compilation->arena); list->push_back((yyvsp[-1].identifier_ptr)); (yyval.declaration_ptr) = new (compilation->arena) DeclarationNode((yyvsp[-2].type_ptr), list); }
+#line 1590 "parser.cpp"
+    break;
+
+  case 10: /* Methods: ReversedMethods  */
+#line 100 "parser.y"
+                                { (yyval.method_list_ptr) = (yyvsp[0].method_list_ptr); (yyval.method_list_ptr)->reverse(); }
+#line 1596 "parser.cpp"
+    break;
+
+  case 11: /* ReversedMethods: Method ReversedMethods  */
+#line 103 "parser.y"
+                                            { (yyval.method_list_ptr) = (yyvsp[0].method_list_ptr); (yyval.method_list_ptr)->push_back((yyvsp[-1].method_ptr)); }
+#line 1602 "parser.cpp"
+    break;
+
+  case 12: /* ReversedMethods: %empty  */
+#line 104 "parser.y"
+                                            { (yyval.method_list_ptr) = new (compilation->arena) NodeList<MethodNode*>(compilation->arena); }
+#line 1608 "parser.cpp"
+    break;
+
+  case 13: /* Method: T_IDENTIFIER '(' Parameters ')' T_ARROW ReturnType '{' Body '}'  */
+#line 107 "parser.y"
+                                                                          { (yyval.method_ptr) = new (compilation->arena) MethodNode((yyvsp[-8].identifier_ptr), (yyvsp[-6].parameter_list_ptr), (yyvsp[-3].type_ptr), (yyvsp[-1].methodbody_ptr)); }
+#line 1614 "parser.cpp"
+    break;
+
+  case 14: /* Parameters: ParameterList  */
+#line 110 "parser.y"
+                                                    { (yyval.parameter_list_ptr) = (yyvsp[0].parameter_list_ptr); }
+#line 1620 "parser.cpp"
+    break;
+
+  case 15: /* Parameters: %empty  */
+#line 111 "parser.y"
+                                                    { (yyval.parameter_list_ptr) = new (compilation->arena) NodeList<ParameterNode*>(compilation->arena); }
+#line 1626 "parser.cpp"
+    break;
+
+  case 16: /* ParameterList: ParameterList ',' Parameter  */
+#line 114 "parser.y"
+                                                    { (yyval.parameter_list_ptr) = (yyvsp[-2].parameter_list_ptr); (yyval.parameter_list_ptr)->push_back((yyvsp[0].parameter_ptr)); }
+#line 1632 "parser.cpp"
+    break;
+
+  case 17: /* ParameterList: Parameter  */
+#line 115 "parser.y"
+                                                    { (yyval.parameter_list_ptr) = new (compilation->arena) NodeList<ParameterNode*>(compilation->arena); (yyval.parameter_list_ptr)->push_back((yyvsp[0].parameter_ptr)); }
+#line 1638 "parser.cpp"
+    break;
+
+  case 18: /* Parameter: T_IDENTIFIER ':' Type  */
+#line 118 "parser.y"
+                                                    { (yyval.parameter_ptr) = new (compilation->arena) ParameterNode((yyvsp[0].type_ptr), (yyvsp[-2].identifier_ptr)); }
+#line 1644 "parser.cpp"
+    break;
+
+  case 19: /* Body: Declarations Statements ReturnStatement  */
+#line 121 "parser.y"
+                                                    { (yyval.methodbody_ptr) = new (compilation->arena) MethodBodyNode((yyvsp[-2].declaration_list_ptr), (yyvsp[-1].statement_list_ptr), (yyvsp[0].returnstatement_ptr)); }
+#line 1650 "parser.cpp"
+    break;
+
+  case 20: /* Declarations: Declarations Declaration  */
+#line 124 "parser.y"
+                                                    { (yyval.declaration_list_ptr) = (yyvsp[-1].declaration_list_ptr); (yyval.declaration_list_ptr)->push_back((yyvsp[0].declaration_ptr)); }
+#line 1656 "parser.cpp"
+    break;
+
+  case 21: /* Declarations: %empty  */
+#line 125 "parser.y"
+                                                    { (yyval.declaration_list_ptr) = new (compilation->arena) NodeList<DeclarationNode*>(compilation->arena); }
+#line 1662 "parser.cpp"
+    break;
+
+  case 22: /* Declaration: Type IdentifierList ';'  */
+#line 128 "parser.y"
+                                                       { (yyval.declaration_ptr) = new (compilation->arena) DeclarationNode((yyvsp[-2].type_ptr), (yyvsp[-1].identifier_list_ptr)); }
+#line 1668 "parser.cpp"
+    break;
+
+  case 23: /* IdentifierList: IdentifierList ',' T_IDENTIFIER  */
+#line 131 "parser.y"
+                                                    { (yyval.identifier_list_ptr) = (yyvsp[-2].identifier_list_ptr); (yyval.identifier_list_ptr)->push_back((yyvsp[0].identifier_ptr)); }
+#line 1674 "parser.cpp"
+    break;
+
+  case 24: /* IdentifierList: T_IDENTIFIER  */
+#line 132 "parser.y"
+                                                    { (yyval.identifier_list_ptr) = new (compilation->arena) NodeList<IdentifierNode*>(compilation->arena); (yyval.identifier_list_ptr)->push_back((yyvsp[0].identifier_ptr)); }
+#line 1680 "parser.cpp"
+    break;
+
+  case 25: /* Statements: ReversedStatements  */
+#line 135 "parser.y"
+                                        { (yyval.statement_list_ptr) = (yyvsp[0].statement_list_ptr); (yyval.statement_list_ptr)->reverse(); }
+#line 1686 "parser.cpp"
+    break;
+
+  case 26: /* ReversedStatements: Statement ReversedStatements  */
+#line 138 "parser.y"
+                                                    { (yyval.statement_list_ptr) = (yyvsp[0].statement_list_ptr); if ((yyvsp[-1].statement_ptr)) (yyval.statement_list_ptr)->push_back((yyvsp[-1].statement_ptr)); }
+#line 1692 "parser.cpp"
+    break;
+
+  case 27: /* ReversedStatements: %empty  */
+#line 139 "parser.y"
+                                                    { (yyval.statement_list_ptr) = new (compilation->arena) NodeList<StatementNode*>(compilation->arena); }
+#line 1698 "parser.cpp"
+    break;
+
+  case 28: /* Block: Statement ReversedStatements  */
+#line 142 "parser.y"
+                                        { (yyval.statement_list_ptr) = (yyvsp[0].statement_list_ptr); if ((yyvsp[-1].statement_ptr)) (yyval.statement_list_ptr)->push_back((yyvsp[-1].statement_ptr)); (yyval.statement_list_ptr)->reverse(); }
+#line 1704 "parser.cpp"
+    break;
+
+  case 29: /* ReturnStatement: T_RETURN Expression ';'  */
+#line 145 "parser.y"
+                                          { (yyval.returnstatement_ptr) = new (compilation->arena) ReturnStatementNode((yyvsp[-1].expression_ptr)); }
+#line 1710 "parser.cpp"
+    break;
+
+  case 30: /* ReturnStatement: %empty  */
+#line 146 "parser.y"
+                                          { (yyval.returnstatement_ptr) = NULL; }
+#line 1716 "parser.cpp"
+    break;
+
+  case 31: /* Statement: Assignment ';'  */
+#line 149 "parser.y"
+                                        { (yyval.statement_ptr) = (yyvsp[-1].assignment_ptr); }
+#line 1722 "parser.cpp"
+    break;
+
+  case 32: /* Statement: MethodCall ';'  */
+#line 150 "parser.y"
+                                        { (yyval.statement_ptr) = new (compilation->arena) CallNode((yyvsp[-1].methodcall_ptr)); }
+#line 1728 "parser.cpp"
+    break;
+
+  case 33: /* Statement: IfElse  */
+#line 151 "parser.y"
+                                        { (yyval.statement_ptr) = (yyvsp[0].ifelse_ptr); }
+#line 1734 "parser.cpp"
+    break;
+
+  case 34: /* Statement: WhileLoop  */
+#line 152 "parser.y"
+                                        { (yyval.statement_ptr) = (yyvsp[0].while_ptr); }
+#line 1740 "parser.cpp"
+    break;
+
+  case 35: /* Statement: Print ';'  */
+#line 153 "parser.y"
+                                        { (yyval.statement_ptr) = (yyvsp[-1].print_ptr); }
+#line 1746 "parser.cpp"
+    break;
+
+  case 36: /* Statement: repeat ';'  */
+#line 154 "parser.y"
+                                        { (yyval.statement_ptr) = (yyvsp[-1].repeat_ptr); }
+#line 1752 "parser.cpp"
+    break;
+
+  case 37: /* Statement: error ';'  */
+#line 155 "parser.y"
+                                        { (yyval.statement_ptr) = NULL; }
+#line 1758 "parser.cpp"
+    break;
+
+  case 38: /* Assignment: T_IDENTIFIER '=' Expression  */
+#line 158 "parser.y"
+                                                                                            { (yyval.assignment_ptr) = new (compilation->arena) AssignmentNode((yyvsp[-2].identifier_ptr), NULL, (yyvsp[0].expression_ptr)); }
+#line 1764 "parser.cpp"
+    break;
+
+  case 39: /* Assignment: T_IDENTIFIER '.' T_IDENTIFIER '=' Expression  */
+#line 159 "parser.y"
+                                                                                            { (yyval.assignment_ptr) = new (compilation->arena) AssignmentNode((yyvsp[-4].identifier_ptr), (yyvsp[-2].identifier_ptr), (yyvsp[0].expression_ptr)); }
+#line 1770 "parser.cpp"
+    break;
+
+  case 40: /* IfElse: T_IF Expression '{' Block '}'  */
+#line 162 "parser.y"
+                                                                       { (yyval.ifelse_ptr) = new (compilation->arena) IfElseNode((yyvsp[-3].expression_ptr), (yyvsp[-1].statement_list_ptr), new (compilation->arena) NodeList<StatementNode*>(compilation->arena)); }
+#line 1776 "parser.cpp"
+    break;
+
+  case 41: /* IfElse: T_IF Expression '{' Block '}' T_ELSE '{' Block '}'  */
+#line 163 "parser.y"
+                                                                        { (yyval.ifelse_ptr) = new (compilation->arena) IfElseNode((yyvsp[-7].expression_ptr), (yyvsp[-5].statement_list_ptr), (yyvsp[-1].statement_list_ptr)); }
+#line 1782 "parser.cpp"
+    break;
+
+  case 42: /* WhileLoop: T_WHILE Expression '{' Block '}'  */
+#line 166 "parser.y"
+                                                                       { (yyval.while_ptr) = new (compilation->arena) WhileNode((yyvsp[-3].expression_ptr), (yyvsp[-1].statement_list_ptr)); }
+#line 1788 "parser.cpp"
+    break;
+
+  case 43: /* repeat: "repeat" '{' Block '}' "until" '(' Expression ')'  */
+#line 171 "parser.y"
+                                                      { (yyval.repeat_ptr) = new (compilation->arena) RepeatNode((yyvsp[-5].statement_list_ptr), (yyvsp[-1].expression_ptr)); }
+#line 1794 "parser.cpp"
+    break;
+
+  case 44: /* Print: T_PRINT Expression  */
+#line 173 "parser.y"
+                                                        { (yyval.print_ptr) = new (compilation->arena) PrintNode((yyvsp[0].expression_ptr)); }
+#line 1800 "parser.cpp"
+    break;
+
+  case 45: /* Expression: Expression '+' Expression  */
+#line 176 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) PlusNode((yyvsp[-2].expression_ptr), (yyvsp[0].expression_ptr)); }
+#line 1806 "parser.cpp"
+    break;
+
+  case 46: /* Expression: Expression '-' Expression  */
+#line 177 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) MinusNode((yyvsp[-2].expression_ptr), (yyvsp[0].expression_ptr)); }
+#line 1812 "parser.cpp"
+    break;
+
+  case 47: /* Expression: Expression '*' Expression  */
+#line 178 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) TimesNode((yyvsp[-2].expression_ptr), (yyvsp[0].expression_ptr)); }
+#line 1818 "parser.cpp"
+    break;
+
+  case 48: /* Expression: Expression '/' Expression  */
+#line 179 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) DivideNode((yyvsp[-2].expression_ptr), (yyvsp[0].expression_ptr)); }
+#line 1824 "parser.cpp"
+    break;
+
+  case 49: /* Expression: Expression '<' Expression  */
+#line 180 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) LessNode((yyvsp[-2].expression_ptr), (yyvsp[0].expression_ptr)); }
+#line 1830 "parser.cpp"
+    break;
+
+  case 50: /* Expression: Expression T_LEQ Expression  */
+#line 181 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) LessEqualNode((yyvsp[-2].expression_ptr), (yyvsp[0].expression_ptr)); }
+#line 1836 "parser.cpp"
+    break;
+
+  case 51: /* Expression: Expression T_EQUALS Expression  */
+#line 182 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) EqualNode((yyvsp[-2].expression_ptr), (yyvsp[0].expression_ptr)); }
+#line 1842 "parser.cpp"
+    break;
+
+  case 52: /* Expression: Expression T_AND Expression  */
+#line 183 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) AndNode((yyvsp[-2].expression_ptr), (yyvsp[0].expression_ptr)); }
+#line 1848 "parser.cpp"
+    break;
+
+  case 53: /* Expression: Expression T_OR Expression  */
+#line 184 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) OrNode((yyvsp[-2].expression_ptr), (yyvsp[0].expression_ptr)); }
+#line 1854 "parser.cpp"
+    break;
+
+  case 54: /* Expression: T_NOT Expression  */
+#line 185 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) NotNode((yyvsp[0].expression_ptr)); }
+#line 1860 "parser.cpp"
+    break;
+
+  case 55: /* Expression: '-' Expression  */
+#line 186 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) NegationNode((yyvsp[0].expression_ptr)); }
+#line 1866 "parser.cpp"
+    break;
+
+  case 56: /* Expression: MethodCall  */
+#line 187 "parser.y"
+                                                        { (yyval.expression_ptr) = (yyvsp[0].methodcall_ptr); }
+#line 1872 "parser.cpp"
+    break;
+
+  case 57: /* Expression: T_IDENTIFIER '.' T_IDENTIFIER  */
+#line 188 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) MemberAccessNode((yyvsp[-2].identifier_ptr), (yyvsp[0].identifier_ptr)); }
+#line 1878 "parser.cpp"
+    break;
+
+  case 58: /* Expression: '(' Expression ')'  */
+#line 189 "parser.y"
+                                                        { (yyval.expression_ptr) = (yyvsp[-1].expression_ptr); }
+#line 1884 "parser.cpp"
+    break;
+
+  case 59: /* Expression: T_IDENTIFIER  */
+#line 190 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) VariableNode((yyvsp[0].identifier_ptr)); }
+#line 1890 "parser.cpp"
+    break;
+
+  case 60: /* Expression: T_NUMBER  */
+#line 191 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) IntegerLiteralNode((yyvsp[0].integer_ptr)); }
+#line 1896 "parser.cpp"
+    break;
+
+  case 61: /* Expression: T_TRUE  */
+#line 192 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) BooleanLiteralNode(new (compilation->arena) IntegerNode(1)); }
+#line 1902 "parser.cpp"
+    break;
+
+  case 62: /* Expression: T_FALSE  */
+#line 193 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) BooleanLiteralNode(new (compilation->arena) IntegerNode(0)); }
+#line 1908 "parser.cpp"
+    break;
+
+  case 63: /* Expression: T_NEW T_IDENTIFIER '(' Arguments ')'  */
+#line 194 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) NewNode((yyvsp[-3].identifier_ptr), (yyvsp[-1].expression_list_ptr)); }
+#line 1914 "parser.cpp"
+    break;
+
+  case 64: /* Expression: T_NEW T_IDENTIFIER  */
+#line 195 "parser.y"
+                                                        { (yyval.expression_ptr) = new (compilation->arena) NewNode((yyvsp[0].identifier_ptr), new (compilation->arena) NodeList<ExpressionNode*>(compilation->arena)); }
+#line 1920 "parser.cpp"
+    break;
+
+  case 65: /* MethodCall: T_IDENTIFIER '.' T_IDENTIFIER '(' Arguments ')'  */
+#line 198 "parser.y"
+                                                                { (yyval.methodcall_ptr) = new (compilation->arena) MethodCallNode((yyvsp[-5].identifier_ptr), (yyvsp[-3].identifier_ptr), (yyvsp[-1].expression_list_ptr)); }
+#line 1926 "parser.cpp"
+    break;
+
+  case 66: /* MethodCall: T_IDENTIFIER '(' Arguments ')'  */
+#line 199 "parser.y"
+                                                                { (yyval.methodcall_ptr) = new (compilation->arena) MethodCallNode((yyvsp[-3].identifier_ptr), NULL, (yyvsp[-1].expression_list_ptr)); }
+#line 1932 "parser.cpp"
+    break;
+
+  case 67: /* Arguments: ArgumentList  */
+#line 202 "parser.y"
+                            { (yyval.expression_list_ptr) = (yyvsp[0].expression_list_ptr); }
+#line 1938 "parser.cpp"
+    break;
+
+  case 68: /* Arguments: %empty  */
+#line 203 "parser.y"
+                            { (yyval.expression_list_ptr) = new (compilation->arena) NodeList<ExpressionNode*>(compilation->arena); }
+#line 1944 "parser.cpp"
+    break;
+
+  case 69: /* ArgumentList: ArgumentList ',' Argument  */
+#line 206 "parser.y"
+                                                                { (yyval.expression_list_ptr) = (yyvsp[-2].expression_list_ptr); (yyval.expression_list_ptr)->push_back((yyvsp[0].expression_ptr)); }
+#line 1950 "parser.cpp"
+    break;
+
+  case 70: /* ArgumentList: Argument  */
+#line 207 "parser.y"
+                                                                { (yyval.expression_list_ptr) = new (compilation->arena) NodeList<ExpressionNode*>(compilation->arena); (yyval.expression_list_ptr)->push_back((yyvsp[0].expression_ptr)); }
+#line 1956 "parser.cpp"
+    break;
+
+  case 71: /* Argument: Expression  */
+#line 210 "parser.y"
+                            { (yyval.expression_ptr) = (yyvsp[0].expression_ptr); }
+#line 1962 "parser.cpp"
+    break;
+
+  case 72: /* Type: T_INTEGER  */
+#line 213 "parser.y"
+                            { (yyval.type_ptr) = new (compilation->arena) IntegerTypeNode(); }
+#line 1968 "parser.cpp"
+    break;
+
+  case 73: /* Type: T_BOOLEAN  */
+#line 214 "parser.y"
+                            { (yyval.type_ptr) = new (compilation->arena) BooleanTypeNode(); }
+#line 1974 "parser.cpp"
+    break;
+
+  case 74: /* Type: T_IDENTIFIER  */
+#line 215 "parser.y"
+                            { (yyval.type_ptr) = new (compilation->arena) ObjectTypeNode((yyvsp[0].identifier_ptr)); }
+#line 1980 "parser.cpp"
+    break;
+
+  case 75: /* ReturnType: Type  */
+#line 218 "parser.y"
+                            { (yyval.type_ptr) = (yyvsp[0].type_ptr); }
+#line 1986 "parser.cpp"
+    break;
+
+  case 76: /* ReturnType: T_NONE  */
+#line 219 "parser.y"
+                            { (yyval.type_ptr) = new (compilation->arena) NoneNode(); }
+#line 1992 "parser.cpp"
+    break;
+
+
+#line 1996 "parser.cpp"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      {
+        yypcontext_t yyctx
+          = {yyssp, yytoken};
+        char const *yymsgp = YY_("syntax error");
+        int yysyntax_error_status;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+        if (yysyntax_error_status == 0)
+          yymsgp = yymsg;
+        else if (yysyntax_error_status == -1)
+          {
+            if (yymsg != yymsgbuf)
+              YYSTACK_FREE (yymsg);
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
+              {
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
+              }
+            else
+              {
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
+              }
+          }
+        yyerror (scanner, compilation, yymsgp);
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
+      }
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, scanner, compilation);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, scanner, compilation);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (scanner, compilation, YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, scanner, compilation);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, scanner, compilation);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+  if (yymsg != yymsgbuf)
+    YYSTACK_FREE (yymsg);
+  return yyresult;
+}
+
+#line 223 "parser.y"
+
+
+// Syntax errors are reported to the diagnostics of the compilation
+// like type errors; the parser then recovers at the next ';' and
+// carries on.
+void yyerror(yyscan_t scanner, Compilation *compilation, const char *s) {
+  int line = yyget_lineno(scanner);
+  std::stringstream ss;
+  ss << s << " at line " << line;
+  compilation->diagnostics.error(ss.str(), NULL, line);
+}
+
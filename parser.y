@@ -2,16 +2,31 @@
     #include <cstdlib>
     #include <cstdio>
     #include <iostream>
+    #include <sstream>
     #include "ast.hpp"
+    #include "langcheck.hpp"
 
     #define YYDEBUG 1
     #define YYINITDEPTH 10000
+%}
 
-    int yylex(void);
-    void yyerror(const char *);
+// The parser is pure and the scanner reentrant: all the state of a
+// parse is in the scanner and the compilation passed to yyparse, so
+// any number of files can be parsed at once.
+%code requires {
+    typedef void* yyscan_t;
+    class Compilation;
+}
 
-    extern ASTNode* astRoot;
-%}
+%code {
+    int yylex(YYSTYPE *lvalp, yyscan_t scanner);
+    int yyget_lineno(yyscan_t scanner);
+    void yyerror(yyscan_t scanner, Compilation *compilation, const char *);
+}
+
+%define api.pure full
+%lex-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {Compilation *compilation}
 
 %error-verbose
 
@@ -35,13 +50,13 @@
 %type <class_ptr> Class
 %type <declaration_list_ptr> Members Declarations
 %type <declaration_ptr> Member Declaration
-%type <method_list_ptr> Methods
+%type <method_list_ptr> Methods ReversedMethods
 %type <method_ptr> Method
 %type <parameter_list_ptr> Parameters ParameterList
 %type <parameter_ptr> Parameter
 %type <methodbody_ptr> Body
 %type <identifier_list_ptr> IdentifierList
-%type <statement_list_ptr> Statements
+%type <statement_list_ptr> Statements ReversedStatements Block
 %type <returnstatement_ptr> ReturnStatement
 %type <statement_ptr> Statement
 %type <assignment_ptr> Assignment
@@ -59,143 +74,161 @@
 
 %%
 
-Start : Classes                 { $$ = new ProgramNode($1); astRoot = $$; }
+Start : Classes                 { $$ = new (compilation->arena) ProgramNode($1); compilation->program = $$; }
       ;
 
-Classes : Class Classes         { $$ = $2; $$->push_front($1); }
-        | Class                 { $$ = new std::list<ClassNode*>(); $$->push_front($1); }
+Classes : Classes Class         { $$ = $1; $$->push_back($2); }
+        | Class                 { $$ = new (compilation->arena) NodeList<ClassNode*>(compilation->arena); $$->push_back($1); }
         ;
 
-Class : T_IDENTIFIER '{' Members Methods '}'                              { $$ = new ClassNode($1, NULL, $3, $4); }
-      | T_IDENTIFIER T_EXTENDS T_IDENTIFIER '{' Members Methods '}'       { $$ = new ClassNode($1, $3, $5, $6); }
+Class : T_IDENTIFIER '{' Members Methods '}'                              { $$ = new (compilation->arena) ClassNode($1, NULL, $3, $4); }
+      | T_IDENTIFIER T_EXTENDS T_IDENTIFIER '{' Members Methods '}'       { $$ = new (compilation->arena) ClassNode($1, $3, $5, $6); }
       ;
 
 Members : Members Member        { $$ = $1; $$->push_back($2); }
-        |                       { $$ = new std::list<DeclarationNode*>(); }
+        |                       { $$ = new (compilation->arena) NodeList<DeclarationNode*>(compilation->arena); }
         ;
 
-Member : Type T_IDENTIFIER ';'     { std::list<IdentifierNode*>* list = new std::list<IdentifierNode*>(); list->push_front($2); $$ = new DeclarationNode($1, list); }
+Member : Type T_IDENTIFIER ';'     { NodeList<IdentifierNode*>* list = new (compilation->arena) NodeList<IdentifierNode*>(compilation->arena); list->push_back($2); $$ = new (compilation->arena) DeclarationNode($1, list); }
        ;
 
-Methods : Method Methods        { $$ = $2; $$->push_front($1); }
-        |                       { $$ = new std::list<MethodNode*>(); }
+// Methods and statements stay right recursive: a member or declaration
+// and a method or statement can both start with an identifier, so an
+// empty left-recursive list could not be reduced with one token of
+// lookahead. The right-recursive rules append, which builds the list
+// backwards, and the list is turned around once it is complete.
+Methods : ReversedMethods       { $$ = $1; $$->reverse(); }
         ;
 
-Method : T_IDENTIFIER '(' Parameters ')' T_ARROW ReturnType '{' Body '}'  { $$ = new MethodNode($1, $3, $6, $8); }
+ReversedMethods : Method ReversedMethods    { $$ = $2; $$->push_back($1); }
+                |                           { $$ = new (compilation->arena) NodeList<MethodNode*>(compilation->arena); }
+                ;
+
+Method : T_IDENTIFIER '(' Parameters ')' T_ARROW ReturnType '{' Body '}'  { $$ = new (compilation->arena) MethodNode($1, $3, $6, $8); }
        ;
 
 Parameters : ParameterList                          { $$ = $1; }
-           |                                        { $$ = new std::list<ParameterNode*>(); }
+           |                                        { $$ = new (compilation->arena) NodeList<ParameterNode*>(compilation->arena); }
            ;
 
-ParameterList : Parameter ',' ParameterList         { $$ = $3; $$->push_front($1); }
-              | Parameter                           { $$ = new std::list<ParameterNode*>(); $$->push_front($1); }
+ParameterList : ParameterList ',' Parameter         { $$ = $1; $$->push_back($3); }
+              | Parameter                           { $$ = new (compilation->arena) NodeList<ParameterNode*>(compilation->arena); $$->push_back($1); }
               ;
 
-Parameter : T_IDENTIFIER ':' Type                   { $$ = new ParameterNode($3, $1); }
+Parameter : T_IDENTIFIER ':' Type                   { $$ = new (compilation->arena) ParameterNode($3, $1); }
           ;
 
-Body : Declarations Statements ReturnStatement      { $$ = new MethodBodyNode($1, $2, $3); }
+Body : Declarations Statements ReturnStatement      { $$ = new (compilation->arena) MethodBodyNode($1, $2, $3); }
      ;
 
 Declarations : Declarations Declaration             { $$ = $1; $$->push_back($2); }
-             |                                      { $$ = new std::list<DeclarationNode*>(); }
+             |                                      { $$ = new (compilation->arena) NodeList<DeclarationNode*>(compilation->arena); }
              ;
 
-Declaration : Type IdentifierList ';'                  { $$ = new DeclarationNode($1, $2); }
+Declaration : Type IdentifierList ';'                  { $$ = new (compilation->arena) DeclarationNode($1, $2); }
             ;
 
-IdentifierList : T_IDENTIFIER ',' IdentifierList    { $$ = $3; $$->push_front($1); }
-               | T_IDENTIFIER                       { $$ = new std::list<IdentifierNode*>(); $$->push_front($1); }
+IdentifierList : IdentifierList ',' T_IDENTIFIER    { $$ = $1; $$->push_back($3); }
+               | T_IDENTIFIER                       { $$ = new (compilation->arena) NodeList<IdentifierNode*>(compilation->arena); $$->push_back($1); }
                ;
 
-Statements : Statement Statements       { $$ = $2; $$->push_front($1); }
-           |                            { $$ = new std::list<StatementNode*>(); }
+Statements : ReversedStatements         { $$ = $1; $$->reverse(); }
            ;
 
-ReturnStatement : T_RETURN Expression ';' { $$ = new ReturnStatementNode($2); }
+ReversedStatements : Statement ReversedStatements   { $$ = $2; if ($1) $$->push_back($1); }
+                   |                                { $$ = new (compilation->arena) NodeList<StatementNode*>(compilation->arena); }
+                   ;
+
+Block : Statement ReversedStatements    { $$ = $2; if ($1) $$->push_back($1); $$->reverse(); }
+      ;
+
+ReturnStatement : T_RETURN Expression ';' { $$ = new (compilation->arena) ReturnStatementNode($2); }
                 |                         { $$ = NULL; }
                 ;
 
 Statement : Assignment       ';'        { $$ = $1; }
-          | MethodCall       ';'        { $$ = new CallNode($1); }
+          | MethodCall       ';'        { $$ = new (compilation->arena) CallNode($1); }
           | IfElse                      { $$ = $1; }
           | WhileLoop                   { $$ = $1; }
           | Print            ';'        { $$ = $1; }
           | repeat           ';'        { $$ = $1; }
+          | error            ';'        { $$ = NULL; }
           ;
 
-Assignment : T_IDENTIFIER '=' Expression                                                    { $$ = new AssignmentNode($1, NULL, $3); }
-           | T_IDENTIFIER '.' T_IDENTIFIER '=' Expression                                   { $$ = new AssignmentNode($1, $3, $5); }
+Assignment : T_IDENTIFIER '=' Expression                                                    { $$ = new (compilation->arena) AssignmentNode($1, NULL, $3); }
+           | T_IDENTIFIER '.' T_IDENTIFIER '=' Expression                                   { $$ = new (compilation->arena) AssignmentNode($1, $3, $5); }
            ;
 
-IfElse : T_IF Expression '{' Statement Statements '}'                                       { $5->push_front($4); $$ = new IfElseNode($2, $5, new std::list<StatementNode*>()); }
-       | T_IF Expression '{' Statement Statements '}' T_ELSE '{' Statement Statements '}'   { $5->push_front($4); $10->push_front($9); $$ = new IfElseNode($2, $5, $10); }
+IfElse : T_IF Expression '{' Block '}'                                 { $$ = new (compilation->arena) IfElseNode($2, $4, new (compilation->arena) NodeList<StatementNode*>(compilation->arena)); }
+       | T_IF Expression '{' Block '}' T_ELSE '{' Block '}'             { $$ = new (compilation->arena) IfElseNode($2, $4, $8); }
        ;
 
-WhileLoop : T_WHILE Expression '{' Statement Statements '}'                                 { $5->push_front($4); $$ = new WhileNode($2, $5); }
+WhileLoop : T_WHILE Expression '{' Block '}'                           { $$ = new (compilation->arena) WhileNode($2, $4); }
           ;
 
 
 repeat:
-    "repeat" '{' Statement Statements '}' "until" '(' Expression ')' { $4->push_front($3); $$ = new RepeatNode($4, $8); };
+    "repeat" '{' Block '}' "until" '(' Expression ')' { $$ = new (compilation->arena) RepeatNode($3, $7); };
 
-Print : T_PRINT Expression                              { $$ = new PrintNode($2); }
+Print : T_PRINT Expression                              { $$ = new (compilation->arena) PrintNode($2); }
       ;
 
-Expression : Expression '+' Expression                  { $$ = new PlusNode($1, $3); }
-           | Expression '-' Expression                  { $$ = new MinusNode($1, $3); }
-           | Expression '*' Expression                  { $$ = new TimesNode($1, $3); }
-           | Expression '/' Expression                  { $$ = new DivideNode($1, $3); }
-           | Expression '<' Expression                  { $$ = new LessNode($1, $3); }
-           | Expression T_LEQ Expression                { $$ = new LessEqualNode($1, $3); }
-           | Expression T_EQUALS Expression             { $$ = new EqualNode($1, $3); }
-           | Expression T_AND Expression                { $$ = new AndNode($1, $3); }
-           | Expression T_OR Expression                 { $$ = new OrNode($1, $3); }
-           | T_NOT Expression                           { $$ = new NotNode($2); }
-           | '-' Expression %prec UMINUS                { $$ = new NegationNode($2); }
+Expression : Expression '+' Expression                  { $$ = new (compilation->arena) PlusNode($1, $3); }
+           | Expression '-' Expression                  { $$ = new (compilation->arena) MinusNode($1, $3); }
+           | Expression '*' Expression                  { $$ = new (compilation->arena) TimesNode($1, $3); }
+           | Expression '/' Expression                  { $$ = new (compilation->arena) DivideNode($1, $3); }
+           | Expression '<' Expression                  { $$ = new (compilation->arena) LessNode($1, $3); }
+           | Expression T_LEQ Expression                { $$ = new (compilation->arena) LessEqualNode($1, $3); }
+           | Expression T_EQUALS Expression             { $$ = new (compilation->arena) EqualNode($1, $3); }
+           | Expression T_AND Expression                { $$ = new (compilation->arena) AndNode($1, $3); }
+           | Expression T_OR Expression                 { $$ = new (compilation->arena) OrNode($1, $3); }
+           | T_NOT Expression                           { $$ = new (compilation->arena) NotNode($2); }
+           | '-' Expression %prec UMINUS                { $$ = new (compilation->arena) NegationNode($2); }
            | MethodCall                                 { $$ = $1; }
-           | T_IDENTIFIER '.' T_IDENTIFIER              { $$ = new MemberAccessNode($1, $3); }
+           | T_IDENTIFIER '.' T_IDENTIFIER              { $$ = new (compilation->arena) MemberAccessNode($1, $3); }
            | '(' Expression ')'                         { $$ = $2; }
-           | T_IDENTIFIER                               { $$ = new VariableNode($1); }
-           | T_NUMBER                                   { $$ = new IntegerLiteralNode($1); }
-           | T_TRUE                                     { $$ = new BooleanLiteralNode(new IntegerNode(1)); }
-           | T_FALSE                                    { $$ = new BooleanLiteralNode(new IntegerNode(0)); }
-           | T_NEW T_IDENTIFIER '(' Arguments ')'       { $$ = new NewNode($2, $4); }
-           | T_NEW T_IDENTIFIER                         { $$ = new NewNode($2, new std::list<ExpressionNode*>()); }
+           | T_IDENTIFIER                               { $$ = new (compilation->arena) VariableNode($1); }
+           | T_NUMBER                                   { $$ = new (compilation->arena) IntegerLiteralNode($1); }
+           | T_TRUE                                     { $$ = new (compilation->arena) BooleanLiteralNode(new (compilation->arena) IntegerNode(1)); }
+           | T_FALSE                                    { $$ = new (compilation->arena) BooleanLiteralNode(new (compilation->arena) IntegerNode(0)); }
+           | T_NEW T_IDENTIFIER '(' Arguments ')'       { $$ = new (compilation->arena) NewNode($2, $4); }
+           | T_NEW T_IDENTIFIER                         { $$ = new (compilation->arena) NewNode($2, new (compilation->arena) NodeList<ExpressionNode*>(compilation->arena)); }
            ;
 
-MethodCall : T_IDENTIFIER '.' T_IDENTIFIER '(' Arguments ')'    { $$ = new MethodCallNode($1, $3, $5); }
-           | T_IDENTIFIER '(' Arguments ')'                     { $$ = new MethodCallNode($1, NULL, $3); }
+MethodCall : T_IDENTIFIER '.' T_IDENTIFIER '(' Arguments ')'    { $$ = new (compilation->arena) MethodCallNode($1, $3, $5); }
+           | T_IDENTIFIER '(' Arguments ')'                     { $$ = new (compilation->arena) MethodCallNode($1, NULL, $3); }
            ;
 
 Arguments : ArgumentList    { $$ = $1; }
-          |                 { $$ = new std::list<ExpressionNode*>(); }
+          |                 { $$ = new (compilation->arena) NodeList<ExpressionNode*>(compilation->arena); }
           ;
 
-ArgumentList : Argument ',' ArgumentList                        { $$ = $3; $$->push_front($1); }
-             | Argument                                         { $$ = new std::list<ExpressionNode*>(); $$->push_front($1); }
+ArgumentList : ArgumentList ',' Argument                        { $$ = $1; $$->push_back($3); }
+             | Argument                                         { $$ = new (compilation->arena) NodeList<ExpressionNode*>(compilation->arena); $$->push_back($1); }
              ;
 
 Argument : Expression       { $$ = $1; }
          ;
 
-Type : T_INTEGER            { $$ = new IntegerTypeNode(); }
-     | T_BOOLEAN            { $$ = new BooleanTypeNode(); }
-     | T_IDENTIFIER         { $$ = new ObjectTypeNode($1); }
+Type : T_INTEGER            { $$ = new (compilation->arena) IntegerTypeNode(); }
+     | T_BOOLEAN            { $$ = new (compilation->arena) BooleanTypeNode(); }
+     | T_IDENTIFIER         { $$ = new (compilation->arena) ObjectTypeNode($1); }
      ;
 
 ReturnType : Type           { $$ = $1; }
-           | T_NONE         { $$ = new NoneNode(); }
+           | T_NONE         { $$ = new (compilation->arena) NoneNode(); }
            ;
 
 
 %%
 
-extern int yylineno;
-
-void yyerror(const char *s) {
-  fprintf(stderr, "%s at line %d\n", s, yylineno);
-  exit(1);
+// Syntax errors are reported to the diagnostics of the compilation
+// like type errors; the parser then recovers at the next ';' and
+// carries on.
+void yyerror(yyscan_t scanner, Compilation *compilation, const char *s) {
+  int line = yyget_lineno(scanner);
+  std::stringstream ss;
+  ss << s << " at line " << line;
+  compilation->diagnostics.error(ss.str(), NULL, line);
 }
 
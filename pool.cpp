@@ -0,0 +1,97 @@
+#include "pool.hpp"
+
+WorkPool::WorkPool(int size) {
+  body = NULL;
+  batch = 0;
+  finished = 0;
+  stopping = false;
+  // The calling thread is always one of them
+  for (int i = 0; i < (size > 1 ? size : 1); i++)
+    queues.push_back(new Queue());
+  for (int i = 1; i < (int) queues.size(); i++)
+    threads.push_back(std::thread(&WorkPool::work, this, i));
+}
+
+WorkPool::~WorkPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  started.notify_all();
+  for (size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+  for (size_t i = 0; i < queues.size(); i++)
+    delete queues[i];
+}
+
+// Takes the next task of a thread: the last of its own, or else
+// the first of another thread's. Returns false if every deque is
+// empty.
+bool WorkPool::take(int worker, size_t &task) {
+  {
+    Queue &own = *queues[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = own.tasks.back();
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  for (size_t i = 1; i < queues.size(); i++) {
+    Queue &victim = *queues[(worker + i) % queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+// Runs tasks of the current batch until there are none left.
+void WorkPool::drain(int worker) {
+  size_t task;
+  while (take(worker, task))
+    (*body)(task, worker);
+}
+
+// The loop of each thread but the one that runs batches: wait for
+// a batch, help with it, and say so once there is nothing left.
+void WorkPool::work(int worker) {
+  unsigned long seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      started.wait(lock, [&]() { return stopping || batch != seen; });
+      if (stopping)
+        return;
+      seen = batch;
+    }
+    drain(worker);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished++;
+    }
+    done.notify_one();
+  }
+}
+
+void WorkPool::run(size_t tasks, const std::function<void(size_t, int)> &body) {
+  size_t size = queues.size();
+  for (size_t task = 0; task < tasks; task++)
+    queues[task * size / tasks]->tasks.push_back(task);
+  this->body = &body;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    batch++;
+    finished = 0;
+  }
+  started.notify_all();
+  drain(0);
+  // The other threads may still be running the last tasks, and
+  // must not see the next batch's body before they are done
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&]() { return finished == (int) threads.size(); });
+  this->body = NULL;
+}
@@ -0,0 +1,59 @@
+#ifndef __POOL_HPP
+#define __POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Defines a pool of threads that run batches of independent tasks.
+// The tasks of a batch are numbered and dealt out to the threads
+// in runs of neighbouring tasks, one deque per thread. A thread
+// takes tasks from the back of its own deque and, once that is
+// empty, steals from the front of the others, so threads that drew
+// cheap tasks help those that drew dear ones. The thread that runs
+// a batch is one of the threads of the pool and works on it too.
+class WorkPool {
+private:
+  typedef struct queue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  } Queue;
+
+  std::vector<Queue *> queues;
+  std::vector<std::thread> threads;
+
+  // The batch being run, and the threads that have finished it
+  const std::function<void(size_t, int)> *body;
+  unsigned long batch;
+  int finished;
+  bool stopping;
+  std::mutex mutex;
+  std::condition_variable started;
+  std::condition_variable done;
+
+  WorkPool(const WorkPool &);
+  WorkPool &operator=(const WorkPool &);
+
+  bool take(int worker, size_t &task);
+  void drain(int worker);
+  void work(int worker);
+
+public:
+  // Starts a pool of the given number of threads, the calling
+  // thread included.
+  WorkPool(int size);
+  ~WorkPool();
+
+  int size() const { return (int) queues.size(); }
+
+  // Calls body(task, worker) for every task below tasks and returns
+  // once all have finished. Worker is the number of the thread the
+  // task runs on, below size(), so that tasks can keep what they
+  // need per thread.
+  void run(size_t tasks, const std::function<void(size_t, int)> &body);
+};
+
+#endif
@@ -0,0 +1,322 @@
+#include "regalloc.hpp"
+
+#include <algorithm>
+
+const char *registerNames[r_registers][2] = {
+    {"%edi", "%rdi"}, {"%esi", "%rsi"}, {"%r8d", "%r8"},   {"%r9d", "%r9"},   {"%r10d", "%r10"},
+    {"%r11d", "%r11"}, {"%ebx", "%rbx"}, {"%r12d", "%r12"}, {"%r13d", "%r13"}, {"%r14d", "%r14"},
+    {"%r15d", "%r15"}, {"%eax", "%rax"}, {"%ecx", "%rcx"}, {"%edx", "%rdx"},
+};
+
+const char *registerName(int reg) {
+  return registerNames[reg][0];
+}
+
+const char *wideRegisterName(int reg) {
+  return registerNames[reg][1];
+}
+
+bool operator==(const Location &a, const Location &b) {
+  return a.kind == b.kind && a.value == b.value;
+}
+
+bool operator!=(const Location &a, const Location &b) {
+  return !(a == b);
+}
+
+std::ostream &operator<<(std::ostream &out, const Location &location) {
+  switch (location.kind) {
+    case l_register:
+      return out << registerName(location.value);
+    case l_frame:
+      return out << location.value << "(%rbp)";
+    case l_constant:
+      return out << "$" << location.value;
+    default:
+      return out;
+  }
+}
+
+int variableOffset(const Function &code, int variable) {
+  if (variable < code.parameters)
+    return -4 * (code.locals + 1 + variable);
+  return -4 * (1 + variable - code.parameters);
+}
+
+// Defines the range of positions a value is live over, and how
+// much it would cost to keep it in the frame: its uses, each
+// counting 8 times as much for every loop it is in.
+typedef struct interval {
+  int value;
+  int start;
+  int end;
+  double weight;
+  bool acrossCall;
+} Interval;
+
+bool startsBefore(const Interval &a, const Interval &b) {
+  return a.start < b.start || (a.start == b.start && a.value < b.value);
+}
+
+// Defines a set of values as bits.
+class ValueSet {
+public:
+  ValueSet() {}
+  explicit ValueSet(size_t size) : words((size + 63) / 64, 0) {}
+
+  bool has(int value) const { return words[value / 64] >> (value % 64) & 1; }
+  void add(int value) { words[value / 64] |= 1ull << (value % 64); }
+  void remove(int value) { words[value / 64] &= ~(1ull << (value % 64)); }
+
+  // Adds the values of another set and returns true if any was new.
+  bool merge(const ValueSet &other) {
+    bool changed = false;
+    for (size_t i = 0; i < words.size(); i++) {
+      unsigned long long merged = words[i] | other.words[i];
+      changed = changed || merged != words[i];
+      words[i] = merged;
+    }
+    return changed;
+  }
+
+  std::vector<unsigned long long> words;
+};
+
+// Returns true if a value needs a place: it is used, and is not a
+// constant, which instructions take as it is.
+bool needsPlace(const IrInstruction &instruction) {
+  return instruction.op != ir_constant && instruction.type != bt_none;
+}
+
+// Finds the interval of every value that needs a place, numbering
+// the instructions two apart in the order the blocks are laid out.
+void buildIntervals(const IrFunction &function, std::vector<Interval> &intervals, std::vector<int> &calls,
+                    std::map<int, std::vector<int> > &liveAfter) {
+  size_t count = function.instructions.size();
+  size_t blocks = function.blocks.size();
+  std::vector<int> position(count, -1), start(blocks), end(blocks);
+  int next = 0;
+  for (size_t b = 0; b < blocks; b++) {
+    start[b] = next;
+    const std::vector<int> &instructions = function.blocks[b].instructions;
+    for (size_t i = 0; i < instructions.size(); i++) {
+      position[instructions[i]] = next;
+      if (isCall(function.instructions[instructions[i]].op) || function.instructions[instructions[i]].op == ir_new ||
+          function.instructions[instructions[i]].op == ir_print)
+        calls.push_back(next);
+      next += 2;
+    }
+    end[b] = next - 2;
+  }
+
+  // What each block uses that it does not define, what it defines,
+  // and what the phis of its successors use of it
+  std::vector<ValueSet> uses(blocks, ValueSet(count)), defines(blocks, ValueSet(count)),
+      phiUses(blocks, ValueSet(count)), liveIn(blocks, ValueSet(count)), liveOut(blocks, ValueSet(count));
+  std::vector<int> depth;
+  loopDepths(function, depth);
+  std::vector<double> weight(count, 0);
+  std::vector<int> first(count, -1), last(count, -1);
+  for (size_t b = 0; b < blocks; b++) {
+    double uses8 = 1;
+    for (int i = 0; i < depth[b] && i < 6; i++)
+      uses8 *= 8;
+    const std::vector<int> &instructions = function.blocks[b].instructions;
+    for (size_t i = 0; i < instructions.size(); i++) {
+      const IrInstruction &instruction = function.instructions[instructions[i]];
+      defines[b].add(instructions[i]);
+      weight[instructions[i]] += uses8;
+      first[instructions[i]] = instruction.op == ir_phi ? start[b] : position[instructions[i]];
+      last[instructions[i]] = first[instructions[i]];
+      for (size_t j = 0; j < instruction.operands.size(); j++) {
+        int operand = instruction.operands[j];
+        if (!needsPlace(function.instructions[operand]))
+          continue;
+        weight[operand] += uses8;
+        if (instruction.op == ir_phi) {
+          phiUses[function.blocks[b].predecessors[j]].add(operand);
+          continue;
+        }
+        last[operand] = std::max(last[operand], position[instructions[i]]);
+        if (!defines[b].has(operand))
+          uses[b].add(operand);
+      }
+    }
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t b = blocks; b-- > 0;) {
+      const std::vector<int> &successors = function.blocks[b].successors;
+      ValueSet out = phiUses[b];
+      for (size_t i = 0; i < successors.size(); i++)
+        out.merge(liveIn[successors[i]]);
+      liveOut[b] = out;
+      for (size_t i = 0; i < out.words.size(); i++)
+        out.words[i] = (out.words[i] & ~defines[b].words[i]) | uses[b].words[i];
+      changed = liveIn[b].merge(out) || changed;
+    }
+  }
+
+  // What is live after each call follows from what is live out of
+  // its block, going back over the instructions after it
+  for (size_t b = 0; b < blocks; b++) {
+    ValueSet live = liveOut[b];
+    const std::vector<int> &instructions = function.blocks[b].instructions;
+    for (size_t i = instructions.size(); i-- > 0;) {
+      const IrInstruction &instruction = function.instructions[instructions[i]];
+      if (instruction.op == ir_phi)
+        break;
+      if (isCall(instruction.op) || instruction.op == ir_new) {
+        std::vector<int> &after = liveAfter[instructions[i]];
+        for (size_t v = 0; v < count; v++)
+          if (live.has(v) && (int) v != instructions[i])
+            after.push_back(v);
+      }
+      live.remove(instructions[i]);
+      for (size_t j = 0; j < instruction.operands.size(); j++)
+        if (needsPlace(function.instructions[instruction.operands[j]]))
+          live.add(instruction.operands[j]);
+    }
+  }
+
+  // A value may be live in a block laid out before the one that
+  // defines it, such as one that leads back into a loop
+  for (size_t b = 0; b < blocks; b++)
+    for (size_t v = 0; v < count; v++) {
+      if (first[v] < 0)
+        continue;
+      if (liveIn[b].has(v)) {
+        first[v] = std::min(first[v], start[b]);
+        last[v] = std::max(last[v], start[b]);
+      }
+      if (liveOut[b].has(v)) {
+        first[v] = std::min(first[v], end[b]);
+        last[v] = std::max(last[v], end[b]);
+      }
+    }
+
+  for (size_t v = 0; v < count; v++) {
+    if (position[v] < 0 || !needsPlace(function.instructions[v]) || last[v] == first[v])
+      continue;
+    Interval interval;
+    interval.value = v;
+    interval.start = first[v];
+    interval.end = last[v];
+    interval.weight = weight[v] / (interval.end - interval.start + 2);
+    // A call that gives the value does not change it
+    std::vector<int>::iterator call = std::lower_bound(calls.begin(), calls.end(), interval.start);
+    if (call != calls.end() && *call == position[v])
+      ++call;
+    interval.acrossCall = call != calls.end() && *call < interval.end;
+    intervals.push_back(interval);
+  }
+  std::sort(intervals.begin(), intervals.end(), startsBefore);
+}
+
+// Gives the spilled values slots of the frame, their own where they
+// can have it, and returns the number of other slots they need.
+int assignSlots(const Function &code, const std::vector<Interval> &spilled, Allocation &allocation) {
+  std::vector<std::vector<std::pair<int, int> > > homes(code.parameters + code.locals);
+  std::vector<int> slotEnds;
+  for (size_t i = 0; i < spilled.size(); i++) {
+    const Interval &interval = spilled[i];
+    int home = allocation.locations[interval.value].value;
+    if (home >= 0 && home < (int) homes.size()) {
+      std::vector<std::pair<int, int> > &taken = homes[home];
+      size_t j;
+      for (j = 0; j < taken.size(); j++)
+        if (taken[j].first <= interval.end && interval.start <= taken[j].second)
+          break;
+      if (j == taken.size()) {
+        taken.push_back(std::make_pair(interval.start, interval.end));
+        allocation.locations[interval.value].value = variableOffset(code, home);
+        continue;
+      }
+    }
+    size_t slot;
+    for (slot = 0; slot < slotEnds.size(); slot++)
+      if (slotEnds[slot] < interval.start)
+        break;
+    if (slot == slotEnds.size())
+      slotEnds.push_back(0);
+    slotEnds[slot] = interval.end;
+    allocation.locations[interval.value].value = -4 * (code.parameters + code.locals + 1 + slot);
+  }
+  return slotEnds.size();
+}
+
+void allocateRegisters(const Function &code, const IrFunction &function, Allocation &allocation) {
+  std::vector<Interval> intervals;
+  std::vector<int> calls;
+  allocation.liveAfter.clear();
+  buildIntervals(function, intervals, calls, allocation.liveAfter);
+
+  allocation.locations.resize(function.instructions.size());
+  for (size_t v = 0; v < function.instructions.size(); v++) {
+    const IrInstruction &instruction = function.instructions[v];
+    allocation.locations[v].kind = instruction.op == ir_constant ? l_constant : l_none;
+    allocation.locations[v].value = instruction.op == ir_constant ? instruction.immediate : 0;
+  }
+
+  // The intervals holding registers, and the values spilled
+  std::vector<int> holder(allocatableRegisters, -1);
+  std::vector<bool> used(allocatableRegisters, false);
+  std::vector<Interval> spilled;
+  for (size_t i = 0; i < intervals.size(); i++) {
+    Interval &current = intervals[i];
+    // A value may take the register of one whose last use is where
+    // it is defined
+    for (int r = 0; r < allocatableRegisters; r++)
+      if (holder[r] >= 0 && intervals[holder[r]].end <= current.start)
+        holder[r] = -1;
+
+    int lowest = current.acrossCall ? firstCalleeSaved : 0;
+    int chosen = -1;
+    for (int r = lowest; r < allocatableRegisters && chosen < 0; r++)
+      if (holder[r] < 0)
+        chosen = r;
+    if (chosen < 0) {
+      // Spill the value that costs least to keep in the frame, this
+      // one or one holding a register it could have
+      int cheapest = -1;
+      for (int r = lowest; r < allocatableRegisters; r++)
+        if (cheapest < 0 || intervals[holder[r]].weight < intervals[holder[cheapest]].weight)
+          cheapest = r;
+      if (intervals[holder[cheapest]].weight < current.weight) {
+        spilled.push_back(intervals[holder[cheapest]]);
+        holder[cheapest] = -1;
+        chosen = cheapest;
+      } else {
+        spilled.push_back(current);
+        continue;
+      }
+    }
+    holder[chosen] = i;
+    used[chosen] = true;
+    allocation.locations[current.value].kind = l_register;
+    allocation.locations[current.value].value = chosen;
+  }
+
+  // Spilled values go to the slots of their variables where they can
+  std::sort(spilled.begin(), spilled.end(), startsBefore);
+  for (size_t i = 0; i < spilled.size(); i++) {
+    allocation.locations[spilled[i].value].kind = l_frame;
+    allocation.locations[spilled[i].value].value = function.instructions[spilled[i].value].variable;
+  }
+  int slots = assignSlots(code, spilled, allocation);
+
+  int bytes = (4 * (code.parameters + code.locals + slots) + 7) & ~7;
+  allocation.saved.clear();
+  allocation.savedAt.clear();
+  for (int r = firstCalleeSaved; r < allocatableRegisters; r++)
+    if (used[r]) {
+      bytes += 8;
+      allocation.saved.push_back(r);
+      allocation.savedAt.push_back(-bytes);
+    }
+  allocation.frameSize = (bytes + 15) & ~15;
+  allocation.values = intervals.size();
+  allocation.spilled = spilled.size();
+}
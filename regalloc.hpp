@@ -0,0 +1,78 @@
+#ifndef __REGALLOC_HPP
+#define __REGALLOC_HPP
+
+#include "ir.hpp"
+
+#include <iostream>
+#include <map>
+#include <vector>
+
+// The registers of x86-64 that hold values. Calls may change the
+// first six, so only values that are not live across a call are
+// given them; the callee-saved ones are saved by the functions that
+// use them. The code generator keeps %eax, %ecx and %edx for itself,
+// and they come last.
+typedef enum {
+  r_rdi, r_rsi, r_r8, r_r9, r_r10, r_r11,
+  r_rbx, r_r12, r_r13, r_r14, r_r15,
+  r_rax, r_rcx, r_rdx, r_registers
+} MachineRegister;
+
+const int firstCalleeSaved = r_rbx;
+const int allocatableRegisters = r_rax;
+
+// Returns the name of the 32 or the 64 bit register.
+const char *registerName(int reg);
+const char *wideRegisterName(int reg);
+
+// Defines where a value is: in a register, in the frame at an
+// offset from the frame pointer, or nowhere, being a constant or
+// unused.
+typedef enum {l_none, l_register, l_frame, l_constant} LocationKind;
+
+typedef struct location {
+  LocationKind kind;
+  int value;
+} Location;
+
+bool operator==(const Location &a, const Location &b);
+bool operator!=(const Location &a, const Location &b);
+
+// Writes a location as an operand of GNU assembly.
+std::ostream &operator<<(std::ostream &out, const Location &location);
+
+// Returns the offset from the frame pointer of the slot of a local
+// or parameter: the locals at the offsets the type checker gave
+// them, -4 and down, so that they take localsSize bytes right below
+// the frame pointer, then the object the method runs on and the
+// parameters.
+int variableOffset(const Function &code, int variable);
+
+// Defines where the values of a function are, and its frame: the
+// bytes below the frame pointer, and the callee-saved registers it
+// saves at the offsets in savedAt. For every instruction that calls
+// out of the function, or allocates, it holds the values live after
+// it, other than its own, which the collector of native code finds
+// the references of the frame with.
+typedef struct allocation {
+  std::vector<Location> locations;
+  int frameSize;
+  std::vector<int> saved;
+  std::vector<int> savedAt;
+  std::map<int, std::vector<int> > liveAfter;
+  int values;
+  int spilled;
+} Allocation;
+
+// Gives every value of a function that is used a register or a slot
+// of the frame with linear scan: each value is live over one range
+// of the blocks laid out in order, covering every block it is live
+// in, and the values are given free registers in the order their
+// ranges start. When none is free, the value that is used least for
+// the length of its range, counting uses in loops as many, is
+// spilled to the frame, so that the counters and the locals of loops
+// stay in registers. A local or parameter is spilled to its own
+// slot where no other value of it is there.
+void allocateRegisters(const Function &code, const IrFunction &function, Allocation &allocation);
+
+#endif
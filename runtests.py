@@ -1,6 +1,10 @@
 from subprocess import Popen, PIPE
-from os import listdir, path
+from os import environ, listdir, path
 from functools import total_ordering
+import json
+import re
+import shutil
+import tempfile
 
 @total_ordering
 class NameOrder(object):
@@ -33,8 +37,11 @@ def runTests():
 		infile = open(f, 'r')
 
 		print("./lang < " + f + ":")
-		p = Popen(["./lang"], stdin=infile, stdout=PIPE, stderr=PIPE)
+		# The reference output only has the first error of each bad test,
+		# so the count of those the cap dropped is left out
+		p = Popen(["./lang", "--max-errors", "1"], stdin=infile, stdout=PIPE, stderr=PIPE)
 		(out, err) = p.communicate()
+		err = b"".join([line for line in err.splitlines(True) if not re.match(b"and [0-9]+ more errors?$", line.strip())])
 
 		try:
 			if (out):
@@ -50,8 +57,245 @@ def runTests():
 		except UnicodeDecodeError:
 			print("Invalid characters in output.\n")
 
+def runCommand(command, f, env=None):
+	p = Popen(command, stdout=PIPE, stderr=PIPE, env=env)
+	(out, err) = p.communicate()
+	# Executables do not know the path of their program
+	err = err.replace((f + ": ").encode("utf-8"), b"")
+	return (out, err, p.returncode)
+
+def printResult(result):
+	(out, err, status) = result
+	try:
+		if (out):
+			print(out.decode("utf-8"))
+		if (err):
+			print(err.decode("utf-8"))
+		if (status):
+			print("Exit status " + str(status) + ".\n")
+		elif (not out and not err):
+			print("No output.\n")
+	except UnicodeDecodeError:
+		print("Invalid characters in output.\n")
+
+# Returns the programs of a directory of tests, in the order of the
+# numbers they are named by.
+def numbered(directory):
+	return sorted([directory + f for f in listdir(directory) if f.endswith(".lang")],
+		key=lambda f: int(path.basename(f).partition(".")[0]))
+
+# The programs of tests/errors have several errors each, all of which
+# are printed, and with no more than three, the count of the rest.
+def runErrors():
+	if (not path.isdir("tests/errors/")):
+		return
+
+	files = numbered("tests/errors/")
+	for f in files:
+		print("./lang " + f + ":")
+		printResult(runCommand(["./lang", f], f))
+	print("./lang --max-errors 3 " + files[0] + ":")
+	printResult(runCommand(["./lang", "--max-errors", "3", files[0]], files[0]))
+
+# The programs of tests/threads have many methods with errors. Checked
+# on 4 threads, a few times over, and with a cap on the errors, each
+# must print what the same check prints on one thread.
+def runThreads():
+	if (not path.isdir("tests/threads/")):
+		return
+
+	for f in numbered("tests/threads/"):
+		for cap in [[], ["--max-errors", "5"]]:
+			command = " ".join(["./lang"] + cap + [f])
+			print(command + ":")
+			expected = runCommand(["./lang"] + cap + [f], f)
+			printResult(expected)
+			for i in range(5):
+				result = runCommand(["./lang", "--threads", "4"] + cap + [f], f)
+				if (result != expected):
+					print(command.replace("./lang", "./lang --threads 4") + " differs:")
+					printResult(result)
+					break
+
+# Prints what JSON output fails to hold: a value that does not parse,
+# or a member whose offset and size are not those of the layout.
+def checkJSON(out, layouts):
+	try:
+		value = json.loads(out.decode("utf-8"))
+	except ValueError:
+		print("Invalid JSON.\n")
+		return
+	if (not layouts):
+		return
+	for c in value["classes"]:
+		placed = dict((m["name"], (m["offset"], m["size"])) for m in c["layout"]["members"])
+		for m in c["members"]:
+			if (placed[m["name"]] != (m["offset"], m["size"])):
+				print("The JSON member " + c["name"] + "." + m["name"] + " is not where the layout has it.\n")
+
+# The programs of tests/formats have their symbol tables printed as
+# JSON, the first with layouts and then all of them as one object,
+# and the first in the binary format, in hex.
+def runFormats():
+	if (not path.isdir("tests/formats/")):
+		return
+
+	files = numbered("tests/formats/")
+	print("./lang --format=json --layouts " + files[0] + ":")
+	result = runCommand(["./lang", "--format=json", "--layouts", files[0]], files[0])
+	printResult(result)
+	checkJSON(result[0], True)
+
+	print("./lang --format=json " + " ".join(files) + ":")
+	result = runCommand(["./lang", "--format=json"] + files, files[0])
+	printResult(result)
+	checkJSON(result[0], False)
+
+	print("./lang --format=binary " + files[0] + ":")
+	(out, err, status) = runCommand(["./lang", "--format=binary", files[0]], files[0])
+	hex = "\n".join([out[i:i + 16].hex() for i in range(0, len(out), 16)])
+	printResult((hex.encode("utf-8") + b"\n" if out else b"", err, status))
+
+# The first program of tests/library is a class library, which is
+# written with --make-lib and read back with --lib to check the
+# others, whose symbol tables are printed with their layouts. Then
+# the library cut short must be rejected.
+def runLibrary():
+	if (not path.isdir("tests/library/")):
+		return
+
+	files = numbered("tests/library/")
+	directory = tempfile.mkdtemp()
+	library = path.join(directory, "lib")
+	cut = path.join(directory, "cut")
+
+	def run(command, f):
+		(out, err, status) = runCommand(command, f)
+		return (out, err.replace(directory.encode("utf-8") + b"/", b""), status)
+
+	print("./lang --make-lib lib " + files[0] + ":")
+	printResult(run(["./lang", "--make-lib", library, files[0]], files[0]))
+	for f in files[1:]:
+		print("./lang --layouts --lib lib " + f + ":")
+		printResult(run(["./lang", "--layouts", "--lib", library, f], f))
+
+	with open(library, "rb") as whole:
+		data = whole.read()
+	with open(cut, "wb") as part:
+		part.write(data[:len(data) // 2])
+	print("./lang --lib cut " + files[1] + ":")
+	printResult(run(["./lang", "--lib", cut, files[1]], files[1]))
+	shutil.rmtree(directory)
+
+# The programs of tests/server are versions of one file, which a
+# server checks in turn, then again unchanged, and again once it has
+# forgotten the file. Each reply is printed, and whether what it
+# holds differs from what a fresh lang prints for the same text.
+def runServer():
+	if (not path.isdir("tests/server/")):
+		return
+
+	files = numbered("tests/server/")
+	directory = tempfile.mkdtemp()
+	program = path.join(directory, "program.lang")
+	server = Popen(["./lang", "--server"], stdin=PIPE, stdout=PIPE, stderr=PIPE)
+
+	def request(line):
+		server.stdin.write((line + "\n").encode("utf-8"))
+		server.stdin.flush()
+		header = server.stdout.readline().decode("utf-8")
+		(reply, outSize, errSize) = header.split()
+		out = server.stdout.read(int(outSize))
+		err = server.stdout.read(int(errSize)).replace((program + ": ").encode("utf-8"), b"")
+		# The errors are counted without the path of the copy
+		print(reply + " " + outSize + " " + str(len(err)))
+		if (err):
+			print(err.decode("utf-8"))
+		return (reply, out, err)
+
+	def check(f):
+		print("check " + f + ":")
+		(reply, out, err) = request("check " + program)
+		fresh = runCommand(["./lang", program], program)
+		if ((out, err, reply == "failed") != (fresh[0], fresh[1], fresh[2] != 0)):
+			print("check " + f + " differs from ./lang " + f + ".\n")
+
+	for f in files:
+		shutil.copyfile(f, program)
+		check(f)
+	check(files[-1])
+	print("forget " + files[-1] + ":")
+	request("forget " + program)
+	print("")
+	check(files[-1])
+	(out, err) = server.communicate(b"quit\n")
+	if (out or err or server.returncode):
+		print("quit left output or exit status " + str(server.returncode) + ".\n")
+	shutil.rmtree(directory)
+
+# The programs of tests/run are run by each backend, and what the
+# first prints is printed, followed by what each other prints if it
+# is not the same: compiled in memory, interpreted, and compiled to
+# an executable, and all three again with the collector moving
+# every object as soon as the next is made, and every third time
+# the old ones too. What optimizing the bytecode did is printed after,
+# or for a program named N.ir.lang, its IR and what optimizing that
+# did. A program named N.layouts.lang has its symbol table with the
+# layouts of its classes printed first.
+def runPrograms():
+	if (not path.isdir("tests/run/")):
+		return
+
+	files = numbered("tests/run/")
+	directory = tempfile.mkdtemp()
+	executable = path.join(directory, "program")
+
+	for f in files:
+		if (f.endswith(".layouts.lang")):
+			print("./lang --layouts " + f + ":")
+			printResult(runCommand(["./lang", "--layouts", f], f))
+
+		print("./lang --run " + f + ":")
+		expected = runCommand(["./lang", "--run", f], f)
+		printResult(expected)
+
+		backends = [("./lang --run --interpret", lambda: runCommand(["./lang", "--run", "--interpret", f], f))]
+		def native():
+			built = runCommand(["./lang", "-o", executable, f], f)
+			return runCommand([executable], f) if built[2] == 0 else built
+		backends.append(("./lang -o", native))
+		stressed = dict(environ, LANG_GC_STRESS="3")
+		backends.append(("LANG_GC_STRESS=3 ./lang --run", lambda: runCommand(["./lang", "--run", f], f, stressed)))
+		backends.append(("LANG_GC_STRESS=3 ./lang --run --interpret",
+			lambda: runCommand(["./lang", "--run", "--interpret", f], f, stressed)))
+		def stressedNative():
+			built = runCommand(["./lang", "-o", executable, f], f)
+			return runCommand([executable], f, stressed) if built[2] == 0 else built
+		backends.append(("LANG_GC_STRESS=3 ./lang -o", stressedNative))
+		for (name, run) in backends:
+			result = run()
+			if (result != expected):
+				print(name + " " + f + " differs:")
+				printResult(result)
+
+		if (f.endswith(".ir.lang")):
+			print("./lang --ir --opt-report " + f + ":")
+			printResult(runCommand(["./lang", "--ir", "--opt-report", f], f))
+		else:
+			print("./lang --bytecode --opt-report " + f + ":")
+			(out, err, status) = runCommand(["./lang", "--bytecode", "--opt-report", f], f)
+			printResult((b"", err, status))
+
+	shutil.rmtree(directory)
+
 def main():
 	runTests()
+	runErrors()
+	runThreads()
+	runFormats()
+	runLibrary()
+	runServer()
+	runPrograms()
 
 if __name__ == "__main__":
 	main()
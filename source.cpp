@@ -0,0 +1,101 @@
+#include "source.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Source::Source() {
+  this->mapped = 0;
+  this->text = NULL;
+  this->length = 0;
+}
+
+Source::~Source() {
+  unmap();
+}
+
+bool Source::map(const char *path) {
+  unmap();
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat status;
+  int error = 0;
+  if (fstat(fd, &status) < 0)
+    error = errno;
+  else if (!S_ISREG(status.st_mode))
+    error = ENODEV;
+  if (error) {
+    close(fd);
+    errno = error;
+    return false;
+  }
+
+  // Reserve room for the text and the two NULs after it, then map
+  // the file over the start of it. The rest of the last page of
+  // the file reads as zeros, and so do the anonymous pages after
+  // it, so the NULs are there even when the file ends at the end
+  // of a page.
+  size_t length = status.st_size;
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t size = (length + 2 + page - 1) / page * page;
+  void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    error = errno;
+    close(fd);
+    errno = error;
+    return false;
+  }
+  if (length > 0 &&
+      mmap(base, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    error = errno;
+    munmap(base, size);
+    close(fd);
+    errno = error;
+    return false;
+  }
+  close(fd);
+
+  this->mapped = size;
+  this->text = (char *) base;
+  this->length = length;
+  return true;
+}
+
+bool Source::load(const char *text, size_t length) {
+  unmap();
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t size = (length + 2 + page - 1) / page * page;
+  void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    return false;
+  memcpy(base, text, length);
+
+  this->mapped = size;
+  this->text = (char *) base;
+  this->length = length;
+  return true;
+}
+
+bool Source::read(FILE *in) {
+  std::string text;
+  char buffer[65536];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), in)) > 0)
+    text.append(buffer, count);
+  if (ferror(in))
+    return false;
+  return load(text.data(), text.size());
+}
+
+void Source::unmap() {
+  if (text)
+    munmap(text, mapped);
+  mapped = 0;
+  text = NULL;
+  length = 0;
+}
@@ -0,0 +1,42 @@
+#ifndef __SOURCE_HPP
+#define __SOURCE_HPP
+
+#include <cstddef>
+#include <cstdio>
+
+// Defines the text of a source file mapped into memory, so that
+// the scanner works on the file where it is instead of reading it
+// into buffers of its own, and names can be kept as views of it.
+// The text is followed by the two NUL characters the scanner
+// needs at the end of a buffer. The scanner briefly writes a NUL
+// after each token as it scans it, so the mapping is private and
+// writable; the file itself is never changed.
+class Source {
+private:
+  size_t mapped;
+
+  Source(const Source &);
+  Source &operator=(const Source &);
+
+public:
+  // The text of the file, or NULL if no file is mapped
+  char *text;
+  size_t length;
+
+  Source();
+  ~Source();
+
+  // Maps the regular file at path. Returns false, with errno
+  // set, if it cannot be mapped.
+  bool map(const char *path);
+
+  // Maps a copy of text, for sources that are not files.
+  bool load(const char *text, size_t length);
+
+  // Reads in to its end and maps a copy of what was read.
+  bool read(FILE *in);
+
+  void unmap();
+};
+
+#endif
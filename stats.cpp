@@ -0,0 +1,188 @@
+#include "stats.hpp"
+#include "ast.hpp"
+
+#include <cstring>
+#include <iomanip>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef LANG_STATS
+thread_local Statistics *activeStatistics = NULL;
+
+void PhaseScope::enter(Phase phase) {
+  Statistics *statistics = activeStatistics;
+  Stopwatch now = stopwatch();
+  if (statistics->current != t_phases) {
+    statistics->times[statistics->current].wall += now.wall - statistics->since.wall;
+    statistics->times[statistics->current].cpu += now.cpu - statistics->since.cpu;
+  }
+  statistics->current = phase;
+  statistics->since = now;
+}
+#endif
+
+void clear(Statistics &statistics) {
+  memset(&statistics, 0, sizeof(statistics));
+  statistics.current = t_phases;
+}
+
+double seconds(clockid_t clock) {
+  struct timespec time;
+  clock_gettime(clock, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+Stopwatch stopwatch() {
+  Stopwatch now = {
+      seconds(CLOCK_MONOTONIC),
+      seconds(CLOCK_THREAD_CPUTIME_ID)
+  };
+  return now;
+}
+
+void record(Statistics &statistics, Phase phase, const Stopwatch &start) {
+  Stopwatch now = stopwatch();
+  statistics.times[phase].wall += now.wall - start.wall;
+  statistics.times[phase].cpu += now.cpu - start.cpu;
+}
+
+void merge(Statistics &statistics, const Statistics &part) {
+  for (int phase = t_classes; phase <= t_expressions; phase++) {
+    statistics.times[phase].wall += part.times[phase].wall;
+    statistics.times[phase].cpu += part.times[phase].cpu;
+  }
+  for (int counter = 0; counter < s_counters; counter++)
+    statistics.counts[counter] += part.counts[counter];
+  for (int kind = 0; kind < STATS_NODE_KINDS; kind++)
+    statistics.nodes[kind] += part.nodes[kind];
+}
+
+// Prints one row of the time report, in milliseconds.
+void printTime(std::ostream &out, const char *name, const Stopwatch &time) {
+  out << "  " << std::left << std::setw(16) << name << std::right
+      << std::setw(12) << time.wall * 1000 << std::setw(12) << time.cpu * 1000 << std::endl;
+}
+
+void printTimeReport(std::ostream &out, const Statistics &statistics) {
+  std::ios::fmtflags flags = out.flags();
+  out << std::fixed << std::setprecision(3);
+  out << "time report (ms):" << std::endl;
+  out << "  " << std::left << std::setw(16) << "phase" << std::right
+      << std::setw(12) << "wall" << std::setw(12) << "cpu" << std::endl;
+  printTime(out, "import", statistics.times[t_import]);
+  printTime(out, "scan", statistics.times[t_scan]);
+  printTime(out, "parse", statistics.times[t_parse]);
+  printTime(out, "typecheck", statistics.times[t_typecheck]);
+#ifdef LANG_STATS
+  printTime(out, "  classes", statistics.times[t_classes]);
+  printTime(out, "  methods", statistics.times[t_methods]);
+  printTime(out, "  statements", statistics.times[t_statements]);
+  printTime(out, "  expressions", statistics.times[t_expressions]);
+#endif
+  printTime(out, "print", statistics.times[t_print]);
+  out << "  (scan is timed in a pass of its own; parse includes scanning)" << std::endl;
+  if (statistics.threads > 1)
+    out << "  (the categories add up the time of the " << statistics.threads << " threads checking bodies)"
+        << std::endl;
+  out.flags(flags);
+}
+
+// Returns the peak resident set size of the process, in kilobytes.
+long peakResidentSize() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) < 0)
+    return 0;
+  return usage.ru_maxrss;
+}
+
+void printStats(std::ostream &out, const Statistics &statistics) {
+  out << "stats:" << std::endl;
+#ifdef LANG_STATS
+  unsigned long nodes = 0;
+  for (int kind = 0; kind < AST_NODE_KINDS; kind++)
+    nodes += statistics.nodes[kind];
+  out << "  ast nodes: " << nodes << std::endl;
+  for (int kind = 0; kind < AST_NODE_KINDS; kind++)
+    if (statistics.nodes[kind])
+      out << "    " << astNodeNames[kind] << ": " << statistics.nodes[kind] << std::endl;
+  out << "  symbol table lookups: " << statistics.counts[s_lookups] << std::endl;
+  out << "  symbol table misses: " << statistics.counts[s_misses] << std::endl;
+  out << "  inherited layout hits: " << statistics.counts[s_inheritedHits] << std::endl;
+  out << "  layout slots copied from super classes: " << statistics.counts[s_copiedSlots] << std::endl;
+#else
+  out << "  counts: not compiled in (build with make STATS=1)" << std::endl;
+#endif
+  if (statistics.counted) {
+    out << "  cycles: " << statistics.hardware[h_cycles] << std::endl;
+    out << "  instructions: " << statistics.hardware[h_instructions] << std::endl;
+    out << "  cache misses: " << statistics.hardware[h_cacheMisses] << std::endl;
+    out << "  branch misses: " << statistics.hardware[h_branchMisses] << std::endl;
+  } else {
+    out << "  hardware counters: unavailable" << std::endl;
+  }
+  out << "  peak rss: " << peakResidentSize() << " KB" << std::endl;
+}
+
+HardwareCounters::HardwareCounters() {
+  for (int i = 0; i < h_counters; i++)
+    fds[i] = -1;
+}
+
+HardwareCounters::~HardwareCounters() {
+  for (int i = 0; i < h_counters; i++)
+    if (fds[i] >= 0)
+      close(fds[i]);
+}
+
+bool HardwareCounters::start() {
+#ifdef __linux__
+  static const unsigned long long events[h_counters] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES
+  };
+  for (int i = 0; i < h_counters; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = events[i];
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Count the calling thread only, on any CPU
+    fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fds[i] < 0)
+      return false;
+  }
+  for (int i = 0; i < h_counters; i++) {
+    ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void HardwareCounters::stop(Statistics &statistics) {
+#ifdef __linux__
+  for (int i = 0; i < h_counters; i++) {
+    if (fds[i] < 0)
+      return;
+    ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+  }
+  for (int i = 0; i < h_counters; i++)
+    if (read(fds[i], &statistics.hardware[i], sizeof(statistics.hardware[i])) != sizeof(statistics.hardware[i]))
+      return;
+  statistics.counted = true;
+#endif
+}
@@ -0,0 +1,182 @@
+#ifndef __STATS_HPP
+#define __STATS_HPP
+
+#include <iostream>
+
+// Defines the instrumentation behind `lang --time-report` and
+// `lang --stats`. Timing whole phases costs a few clock reads per
+// file and is always built. Everything counted per node, per
+// lookup or per visit is only compiled in when LANG_STATS is
+// defined (make STATS=1); in any other build the STATS_ macros
+// below expand to nothing, so the checker pays nothing for them.
+
+// The phases timed by --time-report. The type checker's visits
+// are split by what they visit, each visit being charged to the
+// innermost category it is in.
+typedef enum {
+  t_import,
+  t_scan,
+  t_parse,
+  t_typecheck,
+  t_classes,
+  t_methods,
+  t_statements,
+  t_expressions,
+  t_print,
+  t_phases
+} Phase;
+
+// The events counted by --stats in builds with LANG_STATS.
+// Lookups are probes of a symbol table, misses are probes that
+// did not find their key. Layouts are flattened, so a lookup in a
+// class never walks its super classes; inherited hits are the
+// lookups that found a name a super class declared, each of which
+// would have cost at least one hop up the chain, and copied slots
+// are what the flattening costs instead.
+typedef enum {
+  s_lookups,
+  s_misses,
+  s_inheritedHits,
+  s_copiedSlots,
+  s_counters
+} Counter;
+
+// The hardware events counted by --stats where perf_event_open
+// is available.
+typedef enum {
+  h_cycles,
+  h_instructions,
+  h_cacheMisses,
+  h_branchMisses,
+  h_counters
+} HardwareCounter;
+
+// The most kinds of AST nodes the counts have room for
+#define STATS_NODE_KINDS 64
+
+// Defines a reading of the wall and CPU clocks, in seconds. The
+// CPU clock is that of the calling thread, so phases of files
+// checked at once on several threads are timed apart.
+typedef struct stopwatch {
+  double wall;
+  double cpu;
+} Stopwatch;
+
+// Defines everything measured while checking one compilation.
+typedef struct statistics {
+  // Set to time the phases
+  bool timed;
+  Stopwatch times[t_phases];
+
+  unsigned long counts[s_counters];
+  unsigned long nodes[STATS_NODE_KINDS];
+
+  // Set if the hardware counters could be read
+  bool counted;
+  unsigned long long hardware[h_counters];
+
+  // The category visits are being charged to (t_phases if none),
+  // and when it started
+  Phase current;
+  Stopwatch since;
+
+  // The threads method bodies were checked on, if more than one,
+  // whose times the categories add up
+  int threads;
+} Statistics;
+
+// Zeroes the statistics of a compilation about to be checked.
+void clear(Statistics &statistics);
+
+// Returns the current reading of the clocks.
+Stopwatch stopwatch();
+
+// Adds the counts and the category times of statistics kept apart,
+// such as those of a thread checking method bodies, to others.
+void merge(Statistics &statistics, const Statistics &part);
+
+// Charges the time since start to a phase.
+void record(Statistics &statistics, Phase phase, const Stopwatch &start);
+
+// Prints the phase times, or the counts, hardware counts and the
+// peak resident set size of the process so far. Counts that were
+// not compiled in are left out.
+void printTimeReport(std::ostream &out, const Statistics &statistics);
+void printStats(std::ostream &out, const Statistics &statistics);
+
+// Counts hardware events of the calling thread between start and
+// stop. Where perf_event_open is missing or not permitted, start
+// fails and the counts are left unset.
+class HardwareCounters {
+private:
+  int fds[h_counters];
+
+  HardwareCounters(const HardwareCounters &);
+  HardwareCounters &operator=(const HardwareCounters &);
+
+public:
+  HardwareCounters();
+  ~HardwareCounters();
+
+  bool start();
+  void stop(Statistics &statistics);
+};
+
+#ifdef LANG_STATS
+
+// The statistics of the compilation the calling thread is
+// checking, or NULL
+extern thread_local Statistics *activeStatistics;
+
+// Makes a compilation's statistics the active ones for as long as
+// it is in scope.
+class ActiveStatistics {
+private:
+  Statistics *saved;
+
+public:
+  ActiveStatistics(Statistics &statistics) : saved(activeStatistics) { activeStatistics = &statistics; }
+  ~ActiveStatistics() { activeStatistics = saved; }
+};
+
+// Charges the time spent in its scope to a category of visits,
+// less the time spent in any nested category.
+class PhaseScope {
+private:
+  bool switched;
+  Phase saved;
+
+  static void enter(Phase phase);
+
+public:
+  PhaseScope(Phase phase) : switched(false), saved(t_phases) {
+    if (activeStatistics && activeStatistics->timed && activeStatistics->current != phase) {
+      switched = true;
+      saved = activeStatistics->current;
+      enter(phase);
+    }
+  }
+  ~PhaseScope() {
+    if (switched)
+      enter(saved);
+  }
+};
+
+#define STATS_ACTIVATE(statistics) ActiveStatistics activeStatisticsScope(statistics)
+#define STATS_COUNT(counter) do { if (activeStatistics) activeStatistics->counts[counter]++; } while (0)
+#define STATS_ADD(counter, n) do { if (activeStatistics) activeStatistics->counts[counter] += (n); } while (0)
+#define STATS_NODE(kind) do { if (activeStatistics) activeStatistics->nodes[kind]++; } while (0)
+#define STATS_PHASE(phase) PhaseScope phaseScope(phase)
+
+#else
+
+// Each counter is still a statement, so it can be the body of an if
+#define STATS_ACTIVATE(statistics)
+#define STATS_COUNT(counter) do {} while (0)
+#define STATS_ADD(counter, n) do {} while (0)
+#define STATS_NODE(kind) do {} while (0)
+#define STATS_PHASE(phase)
+
+#endif
+
+#endif
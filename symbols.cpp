@@ -0,0 +1,78 @@
+#include "symbols.hpp"
+
+#include <algorithm>
+
+bool operator<(const Name &a, const Name &b) {
+  int order = memcmp(a.text, b.text, std::min(a.length, b.length));
+  return order < 0 || (order == 0 && a.length < b.length);
+}
+
+std::ostream &operator<<(std::ostream &out, const Name &name) {
+  return out.write(name.text, name.length);
+}
+
+std::string operator+(const std::string &a, const Name &b) {
+  return a + b.str();
+}
+
+// FNV-1a hash of the characters of a name
+unsigned int hashName(const char *text, size_t length) {
+  unsigned int hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char) text[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+SymbolInterner::SymbolInterner() : copies(16 * 1024) {
+  // Symbol 0 is the empty name. It is never stored in the slots,
+  // which use 0 to mark an empty slot.
+  Name empty = {"", 0};
+  names.push_back(empty);
+  hashes.push_back(hashName("", 0));
+  slots.resize(1024, noSymbol);
+}
+
+void SymbolInterner::grow() {
+  std::vector<Symbol> old;
+  old.swap(slots);
+  slots.resize(old.size() * 2, noSymbol);
+  size_t mask = slots.size() - 1;
+  for (size_t i = 0; i < old.size(); i++) {
+    if (old[i] == noSymbol)
+      continue;
+    size_t index = hashes[old[i]] & mask;
+    while (slots[index] != noSymbol)
+      index = (index + 1) & mask;
+    slots[index] = old[i];
+  }
+}
+
+Symbol SymbolInterner::insert(const char *text, size_t length, bool copy) {
+  if (length == 0)
+    return noSymbol;
+  unsigned int hash = hashName(text, length);
+  size_t mask = slots.size() - 1;
+  size_t index = hash & mask;
+  while (slots[index] != noSymbol) {
+    Symbol symbol = slots[index];
+    if (hashes[symbol] == hash && names[symbol].length == length &&
+        !memcmp(names[symbol].text, text, length))
+      return symbol;
+    index = (index + 1) & mask;
+  }
+  Symbol symbol = names.size();
+  if (copy) {
+    char *characters = (char *) copies.allocate(length);
+    memcpy(characters, text, length);
+    text = characters;
+  }
+  Name name = {text, length};
+  names.push_back(name);
+  hashes.push_back(hash);
+  slots[index] = symbol;
+  if (2 * names.size() > slots.size())
+    grow();
+  return symbol;
+}
@@ -0,0 +1,176 @@
+#ifndef __SYMBOLS_HPP
+#define __SYMBOLS_HPP
+
+#include "arena.hpp"
+#include "stats.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Defines a symbol, the id of an interned name. Every name in
+// the program (identifiers, class names) is interned once by the
+// lexer, so the type checker compares and hashes 32-bit ids
+// instead of strings. Symbol 0 is always the empty name and is
+// used where there is no name, such as a missing super class.
+// Each compilation has its own interner, so symbols are only
+// meaningful within the compilation they were interned in.
+typedef unsigned int Symbol;
+
+const Symbol noSymbol = 0;
+
+// Defines a view of the characters of a name. The characters
+// are not NUL terminated and are owned by someone else: the
+// interner, or the mapped source the name was scanned from.
+typedef struct name {
+  const char *text;
+  size_t length;
+
+  std::string str() const { return std::string(text, length); }
+} Name;
+
+bool operator<(const Name &a, const Name &b);
+std::ostream &operator<<(std::ostream &out, const Name &name);
+std::string operator+(const std::string &a, const Name &b);
+
+// Defines the interner, which maps each distinct name to its
+// symbol. Names are kept in an open-addressing hash table of
+// symbols, so interning a name costs one hash of its characters.
+// The characters of a new name are copied into the interner's
+// arena, unless they are interned as a view, in which case the
+// interner refers to them where they are.
+class SymbolInterner {
+private:
+  std::vector<Name> names;
+  std::vector<unsigned int> hashes;
+  std::vector<Symbol> slots;
+  Arena copies;
+
+  void grow();
+  Symbol insert(const char *text, size_t length, bool copy);
+
+public:
+  SymbolInterner();
+
+  Symbol intern(const char *text, size_t length) { return insert(text, length, true); }
+  Symbol intern(const std::string &text) { return intern(text.data(), text.size()); }
+
+  // Interns a name whose characters stay unchanged for as long
+  // as the interner lives, such as a name in a mapped source,
+  // without copying them.
+  Symbol internView(const char *text, size_t length) { return insert(text, length, false); }
+
+  Name name(Symbol symbol) const { return names[symbol]; }
+  size_t size() const { return names.size(); }
+};
+
+// Defines an open-addressing hash table keyed by symbols, used
+// for the variable, method and class tables. Slots hold the key
+// and value inline and are found with linear probing, so a lookup
+// is one multiplicative hash and usually a single probe. Entries
+// are never removed. Iteration order is the slot order; callers
+// that need the entries sorted by name (printing) sort them.
+template <typename T>
+class SymbolMap {
+public:
+  typedef std::pair<Symbol, T> Entry;
+
+  class const_iterator {
+  private:
+    const std::vector<Entry> *slots;
+    size_t index;
+
+    void skip() {
+      while (index < slots->size() && (*slots)[index].first == noSymbol)
+        index++;
+    }
+
+  public:
+    const_iterator(const std::vector<Entry> *slots, size_t index) : slots(slots), index(index) { skip(); }
+    const Entry &operator*() const { return (*slots)[index]; }
+    const Entry *operator->() const { return &(*slots)[index]; }
+    const_iterator &operator++() { index++; skip(); return *this; }
+    bool operator==(const const_iterator &other) const { return index == other.index; }
+    bool operator!=(const const_iterator &other) const { return index != other.index; }
+  };
+
+private:
+  std::vector<Entry> slots;
+  size_t used;
+
+  static size_t hash(Symbol key) { return key * 2654435761u; }
+
+  // Returns the slot of the key, or of the empty slot where
+  // it would be inserted.
+  size_t probe(Symbol key) const {
+    size_t mask = slots.size() - 1;
+    size_t index = hash(key) & mask;
+    while (slots[index].first != key && slots[index].first != noSymbol)
+      index = (index + 1) & mask;
+    return index;
+  }
+
+  void grow() {
+    std::vector<Entry> old;
+    old.swap(slots);
+    slots.resize(old.empty() ? 8 : old.size() * 2);
+    for (size_t i = 0; i < old.size(); i++)
+      if (old[i].first != noSymbol)
+        slots[probe(old[i].first)] = old[i];
+  }
+
+public:
+  SymbolMap() : used(0) {}
+
+  size_t size() const { return used; }
+
+  // Returns the value of the key, or NULL if it is not in the table.
+  T *lookup(Symbol key) {
+    STATS_COUNT(s_lookups);
+    if (used != 0) {
+      Entry &entry = slots[probe(key)];
+      if (entry.first == key)
+        return &entry.second;
+    }
+    STATS_COUNT(s_misses);
+    return NULL;
+  }
+
+  const T *lookup(Symbol key) const {
+    return const_cast<SymbolMap *>(this)->lookup(key);
+  }
+
+  size_t count(Symbol key) const {
+    return lookup(key) ? 1 : 0;
+  }
+
+  // Returns the value of a key that must be in the table.
+  T &at(Symbol key) {
+    return *lookup(key);
+  }
+
+  const T &at(Symbol key) const {
+    return *lookup(key);
+  }
+
+  // Returns the value of the key, inserting a default value if
+  // it is not in the table yet.
+  T &operator[](Symbol key) {
+    if (2 * (used + 1) > slots.size())
+      grow();
+    Entry &entry = slots[probe(key)];
+    if (entry.first == noSymbol) {
+      entry.first = key;
+      entry.second = T();
+      used++;
+    }
+    return entry.second;
+  }
+
+  const_iterator begin() const { return const_iterator(&slots, 0); }
+  const_iterator end() const { return const_iterator(&slots, slots.size()); }
+};
+
+#endif
@@ -1,70 +1,138 @@
 #include "typecheck.hpp"
+#include "pool.hpp"
+
+#include <algorithm>
+
 
 #define forall(iterator, listptr) \
   for(iterator = listptr->begin(); iterator != listptr->end(); iterator++) \
 
 
 
-// Defines the function used to throw type errors. The possible
-// type errors are defined as an enumeration in the header file.
-void typeError(TypeErrorCode code) {
+// Defines the messages for type errors. The possible type
+// errors are defined as an enumeration in the header file.
+const char *typeErrorMessage(TypeErrorCode code) {
   switch (code) {
     case undefined_variable:
-      std::cerr << "Undefined variable." << std::endl;
-      break;
+      return "Undefined variable.";
     case undefined_method:
-      std::cerr << "Method does not exist." << std::endl;
-      break;
+      return "Method does not exist.";
     case undefined_class:
-      std::cerr << "Class does not exist." << std::endl;
-      break;
+      return "Class does not exist.";
     case undefined_member:
-      std::cerr << "Class member does not exist." << std::endl;
-      break;
+      return "Class member does not exist.";
     case not_object:
-      std::cerr << "Variable is not an object." << std::endl;
-      break;
+      return "Variable is not an object.";
     case expression_type_mismatch:
-      std::cerr << "Expression types do not match." << std::endl;
-      break;
+      return "Expression types do not match.";
     case argument_number_mismatch:
-      std::cerr << "Method called with incorrect number of arguments." << std::endl;
-      break;
+      return "Method called with incorrect number of arguments.";
     case argument_type_mismatch:
-      std::cerr << "Method called with argument of incorrect type." << std::endl;
-      break;
+      return "Method called with argument of incorrect type.";
     case while_predicate_type_mismatch:
-      std::cerr << "Predicate of while loop is not boolean." << std::endl;
-      break;
+      return "Predicate of while loop is not boolean.";
     case repeat_predicate_type_mismatch:
-      std::cerr << "Predicate of repeat loop is not boolean." << std::endl;
-      break;
+      return "Predicate of repeat loop is not boolean.";
     case if_predicate_type_mismatch:
-      std::cerr << "Predicate of if statement is not boolean." << std::endl;
-      break;
+      return "Predicate of if statement is not boolean.";
     case assignment_type_mismatch:
-      std::cerr << "Left and right hand sides of assignment types mismatch." << std::endl;
-      break;
+      return "Left and right hand sides of assignment types mismatch.";
     case return_type_mismatch:
-      std::cerr << "Return statement type does not match declared return type." << std::endl;
-      break;
+      return "Return statement type does not match declared return type.";
     case constructor_returns_type:
-      std::cerr << "Class constructor returns a value." << std::endl;
-      break;
+      return "Class constructor returns a value.";
     case no_main_class:
-      std::cerr << "The \"Main\" class was not found." << std::endl;
-      break;
+      return "The \"Main\" class was not found.";
     case main_class_members_present:
-      std::cerr << "The \"Main\" class has members." << std::endl;
-      break;
+      return "The \"Main\" class has members.";
     case no_main_method:
-      std::cerr << "The \"Main\" class does not have a \"main\" method." << std::endl;
-      break;
+      return "The \"Main\" class does not have a \"main\" method.";
     case main_method_incorrect_signature:
-      std::cerr << "The \"main\" method of the \"Main\" class has an incorrect signature." << std::endl;
-      break;
+      return "The \"main\" method of the \"Main\" class has an incorrect signature.";
   }
-  exit(1);
+  return "";
+}
+
+TypeCheck::TypeCheck(SymbolInterner &symbols, Diagnostics &diagnostics) {
+  this->symbols = &symbols;
+  this->diagnostics = &diagnostics;
+  this->classTable = NULL;
+  this->library = false;
+  this->currentMethodTable = NULL;
+  this->currentVariableTable = NULL;
+  this->currentLocalOffset = 0;
+  this->currentParameterOffset = 0;
+  this->currentMemberOffset = 0;
+  this->currentClassName = noSymbol;
+  this->currentMethodName = noSymbol;
+  this->dependencies = NULL;
+  this->pool = NULL;
+  this->classOrder = NULL;
+  this->methodOrders = NULL;
+  this->currentClassOrder = 0;
+  this->currentMethodOrder = 0;
+  this->deferredBodies = NULL;
+}
+
+ClassInfo *TypeCheck::findClass(Symbol className) {
+  if (dependencies && className != currentClassName)
+    dependencies->push_back(className);
+  if (!classDeclared(className))
+    return NULL;
+  return classTable->lookup(className);
+}
+
+bool TypeCheck::classDeclared(Symbol className) {
+  if (!classOrder)
+    return true;
+  // Imported classes have no place in the order
+  const int *order = classOrder->lookup(className);
+  return !order || *order <= currentClassOrder;
+}
+
+bool TypeCheck::methodDeclared(Symbol method) {
+  if (!methodOrders)
+    return true;
+  const int *order = (*methodOrders)[currentClassOrder - 1].lookup(method);
+  return !order || *order < currentMethodOrder;
+}
+
+// Defines the function used to report type errors. Reporting
+// does not stop the type checker, the error is recorded and
+// printed with all the others once checking is finished, after the
+// class and method it is in.
+void TypeCheck::typeError(TypeErrorCode code, ASTNode *node) {
+  std::string where;
+  if (currentClassName != noSymbol)
+    where = where + symbols->name(currentClassName);
+  if (currentMethodName != noSymbol)
+    where = where + "." + symbols->name(currentMethodName);
+  diagnostics->error(typeErrorMessage(code), node, 0, where);
+}
+
+// Returns true if the node has the poison type, which means an
+// error has already been reported for it or one of its children.
+bool poisoned(ASTNode *node) {
+  return node->basetype() == bt_error;
+}
+
+// Reports a failed lookup of a name in the given class and
+// poisons the node. If the class extends an undefined class, the
+// name may well have been declared there, so the lookup failing
+// is a follow-on error and is not reported.
+void lookupError(TypeErrorCode code, ASTNode *at, ASTNode *node, Symbol className, TypeCheck *scope) {
+  if (!scope->classDeclared(className) || !scope->poisonedClasses.count(className))
+    scope->typeError(code, at);
+  node->typeId = bt_error;
+}
+
+// Checks that both operands of a binary expression have the
+// given basetype. Poisoned operands are not reported again.
+void checkOperands(ASTNode *left, ASTNode *right, BaseType expected, ASTNode *node, TypeCheck *scope) {
+  if (poisoned(left) || poisoned(right))
+    return;
+  if (left->basetype() != expected || right->basetype() != expected)
+    scope->typeError(expression_type_mismatch, node);
 }
 
 // TypeCheck Visitor Functions: These are the functions you will
@@ -72,34 +140,136 @@ void typeError(TypeErrorCode code) {
 // Not all functions must have code, many may be left empty.
 
 void TypeCheck::visitProgramNode(ProgramNode *node) {
-  classTable = new ClassTable();
-  node->visit_children(this);
+  STATS_PHASE(t_classes);
+  if (!classTable)
+    classTable = new ClassTable();
+  if (pool)
+    checkOnPool(node);
+  else
+    visitChildren(node);
+  // A class library has no Main class
+  if (!library)
+    checkMainClass(node);
+}
 
+void TypeCheck::checkMainClass(ASTNode *node) {
   const VariableTable *programVarTable = classTable->at(currentClassName).members;
   const MethodTable *programMethodTable = classTable->at(currentClassName).methods;
 
   if (!classTable->count(currentClassName)) {
-    typeError(no_main_class);
+    typeError(no_main_class, node);
     return;
   }
   if (programVarTable->size() != 0) {
-    typeError(main_class_members_present);
+    typeError(main_class_members_present, node);
     return;
   }
-  if (!programMethodTable->count("main")) {
-    typeError(no_main_method);
+  const Symbol mainMethod = symbols->intern("main");
+  if (!programMethodTable->count(mainMethod)) {
+    typeError(no_main_method, node);
     return;
   }
-  if (programMethodTable->at("main").returnType.baseType != bt_none) {
-    typeError(main_method_incorrect_signature);
+  if (baseTypeOf(programMethodTable->at(mainMethod).returnType) != bt_none) {
+    typeError(main_method_incorrect_signature, node);
     return;
   }
+}
+
+// Numbers the classes of the program, from 1, and the methods of
+// each class, from 0, in the order they are declared. Returns
+// false if a class is declared twice or has the name of an imported
+// class, or a class declares a method twice: a body checked as the
+// tree is walked sees the first of the two, which the tables no
+// longer have once every class has been declared.
+bool orderDeclarations(ProgramNode *node, TypeCheck *scope, SymbolMap<int> &classOrder,
+                       std::vector<SymbolMap<int> > &methodOrders) {
+  for (NodeList<ClassNode *>::iterator it = node->class_list->begin(); it != node->class_list->end(); ++it) {
+    Symbol className = (*it)->identifier_1->symbol;
+    if (classOrder.count(className) || scope->classTable->count(className))
+      return false;
+    methodOrders.push_back(SymbolMap<int>());
+    classOrder[className] = methodOrders.size();
+    SymbolMap<int> &methods = methodOrders.back();
+    NodeList<MethodNode *> *methodList = (*it)->method_list;
+    for (NodeList<MethodNode *>::iterator method = methodList->begin(); method != methodList->end(); ++method) {
+      Symbol name = (*method)->identifier->symbol;
+      if (methods.count(name))
+        return false;
+      int order = methods.size();
+      methods[name] = order;
+    }
+  }
+  return true;
+}
 
+void TypeCheck::checkOnPool(ProgramNode *node) {
+  SymbolMap<int> classes;
+  std::vector<SymbolMap<int> > methods;
+  if (!orderDeclarations(node, this, classes, methods)) {
+    visitChildren(node);
+    return;
+  }
 
+  // Declare everything, leaving the statements of the bodies. The
+  // errors found are kept apart until those of the bodies are in.
+  Diagnostics *reported = diagnostics;
+  Diagnostics declaring;
+  std::vector<BodyCheck> bodies;
+  diagnostics = &declaring;
+  deferredBodies = &bodies;
+  visitChildren(node);
+  deferredBodies = NULL;
+  diagnostics = reported;
+
+  // Each thread checks bodies with a checker and counts of its own
+  STATS_PHASE(t_methods);
+  std::vector<TypeCheck> checkers(pool->size(), *this);
+  std::vector<Statistics> statistics(pool->size());
+  for (size_t i = 0; i < checkers.size(); i++) {
+    checkers[i].dependencies = NULL;
+    checkers[i].classOrder = &classes;
+    checkers[i].methodOrders = &methods;
+    clear(statistics[i]);
+#ifdef LANG_STATS
+    statistics[i].timed = activeStatistics && activeStatistics->timed;
+#endif
+  }
+  {
+    // The threads charge their time to categories of their own, and
+    // this one to none while it waits for them
+    STATS_PHASE(t_phases);
+    pool->run(bodies.size(), [&](size_t body, int worker) {
+      STATS_ACTIVATE(statistics[worker]);
+      checkers[worker].checkBody(bodies[body]);
+    });
+  }
+#ifdef LANG_STATS
+  if (activeStatistics) {
+    for (size_t i = 0; i < statistics.size(); i++)
+      merge(*activeStatistics, statistics[i]);
+    activeStatistics->threads = statistics.size();
+  }
+#endif
+
+  // Report the errors in the order checking as the tree is walked
+  // finds them: each body's after those declaring found before it
+  size_t next = 0;
+  for (size_t i = 0; i < bodies.size(); i++) {
+    for (; next < bodies[i].errorsBefore; next++)
+      diagnostics->error(declaring.errors[next].message, declaring.errors[next].node, declaring.errors[next].line,
+                         declaring.errors[next].where);
+    std::vector<Diagnostic> &errors = bodies[i].diagnostics.errors;
+    for (size_t j = 0; j < errors.size(); j++)
+      diagnostics->error(errors[j].message, errors[j].node, errors[j].line, errors[j].where);
+  }
+  for (; next < declaring.errors.size(); next++)
+    diagnostics->error(declaring.errors[next].message, declaring.errors[next].node, declaring.errors[next].line,
+                         declaring.errors[next].where);
 }
 
 void createClassInScopeHelper(ClassNode *node, TypeCheck *scope) {
-  scope->currentClassName = node->identifier_1->name;
+  scope->currentClassName = node->identifier_1->symbol;
+  scope->currentMethodName = noSymbol;
   scope->currentMethodTable = new MethodTable();
   scope->currentVariableTable = new VariableTable();
   scope->currentLocalOffset = 0;
@@ -108,15 +278,175 @@ void createClassInScopeHelper(ClassNode *node, TypeCheck *scope) {
 }
 
 ClassInfo &createClassInfoScopeHelper(ClassInfo &classInfo, IdentifierNode *secondID, TypeCheck *scope) {
-  int byte_size = 4;
-  classInfo.superClassName = (secondID) ? secondID->name : "";
+  classInfo.superClassName = (secondID) ? secondID->symbol : noSymbol;
   classInfo.methods = scope->currentMethodTable;
   classInfo.members = scope->currentVariableTable;
-  classInfo.membersSize = byte_size * classInfo.members->size();
+  // The class starts out with everything it inherits; its own
+  // members and methods are added to the layouts as they are
+  // declared
+  if (secondID) {
+    const ClassInfo &superClass = *scope->findClass(secondID->symbol);
+    classInfo.membersSize = superClass.membersSize;
+    classInfo.memberLayout = new MemberLayout(*superClass.memberLayout);
+    classInfo.methodLayout = new MethodLayout(*superClass.methodLayout);
+    STATS_ADD(s_copiedSlots, superClass.memberLayout->size() + superClass.methodLayout->size());
+  } else {
+    classInfo.membersSize = 0;
+    classInfo.memberLayout = new MemberLayout();
+    classInfo.methodLayout = new MethodLayout();
+  }
   return classInfo;
 }
 
+// Adds a member of the current class to the class's layout, with
+// the size it takes in an object. Its offset is given by
+// layOutMembers, once the class's members are all declared.
+void addMemberToLayout(Symbol name, const VariableInfo &info, TypeCheck *scope) {
+  ClassInfo &classInfo = scope->classTable->at(scope->currentClassName);
+  MemberSlot slot = {
+      info,
+      scope->currentClassName
+  };
+  slot.info.offset = 0;
+  slot.info.size = memberSize(info.type);
+  (*classInfo.memberLayout)[name] = slot;
+}
+
+// Counts the uses of the members of a class in its own methods,
+// each weighted by 8 for every loop it is in (up to 4), as a guess
+// at how often the member is used when the program runs. A name a
+// method declares hides the member; the members of other objects
+// are not counted.
+struct MemberUses : public StaticVisitor<MemberUses> {
+  SymbolMap<int> uses;
+  std::set<Symbol> hidden;
+  int weight;
+
+  MemberUses() : weight(1) {}
+
+  void use(IdentifierNode *identifier) {
+    int *count = uses.lookup(identifier->symbol);
+    if (count && !hidden.count(identifier->symbol))
+      *count += weight;
+  }
+
+  void visitMethodNode(MethodNode *node) {
+    hidden.clear();
+    for (NodeList<ParameterNode *>::iterator it = node->parameter_list->begin(); it != node->parameter_list->end();
+         ++it)
+      hidden.insert((*it)->identifier->symbol);
+    NodeList<DeclarationNode *> *declarations = node->methodbody->declaration_list;
+    for (NodeList<DeclarationNode *>::iterator it = declarations->begin(); it != declarations->end(); ++it)
+      for (NodeList<IdentifierNode *>::iterator identifier = (*it)->identifier_list->begin();
+           identifier != (*it)->identifier_list->end(); ++identifier)
+        hidden.insert((*identifier)->symbol);
+    visitChildren(node->methodbody);
+  }
+  void visitAssignmentNode(AssignmentNode *node) {
+    use(node->identifier_1);
+    visit(node->expression);
+  }
+  void visitMethodCallNode(MethodCallNode *node) {
+    if (node->identifier_2)
+      use(node->identifier_1);
+    visitChildren(node);
+  }
+  void visitMemberAccessNode(MemberAccessNode *node) { use(node->identifier_1); }
+  void visitVariableNode(VariableNode *node) { use(node->identifier); }
+  void visitWhileNode(WhileNode *node) {
+    int outer = weight;
+    weight = weight < 4096 ? weight * 8 : weight;
+    visitChildren(node);
+    weight = outer;
+  }
+  void visitRepeatNode(RepeatNode *node) {
+    int outer = weight;
+    weight = weight < 4096 ? weight * 8 : weight;
+    visitChildren(node);
+    weight = outer;
+  }
+};
+
+// Orders members by their uses, the most used first.
+struct MoreUsed {
+  SymbolMap<int> *uses;
+
+  bool operator()(Symbol a, Symbol b) const { return uses->at(a) > uses->at(b); }
+};
+
+// Gives each of the names the next offset of its size, from offset
+// on, and returns the offset after the last.
+int placeMembers(MemberLayout &memberLayout, const std::vector<Symbol> &names, int offset) {
+  for (size_t i = 0; i < names.size(); i++) {
+    VariableInfo &info = memberLayout.at(names[i]).info;
+    offset = (offset + info.size - 1) / info.size * info.size;
+    info.offset = offset;
+    offset += info.size;
+  }
+  return offset;
+}
+
+// Gives the members the current class declares their places in its
+// objects, after those of the inherited members, which do not move,
+// so that an object of the class is laid out as one of its super
+// class as far as that goes. The booleans take a byte each and are
+// kept together; the other members take a word each, on a word
+// boundary. The booleans go after the words, unless putting them
+// first fills more of the bytes the inherited members leave up to a
+// word boundary. Within the two groups the members used the most
+// come first, nearest the header the whole object is reached from.
+void layOutMembers(ClassNode *node, TypeCheck *scope) {
+  ClassInfo &classInfo = scope->classTable->at(scope->currentClassName);
+  MemberUses counter;
+  std::vector<Symbol> words;
+  std::vector<Symbol> bytes;
+  NodeList<DeclarationNode *> *declarations = node->declaration_list;
+  for (NodeList<DeclarationNode *>::iterator it = declarations->begin(); it != declarations->end(); ++it)
+    for (NodeList<IdentifierNode *>::iterator identifier = (*it)->identifier_list->begin();
+         identifier != (*it)->identifier_list->end(); ++identifier) {
+      Symbol name = (*identifier)->symbol;
+      if (counter.uses.count(name))
+        continue;
+      counter.uses[name] = 0;
+      (classInfo.memberLayout->at(name).info.size == 1 ? bytes : words).push_back(name);
+    }
+  if (words.empty() && bytes.empty())
+    return;
+  for (NodeList<MethodNode *>::iterator it = node->method_list->begin(); it != node->method_list->end(); ++it)
+    counter.visitMethodNode(*it);
+  MoreUsed order = {&counter.uses};
+  std::stable_sort(words.begin(), words.end(), order);
+  std::stable_sort(bytes.begin(), bytes.end(), order);
+
+  int offset = classInfo.membersSize;
+  int padding = -offset & 3;
+  if (!words.empty() && (-(offset + (int) bytes.size()) & 3) < padding) {
+    offset = placeMembers(*classInfo.memberLayout, bytes, offset);
+    offset = placeMembers(*classInfo.memberLayout, words, offset);
+  } else {
+    offset = placeMembers(*classInfo.memberLayout, words, offset);
+    offset = placeMembers(*classInfo.memberLayout, bytes, offset);
+  }
+  classInfo.membersSize = offset;
+}
+
+// Adds a method of the current class to the class's layout. An
+// override takes over the virtual table slot of the method it
+// overrides, a new method gets the next free slot.
+void addMethodToLayout(Symbol name, const MethodInfo &info, TypeCheck *scope) {
+  MethodLayout *methodLayout = scope->classTable->at(scope->currentClassName).methodLayout;
+  MethodSlot *slot = methodLayout->lookup(name);
+  if (!slot) {
+    int next = methodLayout->size();
+    slot = &(*methodLayout)[name];
+    slot->slot = next;
+  }
+  slot->info = info;
+  slot->owner = scope->currentClassName;
+}
+
 void TypeCheck::visitClassNode(ClassNode *node) {
+  STATS_PHASE(t_classes);
 
   IdentifierNode *secondID = node->identifier_2;
 
@@ -124,104 +454,127 @@ void TypeCheck::visitClassNode(ClassNode *node) {
 
   createClassInScopeHelper(node, this);
 
-  if (secondID && !classTable->count(secondID->name)) {
-    typeError(undefined_class);
-    return;
+  if (secondID && !findClass(secondID->symbol)) {
+    typeError(undefined_class, secondID);
+    // Carry on checking the class as if it had no super class
+    poisonedClasses.insert(currentClassName);
+    secondID = NULL;
+  } else if (secondID && poisonedClasses.count(secondID->symbol)) {
+    poisonedClasses.insert(currentClassName);
   }
   createClassInfoScopeHelper(info, secondID, this);
 
   (*classTable)[currentClassName] = info;
-  node->visit_children(this);
-
+  visitChildren(node);
+  layOutMembers(node, this);
 }
 
-void returnStmntTypeError(MethodNode *node) {
-  const ReturnStatementNode *returnStatement = node->methodbody->returnstatement;
-  const BaseType nodeAST = node->type->basetype;
+void returnStmntTypeError(MethodNode *node, TypeCheck *scope) {
+  ReturnStatementNode *returnStatement = node->methodbody->returnstatement;
+  const BaseType nodeAST = node->type->basetype();
+  if (returnStatement && poisoned(returnStatement))
+    return;
   if (!returnStatement && nodeAST != bt_none) {
-    typeError(return_type_mismatch);
-  }
-  if (returnStatement && nodeAST != returnStatement->basetype && nodeAST != bt_none) {
-    typeError(return_type_mismatch);
-  }
-  if (returnStatement && nodeAST == bt_object  &&
-      node->type->objectClassName != returnStatement->objectClassName) {
-    typeError(return_type_mismatch);
-  }
-  if (nodeAST == bt_none && returnStatement) {
-    typeError(return_type_mismatch);
+    scope->typeError(return_type_mismatch, node);
+  } else if (returnStatement && nodeAST != returnStatement->basetype() && nodeAST != bt_none) {
+    scope->typeError(return_type_mismatch, returnStatement);
+  } else if (returnStatement && nodeAST == bt_object  &&
+      node->type->objectClassName() != returnStatement->objectClassName()) {
+    scope->typeError(return_type_mismatch, returnStatement);
+  } else if (nodeAST == bt_none && returnStatement) {
+    scope->typeError(return_type_mismatch, returnStatement);
   }
 }
 
 void constructorErrorTypeError(MethodNode *node, TypeCheck *scope) {
-  const std::string ID = node->identifier->name;
-  const BaseType nodeAST = node->type->basetype;
+  const Symbol ID = node->identifier->symbol;
+  const BaseType nodeAST = node->type->basetype();
   if (ID == scope->currentClassName && nodeAST != bt_none) {
-    typeError(constructor_returns_type);
+    scope->typeError(constructor_returns_type, node);
   }
 }
 
 void TypeCheck::visitMethodNode(MethodNode *node) {
+  STATS_PHASE(t_methods);
   // WRITEME: Replace with code if necessary
   MethodInfo info;
 
+  currentMethodName = node->identifier->symbol;
   currentParameterOffset = 12;
   currentLocalOffset = -4;
   currentVariableTable = new VariableTable();
   info.variables = currentVariableTable;
-  info.parameters = new std::list<CompoundType>();
-
-  node->visit_children(this);
-  const BaseType nodeAST = node->type->basetype;
-  const ReturnStatementNode *returnStatement = node->methodbody->returnstatement;
-  const std::string ID = node->identifier->name;
-  CompoundType returnType = {
-      nodeAST,
-      node->type->objectClassName
-  };
-  returnStmntTypeError(node);
-  constructorErrorTypeError(node, this);
+  info.parameters = new std::list<TypeId>();
+
+  visitChildren(node);
+  const Symbol ID = node->identifier->symbol;
+  if (deferredBodies) {
+    BodyCheck body;
+    body.method = node;
+    body.className = currentClassName;
+    body.methods = currentMethodTable;
+    body.variables = currentVariableTable;
+    body.errorsBefore = diagnostics->errors.size();
+    deferredBodies->push_back(body);
+  } else {
+    returnStmntTypeError(node, this);
+    constructorErrorTypeError(node, this);
+  }
 
-  for (std::list<ParameterNode *>::const_iterator iterator = node->parameter_list->begin();
+  for (NodeList<ParameterNode *>::const_iterator iterator = node->parameter_list->begin();
        iterator != node->parameter_list->end(); ++iterator) {
-    CompoundType paramInfo = {
-        (*iterator)->basetype,
-        (*iterator)->objectClassName = (*iterator)->type->objectClassName
-    };
-    info.parameters->push_back(paramInfo);
+    info.parameters->push_back((*iterator)->typeId);
   }
   int keysize = info.variables->size() - info.parameters->size();
   info.localsSize = 4 * keysize;
-  info.returnType = returnType;
+  info.returnType = node->type->typeId;
   (*currentMethodTable)[ID] = info;
+  addMethodToLayout(ID, info, this);
+  currentMethodName = noSymbol;
 }
 
 void TypeCheck::visitMethodBodyNode(MethodBodyNode *node) {
+  STATS_PHASE(t_methods);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
+  if (!deferredBodies) {
+    visitChildren(node);
+    return;
+  }
+  // The locals are declared as the tree is walked, so that the
+  // method's tables are complete before its body is checked
+  NodeList<DeclarationNode *> *declarations = node->declaration_list;
+  for (NodeList<DeclarationNode *>::iterator it = declarations->begin(); it != declarations->end(); ++it)
+    visitDeclarationNode(*it);
+}
+
+void TypeCheck::checkBody(BodyCheck &body) {
+  STATS_PHASE(t_methods);
+  currentClassName = body.className;
+  currentMethodName = body.method->identifier->symbol;
+  currentMethodTable = body.methods;
+  currentVariableTable = body.variables;
+  currentClassOrder = classOrder->at(body.className);
+  currentMethodOrder = (*methodOrders)[currentClassOrder - 1].at(body.method->identifier->symbol);
+  diagnostics = &body.diagnostics;
+
+  MethodBodyNode *node = body.method->methodbody;
+  for (NodeList<StatementNode *>::iterator it = node->statement_list->begin(); it != node->statement_list->end(); ++it)
+    visit(*it);
+  if (node->returnstatement)
+    visitReturnStatementNode(node->returnstatement);
+  returnStmntTypeError(body.method, this);
+  constructorErrorTypeError(body.method, this);
 }
 
 void TypeCheck::visitParameterNode(ParameterNode *node) {
+  STATS_PHASE(t_methods);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
+  visitChildren(node);
   const int byte_count = 4;
-  const std::string ID = node->identifier->name;
-  std::string nameASTnode;
-
-  if (node->basetype != bt_object)
-    nameASTnode = "";
-  if (node->basetype == bt_object)
-    nameASTnode = node->type->objectClassName;
-
-  const BaseType nodeAST = node->type->basetype;
-  node->basetype = nodeAST;
-  node->objectClassName = nameASTnode;
-  CompoundType methodBodyType = {
-      node->basetype,
-      node->basetype != bt_object ? "" : node->type->objectClassName
-  };
+  const Symbol ID = node->identifier->symbol;
+  node->typeId = node->type->typeId;
   VariableInfo info = {
-      methodBodyType,
+      node->typeId,
       currentParameterOffset,
       byte_count
   };
@@ -230,614 +583,566 @@ void TypeCheck::visitParameterNode(ParameterNode *node) {
 }
 
 void TypeCheck::visitDeclarationNode(DeclarationNode *node) {
+  STATS_PHASE(t_methods);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  node->basetype = node->type->basetype;
+  visitChildren(node);
+  node->typeId = node->type->typeId;
   int byte_count = 4;
-  bool btObj = node->basetype == bt_object;
-  if (btObj) {
-    node->objectClassName = node->type->objectClassName;
+  // Variables of an undefined class are declared with the poison
+  // type, so that their uses are not reported again
+  if (node->basetype() == bt_object && !findClass(node->objectClassName())) {
+    typeError(undefined_class, node->type);
+    node->typeId = bt_error;
   }
-  std::list<IdentifierNode *>::iterator identifier_iterator = node->identifier_list->begin();
-  std::list<IdentifierNode *>::iterator identifier_iterator_fin = node->identifier_list->end();
+  NodeList<IdentifierNode *>::iterator identifier_iterator = node->identifier_list->begin();
+  NodeList<IdentifierNode *>::iterator identifier_iterator_fin = node->identifier_list->end();
   for (identifier_iterator; identifier_iterator != identifier_iterator_fin; ++identifier_iterator) {
-
-    if (btObj && !(*classTable).count(node->type->objectClassName))
-      typeError(undefined_class);
-
-    CompoundType compoundDeclType = {
-        node->basetype,
-        (!btObj) ? "" : node->type->objectClassName
-    };
-
     VariableInfo varInfo = {
-        compoundDeclType,
+        node->typeId,
         (!currentLocalOffset) ? currentMemberOffset : currentLocalOffset,
         byte_count
     };
+    if (!currentLocalOffset)
+      addMemberToLayout((*identifier_iterator)->symbol, varInfo, this);
     currentMemberOffset = (!currentLocalOffset) ? currentMemberOffset + byte_count : currentMemberOffset;
     currentLocalOffset = (!currentLocalOffset) ? currentLocalOffset : currentLocalOffset - byte_count;
-    (*currentVariableTable)[(*identifier_iterator)->name] = varInfo;
+    (*currentVariableTable)[(*identifier_iterator)->symbol] = varInfo;
   }
 }
 
 void TypeCheck::visitReturnStatementNode(ReturnStatementNode *node) {
+  STATS_PHASE(t_statements);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  const BaseType nodeAST = node->basetype;
-  node->basetype = node->expression->basetype;
-  node->objectClassName = nodeAST != bt_object ? node->expression->objectClassName : node->objectClassName;
+  visitChildren(node);
+  node->typeId = node->expression->typeId;
 
 }
 
-void checkIfNotAnObject(bool &located, std::string &reference, std::string &myClass, AssignmentNode *node,
+// Looks a member up in the layout of a class, which has the
+// inherited members as well as the class's own. Returns NULL if
+// there is no such class or member.
+MemberSlot *findMember(Symbol className, Symbol name, TypeCheck *scope) {
+  ClassInfo *classInfo = scope->findClass(className);
+  MemberSlot *member = classInfo ? classInfo->memberLayout->lookup(name) : NULL;
+  if (member && member->owner != className)
+    STATS_COUNT(s_inheritedHits);
+  return member;
+}
+
+// Looks a method up in the layout of a class, which has the
+// inherited methods as well as the class's own. Returns NULL if
+// there is no such class or method.
+MethodSlot *findMethod(Symbol className, Symbol name, TypeCheck *scope) {
+  ClassInfo *classInfo = scope->findClass(className);
+  MethodSlot *method = classInfo ? classInfo->methodLayout->lookup(name) : NULL;
+  if (method && method->owner == scope->currentClassName && !scope->methodDeclared(name)) {
+    // Until the current class declares the method, the name is
+    // that of the method it inherits, if any
+    ClassInfo *superClass = classInfo->superClassName != noSymbol ? scope->findClass(classInfo->superClassName) : NULL;
+    method = superClass ? superClass->methodLayout->lookup(name) : NULL;
+  }
+  if (method && method->owner != className)
+    STATS_COUNT(s_inheritedHits);
+  return method;
+}
+
+void checkIfNotAnObject(bool &located, Symbol &reference, Symbol &myClass, AssignmentNode *node,
                         TypeCheck *scope) {
-  const VariableTable *programVarTable = scope->classTable->at(scope->currentClassName).members;
-  const MethodTable *programMethodTable = scope->classTable->at(scope->currentClassName).methods;
-  std::string NAME = node->identifier_1->name;
-  if ((*scope->currentVariableTable).count(NAME) && node->identifier_2 != NULL) {
-    myClass = (*scope->currentVariableTable)[NAME].type.objectClassName;
+  Symbol NAME = node->identifier_1->symbol;
+  if (node->identifier_2 == NULL)
+    return;
+  VariableInfo *local = scope->currentVariableTable->lookup(NAME);
+  if (local) {
+    myClass = classNameOf(local->type);
     located = true;
     reference = myClass;
-    if ((*scope->currentVariableTable)[NAME].type.baseType != bt_object) {
-      typeError(not_object);
+    if (baseTypeOf(local->type) == bt_error) {
+      node->typeId = bt_error;
+    } else if (baseTypeOf(local->type) != bt_object) {
+      scope->typeError(not_object, node->identifier_1);
+      node->typeId = bt_error;
     }
+    return;
   }
-  if (!(*scope->currentVariableTable).count(NAME) && node->identifier_2 != NULL) {
-    myClass = scope->currentClassName;
-    while (myClass != "" && !located) {
-      if ((*(*scope->classTable)[myClass].members).find(NAME) !=
-          (*(*scope->classTable)[myClass].members).end()) {
-        if ((*(*scope->classTable)[myClass].members)[NAME].type.baseType != bt_object)
-          typeError(not_object);
-        located = true;
-        reference = myClass;
-        break;
-      }
-      myClass = (*scope->classTable)[myClass].superClassName;
+  MemberSlot *member = findMember(scope->currentClassName, NAME, scope);
+  if (member) {
+    if (baseTypeOf(member->info.type) == bt_error) {
+      node->typeId = bt_error;
+    } else if (baseTypeOf(member->info.type) != bt_object) {
+      scope->typeError(not_object, node->identifier_1);
+      node->typeId = bt_error;
     }
+    located = true;
+    myClass = member->owner;
+    reference = myClass;
   }
 }
 
-void checkIfUndefinedVariable(bool &located, std::string &reference, std::string &myClass, AssignmentNode *node,
+void checkIfUndefinedVariable(bool &located, Symbol &reference, Symbol &myClass, AssignmentNode *node,
                               TypeCheck *scope) {
-  std::string NAME = node->identifier_1->name;
+  Symbol NAME = node->identifier_1->symbol;
   if (!(*scope->currentVariableTable).count(NAME) && node->identifier_2 == NULL) {
-    myClass = scope->currentClassName;
-    while (myClass != "" && !located) {
-      located = ((*(*scope->classTable)[myClass].members).count(NAME));
-      if (located) {
-        node->basetype = (*(*scope->classTable)[myClass].members)[NAME].type.baseType;
-        node->objectClassName = (*(*scope->classTable)[myClass].members)[NAME].type.objectClassName;
-      }
-      myClass = (*scope->classTable)[myClass].superClassName;
+    MemberSlot *member = findMember(scope->currentClassName, NAME, scope);
+    located = member != NULL;
+    if (located) {
+      node->typeId = member->info.type;
     }
     if (!located)
-      typeError(undefined_variable);
+      lookupError(undefined_variable, node->identifier_1, node, scope->currentClassName, scope);
   }
 
   if (node->identifier_2 != NULL && !located)
-    typeError(undefined_variable);
+    lookupError(undefined_variable, node->identifier_1, node, scope->currentClassName, scope);
 }
 
 void TypeCheck::visitAssignmentNode(AssignmentNode *node) {
+  STATS_PHASE(t_statements);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
+  visitChildren(node);
   bool located = false;
-  bool bufferIsA = false;
-
-  const VariableTable *programVarTable = classTable->at(currentClassName).members;
-  const MethodTable *programMethodTable = classTable->at(currentClassName).methods;
-//  const MethodTable* programMethodTable = currentMethodTable;
-//  const ClassTable::const_iterator className = (*classTable).find(programName);
-//  const std::string programName = "Main" ;
-  std::string NAME = node->identifier_1->name;
-  std::string myClass;
-  std::string reference;
-  if ((*currentVariableTable).count(NAME) && node->identifier_2 == NULL) {
-    node->basetype = (*currentVariableTable)[NAME].type.baseType;
-    node->objectClassName = (*currentVariableTable)[NAME].type.objectClassName;
+  // A tree that is checked again still has the type it was given
+  // the last time, which the checks below must not see
+  node->typeId = bt_none;
+
+  Symbol NAME = node->identifier_1->symbol;
+  Symbol myClass = noSymbol;
+  Symbol reference = noSymbol;
+  VariableInfo *local = currentVariableTable->lookup(NAME);
+  if (local && node->identifier_2 == NULL) {
+    node->typeId = local->type;
   }
   checkIfNotAnObject(located, reference, myClass, node, this);
+  if (poisoned(node))
+    return;
 
   checkIfUndefinedVariable(located, reference, myClass, node, this);
+  if (poisoned(node))
+    return;
 
-  while (node->identifier_2 != NULL && reference != "") {
-    if ((*(*classTable)[reference].members).count(node->identifier_2->name)) {
-      bufferIsA = true;
-      node->basetype = (*(*classTable)[reference].members)[node->identifier_2->name].type.baseType;
-      node->objectClassName = (*(*classTable)[reference].members)[node->identifier_2->name].type.objectClassName;
-      break;
+  if (node->identifier_2 != NULL) {
+    MemberSlot *member = findMember(reference, node->identifier_2->symbol, this);
+    if (!member) {
+      lookupError(undefined_member, node->identifier_2, node, reference, this);
+      return;
     }
-    reference = (*classTable)[reference].superClassName;
+    node->typeId = member->info.type;
   }
 
-  if (node->identifier_2 != NULL && !bufferIsA)
-    typeError(undefined_member);
-  if (node->basetype != node->expression->basetype)
-    typeError(assignment_type_mismatch);
+  if (poisoned(node) || poisoned(node->expression))
+    return;
+  if (node->basetype() != node->expression->basetype())
+    typeError(assignment_type_mismatch, node);
 
 }
 
 void TypeCheck::visitCallNode(CallNode *node) {
+  STATS_PHASE(t_statements);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  node->basetype = node->methodcall->basetype;
+  visitChildren(node);
+  node->typeId = typeId(node->methodcall->basetype());
 }
 
 void TypeCheck::visitIfElseNode(IfElseNode *node) {
+  STATS_PHASE(t_statements);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
+  visitChildren(node);
 
-  if (node->expression->basetype != bt_boolean) {
-    typeError(if_predicate_type_mismatch);
+  if (!poisoned(node->expression) && node->expression->basetype() != bt_boolean) {
+    typeError(if_predicate_type_mismatch, node->expression);
   }
 
-  node->basetype = bt_boolean;
+  node->typeId = bt_boolean;
 }
 
 void TypeCheck::visitWhileNode(WhileNode *node) {
+  STATS_PHASE(t_statements);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression->basetype != bt_boolean) {
-    typeError(while_predicate_type_mismatch);
+  visitChildren(node);
+  if (!poisoned(node->expression) && node->expression->basetype() != bt_boolean) {
+    typeError(while_predicate_type_mismatch, node->expression);
   }
 
-  node->basetype = bt_boolean;
+  node->typeId = bt_boolean;
 }
 
 void TypeCheck::visitRepeatNode(RepeatNode *node) {
+  STATS_PHASE(t_statements);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression->basetype != bt_boolean) {
-    typeError(repeat_predicate_type_mismatch);
+  visitChildren(node);
+  if (!poisoned(node->expression) && node->expression->basetype() != bt_boolean) {
+    typeError(repeat_predicate_type_mismatch, node->expression);
   }
 
 }
 
 void TypeCheck::visitPrintNode(PrintNode *node) {
+  STATS_PHASE(t_statements);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  node->basetype = node->expression->basetype;
-  node->objectClassName = node->expression->objectClassName;
+  visitChildren(node);
+  node->typeId = node->expression->typeId;
 }
 
 void TypeCheck::visitPlusNode(PlusNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression_1->basetype != bt_integer || node->expression_2->basetype != bt_integer)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_integer;
+  visitChildren(node);
+  checkOperands(node->expression_1, node->expression_2, bt_integer, node, this);
+  node->typeId = bt_integer;
 
 }
 
 void TypeCheck::visitMinusNode(MinusNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression_1->basetype != bt_integer || node->expression_2->basetype != bt_integer)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_integer;
+  visitChildren(node);
+  checkOperands(node->expression_1, node->expression_2, bt_integer, node, this);
+  node->typeId = bt_integer;
 }
 
 void TypeCheck::visitTimesNode(TimesNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression_1->basetype != bt_integer || node->expression_2->basetype != bt_integer)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_integer;
+  visitChildren(node);
+  checkOperands(node->expression_1, node->expression_2, bt_integer, node, this);
+  node->typeId = bt_integer;
 }
 
 void TypeCheck::visitDivideNode(DivideNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression_1->basetype != bt_integer || node->expression_2->basetype != bt_integer)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_integer;
+  visitChildren(node);
+  checkOperands(node->expression_1, node->expression_2, bt_integer, node, this);
+  node->typeId = bt_integer;
 }
 
 void TypeCheck::visitLessNode(LessNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression_1->basetype != bt_integer || node->expression_2->basetype != bt_integer)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_boolean;
+  visitChildren(node);
+  checkOperands(node->expression_1, node->expression_2, bt_integer, node, this);
+  node->typeId = bt_boolean;
 }
 
 void TypeCheck::visitLessEqualNode(LessEqualNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression_1->basetype != bt_integer || node->expression_2->basetype != bt_integer)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_boolean;
+  visitChildren(node);
+  checkOperands(node->expression_1, node->expression_2, bt_integer, node, this);
+  node->typeId = bt_boolean;
 }
 
 void TypeCheck::visitEqualNode(EqualNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression_1->basetype != bt_integer || node->expression_2->basetype != bt_integer)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_boolean;
+  visitChildren(node);
+  checkOperands(node->expression_1, node->expression_2, bt_integer, node, this);
+  node->typeId = bt_boolean;
 }
 
 void TypeCheck::visitAndNode(AndNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression_1->basetype != bt_boolean || node->expression_2->basetype != bt_boolean)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_boolean;
+  visitChildren(node);
+  checkOperands(node->expression_1, node->expression_2, bt_boolean, node, this);
+  node->typeId = bt_boolean;
 }
 
 void TypeCheck::visitOrNode(OrNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression_1->basetype != bt_boolean || node->expression_2->basetype != bt_boolean)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_boolean;
+  visitChildren(node);
+  checkOperands(node->expression_1, node->expression_2, bt_boolean, node, this);
+  node->typeId = bt_boolean;
 }
 
 void TypeCheck::visitNotNode(NotNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression->basetype != bt_boolean)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_boolean;
+  visitChildren(node);
+  if (!poisoned(node->expression) && node->expression->basetype() != bt_boolean)
+    typeError(expression_type_mismatch, node);
+  node->typeId = bt_boolean;
 }
 
 void TypeCheck::visitNegationNode(NegationNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  if (node->expression->basetype != bt_integer)
-    typeError(expression_type_mismatch);
-  node->basetype = bt_integer;
+  visitChildren(node);
+  if (!poisoned(node->expression) && node->expression->basetype() != bt_integer)
+    typeError(expression_type_mismatch, node);
+  node->typeId = bt_integer;
 }
 
-void checkForArgumentMismatch1(MethodCallNode *node, TypeCheck *scope) {
-  node->basetype = (*scope->currentMethodTable)[node->identifier_1->name].returnType.baseType;
-  node->objectClassName = (*scope->currentMethodTable)[node->identifier_1->name].returnType.objectClassName;
-
-  if ((*(*scope->currentMethodTable)[node->identifier_1->name].parameters).size() != node->expression_list->size()) {
-    typeError(argument_number_mismatch);
+// Checks the arguments of a call against the parameter types of
+// the method being called. Poisoned arguments are not reported
+// again.
+void checkArguments(std::list<TypeId> *parameters, MethodCallNode *node, TypeCheck *scope) {
+  if (parameters->size() != node->expression_list->size()) {
+    scope->typeError(argument_number_mismatch, node);
+    return;
   }
-  std::list<CompoundType>::iterator temp = (*scope->currentMethodTable)[node->identifier_1->name].parameters->begin();
-  for (std::list<ExpressionNode *>::iterator expression = node->expression_list->begin();
+  std::list<TypeId>::iterator temp = parameters->begin();
+  for (NodeList<ExpressionNode *>::iterator expression = node->expression_list->begin();
        expression != node->expression_list->end(); ++temp, ++expression)
-    if ((*temp).baseType != (*expression)->basetype)
-      typeError(argument_type_mismatch);
+    if (!poisoned(*expression) && baseTypeOf(*temp) != (*expression)->basetype())
+      scope->typeError(argument_type_mismatch, *expression);
 }
 
-void checkForArgumentMismatch2(std::string &reference, MethodCallNode *node, TypeCheck *scope) {
-  if ((*(*(*scope->classTable)[reference].methods)[node->identifier_1->name].parameters).size() !=
-      node->expression_list->size())
-    typeError(argument_number_mismatch);
-  std::list<CompoundType>::iterator temp = (*(*scope->classTable)[reference].methods)[node->identifier_1->name].parameters->begin();
-  for (std::list<ExpressionNode *>::iterator expression = node->expression_list->begin();
-       expression != node->expression_list->end(); ++temp, ++expression)
-    if ((*temp).baseType != (*expression)->basetype)
-      typeError(argument_type_mismatch);
+void checkForArgumentMismatch1(MethodCallNode *node, TypeCheck *scope) {
+  MethodInfo &method = scope->currentMethodTable->at(node->identifier_1->symbol);
+  node->typeId = method.returnType;
+
+  checkArguments(method.parameters, node, scope);
 }
 
 
-void mutateAndCheckForNotAnObjectInMethodCall(bool& isLocated, std::string &reference, std::string &myClass, MethodCallNode *node, TypeCheck *scope) {
-  if ((*scope->currentVariableTable).count(node->identifier_1->name) && node->identifier_2) {
-    myClass = (*scope->currentVariableTable)[node->identifier_1->name].type.objectClassName;
+void mutateAndCheckForNotAnObjectInMethodCall(bool& isLocated, Symbol &reference, Symbol &myClass, MethodCallNode *node, TypeCheck *scope) {
+  VariableInfo *local = scope->currentVariableTable->lookup(node->identifier_1->symbol);
+  if (local) {
+    myClass = classNameOf(local->type);
     isLocated = true;
     reference = myClass;
+    return;
   }
-  if (!(*scope->currentVariableTable).count(node->identifier_1->name) && node->identifier_2) {
-    while (myClass != "" && !isLocated) {
-      if ((*(*scope->classTable)[myClass].members).count(node->identifier_1->name)) {
-        if ((*(*scope->classTable)[myClass].members)[node->identifier_1->name].type.baseType != bt_object)
-          typeError(not_object);
-        isLocated = true;
-        reference = (*(*scope->classTable)[myClass].members)[node->identifier_1->name].type.objectClassName;
-        break;
-      }
-      myClass = (*scope->classTable)[myClass].superClassName;
+  MemberSlot *member = findMember(myClass, node->identifier_1->symbol, scope);
+  if (member) {
+    if (baseTypeOf(member->info.type) == bt_error) {
+      node->typeId = bt_error;
+    } else if (baseTypeOf(member->info.type) != bt_object) {
+      scope->typeError(not_object, node->identifier_1);
+      node->typeId = bt_error;
     }
+    isLocated = true;
+    reference = classNameOf(member->info.type);
   }
 }
 
-void grabMyMethods(bool& bufferisA, std::string &reference, MethodCallNode *node, TypeCheck *scope) {
-  while (reference != "" && node->identifier_2) {
-    if ((*(*scope->classTable)[reference].methods).count(node->identifier_2->name)) {
-      node->basetype = (*(*scope->classTable)[reference].methods)[node->identifier_2->name].returnType.baseType;
-      node->objectClassName = (*(*scope->classTable)[reference].methods)[node->identifier_2->name].returnType.objectClassName;
-      bufferisA = true;
-      break;
-    }
-    reference = (*scope->classTable)[reference].superClassName;
+// Looks up the method called on an object of the reference class
+// and sets the type of the call to its return type. On return,
+// reference is the class that defines the method.
+void grabMyMethods(bool& bufferisA, Symbol &reference, MethodCallNode *node, TypeCheck *scope) {
+  MethodSlot *method = findMethod(reference, node->identifier_2->symbol, scope);
+  if (!method) {
+    lookupError(undefined_method, node, node, reference, scope);
+    return;
   }
-  if (!bufferisA)
-    typeError(undefined_method);
+  node->typeId = method->info.returnType;
+  reference = method->owner;
+  bufferisA = true;
 }
 
 void TypeCheck::visitMethodCallNode(MethodCallNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
+  visitChildren(node);
   bool isLocated = false;
   bool bufferisA = false;
-  const VariableTable *programVarTable = classTable->at(currentClassName).members;
-  const MethodTable *programMethodTable = classTable->at(currentClassName).methods;
-//  const MethodTable* programMethodTable = currentMethodTable;
-//  const ClassTable::const_iterator className = (*classTable).find(programName);
-//  const std::string programName = "Main" ;
-  std::string NAME = node->identifier_1->name;
-  std::string myClass = currentClassName;
-  std::string reference;
-
+  Symbol myClass = currentClassName;
+  Symbol reference = noSymbol;
+  node->typeId = bt_none;
 
-  if (node->identifier_2 && (*currentVariableTable).count(node->identifier_1->name) &&
-      (*currentVariableTable)[node->identifier_1->name].type.baseType != bt_object) {
-    typeError(not_object);
-  }
   if (node->identifier_2) {
+    VariableInfo *local = currentVariableTable->lookup(node->identifier_1->symbol);
+    if (local && baseTypeOf(local->type) != bt_object) {
+      if (baseTypeOf(local->type) != bt_error)
+        typeError(not_object, node->identifier_1);
+      node->typeId = bt_error;
+      return;
+    }
     mutateAndCheckForNotAnObjectInMethodCall(isLocated, reference, myClass, node, this);
+    if (poisoned(node))
+      return;
+    if (!isLocated) {
+      lookupError(undefined_method, node, node, currentClassName, this);
+      return;
+    }
 
     grabMyMethods(bufferisA, reference, node, this);
-    if ((*(*(*classTable)[reference].methods)[node->identifier_2->name].parameters).size() !=
-        node->expression_list->size())
-      typeError(argument_number_mismatch);
-    std::list<CompoundType>::iterator temp = (*(*classTable)[reference].methods)[node->identifier_2->name].parameters->begin();
-    for (std::list<ExpressionNode *>::iterator expression = node->expression_list->begin();
-         expression != node->expression_list->end(); ++temp, ++expression)
-      if ((*temp).baseType != (*expression)->basetype)
-        typeError(argument_type_mismatch);
+    if (!bufferisA)
+      return;
+    checkArguments(findClass(reference)->methods->at(node->identifier_2->symbol).parameters, node, this);
   } else {
-    if ((*currentMethodTable).find(node->identifier_1->name) != (*currentMethodTable).end()) {
+    // A call without an object only sees the methods of the
+    // current class declared before the calling method
+    if ((*currentMethodTable).count(node->identifier_1->symbol) && methodDeclared(node->identifier_1->symbol)) {
       checkForArgumentMismatch1(node, this);
-
     } else {
-      isLocated = false;
-      myClass = currentClassName;
-      grabMyMethods(bufferisA, myClass, node, this);
-      checkForArgumentMismatch2(reference, node, this);
-
+      lookupError(undefined_method, node, node, currentClassName, this);
     }
   }
 }
 
-void isMemberNodeNotAnObject(bool &isLocated, std::string &reference, std::string &myClass, MemberAccessNode *node,
+void isMemberNodeNotAnObject(bool &isLocated, Symbol &reference, Symbol &myClass, MemberAccessNode *node,
                              TypeCheck *scope) {
-  VariableTable *varTable;
-  if (!(*scope->currentVariableTable).count(node->identifier_1->name)) {
-
-    while (myClass != "") {
-      varTable = scope->classTable->at(myClass).members;
-      if ((varTable)->find(node->identifier_1->name) !=
-          varTable->end()) {
-        if ((*(*scope->classTable)[myClass].members)[node->identifier_1->name].type.baseType != bt_object) {
-          typeError(not_object);
-        }
-        isLocated = true;
-        reference = (*(*scope->classTable)[myClass].members)[node->identifier_1->name].type.objectClassName;
-        break;
+  VariableInfo *local = scope->currentVariableTable->lookup(node->identifier_1->symbol);
+  if (!local) {
+    MemberSlot *member = findMember(myClass, node->identifier_1->symbol, scope);
+    if (member) {
+      if (baseTypeOf(member->info.type) == bt_error) {
+        node->typeId = bt_error;
+      } else if (baseTypeOf(member->info.type) != bt_object) {
+        scope->typeError(not_object, node->identifier_1);
+        node->typeId = bt_error;
       }
-      myClass = (*scope->classTable)[myClass].superClassName;
+      isLocated = true;
+      reference = classNameOf(member->info.type);
     }
 
   } else {
-    myClass = (*scope->currentVariableTable)[node->identifier_1->name].type.objectClassName;
+    myClass = classNameOf(local->type);
     isLocated = true;
     reference = myClass;
-    if ((*scope->currentVariableTable)[node->identifier_1->name].type.baseType != bt_object) {
-      typeError(not_object);
+    if (baseTypeOf(local->type) == bt_error) {
+      node->typeId = bt_error;
+    } else if (baseTypeOf(local->type) != bt_object) {
+      scope->typeError(not_object, node->identifier_1);
+      node->typeId = bt_error;
     }
   }
 }
 
-void mutateAndCheckForUndefinedMember(bool &isBufferA, std::string &reference, std::string &myClass, MemberAccessNode *node,
+void mutateAndCheckForUndefinedMember(bool &isBufferA, Symbol &reference, Symbol &myClass, MemberAccessNode *node,
                                       TypeCheck *scope) {
   IdentifierNode *secondID = node->identifier_2;
 
-  while (reference != "") {
-    if ((*(*scope->classTable)[reference].members).find(secondID->name) != (*(*scope->classTable)[reference].members).end()) {
-      node->basetype = (*(*scope->classTable)[reference].members)[secondID->name].type.baseType;
-      node->objectClassName = (*(*scope->classTable)[reference].members)[secondID->name].type.objectClassName;
-      isBufferA = true;
-      break;
-    }
-    reference = (*scope->classTable)[reference].superClassName;
+  MemberSlot *member = findMember(reference, secondID->symbol, scope);
+  if (member) {
+    node->typeId = member->info.type;
+    isBufferA = true;
   }
   if (!isBufferA)
-    typeError(undefined_member);
+    lookupError(undefined_member, secondID, node, reference, scope);
 
 }
 
 void TypeCheck::visitMemberAccessNode(MemberAccessNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  std::string myClass = currentClassName;
-  std::string reference;
+  visitChildren(node);
+  Symbol myClass = currentClassName;
+  Symbol reference = noSymbol;
   bool isLocated = false;
   bool isBufferA = false;
-  std::string NAME = node->identifier_1->name;
-  VariableTable *varTable;
+  node->typeId = bt_none;
 
   isMemberNodeNotAnObject(isLocated, reference, myClass, node, this);
+  if (poisoned(node))
+    return;
 
-  if (!isLocated)
-    typeError(undefined_variable);
+  if (!isLocated) {
+    lookupError(undefined_variable, node->identifier_1, node, currentClassName, this);
+    return;
+  }
 
   mutateAndCheckForUndefinedMember(isBufferA, reference, myClass, node, this);
 }
 
-void mutateAndTypeCheckVariableNode(bool &isLocated, std::string &myClass, VariableNode *node, TypeCheck *scope) {
-  std::string NAME = node->identifier->name;
+void mutateAndTypeCheckVariableNode(bool &isLocated, Symbol &myClass, VariableNode *node, TypeCheck *scope) {
+  Symbol NAME = node->identifier->symbol;
 
   if (!(*scope->currentVariableTable).count(NAME)) {
-    while ((myClass != "")) {
-      if ((*(*scope->classTable)[myClass].members).count(NAME) && node->basetype == bt_object)
-        node->objectClassName = (*(*scope->classTable)[myClass].members)[NAME].type.objectClassName;
-      if ((*(*scope->classTable)[myClass].members).count(NAME) && node->basetype != bt_object) {
-        node->basetype = (*(*scope->classTable)[myClass].members)[NAME].type.baseType;
-        isLocated = true;
-        break;
-      }
-      myClass = (*scope->classTable)[myClass].superClassName;
+    MemberSlot *member = findMember(myClass, NAME, scope);
+    if (member) {
+      node->typeId = typeId(baseTypeOf(member->info.type));
+      isLocated = true;
     }
   }
   if (!(*scope->currentVariableTable).count(NAME) && !isLocated)
-    typeError(undefined_variable);
+    lookupError(undefined_variable, node, node, scope->currentClassName, scope);
 }
 
 void TypeCheck::visitVariableNode(VariableNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
+  visitChildren(node);
   bool isLocated = false;
-  std::string myClass = currentClassName;
-  std::string NAME = node->identifier->name;
+  Symbol myClass = currentClassName;
+  Symbol NAME = node->identifier->symbol;
 
   mutateAndTypeCheckVariableNode(isLocated, myClass, node, this);
 
-  if ((*currentVariableTable).count(NAME))
-    node->basetype = (*currentVariableTable)[NAME].type.baseType;
-  if ((*currentVariableTable).count(NAME) && node->basetype == bt_object)
-    node->objectClassName = (*currentVariableTable)[NAME].type.objectClassName;
+  VariableInfo *local = currentVariableTable->lookup(NAME);
+  if (local)
+    node->typeId = local->type;
 }
 
 void TypeCheck::visitIntegerLiteralNode(IntegerLiteralNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->basetype = bt_integer;
-  node->visit_children(this);
+  node->typeId = bt_integer;
+  visitChildren(node);
 }
 
 void TypeCheck::visitBooleanLiteralNode(BooleanLiteralNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->basetype = bt_boolean;
-  node->visit_children(this);
+  node->typeId = bt_boolean;
+  visitChildren(node);
 }
 
 void TypeCheck::visitNewNode(NewNode *node) {
+  STATS_PHASE(t_expressions);
   // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-  std::string NAME = node->identifier->name;
-  if ((*classTable).find(NAME) == (*classTable).end())
-    typeError(undefined_class);
-  node->basetype = bt_object;
-  node->objectClassName = NAME;
+  visitChildren(node);
+  Symbol NAME = node->identifier->symbol;
+  if (!findClass(NAME)) {
+    typeError(undefined_class, node->identifier);
+    node->typeId = bt_error;
+    return;
+  }
+  node->typeId = typeId(bt_object, NAME);
 }
 
 void TypeCheck::visitIntegerTypeNode(IntegerTypeNode *node) {
   // WRITEME: Replace with code if necessary
-  node->basetype = bt_integer;
-  node->visit_children(this);
+  node->typeId = bt_integer;
+  visitChildren(node);
 }
 
 void TypeCheck::visitBooleanTypeNode(BooleanTypeNode *node) {
   // WRITEME: Replace with code if necessary
-  node->basetype = bt_boolean;
-  node->visit_children(this);
+  node->typeId = bt_boolean;
+  visitChildren(node);
 }
 
 void TypeCheck::visitObjectTypeNode(ObjectTypeNode *node) {
   // WRITEME: Replace with code if necessary
-  std::string NAME = node->identifier->name;
-  node->basetype = bt_object;
-  node->objectClassName = NAME;
-  node->visit_children(this);
+  Symbol NAME = node->identifier->symbol;
+  node->typeId = typeId(bt_object, NAME);
+  visitChildren(node);
 }
 
 void TypeCheck::visitNoneNode(NoneNode *node) {
   // WRITEME: Replace with code if necessary
-  node->basetype = bt_none;
-  node->visit_children(this);
-}
-
-void TypeCheck::visitIdentifierNode(IdentifierNode *node) {
-  // WRITEME: Replace with code if necessary
-  node->visit_children(this);
-
+  node->typeId = bt_none;
+  visitChildren(node);
 }
 
 void TypeCheck::visitIntegerNode(IntegerNode *node) {
   // WRITEME: Replace with code if necessary
-  node->basetype = bt_integer;
-  node->visit_children(this);
-}
-
-
-// The following functions are used to print the Symbol Table.
-// They do not need to be modified at all.
-
-std::string genIndent(int indent) {
-  std::string string = std::string("");
-  for (int i = 0; i < indent; i++)
-    string += std::string(" ");
-  return string;
-}
-
-std::string string(CompoundType type) {
-  switch (type.baseType) {
-    case bt_integer:
-      return std::string("Integer");
-    case bt_boolean:
-      return std::string("Boolean");
-    case bt_none:
-      return std::string("None");
-    case bt_object:
-      return std::string("Object(") + type.objectClassName + std::string(")");
-    default:
-      return std::string("");
-  }
+  node->typeId = bt_integer;
+  visitChildren(node);
 }
 
 
-void print(VariableTable variableTable, int indent) {
-  std::cout << genIndent(indent) << "VariableTable {";
-  if (variableTable.size() == 0) {
-    std::cout << "}";
-    return;
+void destroy(const ClassInfo &info) {
+  // Inherited methods in the layout share the tables of the
+  // super class's methods, so those are only freed from the
+  // method table of the class that declares them.
+  for (MethodTable::const_iterator method = info.methods->begin(); method != info.methods->end(); ++method) {
+    delete method->second.variables;
+    delete method->second.parameters;
   }
-  std::cout << std::endl;
-  for (VariableTable::iterator it = variableTable.begin(); it != variableTable.end(); it++) {
-    std::cout << genIndent(indent + 2) << it->first << " -> {" << string(it->second.type);
-    std::cout << ", " << it->second.offset << ", " << it->second.size << "}";
-    if (it != --variableTable.end())
-      std::cout << ",";
-    std::cout << std::endl;
-  }
-  std::cout << genIndent(indent) << "}";
+  delete info.methods;
+  delete info.members;
+  delete info.memberLayout;
+  delete info.methodLayout;
 }
 
-void print(MethodTable methodTable, int indent) {
-  std::cout << genIndent(indent) << "MethodTable {";
-  if (methodTable.size() == 0) {
-    std::cout << "}";
+void destroy(ClassTable *classTable) {
+  if (!classTable)
     return;
-  }
-  std::cout << std::endl;
-  for (MethodTable::iterator it = methodTable.begin(); it != methodTable.end(); it++) {
-    std::cout << genIndent(indent + 2) << it->first << " -> {" << std::endl;
-    std::cout << genIndent(indent + 4) << string(it->second.returnType) << "," << std::endl;
-    std::cout << genIndent(indent + 4) << it->second.localsSize << "," << std::endl;
-    print(*it->second.variables, indent + 4);
-    std::cout << std::endl;
-    std::cout << genIndent(indent + 2) << "}";
-    if (it != --methodTable.end())
-      std::cout << ",";
-    std::cout << std::endl;
-  }
-  std::cout << genIndent(indent) << "}";
-}
-
-void print(ClassTable classTable, int indent) {
-  std::cout << genIndent(indent) << "ClassTable {" << std::endl;
-  for (ClassTable::iterator it = classTable.begin(); it != classTable.end(); it++) {
-    std::cout << genIndent(indent + 2) << it->first << " -> {" << std::endl;
-    if (it->second.superClassName != "")
-      std::cout << genIndent(indent + 4) << it->second.superClassName << "," << std::endl;
-    print(*it->second.members, indent + 4);
-    std::cout << "," << std::endl;
-    print(*it->second.methods, indent + 4);
-    std::cout << std::endl;
-    std::cout << genIndent(indent + 2) << "}";
-    if (it != --classTable.end())
-      std::cout << ",";
-    std::cout << std::endl;
-  }
-  std::cout << genIndent(indent) << "}" << std::endl;
-}
-
-void print(ClassTable classTable) {
-  print(classTable, 0);
+  for (ClassTable::const_iterator it = classTable->begin(); it != classTable->end(); ++it)
+    destroy(it->second);
+  delete classTable;
 }
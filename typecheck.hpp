@@ -2,31 +2,38 @@
 #define __TYPECHECK_HPP
 
 #include "ast.hpp"
+#include "diagnostics.hpp"
+#include "symbols.hpp"
 
 #include <cstdlib>
 #include <iostream>
-#include <map>
-
-// Defines a compound type, which is a basetype as well as a
-// string representing the class name of an object type.
-typedef struct compoundtype {
-  BaseType baseType;
-  std::string objectClassName;
-} CompoundType;
+#include <list>
+#include <set>
+#include <vector>
 
 // Defines the information for a variable. This will be the
 // data in the variable table (each variable will map to one
-// of these). Includes the type, the offset, and the size
-// (always 4 bytes or 1 word in our language).
+// of these). Includes the type (a type id, which holds the
+// basetype and the class name of an object type), the offset,
+// and the size (4 bytes or 1 word for every variable, and for a
+// member as the class declares it; where a member is in an object
+// is given by the member layout).
 typedef struct variableinfo {
-  CompoundType type;
+  TypeId type;
   int offset;
   int size;
 } VariableInfo;
 
-// Defines a variable table. Maps from a string (variable
+// Returns the bytes a member of a type takes in an object, which
+// are also what its offset is a multiple of: 1 for a boolean, and
+// 4 for an integer or an object reference.
+inline int memberSize(TypeId type) {
+  return baseTypeOf(type) == bt_boolean ? 1 : 4;
+}
+
+// Defines a variable table. Maps from a symbol (variable
 // name) to a variable info.
-typedef std::map<std::string, VariableInfo> VariableTable;
+typedef SymbolMap<VariableInfo> VariableTable;
 
 // Defines the information for a method. This will be the
 // data in the method table (each method will map to one
@@ -36,36 +43,76 @@ typedef std::map<std::string, VariableInfo> VariableTable;
 // the local variables (used when allocating space in the
 // stack frame).
 typedef struct methodinfo {
-  CompoundType returnType;
+  TypeId returnType;
   VariableTable *variables;
-  std::list<CompoundType> *parameters;
+  std::list<TypeId> *parameters;
   int localsSize;
 } MethodInfo;
 
-// Defines a method table. Maps from a string (method name)
+// Defines a method table. Maps from a symbol (method name)
 // to a method info.
-typedef std::map<std::string, MethodInfo> MethodTable;
+typedef SymbolMap<MethodInfo> MethodTable;
+
+// Defines an entry of a member layout: the variable info of
+// a member, with its offset from the start of the object
+// rather than from the start of its own class's members and its
+// size there, and the class that declares it.
+typedef struct memberslot {
+  VariableInfo info;
+  Symbol owner;
+} MemberSlot;
+
+// Defines a member layout. Maps from a symbol (member name)
+// to every member an object of the class has, own and
+// inherited. A member redeclared in a subclass hides the
+// inherited one by name, but both keep their offsets.
+typedef SymbolMap<MemberSlot> MemberLayout;
+
+// Defines an entry of a method layout: the method info of the
+// method an object of the class runs for a name, the class
+// that defines it, and its slot in the class's virtual table.
+// An override keeps the slot of the method it overrides.
+typedef struct methodslot {
+  MethodInfo info;
+  Symbol owner;
+  int slot;
+} MethodSlot;
+
+// Defines a method layout. Maps from a symbol (method name)
+// to every method of the class, own and inherited.
+typedef SymbolMap<MethodSlot> MethodLayout;
 
 // Defines the information for a class. This will be the
 // data in the class table (each class will map to one
-// of these). Includes the super class name (empty string
-// if no super class), the method table, the member table
-// (which is a variable table), and the size of the members
-// (which is used when allocating on the heap).
+// of these). Includes the super class name (noSymbol if
+// no super class), the method table, the member table
+// (which is a variable table), and the bytes of the members
+// including inherited ones (which is used when allocating
+// on the heap). The member and method layouts are the
+// flattened view of the class: they start as copies of the
+// super class's layouts and are extended as the class's own
+// members and methods are declared, so that looking up a name
+// in a class is a single probe instead of a walk up the chain
+// of super classes. The class's own members are given their
+// offsets once they are all declared, packed after the inherited
+// ones, which keep theirs.
 typedef struct classinfo {
-  std::string superClassName;
+  Symbol superClassName;
   MethodTable *methods;
   VariableTable *members;
   int membersSize;
+  MemberLayout *memberLayout;
+  MethodLayout *methodLayout;
 } ClassInfo;
 
-// Defines a class table. Maps from a string (class name)
+// Defines a class table. Maps from a symbol (class name)
 // to a class info.
-typedef std::map<std::string, ClassInfo> ClassTable;
+typedef SymbolMap<ClassInfo> ClassTable;
 
-// This function will print the symbol table. The functions are
-// at the bottom of this file, and do not need modification.
-void print(ClassTable classTable);
+// Frees a class table built by the type checker, or the tables
+// of one class, along with every table they own.
+void destroy(ClassTable *classTable);
+void destroy(const ClassInfo &info);
 
 // Defines all the possible type errors that can be thrown
 // by the type checker. These are used to print strings out
@@ -91,24 +138,53 @@ typedef enum {
   main_method_incorrect_signature
 } TypeErrorCode;
 
-// Declares a a function which will display type errors, then
-// terminate the program with an error status code. The
-// possible type errors are defined as an enumeration above.
-void typeError(TypeErrorCode code);
+// Returns the message printed for a type error.
+const char *typeErrorMessage(TypeErrorCode code);
+
+class WorkPool;
+
+// Defines a method body whose statements are checked once every
+// class has been declared rather than as the tree is walked: the
+// method, the class it is in with the tables the body is checked
+// against, and the errors checking it found. Declaring the classes
+// had found errorsBefore errors by the time it reached the body.
+typedef struct bodycheck {
+  MethodNode *method;
+  Symbol className;
+  MethodTable *methods;
+  VariableTable *variables;
+  size_t errorsBefore;
+  Diagnostics diagnostics;
+} BodyCheck;
 
 // This defines the TypeCheck visitor, which will visit the AST
 // and construct the symbol table. You will do all your
 // implementation of the symbol table construction in the
 // visitor functions for this visitor.
-class TypeCheck : public Visitor {
+class TypeCheck : public StaticVisitor<TypeCheck> {
 public:
+  // The compilation the visitor checks: the interner the names
+  // of the program were interned in, and the diagnostics type
+  // errors are reported to. The visitor keeps no other state
+  // outside itself, so compilations can be checked at once.
+  SymbolInterner* symbols;
+  Diagnostics* diagnostics;
+
   // This member represents the main class table. You can
   // think of this as the "root" of the symbol table.
   //
   // NOTE: You will need to construct a new ClassTable
   // and set this pointer at the beginning of the TypeCheck
   // visitor pass over the AST.
+  //
+  // If it is set before the pass, it already holds the classes
+  // imported from class libraries, and the program's classes
+  // are added to them.
   ClassTable* classTable;
+
+  // Set to check a class library, which is a program without a
+  // Main class.
+  bool library;
   
   // These members allow you to keep track of the current
   // method table and and current variable table. This allows
@@ -145,56 +221,116 @@ public:
 
   // This member allows you to keep track of the name of the
   // current class. This is necessary for type checking.
-  std::string currentClassName;
+  Symbol currentClassName;
+  // The method being checked, or noSymbol outside methods, which
+  // errors are reported in along with the class.
+  Symbol currentMethodName;
+
+  // The classes that extend an undefined class, directly or
+  // through their super classes. Failed lookups in these classes
+  // are follow-on errors of the undefined class and are not
+  // reported again.
+  std::set<Symbol> poisonedClasses;
+
+  // If set, every class other than the current one that is looked
+  // up is added to it, so that the compile server can tell which
+  // classes the check of a class depends on. The poisoned classes
+  // are only asked about classes that have been looked up.
+  std::vector<Symbol>* dependencies;
+
+  // If set, the statements of method bodies are checked on these
+  // threads once every class, member and method has been declared;
+  // the declarations are still made as the tree is walked. Errors
+  // are reported in the same order as when checking as the tree is
+  // walked, and the result is the same.
+  WorkPool* pool;
+
+  // While the statements of a body are checked on the pool, the
+  // order the classes of the program and the methods of the
+  // current class were declared in. Whatever was declared after
+  // the current method is hidden from it, as it would be had the
+  // body been checked as the tree was walked.
+  const SymbolMap<int>* classOrder;
+  const std::vector<SymbolMap<int> >* methodOrders;
+  int currentClassOrder;
+  int currentMethodOrder;
+
+  // The bodies left to check on the pool, while the classes are
+  // being declared
+  std::vector<BodyCheck>* deferredBodies;
+
+  TypeCheck(SymbolInterner& symbols, Diagnostics& diagnostics);
+
+  // Looks a class up in the class table, recording it as a
+  // dependency. Returns NULL if there is no such class, or if it
+  // is hidden from the body being checked.
+  ClassInfo* findClass(Symbol className);
+
+  // Returns false if a class of the program or a method of the
+  // current class is hidden from the body being checked.
+  bool classDeclared(Symbol className);
+  bool methodDeclared(Symbol method);
+
+  // Declares the classes of the program, then checks the bodies of
+  // their methods on the pool.
+  void checkOnPool(ProgramNode* node);
+
+  // Checks the statements of a method body that was left to check
+  // on the pool, and the return type of its method.
+  void checkBody(BodyCheck& body);
+
+  // Checks the Main class, once every class has been checked.
+  // The errors are reported against node.
+  void checkMainClass(ASTNode* node);
+
+  // Reports a type error against the node it was found at.
+  // Errors are recorded in the diagnostics and checking carries
+  // on; the node should then be given the poison type (bt_error)
+  // so that the error does not cause more errors further up the
+  // tree. The possible type errors are defined as an enumeration
+  // above.
+  void typeError(TypeErrorCode code, ASTNode* node = NULL);
   
   // All the visitor functions. You will need to write
   // appropriate implementation in the typecheck.cpp file.
-  virtual void visitProgramNode(ProgramNode* node);
-  virtual void visitClassNode(ClassNode* node);
-  virtual void visitMethodNode(MethodNode* node);
-  virtual void visitMethodBodyNode(MethodBodyNode* node);
-  virtual void visitParameterNode(ParameterNode* node);
-  virtual void visitDeclarationNode(DeclarationNode* node);
-  virtual void visitReturnStatementNode(ReturnStatementNode* node);
-  virtual void visitAssignmentNode(AssignmentNode* node);
-  virtual void visitCallNode(CallNode* node);
-  virtual void visitIfElseNode(IfElseNode* node);
-  virtual void visitWhileNode(WhileNode* node);
-  virtual void visitRepeatNode(RepeatNode* node);
-  virtual void visitPrintNode(PrintNode* node);
-  virtual void visitPlusNode(PlusNode* node);
-  virtual void visitMinusNode(MinusNode* node);
-  virtual void visitTimesNode(TimesNode* node);
-  virtual void visitDivideNode(DivideNode* node);
-  virtual void visitLessNode(LessNode* node);
-  virtual void visitLessEqualNode(LessEqualNode* node);
-  virtual void visitEqualNode(EqualNode* node);
-  virtual void visitAndNode(AndNode* node);
-  virtual void visitOrNode(OrNode* node);
-  virtual void visitNotNode(NotNode* node);
-  virtual void visitNegationNode(NegationNode* node);
-  virtual void visitMethodCallNode(MethodCallNode* node);
-  virtual void visitMemberAccessNode(MemberAccessNode* node);
-  virtual void visitVariableNode(VariableNode* node);
-  virtual void visitIntegerLiteralNode(IntegerLiteralNode* node);
-  virtual void visitBooleanLiteralNode(BooleanLiteralNode* node);
-  virtual void visitNewNode(NewNode* node);
-  virtual void visitIntegerTypeNode(IntegerTypeNode* node);
-  virtual void visitBooleanTypeNode(BooleanTypeNode* node);
-  virtual void visitObjectTypeNode(ObjectTypeNode* node);
-  virtual void visitNoneNode(NoneNode* node);
-  virtual void visitIdentifierNode(IdentifierNode* node);
-  virtual void visitIntegerNode(IntegerNode* node);
+  // TypeCheck is a statically dispatched visitor, so these are
+  // not virtual; identifiers are left to the default handler,
+  // which does nothing.
+  void visitProgramNode(ProgramNode* node);
+  void visitClassNode(ClassNode* node);
+  void visitMethodNode(MethodNode* node);
+  void visitMethodBodyNode(MethodBodyNode* node);
+  void visitParameterNode(ParameterNode* node);
+  void visitDeclarationNode(DeclarationNode* node);
+  void visitReturnStatementNode(ReturnStatementNode* node);
+  void visitAssignmentNode(AssignmentNode* node);
+  void visitCallNode(CallNode* node);
+  void visitIfElseNode(IfElseNode* node);
+  void visitWhileNode(WhileNode* node);
+  void visitRepeatNode(RepeatNode* node);
+  void visitPrintNode(PrintNode* node);
+  void visitPlusNode(PlusNode* node);
+  void visitMinusNode(MinusNode* node);
+  void visitTimesNode(TimesNode* node);
+  void visitDivideNode(DivideNode* node);
+  void visitLessNode(LessNode* node);
+  void visitLessEqualNode(LessEqualNode* node);
+  void visitEqualNode(EqualNode* node);
+  void visitAndNode(AndNode* node);
+  void visitOrNode(OrNode* node);
+  void visitNotNode(NotNode* node);
+  void visitNegationNode(NegationNode* node);
+  void visitMethodCallNode(MethodCallNode* node);
+  void visitMemberAccessNode(MemberAccessNode* node);
+  void visitVariableNode(VariableNode* node);
+  void visitIntegerLiteralNode(IntegerLiteralNode* node);
+  void visitBooleanLiteralNode(BooleanLiteralNode* node);
+  void visitNewNode(NewNode* node);
+  void visitIntegerTypeNode(IntegerTypeNode* node);
+  void visitBooleanTypeNode(BooleanTypeNode* node);
+  void visitObjectTypeNode(ObjectTypeNode* node);
+  void visitNoneNode(NoneNode* node);
+  void visitIntegerNode(IntegerNode* node);
 };
 
-// The following functions are used to print the Symbol Table.
-// They do not need to be modified at all.
-
-std::string genIndent(int indent);
-std::string string(CompoundType type);
-
-void print(VariableTable variableTable, int indent);
-void print(MethodTable methodTable, int indent);
-void print(ClassTable classTable, int indent);
-
 #endif
@@ -0,0 +1,271 @@
+#include "vm.hpp"
+#include "frames.hpp"
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Defines the state of a running program.
+typedef struct machine {
+  const Bytecode *bytecode;
+  Emitter *out;
+  int *stack;
+  Heap *heap;
+  std::vector<StackMap> stackMaps;
+  std::vector<CallRecord> calls;
+  std::string error;
+} Machine;
+
+// Runs a function whose frame starts at frame until it returns.
+// The instructions are dispatched with computed gotos where the
+// compiler has them: every instruction jumps straight to the code
+// of the next, rather than back to a single switch.
+bool execute(Machine &machine, int function, int *frame) {
+  const Bytecode &bytecode = *machine.bytecode;
+  Heap &heap = *machine.heap;
+  int *stackEnd = machine.stack + stackRegisters;
+  size_t base = machine.calls.size();
+  const Function *current;
+  const Function *callee;
+  const Instruction *pc;
+  int *r;
+
+#ifdef __GNUC__
+#define OPCODE_LABEL(name) &&do_##name,
+  static void *labels[] = {OPCODES(OPCODE_LABEL)};
+#undef OPCODE_LABEL
+#define DISPATCH() goto *labels[pc->op]
+#define CASE(name) do_##name:
+#else
+#define DISPATCH() goto dispatch
+#define CASE(name) case op_##name:
+#endif
+#define NEXT()  \
+  do {          \
+    pc++;       \
+    DISPATCH(); \
+  } while (0)
+#define FAIL(message)             \
+  do {                            \
+    machine.error = message;      \
+    machine.calls.resize(base);   \
+    return false;                 \
+  } while (0)
+// Returns to the caller, or from the function that was run, and
+// runs store in the caller's frame
+#define RETURN(store)                             \
+  do {                                            \
+    if (machine.calls.size() == base)             \
+      return true;                                \
+    CallRecord &record = machine.calls.back();    \
+    current = record.function;                    \
+    r = record.frame;                             \
+    pc = record.pc;                               \
+    store;                                        \
+    machine.calls.pop_back();                     \
+    NEXT();                                       \
+  } while (0)
+#define FIELD(ref, offset) (*(int *) (heap.base + (ref) + (offset)))
+#define BYTE(ref, offset) (*(unsigned char *) (heap.base + (ref) + (offset)))
+
+  callee = &bytecode.functions[function];
+  r = frame;
+  goto enter;
+
+  // Enters callee with its frame at r, zeroing its locals
+enter:
+  if (r + callee->registers > stackEnd)
+    FAIL("stack overflow");
+  memset(r + callee->parameters, 0, callee->locals * sizeof(int));
+  current = callee;
+  pc = &callee->code[0];
+
+#ifndef __GNUC__
+dispatch:
+  switch (pc->op) {
+#else
+  DISPATCH();
+#endif
+  CASE(move)
+    r[pc->a] = r[pc->b];
+    NEXT();
+  CASE(constant)
+    r[pc->a] = pc->b;
+    NEXT();
+  CASE(add)
+    r[pc->a] = (unsigned int) r[pc->b] + (unsigned int) r[pc->c];
+    NEXT();
+  CASE(addConstant)
+    r[pc->a] = (unsigned int) r[pc->b] + (unsigned int) pc->c;
+    NEXT();
+  CASE(subtract)
+    r[pc->a] = (unsigned int) r[pc->b] - (unsigned int) r[pc->c];
+    NEXT();
+  CASE(multiply)
+    r[pc->a] = (unsigned int) r[pc->b] * (unsigned int) r[pc->c];
+    NEXT();
+  CASE(divide)
+    if (!r[pc->c])
+      FAIL("division by zero");
+    // The one quotient that does not fit wraps around
+    r[pc->a] = r[pc->c] == -1 ? 0u - (unsigned int) r[pc->b] : r[pc->b] / r[pc->c];
+    NEXT();
+  CASE(less)
+    r[pc->a] = r[pc->b] < r[pc->c];
+    NEXT();
+  CASE(lessEqual)
+    r[pc->a] = r[pc->b] <= r[pc->c];
+    NEXT();
+  CASE(equal)
+    r[pc->a] = r[pc->b] == r[pc->c];
+    NEXT();
+  CASE(and)
+    r[pc->a] = r[pc->b] & r[pc->c];
+    NEXT();
+  CASE(or)
+    r[pc->a] = r[pc->b] | r[pc->c];
+    NEXT();
+  CASE(not)
+    r[pc->a] = !r[pc->b];
+    NEXT();
+  CASE(negate)
+    r[pc->a] = 0u - (unsigned int) r[pc->b];
+    NEXT();
+  CASE(jump)
+    pc = &current->code[pc->b];
+    DISPATCH();
+  CASE(jumpIf)
+    pc = r[pc->a] ? &current->code[pc->b] : pc + 1;
+    DISPATCH();
+  CASE(jumpUnless)
+    pc = r[pc->a] ? pc + 1 : &current->code[pc->b];
+    DISPATCH();
+  CASE(jumpUnlessLess)
+    pc = r[pc->a] < r[pc->b] ? pc + 1 : &current->code[pc->c];
+    DISPATCH();
+  CASE(jumpUnlessLessEqual)
+    pc = r[pc->a] <= r[pc->b] ? pc + 1 : &current->code[pc->c];
+    DISPATCH();
+  CASE(jumpUnlessEqual)
+    pc = r[pc->a] == r[pc->b] ? pc + 1 : &current->code[pc->c];
+    DISPATCH();
+  CASE(getField)
+    if (!r[pc->b])
+      FAIL("member of none accessed");
+    r[pc->a] = FIELD(r[pc->b], pc->c);
+    NEXT();
+  CASE(setField)
+    if (!r[pc->a])
+      FAIL("member of none assigned");
+    FIELD(r[pc->a], pc->c) = r[pc->b];
+    heap.remember(r[pc->a], r[pc->b]);
+    NEXT();
+  CASE(getByte)
+    if (!r[pc->b])
+      FAIL("member of none accessed");
+    r[pc->a] = BYTE(r[pc->b], pc->c);
+    NEXT();
+  CASE(setByte)
+    if (!r[pc->a])
+      FAIL("member of none assigned");
+    BYTE(r[pc->a], pc->c) = r[pc->b];
+    NEXT();
+  CASE(checkClass) {
+    int ref = r[pc->a];
+    if (ref) {
+      int classNumber = FIELD(ref, 0);
+      if (classNumber < pc->b || classNumber > bytecode.classes[pc->b].lastSubclass)
+        FAIL("object used as an object of a class it is not of");
+    }
+    NEXT();
+  }
+  CASE(checkObject)
+    if (!r[pc->a])
+      FAIL("method called on none");
+    NEXT();
+  CASE(new) {
+    FrameRoots roots(bytecode, machine.stackMaps, machine.calls.data(), machine.calls.size(), current, pc, r);
+    if (!(r[pc->a] = heap.allocate(pc->b, roots)))
+      FAIL("out of memory");
+    NEXT();
+  }
+  CASE(call) {
+    CallRecord record = {current, pc, r, pc->a};
+    machine.calls.push_back(record);
+    callee = &bytecode.functions[pc->b];
+    r += pc->c;
+    goto enter;
+  }
+  CASE(callDirect) {
+    if (!r[pc->c])
+      FAIL("method called on none");
+    CallRecord record = {current, pc, r, pc->a};
+    machine.calls.push_back(record);
+    callee = &bytecode.functions[pc->b];
+    r += pc->c;
+    goto enter;
+  }
+  CASE(callMethod) {
+    int ref = r[pc->c];
+    if (!ref)
+      FAIL("method called on none");
+    CallRecord record = {current, pc, r, pc->a};
+    machine.calls.push_back(record);
+    callee = &bytecode.functions[bytecode.classes[FIELD(ref, 0)].methods[pc->b]];
+    r += pc->c;
+    goto enter;
+  }
+  CASE(print)
+    *machine.out << (long) r[pc->a] << "\n";
+    NEXT();
+  CASE(return) {
+    int value = r[pc->a];
+    RETURN(r[record.target] = value);
+  }
+  CASE(returnNone)
+    RETURN((void) 0);
+#ifndef __GNUC__
+  default:
+    FAIL("invalid instruction");
+  }
+#endif
+
+#undef BYTE
+#undef FIELD
+#undef RETURN
+#undef FAIL
+#undef NEXT
+#undef CASE
+#undef DISPATCH
+}
+
+bool run(const Bytecode &bytecode, Emitter &out, std::string &error) {
+  Heap heap(bytecode.classes);
+  Machine machine;
+  machine.bytecode = &bytecode;
+  machine.out = &out;
+  machine.stack = (int *) calloc(stackRegisters, sizeof(int));
+  machine.heap = &heap;
+  StackMap unbuilt;
+  unbuilt.built = false;
+  machine.stackMaps.assign(bytecode.functions.size(), unbuilt);
+
+  // Nothing is running yet, so the Main object is made without roots
+  FrameRoots roots(bytecode, machine.stackMaps, NULL, 0, NULL, NULL, NULL);
+  bool ok = machine.stack && heap.reserved();
+  if (!ok)
+    machine.error = "out of memory";
+  if (ok && !(machine.stack[0] = heap.allocate(bytecode.mainClass, roots))) {
+    machine.error = "out of memory";
+    ok = false;
+  }
+  if (ok && bytecode.mainConstructor >= 0)
+    ok = execute(machine, bytecode.mainConstructor, machine.stack);
+  if (ok)
+    ok = execute(machine, bytecode.mainMethod, machine.stack);
+
+  free(machine.stack);
+  error = machine.error;
+  return ok;
+}
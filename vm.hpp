@@ -0,0 +1,17 @@
+#ifndef __VM_HPP
+#define __VM_HPP
+
+#include "bytecode.hpp"
+#include "emit.hpp"
+
+#include <string>
+
+// Runs a lowered program: creates its Main object, runs the
+// constructor of Main if it has one, then calls main on it, writing
+// what the program prints to out. Returns false, with the reason
+// in error, if the program failed at run time: divided by zero,
+// used a none object, stored an object in a variable of a class it
+// is not of, recursed too deeply or ran out of memory.
+bool run(const Bytecode &bytecode, Emitter &out, std::string &error);
+
+#endif
@@ -0,0 +1,289 @@
+#include "workspace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+// Splits text into the source of each of its classes: everything up
+// to and including the brace that closes the class. Comments are
+// skipped, so that braces in them do not count, and whatever follows
+// the last class goes with it. Returns false if the braces do not
+// balance or a comment does not end, leaving the whole text for the
+// parser to report on.
+bool split(const char *text, size_t length, std::vector<std::string> &classes) {
+  size_t start = 0;
+  int depth = 0;
+  for (size_t i = 0; i < length; i++) {
+    if (text[i] == '/' && i + 1 < length && text[i + 1] == '*') {
+      for (i += 2; i + 1 < length && !(text[i] == '*' && text[i + 1] == '/'); i++)
+        ;
+      if (i + 1 >= length)
+        return false;
+      i++;
+    } else if (text[i] == '{') {
+      depth++;
+    } else if (text[i] == '}') {
+      if (--depth < 0)
+        return false;
+      if (depth == 0) {
+        classes.push_back(std::string(text + start, i + 1 - start));
+        start = i + 1;
+      }
+    }
+  }
+  if (depth != 0 || classes.empty())
+    return false;
+  classes.back().append(text + start, length - start);
+  return true;
+}
+
+unsigned long mix(unsigned long hash, unsigned long word) {
+  return hash ^ (word + 0x9e3779b97f4a7c15ul + (hash << 6) + (hash >> 2));
+}
+
+unsigned long mix(unsigned long hash, const std::list<TypeId> &types) {
+  for (std::list<TypeId>::const_iterator type = types.begin(); type != types.end(); ++type)
+    hash = mix(hash, *type);
+  return hash;
+}
+
+// Returns the fingerprint of a class: its super class, whether it is
+// poisoned, and the names, types and places of its members and
+// methods, which is all the check of another class can see of it.
+// The entries of each table are summed, so the order the table
+// keeps them in does not matter. No class has the fingerprint 0.
+unsigned long fingerprint(const ClassInfo &info, bool poisoned) {
+  unsigned long entries = 0;
+  for (MemberLayout::const_iterator it = info.memberLayout->begin(); it != info.memberLayout->end(); ++it) {
+    const VariableInfo &member = it->second.info;
+    entries += mix(mix(mix(mix(mix(1, it->first), member.type), member.offset), member.size), it->second.owner);
+  }
+  for (MethodLayout::const_iterator it = info.methodLayout->begin(); it != info.methodLayout->end(); ++it) {
+    const MethodInfo &method = it->second.info;
+    entries += mix(mix(mix(mix(mix(2, it->first), it->second.slot), it->second.owner), method.returnType),
+                   *method.parameters);
+  }
+  for (MethodTable::const_iterator it = info.methods->begin(); it != info.methods->end(); ++it)
+    entries += mix(mix(mix(3, it->first), it->second.returnType), *it->second.parameters);
+  return mix(mix(mix(mix(0, info.superClassName), poisoned), info.membersSize), entries) | 1;
+}
+
+// Points the inherited entries of the virtual table of a class that
+// is kept at the method tables of the classes that now define them,
+// which may have been checked again since.
+void refresh(ClassInfo &info, Symbol className, ClassTable &classTable) {
+  for (MethodLayout::const_iterator it = info.methodLayout->begin(); it != info.methodLayout->end(); ++it) {
+    if (it->second.owner == className)
+      continue;
+    ClassInfo *owner = classTable.lookup(it->second.owner);
+    MethodInfo *method = owner ? owner->methods->lookup(it->first) : NULL;
+    if (method)
+      info.methodLayout->at(it->first).info = *method;
+  }
+}
+
+// Returns true if every class the class looked up when it was
+// checked still has the fingerprint it had then.
+bool unchanged(const CheckedClass &checked, const SymbolMap<unsigned long> &fingerprints) {
+  for (size_t i = 0; i < checked.dependencies.size(); i++) {
+    const unsigned long *now = fingerprints.lookup(checked.dependencies[i].className);
+    if ((now ? *now : 0) != checked.dependencies[i].fingerprint)
+      return false;
+  }
+  return true;
+}
+
+Workspace::Workspace(const std::vector<const Library*> &libraries, int maxErrors) {
+  this->libraries = &libraries;
+  this->maxErrors = maxErrors;
+  state = NULL;
+  imported = NULL;
+  whole = NULL;
+  generation = 0;
+  parsed = 0;
+  checked = 0;
+  reset();
+}
+
+Workspace::~Workspace() {
+  discard();
+  delete whole;
+}
+
+// Frees every class and the state they were parsed into.
+void Workspace::discard() {
+  for (std::unordered_map<std::string, CheckedClass *>::iterator it = classes.begin(); it != classes.end(); ++it) {
+    if (it->second->checked)
+      destroy(it->second->info);
+    delete it->second;
+  }
+  classes.clear();
+  if (state) {
+    // The table of the last check only has entries of the classes
+    delete state->classTable;
+    state->classTable = NULL;
+  }
+  delete state;
+  destroy(imported);
+  importedFingerprints = SymbolMap<unsigned long>();
+}
+
+// Starts over with no classes, importing the libraries again into
+// a new state, so that the trees and names of classes that are gone
+// are freed.
+void Workspace::reset() {
+  discard();
+  state = new Compilation();
+  importFailed = false;
+  for (size_t i = 0; i < libraries->size(); i++)
+    importFailed = !import(*state, *(*libraries)[i]) || importFailed;
+  imported = state->classTable ? state->classTable : new ClassTable();
+  state->classTable = NULL;
+  state->diagnostics.errors.clear();
+  for (ClassTable::const_iterator it = imported->begin(); it != imported->end(); ++it)
+    importedFingerprints[it->first] = fingerprint(it->second, false);
+  garbage = 0;
+}
+
+// Parses the text of one class into the state. Returns NULL if it
+// is not one class that parses without errors.
+CheckedClass *Workspace::parseClass(const std::string &text) {
+  // The scanner needs two NULs after the text
+  std::string buffer(text);
+  buffer.append(2, '\0');
+  size_t used = state->arena.bytesUsed();
+  state->program = NULL;
+  state->diagnostics.errors.clear();
+  bool parsedClass = parse(*state, &buffer[0], text.size()) && state->program->class_list->size() == 1;
+  state->diagnostics.errors.clear();
+  if (!parsedClass)
+    return NULL;
+  CheckedClass *parsedText = new CheckedClass();
+  parsedText->text = text;
+  parsedText->node = state->program->class_list->front();
+  parsedText->name = parsedText->node->identifier_1->symbol;
+  parsedText->bytes = state->arena.bytesUsed() - used;
+  parsedText->checked = false;
+  parsedText->generation = 0;
+  parsed++;
+  return parsedText;
+}
+
+Compilation &Workspace::checkWhole(const char *path) {
+  delete whole;
+  whole = new Compilation();
+  whole->diagnostics.maxErrors = maxErrors;
+  for (size_t i = 0; i < libraries->size(); i++)
+    import(*whole, *(*libraries)[i]);
+  checkFile(*whole, path);
+  return *whole;
+}
+
+Compilation &Workspace::check(const char *path) {
+  parsed = 0;
+  checked = 0;
+  Source file;
+  std::vector<std::string> texts;
+  if (importFailed || !file.map(path) || !split(file.text, file.length, texts))
+    return checkWhole(path);
+  if (garbage > state->arena.bytesUsed() / 2)
+    reset();
+  STATS_ACTIVATE(state->statistics);
+  generation++;
+
+  // Find the classes of the file, parsing those that are new
+  std::vector<CheckedClass *> order;
+  std::set<Symbol> names;
+  for (size_t i = 0; i < texts.size(); i++) {
+    CheckedClass *&entry = classes[texts[i]];
+    if (!entry)
+      entry = parseClass(texts[i]);
+    if (!entry) {
+      classes.erase(texts[i]);
+      return checkWhole(path);
+    }
+    if (!names.insert(entry->name).second)
+      return checkWhole(path);
+    order.push_back(entry);
+  }
+
+  // Check the classes in order, as the whole program would be, but
+  // keep those whose text and dependencies did not change
+  delete state->classTable;
+  state->classTable = new ClassTable(*imported);
+  ClassTable &classTable = *state->classTable;
+  SymbolMap<unsigned long> fingerprints(importedFingerprints);
+  Diagnostics checking;
+  TypeCheck typecheck(state->symbols, checking);
+  typecheck.classTable = state->classTable;
+  std::vector<Symbol> dependencies;
+  for (size_t i = 0; i < order.size(); i++) {
+    CheckedClass &entry = *order[i];
+    entry.generation = generation;
+    if (entry.checked && unchanged(entry, fingerprints)) {
+      refresh(entry.info, entry.name, classTable);
+      classTable[entry.name] = entry.info;
+      if (entry.poisoned)
+        typecheck.poisonedClasses.insert(entry.name);
+      fingerprints[entry.name] = entry.fingerprint;
+      continue;
+    }
+    if (entry.checked)
+      destroy(entry.info);
+    dependencies.clear();
+    checking.errors.clear();
+    typecheck.dependencies = &dependencies;
+    typecheck.visitClassNode(entry.node);
+    typecheck.dependencies = NULL;
+
+    entry.checked = true;
+    entry.info = classTable.at(entry.name);
+    entry.poisoned = typecheck.poisonedClasses.count(entry.name) > 0;
+    entry.fingerprint = fingerprint(entry.info, entry.poisoned);
+    entry.errors.clear();
+    for (size_t j = 0; j < checking.errors.size(); j++) {
+      entry.errors.push_back(checking.errors[j]);
+      entry.errors.back().node = NULL;
+    }
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+    entry.dependencies.clear();
+    for (size_t j = 0; j < dependencies.size(); j++) {
+      const unsigned long *now = fingerprints.lookup(dependencies[j]);
+      Dependency dependency = {dependencies[j], now ? *now : 0};
+      entry.dependencies.push_back(dependency);
+    }
+    fingerprints[entry.name] = entry.fingerprint;
+    checked++;
+  }
+  // The Main class is the class checked last
+  checking.errors.clear();
+  typecheck.currentClassName = order.back()->name;
+  typecheck.checkMainClass(NULL);
+
+  // Report the errors of every class in order, then those of the
+  // program as a whole
+  Diagnostics &diagnostics = state->diagnostics;
+  diagnostics.errors.clear();
+  diagnostics.dropped = 0;
+  diagnostics.maxErrors = maxErrors;
+  for (size_t i = 0; i < order.size(); i++)
+    for (size_t j = 0; j < order[i]->errors.size(); j++)
+      diagnostics.error(order[i]->errors[j].message, NULL, 0, order[i]->errors[j].where);
+  for (size_t j = 0; j < checking.errors.size(); j++)
+    diagnostics.error(checking.errors[j].message, NULL, 0, checking.errors[j].where);
+
+  // Free the classes that are no longer in the file
+  for (std::unordered_map<std::string, CheckedClass *>::iterator it = classes.begin(); it != classes.end();) {
+    if (it->second->generation == generation) {
+      ++it;
+      continue;
+    }
+    if (it->second->checked)
+      destroy(it->second->info);
+    garbage += it->second->bytes;
+    delete it->second;
+    it = classes.erase(it);
+  }
+  return *state;
+}
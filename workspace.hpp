@@ -0,0 +1,100 @@
+#ifndef __WORKSPACE_HPP
+#define __WORKSPACE_HPP
+
+#include "langcheck.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Defines a class the check of another class looked up, with the
+// fingerprint it had then, or 0 if there was no such class yet.
+typedef struct dependency {
+  Symbol className;
+  unsigned long fingerprint;
+} Dependency;
+
+// Defines one class of a file the compile server has checked: the
+// text it was parsed from, its tree, and what checking it gave.
+// The fingerprint sums up everything other classes can see of it,
+// so a class need only be checked again when its text changes or
+// the fingerprint of one of its dependencies does. Editing the body
+// of a method changes the class itself but not its fingerprint.
+typedef struct checkedclass {
+  std::string text;
+  ClassNode *node;
+  Symbol name;
+  // The bytes the tree took in the arena
+  size_t bytes;
+
+  // Whether the class has been checked; the rest is only set once
+  // it has. The tables of info belong to the class.
+  bool checked;
+  ClassInfo info;
+  bool poisoned;
+  unsigned long fingerprint;
+  // The errors found checking it, kept without their nodes
+  std::vector<Diagnostic> errors;
+  std::vector<Dependency> dependencies;
+
+  // The last check the class was part of
+  unsigned long generation;
+} CheckedClass;
+
+// Defines what the compile server keeps of one source file between
+// requests. Checking the file again splits it into the text of each
+// class, parses only the classes whose text is new, and type checks
+// only those and the classes whose dependencies changed; the other
+// classes keep their entries in the class table and their errors.
+// The result is the same as checking the whole file afresh. Files
+// the parts of which do not parse on their own, or that define a
+// class twice, are checked whole.
+class Workspace {
+private:
+  const std::vector<const Library*> *libraries;
+
+  // The trees and names of the classes, and the classes of the
+  // libraries, with their fingerprints
+  Compilation *state;
+  ClassTable *imported;
+  SymbolMap<unsigned long> importedFingerprints;
+  // Set if a library is malformed, which checking whole reports
+  bool importFailed;
+
+  // The classes, by their text
+  std::unordered_map<std::string, CheckedClass *> classes;
+  unsigned long generation;
+
+  // The bytes of trees in the arena whose classes are gone
+  size_t garbage;
+
+  // The result of the last file checked whole
+  Compilation *whole;
+
+  Workspace(const Workspace &);
+  Workspace &operator=(const Workspace &);
+
+  void reset();
+  void discard();
+  CheckedClass *parseClass(const std::string &text);
+  Compilation &checkWhole(const char *path);
+
+public:
+  int maxErrors;
+
+  // How many classes the last check parsed and type checked
+  int parsed;
+  int checked;
+
+  // The classes of the libraries are imported into every check.
+  // The libraries must outlive the workspace.
+  Workspace(const std::vector<const Library*> &libraries, int maxErrors);
+  ~Workspace();
+
+  // Checks the file at path, which may have changed since the last
+  // time, and returns the compilation that holds the symbol table
+  // and the errors. The compilation is valid until the next check.
+  Compilation &check(const char *path);
+};
+
+#endif